@@ -0,0 +1,859 @@
+#include "color_convert.h"
+#include <stdio.h>
+
+//libirparse rounds every product and sum to double, a fused multiply-add changes the last bit of some pixels
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
+
+#if defined(COLOR_CONVERT_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <immintrin.h>
+#elif defined(COLOR_CONVERT_ARM64)
+#include <arm_neon.h>
+#endif
+
+//the sse4.1 and avx2 kernels are built into every x86 binary and only called on cpus which have them
+#if defined(__GNUC__)
+#define COLOR_TARGET_SSE41  __attribute__((target("sse4.1")))
+#define COLOR_TARGET_AVX2   __attribute__((target("avx2")))
+#else
+#define COLOR_TARGET_SSE41
+#define COLOR_TARGET_AVX2
+#endif
+
+//R = Y + 1.14(V-128), G = Y - 0.394(U-128) - 0.581(V-128), B = Y + 2.032(U-128)
+#define COLOR_R_V   1.14
+#define COLOR_G_U   0.394
+#define COLOR_G_V   0.581
+#define COLOR_B_U   2.032
+
+//byte order of the yuv kernels' output pixels. BGRA is the little endian XRGB8888 of drm, alpha 255
+typedef enum {
+    COLOR_LAYOUT_RGB = 0,
+    COLOR_LAYOUT_BGR,
+    COLOR_LAYOUT_BGRA
+}ColorLayout_e;
+
+typedef struct {
+    //pair_num pixel pairs of Y0 U Y1 V
+    void (*yuyv_convert)(const uint8_t* yuyv, int pair_num, uint8_t* dst, ColorLayout_e layout);
+    //one row of the semi planar formats, the pairs share the U V bytes of the uv row
+    void (*nv_row_convert)(const uint8_t* y_row, const uint8_t* uv_row, int pair_num, uint8_t* dst, ColorLayout_e layout);
+    void (*rgb_to_bgr)(const uint8_t* rgb, int pixel_num, uint8_t* bgr);
+    void (*y16_to_rgb)(const uint16_t* y16, int pixel_num, uint8_t* rgb);
+    void (*y14_to_yuv444)(const uint16_t* y14, int pixel_num, uint8_t* yuv);
+}ColorKernels_t;
+
+
+//scalar kernels, the reference of the vector ones and their tails
+static inline uint8_t color_clamp(int value)
+{
+    if (value > 255)
+    {
+        return 255;
+    }
+    return (value <= 0) ? 0 : (uint8_t)value;
+}
+
+static inline int color_pixel_size(ColorLayout_e layout)
+{
+    return (layout == COLOR_LAYOUT_BGRA) ? 4 : 3;
+}
+
+static inline void yuv_pixel_convert(int y, int u, int v, uint8_t* dst, ColorLayout_e layout)
+{
+    double du = u - 128;
+    double dv = v - 128;
+    uint8_t r = color_clamp((int)(y + COLOR_R_V * dv));
+    uint8_t g = color_clamp((int)(y - COLOR_G_U * du - COLOR_G_V * dv));
+    uint8_t b = color_clamp((int)(y + COLOR_B_U * du));
+    if (layout == COLOR_LAYOUT_RGB)
+    {
+        dst[0] = r;
+        dst[1] = g;
+        dst[2] = b;
+        return;
+    }
+    dst[0] = b;
+    dst[1] = g;
+    dst[2] = r;
+    if (layout == COLOR_LAYOUT_BGRA)
+    {
+        dst[3] = 255;
+    }
+}
+
+static void yuyv_convert_c(const uint8_t* yuyv, int pair_num, uint8_t* dst, ColorLayout_e layout)
+{
+    int size = color_pixel_size(layout);
+    for (int i = 0; i < pair_num; i++)
+    {
+        yuv_pixel_convert(yuyv[4 * i], yuyv[4 * i + 1], yuyv[4 * i + 3], dst + 2 * size * i, layout);
+        yuv_pixel_convert(yuyv[4 * i + 2], yuyv[4 * i + 1], yuyv[4 * i + 3], dst + 2 * size * i + size, layout);
+    }
+}
+
+static void nv_row_convert_c(const uint8_t* y_row, const uint8_t* uv_row, int pair_num, uint8_t* dst, ColorLayout_e layout)
+{
+    int size = color_pixel_size(layout);
+    for (int i = 0; i < pair_num; i++)
+    {
+        yuv_pixel_convert(y_row[2 * i], uv_row[2 * i], uv_row[2 * i + 1], dst + 2 * size * i, layout);
+        yuv_pixel_convert(y_row[2 * i + 1], uv_row[2 * i], uv_row[2 * i + 1], dst + 2 * size * i + size, layout);
+    }
+}
+
+static void rgb_to_bgr_c(const uint8_t* rgb, int pixel_num, uint8_t* bgr)
+{
+    for (int i = 0; i < pixel_num; i++)
+    {
+        uint8_t r = rgb[3 * i];
+        uint8_t g = rgb[3 * i + 1];
+        uint8_t b = rgb[3 * i + 2];
+        bgr[3 * i] = b;
+        bgr[3 * i + 1] = g;
+        bgr[3 * i + 2] = r;
+    }
+}
+
+static void y16_to_rgb_c(const uint16_t* y16, int pixel_num, uint8_t* rgb)
+{
+    for (int i = 0; i < pixel_num; i++)
+    {
+        uint8_t gray = y16[i] / 257;
+        rgb[3 * i] = gray;
+        rgb[3 * i + 1] = gray;
+        rgb[3 * i + 2] = gray;
+    }
+}
+
+static void y14_to_yuv444_c(const uint16_t* y14, int pixel_num, uint8_t* yuv)
+{
+    for (int i = 0; i < pixel_num; i++)
+    {
+        int value = (y14[i] > 16383) ? 16383 : y14[i];
+        yuv[3 * i] = value * 255 / 16383;
+        yuv[3 * i + 1] = 128;
+        yuv[3 * i + 2] = 128;
+    }
+}
+
+static const ColorKernels_t color_kernels_c = {
+    yuyv_convert_c, nv_row_convert_c, rgb_to_bgr_c, y16_to_rgb_c, y14_to_yuv444_c
+};
+
+
+#if defined(COLOR_CONVERT_X86)
+//16 pixels of three planes to 48 bytes of packed RGB888
+static inline COLOR_TARGET_SSE41 void store_rgb24_sse41(uint8_t* dst, __m128i r, __m128i g, __m128i b)
+{
+    __m128i out0 = _mm_or_si128(_mm_or_si128(
+        _mm_shuffle_epi8(r, _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5)),
+        _mm_shuffle_epi8(g, _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1))),
+        _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1)));
+    __m128i out1 = _mm_or_si128(_mm_or_si128(
+        _mm_shuffle_epi8(r, _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1)),
+        _mm_shuffle_epi8(g, _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10))),
+        _mm_shuffle_epi8(b, _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1)));
+    __m128i out2 = _mm_or_si128(_mm_or_si128(
+        _mm_shuffle_epi8(r, _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1)),
+        _mm_shuffle_epi8(g, _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1))),
+        _mm_shuffle_epi8(b, _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15)));
+    _mm_storeu_si128((__m128i*)dst, out0);
+    _mm_storeu_si128((__m128i*)(dst + 16), out1);
+    _mm_storeu_si128((__m128i*)(dst + 32), out2);
+}
+
+//16 pixels of three planes in the byte order of layout, 48 or 64 bytes
+static inline COLOR_TARGET_SSE41 void store_pixels16_sse41(uint8_t* dst, __m128i r, __m128i g, __m128i b, ColorLayout_e layout)
+{
+    if (layout == COLOR_LAYOUT_RGB)
+    {
+        store_rgb24_sse41(dst, r, g, b);
+        return;
+    }
+    if (layout == COLOR_LAYOUT_BGR)
+    {
+        store_rgb24_sse41(dst, b, g, r);
+        return;
+    }
+
+    const __m128i alpha = _mm_set1_epi8((char)0xff);
+    __m128i bg = _mm_unpacklo_epi8(b, g);
+    __m128i ra = _mm_unpacklo_epi8(r, alpha);
+    _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(bg, ra));
+    bg = _mm_unpackhi_epi8(b, g);
+    ra = _mm_unpackhi_epi8(r, alpha);
+    _mm_storeu_si128((__m128i*)(dst + 32), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(dst + 48), _mm_unpackhi_epi16(bg, ra));
+}
+
+//8 pixel pairs, Y0 Y1 U V bytes apart in the low 8 bytes of each register
+static inline COLOR_TARGET_SSE41 void load_yuyv_pairs8_sse41(const uint8_t* yuyv, __m128i* y_even, __m128i* y_odd, __m128i* u, __m128i* v)
+{
+    const __m128i split = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    __m128i first = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)yuyv), split);
+    __m128i second = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(yuyv + 16)), split);
+    __m128i y_even_u = _mm_unpacklo_epi32(first, second);
+    __m128i y_odd_v = _mm_unpackhi_epi32(first, second);
+    *y_even = y_even_u;
+    *u = _mm_srli_si128(y_even_u, 8);
+    *y_odd = y_odd_v;
+    *v = _mm_srli_si128(y_odd_v, 8);
+}
+
+static inline COLOR_TARGET_SSE41 void load_nv_pairs8_sse41(const uint8_t* y_row, const uint8_t* uv_row, __m128i* y_even, __m128i* y_odd, __m128i* u, __m128i* v)
+{
+    const __m128i split = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    __m128i y = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)y_row), split);
+    __m128i uv = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)uv_row), split);
+    *y_even = y;
+    *y_odd = _mm_srli_si128(y, 8);
+    *u = uv;
+    *v = _mm_srli_si128(uv, 8);
+}
+
+//r g b of 2 groups of 4 pixel pairs as int32, even and odd pixels apart, to 16 pixels of layout.
+//the saturating packs clamp to 0~255 as libirparse does
+static inline COLOR_TARGET_SSE41 void store_pairs8_sse41(__m128i even[2][3], __m128i odd[2][3], uint8_t* dst, ColorLayout_e layout)
+{
+    __m128i pixels[3];
+    for (int c = 0; c < 3; c++)
+    {
+        __m128i even_16 = _mm_packs_epi32(even[0][c], even[1][c]);
+        __m128i odd_16 = _mm_packs_epi32(odd[0][c], odd[1][c]);
+        pixels[c] = _mm_unpacklo_epi8(_mm_packus_epi16(even_16, even_16), _mm_packus_epi16(odd_16, odd_16));
+    }
+    store_pixels16_sse41(dst, pixels[0], pixels[1], pixels[2], layout);
+}
+
+static inline COLOR_TARGET_SSE41 __m128i cvtt_pd2_epi32_sse41(__m128d low, __m128d high)
+{
+    return _mm_unpacklo_epi64(_mm_cvttpd_epi32(low), _mm_cvttpd_epi32(high));
+}
+
+//4 pixels of y as int32, the chroma products of their pairs 2 doubles a register
+static inline COLOR_TARGET_SSE41 void yuv_pixels4_sse41(__m128i y, const __m128d* r_v, const __m128d* g_u, const __m128d* g_v, const __m128d* b_u, __m128i* rgb)
+{
+    __m128d y_low = _mm_cvtepi32_pd(y);
+    __m128d y_high = _mm_cvtepi32_pd(_mm_unpackhi_epi64(y, y));
+    rgb[0] = cvtt_pd2_epi32_sse41(_mm_add_pd(y_low, r_v[0]), _mm_add_pd(y_high, r_v[1]));
+    rgb[1] = cvtt_pd2_epi32_sse41(_mm_sub_pd(_mm_sub_pd(y_low, g_u[0]), g_v[0]), _mm_sub_pd(_mm_sub_pd(y_high, g_u[1]), g_v[1]));
+    rgb[2] = cvtt_pd2_epi32_sse41(_mm_add_pd(y_low, b_u[0]), _mm_add_pd(y_high, b_u[1]));
+}
+
+static COLOR_TARGET_SSE41 void yuv_pairs8_convert_sse41(__m128i y_even, __m128i y_odd, __m128i u, __m128i v, uint8_t* dst, ColorLayout_e layout)
+{
+    const __m128i offset = _mm_set1_epi32(128);
+    __m128i even[2][3];
+    __m128i odd[2][3];
+    for (int k = 0; k < 2; k++)
+    {
+        __m128i du = _mm_sub_epi32(_mm_cvtepu8_epi32(u), offset);
+        __m128i dv = _mm_sub_epi32(_mm_cvtepu8_epi32(v), offset);
+        __m128d du_pd[2] = { _mm_cvtepi32_pd(du), _mm_cvtepi32_pd(_mm_unpackhi_epi64(du, du)) };
+        __m128d dv_pd[2] = { _mm_cvtepi32_pd(dv), _mm_cvtepi32_pd(_mm_unpackhi_epi64(dv, dv)) };
+        __m128d r_v[2], g_u[2], g_v[2], b_u[2];
+        for (int i = 0; i < 2; i++)
+        {
+            r_v[i] = _mm_mul_pd(_mm_set1_pd(COLOR_R_V), dv_pd[i]);
+            g_u[i] = _mm_mul_pd(_mm_set1_pd(COLOR_G_U), du_pd[i]);
+            g_v[i] = _mm_mul_pd(_mm_set1_pd(COLOR_G_V), dv_pd[i]);
+            b_u[i] = _mm_mul_pd(_mm_set1_pd(COLOR_B_U), du_pd[i]);
+        }
+        yuv_pixels4_sse41(_mm_cvtepu8_epi32(y_even), r_v, g_u, g_v, b_u, even[k]);
+        yuv_pixels4_sse41(_mm_cvtepu8_epi32(y_odd), r_v, g_u, g_v, b_u, odd[k]);
+
+        y_even = _mm_srli_si128(y_even, 4);
+        y_odd = _mm_srli_si128(y_odd, 4);
+        u = _mm_srli_si128(u, 4);
+        v = _mm_srli_si128(v, 4);
+    }
+    store_pairs8_sse41(even, odd, dst, layout);
+}
+
+static COLOR_TARGET_SSE41 void yuyv_convert_sse41(const uint8_t* yuyv, int pair_num, uint8_t* dst, ColorLayout_e layout)
+{
+    int size = color_pixel_size(layout);
+    int i = 0;
+    for (; i + 8 <= pair_num; i += 8)
+    {
+        __m128i y_even, y_odd, u, v;
+        load_yuyv_pairs8_sse41(yuyv + 4 * i, &y_even, &y_odd, &u, &v);
+        yuv_pairs8_convert_sse41(y_even, y_odd, u, v, dst + 2 * size * i, layout);
+    }
+    yuyv_convert_c(yuyv + 4 * i, pair_num - i, dst + 2 * size * i, layout);
+}
+
+static COLOR_TARGET_SSE41 void nv_row_convert_sse41(const uint8_t* y_row, const uint8_t* uv_row, int pair_num, uint8_t* dst, ColorLayout_e layout)
+{
+    int size = color_pixel_size(layout);
+    int i = 0;
+    for (; i + 8 <= pair_num; i += 8)
+    {
+        __m128i y_even, y_odd, u, v;
+        load_nv_pairs8_sse41(y_row + 2 * i, uv_row + 2 * i, &y_even, &y_odd, &u, &v);
+        yuv_pairs8_convert_sse41(y_even, y_odd, u, v, dst + 2 * size * i, layout);
+    }
+    nv_row_convert_c(y_row + 2 * i, uv_row + 2 * i, pair_num - i, dst + 2 * size * i, layout);
+}
+
+//5 pixels a step, the 16th byte is stored back unchanged so rgb and bgr may be the same frame
+static COLOR_TARGET_SSE41 void rgb_to_bgr_sse41(const uint8_t* rgb, int pixel_num, uint8_t* bgr)
+{
+    const __m128i swap = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+    int byte_size = pixel_num * 3;
+    int i = 0;
+    for (; i + 16 <= byte_size; i += 15)
+    {
+        _mm_storeu_si128((__m128i*)(bgr + i), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(rgb + i)), swap));
+    }
+    rgb_to_bgr_c(rgb + i, (byte_size - i) / 3, bgr + i);
+}
+
+static COLOR_TARGET_SSE41 void y16_to_rgb_sse41(const uint16_t* y16, int pixel_num, uint8_t* rgb)
+{
+    //x / 257 == (x * 0xff01) >> 24 for every 16 bit x
+    const __m128i divisor = _mm_set1_epi16((short)0xff01);
+    int i = 0;
+    for (; i + 16 <= pixel_num; i += 16)
+    {
+        __m128i low = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(y16 + i)), divisor), 8);
+        __m128i high = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(y16 + i + 8)), divisor), 8);
+        __m128i gray = _mm_packus_epi16(low, high);
+        store_rgb24_sse41(rgb + 3 * i, gray, gray, gray);
+    }
+    y16_to_rgb_c(y16 + i, pixel_num - i, rgb + 3 * i);
+}
+
+static COLOR_TARGET_SSE41 void y14_to_yuv444_sse41(const uint16_t* y14, int pixel_num, uint8_t* yuv)
+{
+    //x * 255 / 16383 == (x * 65284) >> 22 for x <= 16383
+    const __m128i max_value = _mm_set1_epi16(16383);
+    const __m128i divisor = _mm_set1_epi16((short)65284);
+    const __m128i chroma = _mm_set1_epi8((char)128);
+    int i = 0;
+    for (; i + 16 <= pixel_num; i += 16)
+    {
+        __m128i low = _mm_min_epu16(_mm_loadu_si128((const __m128i*)(y14 + i)), max_value);
+        __m128i high = _mm_min_epu16(_mm_loadu_si128((const __m128i*)(y14 + i + 8)), max_value);
+        low = _mm_srli_epi16(_mm_mulhi_epu16(low, divisor), 6);
+        high = _mm_srli_epi16(_mm_mulhi_epu16(high, divisor), 6);
+        store_rgb24_sse41(yuv + 3 * i, _mm_packus_epi16(low, high), chroma, chroma);
+    }
+    y14_to_yuv444_c(y14 + i, pixel_num - i, yuv + 3 * i);
+}
+
+static const ColorKernels_t color_kernels_sse41 = {
+    yuyv_convert_sse41, nv_row_convert_sse41, rgb_to_bgr_sse41, y16_to_rgb_sse41, y14_to_yuv444_sse41
+};
+
+//avx2 runs the double precision math 4 lanes wide, the rest is the sse4.1 code
+static COLOR_TARGET_AVX2 void yuv_pairs8_convert_avx2(__m128i y_even, __m128i y_odd, __m128i u, __m128i v, uint8_t* dst, ColorLayout_e layout)
+{
+    const __m128i offset = _mm_set1_epi32(128);
+    __m128i even[2][3];
+    __m128i odd[2][3];
+    for (int k = 0; k < 2; k++)
+    {
+        __m256d du = _mm256_cvtepi32_pd(_mm_sub_epi32(_mm_cvtepu8_epi32(u), offset));
+        __m256d dv = _mm256_cvtepi32_pd(_mm_sub_epi32(_mm_cvtepu8_epi32(v), offset));
+        __m256d r_v = _mm256_mul_pd(_mm256_set1_pd(COLOR_R_V), dv);
+        __m256d g_u = _mm256_mul_pd(_mm256_set1_pd(COLOR_G_U), du);
+        __m256d g_v = _mm256_mul_pd(_mm256_set1_pd(COLOR_G_V), dv);
+        __m256d b_u = _mm256_mul_pd(_mm256_set1_pd(COLOR_B_U), du);
+
+        __m256d y = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(y_even));
+        even[k][0] = _mm256_cvttpd_epi32(_mm256_add_pd(y, r_v));
+        even[k][1] = _mm256_cvttpd_epi32(_mm256_sub_pd(_mm256_sub_pd(y, g_u), g_v));
+        even[k][2] = _mm256_cvttpd_epi32(_mm256_add_pd(y, b_u));
+        y = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(y_odd));
+        odd[k][0] = _mm256_cvttpd_epi32(_mm256_add_pd(y, r_v));
+        odd[k][1] = _mm256_cvttpd_epi32(_mm256_sub_pd(_mm256_sub_pd(y, g_u), g_v));
+        odd[k][2] = _mm256_cvttpd_epi32(_mm256_add_pd(y, b_u));
+
+        y_even = _mm_srli_si128(y_even, 4);
+        y_odd = _mm_srli_si128(y_odd, 4);
+        u = _mm_srli_si128(u, 4);
+        v = _mm_srli_si128(v, 4);
+    }
+    store_pairs8_sse41(even, odd, dst, layout);
+}
+
+static COLOR_TARGET_AVX2 void yuyv_convert_avx2(const uint8_t* yuyv, int pair_num, uint8_t* dst, ColorLayout_e layout)
+{
+    int size = color_pixel_size(layout);
+    int i = 0;
+    for (; i + 8 <= pair_num; i += 8)
+    {
+        __m128i y_even, y_odd, u, v;
+        load_yuyv_pairs8_sse41(yuyv + 4 * i, &y_even, &y_odd, &u, &v);
+        yuv_pairs8_convert_avx2(y_even, y_odd, u, v, dst + 2 * size * i, layout);
+    }
+    yuyv_convert_c(yuyv + 4 * i, pair_num - i, dst + 2 * size * i, layout);
+}
+
+static COLOR_TARGET_AVX2 void nv_row_convert_avx2(const uint8_t* y_row, const uint8_t* uv_row, int pair_num, uint8_t* dst, ColorLayout_e layout)
+{
+    int size = color_pixel_size(layout);
+    int i = 0;
+    for (; i + 8 <= pair_num; i += 8)
+    {
+        __m128i y_even, y_odd, u, v;
+        load_nv_pairs8_sse41(y_row + 2 * i, uv_row + 2 * i, &y_even, &y_odd, &u, &v);
+        yuv_pairs8_convert_avx2(y_even, y_odd, u, v, dst + 2 * size * i, layout);
+    }
+    nv_row_convert_c(y_row + 2 * i, uv_row + 2 * i, pair_num - i, dst + 2 * size * i, layout);
+}
+
+//the byte shuffles of the gray and rgb kernels are load/store bound, 256 bit registers don't make them faster
+static const ColorKernels_t color_kernels_avx2 = {
+    yuyv_convert_avx2, nv_row_convert_avx2, rgb_to_bgr_sse41, y16_to_rgb_sse41, y14_to_yuv444_sse41
+};
+
+static bool color_cpu_has_sse41(void)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+static bool color_cpu_has_avx2(void)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    //avx needs the os to save the ymm registers too
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+
+#if defined(COLOR_CONVERT_ARM64)
+static inline void s16_to_f64_neon(int16x8_t x, float64x2_t* out)
+{
+    int32x4_t low = vmovl_s16(vget_low_s16(x));
+    int32x4_t high = vmovl_s16(vget_high_s16(x));
+    out[0] = vcvtq_f64_s64(vmovl_s32(vget_low_s32(low)));
+    out[1] = vcvtq_f64_s64(vmovl_s32(vget_high_s32(low)));
+    out[2] = vcvtq_f64_s64(vmovl_s32(vget_low_s32(high)));
+    out[3] = vcvtq_f64_s64(vmovl_s32(vget_high_s32(high)));
+}
+
+//truncate toward zero like the scalar cast, then clamp to 0~255
+static inline uint8x8_t f64_to_u8_neon(const float64x2_t* in)
+{
+    int32x4_t low = vcombine_s32(vmovn_s64(vcvtq_s64_f64(in[0])), vmovn_s64(vcvtq_s64_f64(in[1])));
+    int32x4_t high = vcombine_s32(vmovn_s64(vcvtq_s64_f64(in[2])), vmovn_s64(vcvtq_s64_f64(in[3])));
+    return vqmovun_s16(vcombine_s16(vmovn_s32(low), vmovn_s32(high)));
+}
+
+static inline uint8x16_t zip_pixels_neon(uint8x8_t even, uint8x8_t odd)
+{
+    uint8x8x2_t zipped = vzip_u8(even, odd);
+    return vcombine_u8(zipped.val[0], zipped.val[1]);
+}
+
+static void yuv_pairs8_convert_neon(uint8x8_t y_even, uint8x8_t y_odd, uint8x8_t u, uint8x8_t v, uint8_t* dst, ColorLayout_e layout)
+{
+    const uint8x8_t offset = vdup_n_u8(128);
+    float64x2_t du[4], dv[4], y[4];
+    float64x2_t r_v[4], g_u[4], g_v[4], b_u[4];
+    float64x2_t r[4], g[4], b[4];
+    uint8x8_t even[3], odd[3];
+    s16_to_f64_neon(vreinterpretq_s16_u16(vsubl_u8(u, offset)), du);
+    s16_to_f64_neon(vreinterpretq_s16_u16(vsubl_u8(v, offset)), dv);
+    for (int i = 0; i < 4; i++)
+    {
+        r_v[i] = vmulq_f64(vdupq_n_f64(COLOR_R_V), dv[i]);
+        g_u[i] = vmulq_f64(vdupq_n_f64(COLOR_G_U), du[i]);
+        g_v[i] = vmulq_f64(vdupq_n_f64(COLOR_G_V), dv[i]);
+        b_u[i] = vmulq_f64(vdupq_n_f64(COLOR_B_U), du[i]);
+    }
+
+    for (int k = 0; k < 2; k++)
+    {
+        s16_to_f64_neon(vreinterpretq_s16_u16(vmovl_u8(k == 0 ? y_even : y_odd)), y);
+        for (int i = 0; i < 4; i++)
+        {
+            r[i] = vaddq_f64(y[i], r_v[i]);
+            g[i] = vsubq_f64(vsubq_f64(y[i], g_u[i]), g_v[i]);
+            b[i] = vaddq_f64(y[i], b_u[i]);
+        }
+        uint8x8_t* channels = (k == 0) ? even : odd;
+        channels[0] = f64_to_u8_neon(r);
+        channels[1] = f64_to_u8_neon(g);
+        channels[2] = f64_to_u8_neon(b);
+    }
+
+    uint8x16_t r = zip_pixels_neon(even[0], odd[0]);
+    uint8x16_t g = zip_pixels_neon(even[1], odd[1]);
+    uint8x16_t b = zip_pixels_neon(even[2], odd[2]);
+    if (layout == COLOR_LAYOUT_BGRA)
+    {
+        uint8x16x4_t pixels;
+        pixels.val[0] = b;
+        pixels.val[1] = g;
+        pixels.val[2] = r;
+        pixels.val[3] = vdupq_n_u8(255);
+        vst4q_u8(dst, pixels);
+        return;
+    }
+    uint8x16x3_t pixels;
+    pixels.val[0] = (layout == COLOR_LAYOUT_RGB) ? r : b;
+    pixels.val[1] = g;
+    pixels.val[2] = (layout == COLOR_LAYOUT_RGB) ? b : r;
+    vst3q_u8(dst, pixels);
+}
+
+static void yuyv_convert_neon(const uint8_t* yuyv, int pair_num, uint8_t* dst, ColorLayout_e layout)
+{
+    int size = color_pixel_size(layout);
+    int i = 0;
+    for (; i + 8 <= pair_num; i += 8)
+    {
+        uint8x8x4_t pairs = vld4_u8(yuyv + 4 * i);
+        yuv_pairs8_convert_neon(pairs.val[0], pairs.val[2], pairs.val[1], pairs.val[3], dst + 2 * size * i, layout);
+    }
+    yuyv_convert_c(yuyv + 4 * i, pair_num - i, dst + 2 * size * i, layout);
+}
+
+static void nv_row_convert_neon(const uint8_t* y_row, const uint8_t* uv_row, int pair_num, uint8_t* dst, ColorLayout_e layout)
+{
+    int size = color_pixel_size(layout);
+    int i = 0;
+    for (; i + 8 <= pair_num; i += 8)
+    {
+        uint8x8x2_t y = vld2_u8(y_row + 2 * i);
+        uint8x8x2_t uv = vld2_u8(uv_row + 2 * i);
+        yuv_pairs8_convert_neon(y.val[0], y.val[1], uv.val[0], uv.val[1], dst + 2 * size * i, layout);
+    }
+    nv_row_convert_c(y_row + 2 * i, uv_row + 2 * i, pair_num - i, dst + 2 * size * i, layout);
+}
+
+static void rgb_to_bgr_neon(const uint8_t* rgb, int pixel_num, uint8_t* bgr)
+{
+    int i = 0;
+    for (; i + 16 <= pixel_num; i += 16)
+    {
+        uint8x16x3_t pixels = vld3q_u8(rgb + 3 * i);
+        uint8x16_t r = pixels.val[0];
+        pixels.val[0] = pixels.val[2];
+        pixels.val[2] = r;
+        vst3q_u8(bgr + 3 * i, pixels);
+    }
+    rgb_to_bgr_c(rgb + 3 * i, pixel_num - i, bgr + 3 * i);
+}
+
+//x / 257 == (x * 0xff01) >> 24 for every 16 bit x
+static inline uint8x8_t y16_div257_neon(uint16x4_t low, uint16x4_t high)
+{
+    const uint16x4_t divisor = vdup_n_u16(0xff01);
+    uint16x8_t quotient = vcombine_u16(vshrn_n_u32(vmull_u16(low, divisor), 16), vshrn_n_u32(vmull_u16(high, divisor), 16));
+    return vshrn_n_u16(quotient, 8);
+}
+
+static void y16_to_rgb_neon(const uint16_t* y16, int pixel_num, uint8_t* rgb)
+{
+    int i = 0;
+    for (; i + 16 <= pixel_num; i += 16)
+    {
+        uint16x8_t first = vld1q_u16(y16 + i);
+        uint16x8_t second = vld1q_u16(y16 + i + 8);
+        uint8x16_t gray = vcombine_u8(y16_div257_neon(vget_low_u16(first), vget_high_u16(first)), \
+            y16_div257_neon(vget_low_u16(second), vget_high_u16(second)));
+        uint8x16x3_t pixels;
+        pixels.val[0] = gray;
+        pixels.val[1] = gray;
+        pixels.val[2] = gray;
+        vst3q_u8(rgb + 3 * i, pixels);
+    }
+    y16_to_rgb_c(y16 + i, pixel_num - i, rgb + 3 * i);
+}
+
+//x * 255 / 16383 == (x * 65284) >> 22 for x <= 16383
+static inline uint8x8_t y14_to_y8_neon(uint16x8_t x)
+{
+    const uint16x4_t divisor = vdup_n_u16(65284);
+    x = vminq_u16(x, vdupq_n_u16(16383));
+    uint16x8_t quotient = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(x), divisor), 16), \
+        vshrn_n_u32(vmull_u16(vget_high_u16(x), divisor), 16));
+    return vshrn_n_u16(quotient, 6);
+}
+
+static void y14_to_yuv444_neon(const uint16_t* y14, int pixel_num, uint8_t* yuv)
+{
+    int i = 0;
+    for (; i + 16 <= pixel_num; i += 16)
+    {
+        uint8x16x3_t pixels;
+        pixels.val[0] = vcombine_u8(y14_to_y8_neon(vld1q_u16(y14 + i)), y14_to_y8_neon(vld1q_u16(y14 + i + 8)));
+        pixels.val[1] = vdupq_n_u8(128);
+        pixels.val[2] = vdupq_n_u8(128);
+        vst3q_u8(yuv + 3 * i, pixels);
+    }
+    y14_to_yuv444_c(y14 + i, pixel_num - i, yuv + 3 * i);
+}
+
+static const ColorKernels_t color_kernels_neon = {
+    yuyv_convert_neon, nv_row_convert_neon, rgb_to_bgr_neon, y16_to_rgb_neon, y14_to_yuv444_neon
+};
+#endif
+
+
+static const ColorKernels_t* color_kernels_of(ColorConvertIsa_e isa)
+{
+    switch (isa)
+    {
+    case COLOR_CONVERT_SCALAR:
+        return &color_kernels_c;
+#if defined(COLOR_CONVERT_X86)
+    case COLOR_CONVERT_SSE41:
+        return color_cpu_has_sse41() ? &color_kernels_sse41 : NULL;
+    case COLOR_CONVERT_AVX2:
+        return color_cpu_has_avx2() ? &color_kernels_avx2 : NULL;
+#elif defined(COLOR_CONVERT_ARM64)
+    //NEON is part of armv8-a
+    case COLOR_CONVERT_NEON:
+        return &color_kernels_neon;
+#endif
+    default:
+        return NULL;
+    }
+}
+
+static ColorConvertIsa_e color_convert_best_isa(void)
+{
+    for (int isa = COLOR_CONVERT_ISA_NUM - 1; isa > COLOR_CONVERT_SCALAR; isa--)
+    {
+        if (color_kernels_of((ColorConvertIsa_e)isa) != NULL)
+        {
+            return (ColorConvertIsa_e)isa;
+        }
+    }
+    return COLOR_CONVERT_SCALAR;
+}
+
+static ColorConvertIsa_e color_isa = color_convert_best_isa();
+static const ColorKernels_t* color_kernels = color_kernels_of(color_isa);
+
+ColorConvertIsa_e color_convert_get_isa(void)
+{
+    return color_isa;
+}
+
+int color_convert_set_isa(ColorConvertIsa_e isa)
+{
+    const ColorKernels_t* kernels = color_kernels_of(isa);
+    if (kernels == NULL)
+    {
+        printf("color convert: %s isn't supported here\n", color_convert_isa_name(isa));
+        return -1;
+    }
+    color_isa = isa;
+    color_kernels = kernels;
+    return 0;
+}
+
+const char* color_convert_isa_name(ColorConvertIsa_e isa)
+{
+    switch (isa)
+    {
+    case COLOR_CONVERT_SCALAR:
+        return "scalar";
+    case COLOR_CONVERT_SSE41:
+        return "sse4.1";
+    case COLOR_CONVERT_AVX2:
+        return "avx2";
+    case COLOR_CONVERT_NEON:
+        return "neon";
+    default:
+        return "unknown";
+    }
+}
+
+//two rows of Y share one row of UV, rows [row_start, row_end) are written at dst + row * pitch
+static int nv12_convert(uint8_t* nv12_data, int width, int height, int row_start, int row_end, uint8_t* dst, int pitch, ColorLayout_e layout)
+{
+    const uint8_t* uv_plane = nv12_data + width * height;
+    for (int row = row_start; row < row_end; row++)
+    {
+        color_kernels->nv_row_convert(nv12_data + row * width, uv_plane + (row / 2) * width, width / 2, dst + row * pitch, layout);
+    }
+    return 0;
+}
+
+int color_convert_yuv422_to_rgb(uint8_t* yuv422, int pixel_num, uint8_t* rgb_data)
+{
+    if (yuv422 == NULL || rgb_data == NULL || pixel_num <= 0 || (pixel_num % 2) != 0)
+    {
+        printf("color_convert_yuv422_to_rgb: invalid param\n");
+        return -1;
+    }
+
+    color_kernels->yuyv_convert(yuv422, pixel_num / 2, rgb_data, COLOR_LAYOUT_RGB);
+    return 0;
+}
+
+int color_convert_yuv422_to_bgr(uint8_t* yuv422, int pixel_num, uint8_t* bgr_data)
+{
+    if (yuv422 == NULL || bgr_data == NULL || pixel_num <= 0 || (pixel_num % 2) != 0)
+    {
+        printf("color_convert_yuv422_to_bgr: invalid param\n");
+        return -1;
+    }
+
+    color_kernels->yuyv_convert(yuv422, pixel_num / 2, bgr_data, COLOR_LAYOUT_BGR);
+    return 0;
+}
+
+int color_convert_yuv422_to_bgra(uint8_t* yuv422, int width, int height, uint8_t* bgra_data, int bgra_pitch)
+{
+    if (yuv422 == NULL || bgra_data == NULL || width <= 0 || height <= 0 || (width % 2) != 0 || bgra_pitch < width * 4)
+    {
+        printf("color_convert_yuv422_to_bgra: invalid param\n");
+        return -1;
+    }
+
+    for (int row = 0; row < height; row++)
+    {
+        color_kernels->yuyv_convert(yuv422 + row * width * 2, width / 2, bgra_data + row * bgra_pitch, COLOR_LAYOUT_BGRA);
+    }
+    return 0;
+}
+
+int color_convert_nv12_to_rgb(uint8_t* nv12_data, int im_width, int im_height, uint8_t* rgb_data)
+{
+    if (nv12_data == NULL || rgb_data == NULL || im_width <= 0 || im_height <= 0 || (im_width % 2) != 0 || (im_height % 2) != 0)
+    {
+        printf("color_convert_nv12_to_rgb: invalid param\n");
+        return -1;
+    }
+
+    return nv12_convert(nv12_data, im_width, im_height, 0, im_height, rgb_data, im_width * 3, COLOR_LAYOUT_RGB);
+}
+
+int color_convert_nv12_to_bgr(uint8_t* nv12_data, int im_width, int im_height, uint8_t* bgr_data)
+{
+    if (nv12_data == NULL || bgr_data == NULL || im_width <= 0 || im_height <= 0 || (im_width % 2) != 0 || (im_height % 2) != 0)
+    {
+        printf("color_convert_nv12_to_bgr: invalid param\n");
+        return -1;
+    }
+
+    return nv12_convert(nv12_data, im_width, im_height, 0, im_height, bgr_data, im_width * 3, COLOR_LAYOUT_BGR);
+}
+
+int color_convert_nv12_to_bgra(uint8_t* nv12_data, int im_width, int im_height, uint8_t* bgra_data, int bgra_pitch)
+{
+    if (nv12_data == NULL || bgra_data == NULL || im_width <= 0 || im_height <= 0 || (im_width % 2) != 0 || (im_height % 2) != 0 \
+        || bgra_pitch < im_width * 4)
+    {
+        printf("color_convert_nv12_to_bgra: invalid param\n");
+        return -1;
+    }
+
+    return nv12_convert(nv12_data, im_width, im_height, 0, im_height, bgra_data, bgra_pitch, COLOR_LAYOUT_BGRA);
+}
+
+int color_convert_nv12_rows_to_bgr(uint8_t* nv12_data, int im_width, int im_height, int row_start, int row_end, uint8_t* bgr_data)
+{
+    if (nv12_data == NULL || bgr_data == NULL || im_width <= 0 || im_height <= 0 || (im_width % 2) != 0 || (im_height % 2) != 0 \
+        || row_start < 0 || row_start > row_end || row_end > im_height)
+    {
+        printf("color_convert_nv12_rows_to_bgr: invalid param\n");
+        return -1;
+    }
+
+    return nv12_convert(nv12_data, im_width, im_height, row_start, row_end, bgr_data, im_width * 3, COLOR_LAYOUT_BGR);
+}
+
+int color_convert_nv12_rows_to_bgra(uint8_t* nv12_data, int im_width, int im_height, int row_start, int row_end, uint8_t* bgra_data, int bgra_pitch)
+{
+    if (nv12_data == NULL || bgra_data == NULL || im_width <= 0 || im_height <= 0 || (im_width % 2) != 0 || (im_height % 2) != 0 \
+        || row_start < 0 || row_start > row_end || row_end > im_height || bgra_pitch < im_width * 4)
+    {
+        printf("color_convert_nv12_rows_to_bgra: invalid param\n");
+        return -1;
+    }
+
+    return nv12_convert(nv12_data, im_width, im_height, row_start, row_end, bgra_data, bgra_pitch, COLOR_LAYOUT_BGRA);
+}
+
+int color_convert_nv16_to_rgb(uint8_t* nv16_data, int width, int height, uint8_t* rgb_data)
+{
+    if (nv16_data == NULL || rgb_data == NULL || width <= 0 || height <= 0 || (width % 2) != 0)
+    {
+        printf("color_convert_nv16_to_rgb: invalid param\n");
+        return -1;
+    }
+
+    //the rows of the planes line up, so the frame is one long row
+    int pixel_num = width * height;
+    color_kernels->nv_row_convert(nv16_data, nv16_data + pixel_num, pixel_num / 2, rgb_data, COLOR_LAYOUT_RGB);
+    return 0;
+}
+
+int color_convert_rgb_to_bgr(uint8_t* rgb_data, int pixel_num, uint8_t* bgr_data)
+{
+    if (rgb_data == NULL || bgr_data == NULL || pixel_num <= 0)
+    {
+        printf("color_convert_rgb_to_bgr: invalid param\n");
+        return -1;
+    }
+
+    color_kernels->rgb_to_bgr(rgb_data, pixel_num, bgr_data);
+    return 0;
+}
+
+int color_convert_y16_to_rgb(uint16_t* y16_data, int width, int height, uint8_t* rgb_data)
+{
+    if (y16_data == NULL || rgb_data == NULL || width <= 0 || height <= 0)
+    {
+        printf("color_convert_y16_to_rgb: invalid param\n");
+        return -1;
+    }
+
+    color_kernels->y16_to_rgb(y16_data, width * height, rgb_data);
+    return 0;
+}
+
+int color_convert_y16_to_bgr(uint16_t* y16_data, int width, int height, uint8_t* bgr_data)
+{
+    //gray, R G B are the same byte
+    return color_convert_y16_to_rgb(y16_data, width, height, bgr_data);
+}
+
+int color_convert_y14_to_yuv444(uint16_t* packet_data, int pixel_num, uint8_t* yuv_data)
+{
+    if (packet_data == NULL || yuv_data == NULL || pixel_num <= 0)
+    {
+        printf("color_convert_y14_to_yuv444: invalid param\n");
+        return -1;
+    }
+
+    color_kernels->y14_to_yuv444(packet_data, pixel_num, yuv_data);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#ifndef _COLOR_CONVERT_H_
+#define _COLOR_CONVERT_H_
+
+#include <stdint.h>
+
+//in-tree versions of the libirparse colour conversions the display threads use, with the same parameters.
+//the output is bit-exact with libirparse: the yuv conversions run the same double precision formula
+//(no fused multiply-add, truncate then clamp to 0~255), the gray ones the same integer division.
+//every function picks the fastest kernel of the cpu it runs on, see color_convert_get_isa
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define COLOR_CONVERT_X86
+#elif defined(__aarch64__) || defined(_M_ARM64)
+//the yuv kernels need 64 bit float vectors, which 32 bit arm NEON hasn't, so arm v7 runs the scalar kernels
+#define COLOR_CONVERT_ARM64
+#endif
+
+typedef enum {
+    COLOR_CONVERT_SCALAR = 0,
+    COLOR_CONVERT_SSE41,
+    COLOR_CONVERT_AVX2,
+    COLOR_CONVERT_NEON,
+    COLOR_CONVERT_ISA_NUM
+}ColorConvertIsa_e;
+
+//the kernels in use, chosen by cpu feature detection when the program starts
+ColorConvertIsa_e color_convert_get_isa(void);
+
+//force the kernels of one instruction set, to compare them. -1 if this build or cpu can't run it
+int color_convert_set_isa(ColorConvertIsa_e isa);
+
+const char* color_convert_isa_name(ColorConvertIsa_e isa);
+
+//YUYV(Y0 U Y1 V) to RGB888, pixel_num is even
+int color_convert_yuv422_to_rgb(uint8_t* yuv422, int pixel_num, uint8_t* rgb_data);
+
+//NV12(Y plane, then the UV plane of width*height/2 bytes) to RGB888, width and height are even
+int color_convert_nv12_to_rgb(uint8_t* nv12_data, int im_width, int im_height, uint8_t* rgb_data);
+
+//the same pixels written as BGR888 for opencv in one pass, the bytes of the rgb version followed by rgb_to_bgr
+int color_convert_yuv422_to_bgr(uint8_t* yuv422, int pixel_num, uint8_t* bgr_data);
+int color_convert_nv12_to_bgr(uint8_t* nv12_data, int im_width, int im_height, uint8_t* bgr_data);
+
+//the same pixels written as B G R 255, drm's XRGB8888, into rows of bgra_pitch bytes so a dumb buffer can be the output
+int color_convert_yuv422_to_bgra(uint8_t* yuv422, int width, int height, uint8_t* bgra_data, int bgra_pitch);
+int color_convert_nv12_to_bgra(uint8_t* nv12_data, int im_width, int im_height, uint8_t* bgra_data, int bgra_pitch);
+
+//only rows [row_start, row_end) of the nv12 frame, written to the same rows of the whole output frame, for row bands
+int color_convert_nv12_rows_to_bgr(uint8_t* nv12_data, int im_width, int im_height, int row_start, int row_end, uint8_t* bgr_data);
+int color_convert_nv12_rows_to_bgra(uint8_t* nv12_data, int im_width, int im_height, int row_start, int row_end, uint8_t* bgra_data, int bgra_pitch);
+
+//NV16(Y plane, then the UV plane of width*height bytes) to RGB888, width is even
+int color_convert_nv16_to_rgb(uint8_t* nv16_data, int width, int height, uint8_t* rgb_data);
+
+//swap R and B, rgb_data and bgr_data may be the same frame
+int color_convert_rgb_to_bgr(uint8_t* rgb_data, int pixel_num, uint8_t* bgr_data);
+
+//gray RGB888 of the high byte(y16 / 257)
+int color_convert_y16_to_rgb(uint16_t* y16_data, int width, int height, uint8_t* rgb_data);
+int color_convert_y16_to_bgr(uint16_t* y16_data, int width, int height, uint8_t* bgr_data);
+
+//Y of YUV444 stretched from 0~16383, U and V 128
+int color_convert_y14_to_yuv444(uint16_t* packet_data, int pixel_num, uint8_t* yuv_data);
+
+#endif
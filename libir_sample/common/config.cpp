@@ -42,6 +42,14 @@ do {\
     } \
 } while(0)
 
+#define PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, obj, value) \
+do {\
+    cJSON* object_item = cJSON_GetObjectItem(json, obj);\
+    if (object_item != nullptr) { \
+        value = cJSON_GetNumberValue(object_item); \
+    } \
+} while(0)
+
 #define PARSE_BOOL_VALUE_WITHOUT_RETURN(json, obj, value) \
 do {\
     cJSON* object_item = cJSON_GetObjectItem(json, obj);\
@@ -237,6 +245,123 @@ int config::parse_camera_config(const cJSON* json, camera_config& data)
     PARSE_BOOL_VALUE_WITHOUT_RETURN(json, "is_auto_image", data.is_auto_image);
     PARSE_BOOL_VALUE_WITHOUT_RETURN(json, "open_temp_measure", data.open_temp_measure);
     PARSE_STRING_VALUE_WITHOUT_RETURN(json, "image_channel_type", data.image_channel_type);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "frame_ring_slots", data.frame_ring_slots);
+    PARSE_STRING_VALUE_WITHOUT_RETURN(json, "frame_ring_policy", data.frame_ring_policy);
+    if (data.frame_ring_policy != "drop_oldest" && data.frame_ring_policy != "block")
+    {
+        cout << "set an illicit frame_ring_policy" << endl;
+        return -1;
+    }
+    PARSE_STRING_VALUE_WITHOUT_RETURN(json, "v4l2_capture_mode", data.v4l2_capture_mode);
+    if (data.v4l2_capture_mode != "copy" && data.v4l2_capture_mode != "mmap")
+    {
+        cout << "set an illicit v4l2_capture_mode" << endl;
+        return -1;
+    }
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "frame_pair_window", data.frame_pair_window);
+    if (data.frame_pair_window <= 0)
+    {
+        cout << "set an illicit frame_pair_window" << endl;
+        return -1;
+    }
+    PARSE_STRING_VALUE_WITHOUT_RETURN(json, "record_path", data.record_path);
+    PARSE_STRING_VALUE_WITHOUT_RETURN(json, "video_record_path", data.video_record_path);
+    PARSE_STRING_VALUE_WITHOUT_RETURN(json, "video_record_codec", data.video_record_codec);
+    if (data.video_record_codec != "mjpeg" && data.video_record_codec != "h264")
+    {
+        cout << "set an illicit video_record_codec" << endl;
+        return -1;
+    }
+    PARSE_STRING_VALUE_WITHOUT_RETURN(json, "replay_path", data.replay_path);
+    PARSE_STRING_VALUE_WITHOUT_RETURN(json, "replay_pace", data.replay_pace);
+    if (data.replay_pace != "recorded" && data.replay_pace != "fast")
+    {
+        cout << "set an illicit replay_pace" << endl;
+        return -1;
+    }
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "replay_loops", data.replay_loops);
+    PARSE_BOOL_VALUE_WITHOUT_RETURN(json, "synthetic", data.synthetic);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "synthetic_fps", data.synthetic_fps);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "synthetic_drop_rate", data.synthetic_drop_rate);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "synthetic_jitter_us", data.synthetic_jitter_us);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "synthetic_crc_error_rate", data.synthetic_crc_error_rate);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "synthetic_frames", data.synthetic_frames);
+    if (data.synthetic_fps <= 0 || data.synthetic_drop_rate < 0 || data.synthetic_drop_rate >= 1 || data.synthetic_jitter_us < 0 \
+        || data.synthetic_crc_error_rate < 0 || data.synthetic_crc_error_rate >= 1 || data.synthetic_frames < 0)
+    {
+        cout << "set an illicit synthetic camera param" << endl;
+        return -1;
+    }
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "row_band_threads", data.row_band_threads);
+    if (data.row_band_threads < 0)
+    {
+        cout << "set an illicit row_band_threads" << endl;
+        return -1;
+    }
+    cJSON* row_band_cpus_item = cJSON_GetObjectItem(json, "row_band_cpus");
+    if (row_band_cpus_item != nullptr)
+    {
+        if (!cJSON_IsArray(row_band_cpus_item))
+        {
+            cout << "set an illicit row_band_cpus" << endl;
+            return -1;
+        }
+        data.row_band_cpus.clear();
+        int cpu_size = cJSON_GetArraySize(row_band_cpus_item);
+        for (int cpu_idx = 0; cpu_idx < cpu_size; cpu_idx++)
+        {
+            cJSON* cpu_item = cJSON_GetArrayItem(row_band_cpus_item, cpu_idx);
+            if (!cJSON_IsNumber(cpu_item) || cpu_item->valueint < 0)
+            {
+                cout << "set an illicit row_band_cpus" << endl;
+                return -1;
+            }
+            data.row_band_cpus.push_back(cpu_item->valueint);
+        }
+    }
+    PARSE_STRING_VALUE_WITHOUT_RETURN(json, "temp_palette", data.temp_palette);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "temp_palette_low", data.temp_palette_low);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "temp_palette_high", data.temp_palette_high);
+    if (data.temp_palette_low > data.temp_palette_high)
+    {
+        cout << "set an illicit temp palette range" << endl;
+        return -1;
+    }
+    PARSE_STRING_VALUE_WITHOUT_RETURN(json, "temp_agc", data.temp_agc);
+    if (data.temp_agc != "off" && data.temp_agc != "plateau" && data.temp_agc != "linear")
+    {
+        cout << "set an illicit temp_agc" << endl;
+        return -1;
+    }
+    cJSON* temp_alarms_item = cJSON_GetObjectItem(json, "temp_alarms");
+    if (temp_alarms_item != nullptr)
+    {
+        if (!cJSON_IsArray(temp_alarms_item))
+        {
+            cout << "set an illicit temp_alarms" << endl;
+            return -1;
+        }
+        data.temp_alarms.clear();
+        int alarm_size = cJSON_GetArraySize(temp_alarms_item);
+        for (int alarm_idx = 0; alarm_idx < alarm_size; alarm_idx++)
+        {
+            temp_alarm_config alarm;
+            if (parse_temp_alarm_config(cJSON_GetArrayItem(temp_alarms_item, alarm_idx), alarm) != 0)
+            {
+                cout << "set an illicit temp_alarms" << endl;
+                return -1;
+            }
+            data.temp_alarms.push_back(alarm);
+        }
+    }
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "temp_alarm_hysteresis", data.temp_alarm_hysteresis);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "temp_alarm_raise_ms", data.temp_alarm_raise_ms);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "temp_alarm_clear_ms", data.temp_alarm_clear_ms);
+    if (data.temp_alarm_hysteresis < 0 || data.temp_alarm_raise_ms < 0 || data.temp_alarm_clear_ms < 0)
+    {
+        cout << "set an illicit temp alarm param" << endl;
+        return -1;
+    }
     cJSON* v4l2_stream_item = cJSON_GetObjectItem(json, "v4l2_stream");
     if (v4l2_stream_item != nullptr && parse_v4l2_stream_config(v4l2_stream_item, data.v4l2_config) != 0)
     {
@@ -252,6 +377,33 @@ int config::parse_camera_config(const cJSON* json, camera_config& data)
     return 0;
 }
 
+int config::parse_temp_alarm_config(const cJSON* json, temp_alarm_config& alarm)
+{
+    PARSE_STRING_VALUE(json, "type", alarm.type);
+    if (alarm.type != "point" && alarm.type != "line" && alarm.type != "rect")
+    {
+        return -1;
+    }
+    PARSE_NUMBER_VALUE(json, "start_x", alarm.start_x);
+    PARSE_NUMBER_VALUE(json, "start_y", alarm.start_y);
+    alarm.end_x = alarm.start_x;
+    alarm.end_y = alarm.start_y;
+    if (alarm.type != "point")
+    {
+        PARSE_NUMBER_VALUE(json, "end_x", alarm.end_x);
+        PARSE_NUMBER_VALUE(json, "end_y", alarm.end_y);
+    }
+    alarm.has_high = (cJSON_GetObjectItem(json, "high_temp") != nullptr);
+    alarm.has_low = (cJSON_GetObjectItem(json, "low_temp") != nullptr);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "high_temp", alarm.high_temp);
+    PARSE_NUMBER_VALUE_WITHOUT_RETURN(json, "low_temp", alarm.low_temp);
+    if ((!alarm.has_high && !alarm.has_low) || (alarm.has_high && alarm.has_low && alarm.low_temp >= alarm.high_temp))
+    {
+        return -1;
+    }
+    return 0;
+}
+
 int config::parse_v4l2_stream_config(const cJSON* json, v4l2_streams& v4l2_stream_config)
 {
     int v4l2_size = cJSON_GetArraySize(json);
@@ -423,6 +575,42 @@ string camera_config::to_string()
     ss << "temp_line_ratio: " << temp_line_ratio << ", dummy_info_ratio: " << dummy_info_ratio << endl;
     ss << "is_auto_image: " << is_auto_image << ", open_temp_measure: " << open_temp_measure << endl;
     ss << "image_channel_type: " << image_channel_type << endl;
+    ss << "frame_ring_slots: " << frame_ring_slots << ", frame_ring_policy: " << frame_ring_policy << endl;
+    ss << "v4l2_capture_mode: " << v4l2_capture_mode << ", frame_pair_window: " << frame_pair_window << endl;
+    if (!record_path.empty())
+    {
+        ss << "record_path: " << record_path << endl;
+    }
+    if (!video_record_path.empty())
+    {
+        ss << "video_record_path: " << video_record_path << ", video_record_codec: " << video_record_codec << endl;
+    }
+    if (!replay_path.empty())
+    {
+        ss << "replay_path: " << replay_path << ", replay_pace: " << replay_pace << ", replay_loops: " << replay_loops << endl;
+    }
+    if (synthetic)
+    {
+        ss << "synthetic_fps: " << synthetic_fps << ", synthetic_drop_rate: " << synthetic_drop_rate << ", synthetic_jitter_us: " \
+            << synthetic_jitter_us << ", synthetic_crc_error_rate: " << synthetic_crc_error_rate << ", synthetic_frames: " << synthetic_frames << endl;
+    }
+    ss << "row_band_threads: " << row_band_threads << ", row_band_cpus:";
+    for (size_t i = 0; i < row_band_cpus.size(); i++)
+    {
+        ss << " " << row_band_cpus[i];
+    }
+    ss << endl;
+    ss << "temp_palette: " << temp_palette << ", temp_palette_low: " << temp_palette_low << ", temp_palette_high: " \
+        << temp_palette_high << ", temp_agc: " << temp_agc << endl;
+    for (size_t i = 0; i < temp_alarms.size(); i++)
+    {
+        ss << "temp_alarms[" << i << "]: " << temp_alarms[i].to_string() << endl;
+    }
+    if (!temp_alarms.empty())
+    {
+        ss << "temp_alarm_hysteresis: " << temp_alarm_hysteresis << ", temp_alarm_raise_ms: " << temp_alarm_raise_ms \
+            << ", temp_alarm_clear_ms: " << temp_alarm_clear_ms << endl;
+    }
     if (v4l2_config.has_image)
     {
         ss << "v4l2_config::image_stream: " << v4l2_config.image_stream.to_string();
@@ -439,10 +627,63 @@ string camera_config::to_string()
     return ss.str();
 }
 
+temp_alarm_config::temp_alarm_config()
+    : start_x(0),
+      start_y(0),
+      end_x(0),
+      end_y(0),
+      has_high(false),
+      high_temp(0),
+      has_low(false),
+      low_temp(0)
+{
+
+}
+
+string temp_alarm_config::to_string()
+{
+    stringstream ss;
+    ss << type << " (" << start_x << ", " << start_y << ")";
+    if (type != "point")
+    {
+        ss << "~(" << end_x << ", " << end_y << ")";
+    }
+    if (has_high)
+    {
+        ss << ", high_temp: " << high_temp;
+    }
+    if (has_low)
+    {
+        ss << ", low_temp: " << low_temp;
+    }
+    return ss.str();
+}
+
 camera_config::camera_config()
     : is_auto_image(true),
       open_temp_measure(false),
-      image_channel_type("usb")
+      image_channel_type("usb"),
+      frame_ring_slots(4),
+      frame_ring_policy("drop_oldest"),
+      v4l2_capture_mode("copy"),
+      frame_pair_window(4),
+      video_record_codec("mjpeg"),
+      replay_pace("recorded"),
+      replay_loops(0),
+      synthetic(false),
+      synthetic_fps(25),
+      synthetic_drop_rate(0),
+      synthetic_jitter_us(0),
+      synthetic_crc_error_rate(0),
+      synthetic_frames(0),
+      row_band_threads(1),
+      temp_palette("white_hot"),
+      temp_palette_low(0),
+      temp_palette_high(0),
+      temp_agc("off"),
+      temp_alarm_hysteresis(1),
+      temp_alarm_raise_ms(1000),
+      temp_alarm_clear_ms(1000)
 {
 
 }
@@ -470,6 +711,32 @@ camera_config& camera_config::operator= (const camera_config& rhs)
     this->is_auto_image = rhs.is_auto_image;
     this->open_temp_measure = rhs.open_temp_measure;
     this->image_channel_type = rhs.image_channel_type;
+    this->frame_ring_slots = rhs.frame_ring_slots;
+    this->frame_ring_policy = rhs.frame_ring_policy;
+    this->v4l2_capture_mode = rhs.v4l2_capture_mode;
+    this->frame_pair_window = rhs.frame_pair_window;
+    this->record_path = rhs.record_path;
+    this->video_record_path = rhs.video_record_path;
+    this->video_record_codec = rhs.video_record_codec;
+    this->replay_path = rhs.replay_path;
+    this->replay_pace = rhs.replay_pace;
+    this->replay_loops = rhs.replay_loops;
+    this->synthetic = rhs.synthetic;
+    this->synthetic_fps = rhs.synthetic_fps;
+    this->synthetic_drop_rate = rhs.synthetic_drop_rate;
+    this->synthetic_jitter_us = rhs.synthetic_jitter_us;
+    this->synthetic_crc_error_rate = rhs.synthetic_crc_error_rate;
+    this->synthetic_frames = rhs.synthetic_frames;
+    this->row_band_threads = rhs.row_band_threads;
+    this->row_band_cpus = rhs.row_band_cpus;
+    this->temp_palette = rhs.temp_palette;
+    this->temp_palette_low = rhs.temp_palette_low;
+    this->temp_palette_high = rhs.temp_palette_high;
+    this->temp_agc = rhs.temp_agc;
+    this->temp_alarms = rhs.temp_alarms;
+    this->temp_alarm_hysteresis = rhs.temp_alarm_hysteresis;
+    this->temp_alarm_raise_ms = rhs.temp_alarm_raise_ms;
+    this->temp_alarm_clear_ms = rhs.temp_alarm_clear_ms;
     this->v4l2_config = rhs.v4l2_config;
     this->uvc_stream_conf = rhs.uvc_stream_conf;
     return *this;
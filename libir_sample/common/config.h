@@ -66,6 +66,21 @@ struct control_config {
     uart_param    uart_param;
 };
 
+//a roi of the alarm thread with its thresholds, celsius
+struct temp_alarm_config {
+    temp_alarm_config();
+    string to_string();
+    string type;        // point, line or rect
+    int start_x;
+    int start_y;
+    int end_x;
+    int end_y;
+    bool has_high;
+    float high_temp;
+    bool has_low;
+    float low_temp;
+};
+
 struct camera_config {
     string to_string();
     camera_config();
@@ -85,6 +100,32 @@ struct camera_config {
     bool open_temp_measure;
 
     string image_channel_type;
+    int frame_ring_slots;
+    string frame_ring_policy;
+    string v4l2_capture_mode;
+    int frame_pair_window;
+    string record_path;
+    string video_record_path;
+    string video_record_codec;
+    string replay_path;
+    string replay_pace;
+    int replay_loops;
+    bool synthetic;
+    int synthetic_fps;
+    float synthetic_drop_rate;
+    int synthetic_jitter_us;
+    float synthetic_crc_error_rate;
+    int synthetic_frames;
+    int row_band_threads;
+    vector<int> row_band_cpus;
+    string temp_palette;
+    float temp_palette_low;
+    float temp_palette_high;
+    string temp_agc;
+    vector<temp_alarm_config> temp_alarms;
+    float temp_alarm_hysteresis;
+    int temp_alarm_raise_ms;
+    int temp_alarm_clear_ms;
     v4l2_streams v4l2_config;
     uvc_stream uvc_stream_conf;
 };
@@ -111,6 +152,7 @@ private:
     int  parse_v4l2_stream_config(const cJSON* json, v4l2_streams& v4l2_stream_config);
     int  parse_uvc_stream_config(const cJSON* json, uvc_stream& uvc_stream_config);
     int  parse_uvc_dev_info(const cJSON* json, usb_dev_info& dev_info);
+    int  parse_temp_alarm_config(const cJSON* json, temp_alarm_config& alarm);
 private:
     map<string, int> frame_output_format_dict;
     map<string, single_config> product_config;
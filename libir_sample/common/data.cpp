@@ -1,135 +1,116 @@
 #include "data.h"
+#include "frame_ring.h"
+#include <time.h>
 
-//thread's semaphore
-#if defined(_WIN32)
-HANDLE image_sem, image_done_sem;
-HANDLE i_temp_sem;
-HANDLE i_temp_done;
-HANDLE cap_sem, cap_done_sem;
-HANDLE info_sem, info_done_sem;
-HANDLE temp_sem, temp_done_sem;
-HANDLE cmd_sem;
-#elif defined(linux) || defined(unix)
-sem_t image_sem, image_done_sem;
-sem_t i_temp_sem;
-sem_t i_temp_done;
-sem_t cap_sem, cap_done_sem;
-sem_t info_sem, info_done_sem;
-sem_t temp_sem, temp_done_sem;
-sem_t cmd_sem;
-#endif
-
-//init the semaphore
-int init_pthread_sem()
+uint64_t frame_clock_us()
 {
 #if defined(_WIN32)
-	image_sem = CreateSemaphore(NULL, 0, 1, NULL);
-	image_done_sem = CreateSemaphore(NULL, 1, 1, NULL);
-    i_temp_sem = CreateSemaphore(NULL, 0, 1, NULL);
-    i_temp_done = CreateSemaphore(NULL, 0, 1, NULL);
-	cap_sem = CreateSemaphore(NULL, 1, 1, NULL);
-	cap_done_sem = CreateSemaphore(NULL, 0, 1, NULL);
-    info_sem = CreateSemaphore(NULL, 0, 1, NULL);
-	info_done_sem = CreateSemaphore(NULL, 1, 1, NULL);
-    temp_sem = CreateSemaphore(NULL, 0, 1, NULL);
-    temp_done_sem = CreateSemaphore(NULL, 1, 1, NULL);
-    cmd_sem = CreateSemaphore(NULL, 0, 1, NULL);
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000 \
+        + (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
 #elif defined(linux) || defined(unix)
-	sem_init(&image_sem, 0, 0);
-	sem_init(&image_done_sem, 0, 1);
-    sem_init(&i_temp_sem, 0, 0);
-    sem_init(&i_temp_done, 0, 0);
-	sem_init(&cap_sem, 0, 1);
-	sem_init(&cap_done_sem, 0, 0);
-    sem_init(&info_sem, 0, 0);
-	sem_init(&info_done_sem, 0, 1);
-    sem_init(&temp_sem, 0, 0);
-    sem_init(&temp_done_sem, 0, 1);
-    sem_init(&cmd_sem,0,0);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
 #endif
-	return 0;
 }
 
-//recycle the semaphore
-int destroy_pthread_sem()
+FrameBuffer_t* frame_buffer_create(uint32_t byte_size)
 {
-#if defined(_WIN32)
-	CloseHandle(image_sem);
-	CloseHandle(image_done_sem);
-    CloseHandle(i_temp_sem);
-	CloseHandle(cap_sem);
-	CloseHandle(cap_done_sem);
-    CloseHandle(info_sem);
-	CloseHandle(info_done_sem);
-    CloseHandle(temp_sem);
-    CloseHandle(temp_done_sem);
-    CloseHandle(cmd_sem);
-#elif defined(linux) || defined(unix)
-	sem_destroy(&image_sem);
-	sem_destroy(&image_done_sem);
-    sem_destroy(&i_temp_sem);
-	sem_destroy(&cap_sem);
-	sem_destroy(&cap_done_sem);
-    sem_destroy(&info_sem);
-	sem_destroy(&info_done_sem);
-    sem_destroy(&temp_sem);
-    sem_destroy(&temp_done_sem);
-    sem_destroy(&cmd_sem);
-#endif
-	return 0;
-}
-
+    if (byte_size == 0)
+    {
+        return NULL;
+    }
 
-//create the raw frame/image frame/temperature frame's buffer
-int create_data_demo(StreamFrameInfo_t* stream_frame_info)
-{
-    if (stream_frame_info == NULL)
+    uint8_t* data = (uint8_t*)malloc(byte_size);
+    if (data == NULL)
     {
-        printf("stream_frame_info is NULL\n");
-        return -1;
+        printf("there is no more space!\n");
+        return NULL;
     }
 
-    if (stream_frame_info->raw_frame == NULL && stream_frame_info->image_info.data == NULL && \
-        stream_frame_info->information_line.data == NULL && stream_frame_info->temp_info.data == NULL)
+    FrameBuffer_t* buffer = frame_buffer_wrap(data, byte_size, NULL, NULL);
+    if (buffer == NULL)
     {
-        stream_frame_info->raw_frame = (uint8_t*)malloc(stream_frame_info->raw_byte_size);
-        stream_frame_info->raw_temp_frame = (uint8_t*)malloc(stream_frame_info->raw_temp_byte_size);
-        stream_frame_info->image_info.data = (uint8_t*)malloc(stream_frame_info->image_info.byte_size);
-        stream_frame_info->information_line.data = (uint8_t*)malloc(stream_frame_info->information_line.byte_size);
-        stream_frame_info->temp_info.data = (uint8_t*)malloc(stream_frame_info->temp_info.byte_size);
-        stream_frame_info->dummy_info.data = (uint8_t*)malloc(stream_frame_info->dummy_info.byte_size);
+        free(data);
     }
-    else
+    return buffer;
+}
+
+FrameBuffer_t* frame_buffer_wrap(uint8_t* data, uint32_t byte_size, void (*release)(FrameBuffer_t* buffer), void* priv)
+{
+    FrameBuffer_t* buffer = new FrameBuffer_t;
+    buffer->data = data;
+    buffer->byte_size = byte_size;
+    buffer->ref_count = 1;
+    buffer->release = release;
+    buffer->priv = priv;
+    buffer->timestamp_us = 0;
+    return buffer;
+}
+
+void frame_buffer_ref(FrameBuffer_t* buffer)
+{
+    if (buffer != NULL)
     {
-        printf("create_data_demo failed!\n");
-        return -1;
+        buffer->ref_count++;
     }
+}
 
-    if (stream_frame_info->raw_byte_size == 0)
+void frame_buffer_unref(FrameBuffer_t* buffer)
+{
+    if (buffer == NULL || --buffer->ref_count > 0)
     {
-        stream_frame_info->raw_frame = NULL;
+        return;
     }
-    if (stream_frame_info->image_info.byte_size == 0)
+
+    if (buffer->release != NULL)
     {
-        stream_frame_info->image_info.data = NULL;
+        //the owner may recycle the buffer, so it decides when to delete it
+        buffer->release(buffer);
+        return;
     }
-    if (stream_frame_info->information_line.byte_size == 0)
+    free(buffer->data);
+    delete buffer;
+}
+
+void frame_info_bind(FrameInfo_t* frame_info, FrameBuffer_t* buffer, uint32_t offset)
+{
+    frame_info->buffer = buffer;
+    frame_info->offset = offset;
+    if (buffer == NULL || frame_info->byte_size == 0)
     {
-        stream_frame_info->information_line.data = NULL;
+        frame_info->data = NULL;
+        return;
     }
-    if (stream_frame_info->temp_info.byte_size == 0)
+    frame_info->data = buffer->data + offset;
+}
+
+void bind_stream_frame_info(StreamFrameInfo_t* stream_frame_info, FrameBuffer_t* raw_buffer, FrameBuffer_t* raw_temp_buffer)
+{
+    stream_frame_info->raw_buffer = raw_buffer;
+    stream_frame_info->raw_temp_buffer = raw_temp_buffer;
+    stream_frame_info->raw_frame = (raw_buffer != NULL) ? raw_buffer->data : NULL;
+    stream_frame_info->raw_temp_frame = (raw_temp_buffer != NULL) ? raw_temp_buffer->data : NULL;
+
+    frame_info_bind(&stream_frame_info->image_info, raw_buffer, stream_frame_info->image_info.offset);
+    frame_info_bind(&stream_frame_info->information_line, raw_buffer, stream_frame_info->information_line.offset);
+    if (stream_frame_info->raw_temp_byte_size == 0)
     {
-        stream_frame_info->temp_info.data = NULL;
+        frame_info_bind(&stream_frame_info->temp_info, raw_buffer, stream_frame_info->temp_info.offset);
+        frame_info_bind(&stream_frame_info->dummy_info, raw_buffer, stream_frame_info->dummy_info.offset);
     }
-    if (stream_frame_info->dummy_info.data == 0)
+    else
     {
-        stream_frame_info->dummy_info.data = NULL;
+        frame_info_bind(&stream_frame_info->temp_info, raw_temp_buffer, stream_frame_info->temp_info.offset);
+        frame_info_bind(&stream_frame_info->dummy_info, raw_temp_buffer, stream_frame_info->dummy_info.offset);
     }
-	return 0;
 }
 
-//recycle the raw frame/image frame/temperature frame's buffer
-int destroy_data_demo(StreamFrameInfo_t* stream_frame_info)
+//create the frame ring, every slot holds a raw frame that image/temperature frames are views into
+int create_data_demo(StreamFrameInfo_t* stream_frame_info)
 {
     if (stream_frame_info == NULL)
     {
@@ -137,41 +118,43 @@ int destroy_data_demo(StreamFrameInfo_t* stream_frame_info)
         return -1;
     }
 
-    if (stream_frame_info->raw_frame != NULL)
+    if (stream_frame_info->frame_ring != NULL)
     {
-        free(stream_frame_info->raw_frame);
-        stream_frame_info->raw_frame = NULL;
+        printf("create_data_demo failed!\n");
+        return -1;
     }
 
-    if (stream_frame_info->raw_temp_frame != NULL)
+    int slot_num = stream_frame_info->product_config.camera.frame_ring_slots;
+    if (slot_num <= 0)
     {
-        free(stream_frame_info->raw_temp_frame);
-        stream_frame_info->raw_temp_frame = NULL;
+        slot_num = FRAME_RING_DEFAULT_SLOTS;
     }
-
-    if (stream_frame_info->image_info.data != NULL)
+    FrameRingPolicy_e policy = frame_ring_policy_from_name(stream_frame_info->product_config.camera.frame_ring_policy.c_str());
+    stream_frame_info->frame_ring = frame_ring_create(slot_num, policy, \
+        stream_frame_info->raw_byte_size, stream_frame_info->raw_temp_byte_size);
+    if (stream_frame_info->frame_ring == NULL)
     {
-        free(stream_frame_info->image_info.data);
-        stream_frame_info->image_info.data = NULL;
+        printf("create_data_demo failed!\n");
+        return -1;
     }
 
-    if (stream_frame_info->information_line.data != NULL)
-    {
-        free(stream_frame_info->information_line.data);
-        stream_frame_info->information_line.data = NULL;
-    }
+    //the shared info only describes the layout, each thread binds its own copy to the frame it holds
+    bind_stream_frame_info(stream_frame_info, NULL, NULL);
+	return 0;
+}
 
-    if (stream_frame_info->temp_info.data != NULL)
+//recycle the frame ring, all threads must have released their frames
+int destroy_data_demo(StreamFrameInfo_t* stream_frame_info)
+{
+    if (stream_frame_info == NULL)
     {
-        free(stream_frame_info->temp_info.data);
-        stream_frame_info->temp_info.data = NULL;
+        printf("stream_frame_info is NULL\n");
+        return -1;
     }
 
-    if (stream_frame_info->dummy_info.data != NULL)
-    {
-        free(stream_frame_info->dummy_info.data);
-        stream_frame_info->dummy_info.data = NULL;
-    }
+    bind_stream_frame_info(stream_frame_info, NULL, NULL);
+    frame_ring_destroy(stream_frame_info->frame_ring);
+    stream_frame_info->frame_ring = NULL;
 
 	return 0;
 }
@@ -198,15 +181,23 @@ void load_stream_frame_info(StreamFrameInfo_t* stream_info, bool is_v4l2_driver,
     stream_info->temp_info.byte_size = stream_info->temp_info.width * stream_info->temp_info.height * stream_info->product_config.camera.temp_line_ratio;
     stream_info->dummy_info.byte_size = stream_info->dummy_info.width * stream_info->dummy_info.height * stream_info->product_config.camera.dummy_info_ratio;
 
+    //composite layout: image + information line + temp + dummy, 2 channel puts temp + dummy in raw_temp_frame
+    stream_info->image_info.offset = 0;
+    stream_info->information_line.offset = stream_info->image_info.byte_size;
     if (!is_v4l2_driver || !stream_info->product_config.camera.v4l2_config.has_temp || use_single_channel)
     {
         stream_info->raw_byte_size = stream_info->image_info.byte_size + stream_info->information_line.byte_size + \
             stream_info->temp_info.byte_size + stream_info->dummy_info.byte_size;
+        stream_info->raw_temp_byte_size = 0;
+        stream_info->temp_info.offset = stream_info->image_info.byte_size + stream_info->information_line.byte_size;
+        stream_info->dummy_info.offset = stream_info->temp_info.offset + stream_info->temp_info.byte_size;
     }
     else
     {
         stream_info->raw_byte_size = stream_info->image_info.byte_size + stream_info->information_line.byte_size;
         stream_info->raw_temp_byte_size = stream_info->temp_info.byte_size + stream_info->dummy_info.byte_size;
+        stream_info->temp_info.offset = 0;
+        stream_info->dummy_info.offset = stream_info->temp_info.byte_size;
     }
 
     printf("stream_info image:%dx%d,information_line:%dx%d,temp:%dx%d,dummy:%dx%d\n", \
@@ -18,36 +18,12 @@
 #include <unistd.h>
 #include <semaphore.h>
 #endif
-extern std::atomic_bool isRUNNING;
-extern int temp_measure_on;
-extern IrVideoHandle_t* ir_image_video_handle;
-extern IrVideoHandle_t* ir_temp_video_handle;
-
 #define VERSION_NAME "libir_sample"
 #define VERSION_NUMBER "V2.4.3"
 #define MAX_MALLOC_DATA_LENGTH  10000000
 
 //#define INFO_LINE
 
-//thread's semaphore
-#if defined(_WIN32)
-extern HANDLE image_sem, image_done_sem;
-extern HANDLE i_temp_sem;
-extern HANDLE i_temp_done;
-extern HANDLE cap_sem, cap_done_sem;
-extern HANDLE info_sem, info_done_sem;
-extern HANDLE temp_sem, temp_done_sem;
-extern HANDLE cmd_sem;
-#elif defined(linux) || defined(unix)
-extern sem_t image_sem, image_done_sem;
-extern sem_t i_temp_sem;
-extern sem_t i_temp_done;
-extern sem_t cap_sem, cap_done_sem;
-extern sem_t info_sem, info_done_sem;
-extern sem_t temp_sem, temp_done_sem;
-extern sem_t cmd_sem;
-#endif
-
 typedef enum
 {
     YUYV_IMAGE = 0,
@@ -87,13 +63,37 @@ typedef enum
     OUTPUT_FMT_INFO_LINE,
 }OutputFormat_t;
 
+//reference-counted raw frame buffer, the regions of one frame are views into it
+typedef struct FrameBuffer_s FrameBuffer_t;
+struct FrameBuffer_s {
+    uint8_t* data;
+    uint32_t byte_size;
+    std::atomic_int ref_count;
+    void (*release)(FrameBuffer_t* buffer);    //called when the last reference is dropped, NULL to free data
+    void* priv;
+    uint64_t timestamp_us;  //capture time on CLOCK_MONOTONIC, the V4L2 buffer timestamp for mmap capture, 0 if unknown
+};
+
+//bounded multi-slot queue of raw frames between the stream thread and its consumers, see frame_ring.h
+typedef struct FrameRing_s FrameRing_t;
+
+//matches the independently dequeued frames of the mipi 2vc image/temp channels, see frame_pair.h
+typedef struct FramePair_s FramePair_t;
+
+//one camera's stream info, video handles, run flag and thread semaphores, see pipeline.h
+//image frames are handed to display/info line parse/temp measure by the frame ring,
+//the two mipi 2vc channels are matched by the frame pairer
+typedef struct Pipeline_s Pipeline_t;
+
 typedef struct {
     uint32_t width;
     uint32_t height;
-    uint8_t* data;
+    uint8_t* data;      //points to buffer->data + offset
     uint32_t byte_size;
     InputFormat_t  input_format;
     OutputFormat_t  output_format;
+    FrameBuffer_t* buffer;  //the raw buffer this region is a view into
+    uint32_t offset;        //byte offset of this region inside the raw buffer
 }FrameInfo_t;
 
 typedef struct {
@@ -114,6 +114,11 @@ typedef struct {
     uint32_t raw_byte_size;
     uint8_t* raw_temp_frame;
     uint32_t raw_temp_byte_size;
+    FrameBuffer_t* raw_buffer;      //buffers the views are bound to, not referenced
+    FrameBuffer_t* raw_temp_buffer;
+    FrameRing_t* frame_ring;
+    FramePair_t* frame_pair;        //only for v4l2_image/temp_channel_stream_function
+    Pipeline_t* pipeline;           //the pipeline owning this stream info, copies of it share the pipeline
     FrameOutputFmt_t frame_output_format;
 
     FrameInfo_t image_info;
@@ -123,13 +128,27 @@ typedef struct {
     single_config product_config;
 }StreamFrameInfo_t;
 
-//initial the pthread's cond and mutex
-int init_pthread_sem();
+//monotonic clock in microseconds for frame timestamps, the same clock as V4L2 buffer timestamps on linux
+uint64_t frame_clock_us();
+
+//create a raw buffer with one reference held by the caller
+FrameBuffer_t* frame_buffer_create(uint32_t byte_size);
+
+//wrap memory owned by someone else, release is called when the last reference is dropped
+FrameBuffer_t* frame_buffer_wrap(uint8_t* data, uint32_t byte_size, void (*release)(FrameBuffer_t* buffer), void* priv);
+
+void frame_buffer_ref(FrameBuffer_t* buffer);
+
+void frame_buffer_unref(FrameBuffer_t* buffer);
+
+//point the region at buffer->data + offset, the view doesn't hold a reference
+void frame_info_bind(FrameInfo_t* frame_info, FrameBuffer_t* buffer, uint32_t offset);
 
-//release the pthread's cond and mutex
-int destroy_pthread_sem();
+//point image/information line/temp/dummy views at the raw buffers by the layout from load_stream_frame_info,
+//threads bind their own copy of the stream info to the frame slot they hold
+void bind_stream_frame_info(StreamFrameInfo_t* stream_frame_info, FrameBuffer_t* raw_buffer, FrameBuffer_t* raw_temp_buffer);
 
-//create space for getting frames
+//create the frame ring for getting frames
 int create_data_demo(StreamFrameInfo_t* stream_frame_info);
 
 //destroy the space
@@ -50,7 +50,7 @@ static int modeset_create_fb(int fd, struct buffer_object *bo)
 
 	create.width = bo->width;
 	create.height = bo->height;
-	create.bpp = 24;
+	create.bpp = 32;
 	drmIoctl(fd, DRM_IOCTL_MODE_CREATE_DUMB, &create);
 
 	bo->pitch = create.pitch;
@@ -71,8 +71,9 @@ static int modeset_create_fb(int fd, struct buffer_object *bo)
 	handles[0] = bo->handle;
 	pitches[0] = bo->pitch;
 
+	//B G R X bytes, which the frame converters write straight into the buffer
 	ret = drmModeAddFB2(fd, bo->width, bo->height,
-						DRM_FORMAT_BGR888, handles, pitches, offsets, &bo->fb_id, 0); //DRM_FORMAT_BGR888 bmp DRM_FORMAT_XRGB8888
+						DRM_FORMAT_XRGB8888, handles, pitches, offsets, &bo->fb_id, 0); //DRM_FORMAT_BGR888 bmp DRM_FORMAT_XRGB8888
 	if (ret)
 	{
 		printf("drmModeAddFB2 return err %d\n", ret);
@@ -208,15 +209,32 @@ int drm_dev_close()
 	return 0;
 }
 
-void drm_display(void *buff)
+uint8_t* drm_get_back_buffer(uint32_t* pitch)
+{
+	*pitch = plane_buf[buf_flag ^ 1].pitch;
+	return plane_buf[buf_flag ^ 1].vaddr;
+}
+
+void drm_flip()
 {
 	buf_flag ^= 1;//double buffer to avoid line crash
-	memcpy(plane_buf[buf_flag].vaddr, buff, plane_buf[buf_flag].size);
 	drmModeSetPlane(fd, plane_res->planes[1], crtc_id, plane_buf[buf_flag].fb_id, 0,
 						0, 0, 800, 1200,
 						0, 0, (plane_buf[buf_flag].width) << 16, (plane_buf[buf_flag].height) << 16);
 }
 
+void drm_display(void *buff)
+{
+	uint32_t pitch = 0;
+	uint8_t* back_buffer = drm_get_back_buffer(&pitch);
+	uint32_t row_size = plane_buf[buf_flag ^ 1].width * 4;
+	for (uint32_t row = 0; row < plane_buf[buf_flag ^ 1].height; row++)
+	{
+		memcpy(back_buffer + row * pitch, (uint8_t*)buff + row * row_size, row_size);
+	}
+	drm_flip();
+}
+
 u_int32_t drm_get_screeninfo_width()
 {
 	return plane_buf[buf_flag].width;
@@ -253,18 +271,20 @@ void* drm_display_function(void* threadarg)
 		return NULL;
 	}
 
-	StreamFrameInfo_t* stream_frame_info = (StreamFrameInfo_t*)threadarg;
+	//private copy of the layout, bound to each frame read from the ring
+	StreamFrameInfo_t frame_view = *(StreamFrameInfo_t*)threadarg;
+	StreamFrameInfo_t* stream_frame_info = &frame_view;
+	FrameRing_t* frame_ring = stream_frame_info->frame_ring;
+	FrameSlot_t slot;
 
 	int ret;
 	int drm_dev_open_flag = 0;
 	int file_n = 0;
 	int cnt = 0;
 
-	uint8_t* rgb_image_frame = NULL;
-	rgb_image_frame = (uint8_t*)malloc(stream_frame_info->width * stream_frame_info->height * 3);
-	if (rgb_image_frame == NULL)
+	int consumer_id = frame_ring_add_consumer(frame_ring);
+	if (consumer_id < 0)
 	{
-		printf("there is no more space!\n");
 		return NULL;
 	}
 
@@ -277,34 +297,65 @@ void* drm_display_function(void* threadarg)
 	im_rect drect;
 	im_rect prect;
 	empty_structure(NULL, NULL, &pat, &srect, &drect, &prect);
+	uint8_t* bgra_image_frame = NULL;
+	bgra_image_frame = (uint8_t*)malloc(stream_frame_info->width * stream_frame_info->height * 4);
+	if (bgra_image_frame == NULL)
+	{
+		printf("there is no more space!\n");
+		frame_ring_remove_consumer(frame_ring, consumer_id);
+		return NULL;
+	}
 	uint8_t* src_rgb_image_frame = NULL;
 	src_rgb_image_frame = (uint8_t*)malloc(stream_frame_info->width * stream_frame_info->height * 3);
 	if (src_rgb_image_frame == NULL)
 	{
 		printf("there is no more space!\n");
-		free(rgb_image_frame);
+		free(bgra_image_frame);
+		frame_ring_remove_consumer(frame_ring, consumer_id);
 		return NULL;
 	}
 #endif
 
-	while (isRUNNING)
+	while (stream_frame_info->pipeline->is_running)
 	{
-		sem_wait(&image_sem);
+		if (frame_ring_read(frame_ring, consumer_id, &slot) != 0)
+		{
+			break;
+		}
+		bind_stream_frame_info(stream_frame_info, slot.raw_buffer, slot.raw_temp_buffer);
+		if(drm_dev_open_flag == 0)
+		{
+			ret = drm_dev_open(stream_frame_info->width, stream_frame_info->height); //init display
+			if (ret != 0)
+			{
+				printf("drm dev open fail\n");
+				frame_ring_release(&slot);
+				frame_ring_remove_consumer(frame_ring, consumer_id);
+#ifdef USE_RGA
+				free(bgra_image_frame);
+				bgra_image_frame = NULL;
+				free(src_rgb_image_frame);
+				src_rgb_image_frame = NULL;
+#endif
+				return NULL;
+			}
+			drm_dev_open_flag = 1;
+		}
 #ifdef USE_RGA
 		memcpy(src_rgb_image_frame, stream_frame_info->image_info.data, stream_frame_info->image_info.byte_size); //image data
 		if ((stream_frame_info->frame_output_format == NV12_IMAGE) || (stream_frame_info->frame_output_format == NV12_AND_TEMP))
 		{
 			src = wrapbuffer_virtualaddr(src_rgb_image_frame, stream_frame_info->width, \
 				stream_frame_info->height, RK_FORMAT_YCbCr_420_SP);
-			dst = wrapbuffer_virtualaddr(rgb_image_frame, stream_frame_info->width, \
-				stream_frame_info->height, RK_FORMAT_RGB_888);
+			dst = wrapbuffer_virtualaddr(bgra_image_frame, stream_frame_info->width, \
+				stream_frame_info->height, RK_FORMAT_BGRA_8888);
 		}
 		if ((stream_frame_info->frame_output_format == YUYV_IMAGE) || (stream_frame_info->frame_output_format == YUYV_AND_TEMP))
 		{
 			src = wrapbuffer_virtualaddr(src_rgb_image_frame, stream_frame_info->width, \
 				stream_frame_info->height, RK_FORMAT_YVYU_422);
-			dst = wrapbuffer_virtualaddr(rgb_image_frame, stream_frame_info->width, \
-				stream_frame_info->height, RK_FORMAT_RGB_888);
+			dst = wrapbuffer_virtualaddr(bgra_image_frame, stream_frame_info->width, \
+				stream_frame_info->height, RK_FORMAT_BGRA_8888);
 		}
 
 		src_info.fd = src.fd;
@@ -316,44 +367,35 @@ void* drm_display_function(void* threadarg)
 		dst_info.mmuFlag = 1;
 		rga_set_rect(&dst_info.rect, drect.x, drect.y, dst.width, dst.height, dst.wstride, dst.hstride, dst.format);
 		RgaBlit(&src_info, &dst_info, NULL);//旋转+缩放+颜色转换
+		drm_display(bgra_image_frame); //send to display
 #else
+		//convert straight into the plane buffer shown next, no intermediate frame and copy
+		uint32_t pitch = 0;
+		uint8_t* back_buffer = drm_get_back_buffer(&pitch);
 		if ((stream_frame_info->frame_output_format == YUYV_IMAGE) || (stream_frame_info->frame_output_format == YUYV_AND_TEMP)
 			|| (stream_frame_info->frame_output_format == UYVY_IMAGE))
 		{
-			yuv422_to_rgb(stream_frame_info->image_info.data, (stream_frame_info->width*stream_frame_info->height), rgb_image_frame);
+			row_band_yuv422_to_bgra(stream_frame_info->pipeline->row_band_pool, stream_frame_info->image_info.data, \
+				stream_frame_info->width, stream_frame_info->height, back_buffer, pitch);
 		}
 		if ((stream_frame_info->frame_output_format == NV12_IMAGE) || (stream_frame_info->frame_output_format == NV12_AND_TEMP))
 		{
-			nv12_to_rgb(stream_frame_info->image_info.data, stream_frame_info->width, stream_frame_info->height, rgb_image_frame);
+			row_band_nv12_to_bgra(stream_frame_info->pipeline->row_band_pool, stream_frame_info->image_info.data, \
+				stream_frame_info->width, stream_frame_info->height, back_buffer, pitch);
 		}
-
-#endif
-		if(drm_dev_open_flag == 0)
-		{
-			ret = drm_dev_open(stream_frame_info->width, stream_frame_info->height); //init display
-			if (ret != 0)
-			{
-				printf("drm dev open fail\n");
-				free(rgb_image_frame);
-				rgb_image_frame = NULL;
-#ifdef USE_RGA
-				free(src_rgb_image_frame);
-				src_rgb_image_frame = NULL;
+		drm_flip(); //send to display
 #endif
-				return NULL;
-			}
-			drm_dev_open_flag = 1;
-		}
-		drm_display(rgb_image_frame); //send to display
-		sem_post(&image_done_sem);
+		frame_ring_release(&slot);
 	}
+	printf("display skipped %llu frames\n", (unsigned long long)frame_ring_dropped(frame_ring, consumer_id));
+	frame_ring_remove_consumer(frame_ring, consumer_id);
 
-	if (rgb_image_frame != NULL)
+#ifdef USE_RGA
+	if (bgra_image_frame != NULL)
 	{
-		free(rgb_image_frame);
-		rgb_image_frame = NULL;
+		free(bgra_image_frame);
+		bgra_image_frame = NULL;
 	}
-#ifdef USE_RGA
 	if (src_rgb_image_frame != NULL)
 	{
 		free(src_rgb_image_frame);
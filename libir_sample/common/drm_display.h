@@ -5,6 +5,9 @@
 #include <stdint.h>
 #include <stdint.h>
 #include "data.h"
+#include "pipeline.h"
+#include "frame_ring.h"
+#include "row_band_kernels.h"
 
 #define DRM_DEV_PATH "/dev/dri/card0"
 
@@ -35,7 +38,11 @@ extern "C"
 
     int drm_dev_open(int width, int height);
     int drm_dev_close();
+    //buff is a XRGB8888 frame of the opened size
     void drm_display(void *buff);
+    //the plane buffer shown by the next drm_flip, frames can be converted straight into it
+    uint8_t* drm_get_back_buffer(uint32_t* pitch);
+    void drm_flip();
 
     uint32_t drm_get_screeninfo_width();
     uint32_t drm_get_screeninfo_height();
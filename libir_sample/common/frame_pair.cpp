@@ -0,0 +1,223 @@
+#include "frame_pair.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <deque>
+#include <vector>
+
+using std::deque;
+using std::vector;
+
+#define FRAME_PAIR_IMAGE    0
+#define FRAME_PAIR_TEMP     1
+#define FRAME_PAIR_DEFAULT_FPS  25
+
+typedef struct {
+    FrameBuffer_t* buffer;
+    int frame_count;
+}PairEntry_t;
+
+struct FramePair_s {
+    FrameRing_t* ring;
+    uint32_t window;
+    int64_t period_us;
+    deque<PairEntry_t> pending[2];  //unmatched frames of each channel, oldest first
+    FramePairStats_t stats;
+    pthread_mutex_t mutex;
+    //the pairs are numbered under mutex and committed outside it in that order, a commit waiting for the ring only
+    //holds back the commits after it, never the channel parking a frame
+    uint64_t next_sequence;
+    uint64_t commit_sequence;
+    pthread_mutex_t commit_mutex;
+    pthread_cond_t commit_cond;
+};
+
+FramePair_t* frame_pair_create(FrameRing_t* ring, uint32_t window, uint32_t fps)
+{
+    if (ring == NULL)
+    {
+        printf("frame_pair_create: invalid param\n");
+        return NULL;
+    }
+
+    FramePair_t* pair = new FramePair_t;
+    pair->ring = ring;
+    pair->window = (window == 0) ? FRAME_PAIR_DEFAULT_WINDOW : window;
+    pair->period_us = 1000000 / ((fps == 0) ? FRAME_PAIR_DEFAULT_FPS : fps);
+    memset(&pair->stats, 0, sizeof(pair->stats));
+    pthread_mutex_init(&pair->mutex, NULL);
+    pair->next_sequence = 0;
+    pair->commit_sequence = 0;
+    pthread_mutex_init(&pair->commit_mutex, NULL);
+    pthread_cond_init(&pair->commit_cond, NULL);
+    printf("frame pair: window %d, frame period %lldus\n", pair->window, (long long)pair->period_us);
+    return pair;
+}
+
+void frame_pair_destroy(FramePair_t* pair)
+{
+    if (pair == NULL)
+    {
+        return;
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+        for (size_t j = 0; j < pair->pending[i].size(); j++)
+        {
+            frame_buffer_unref(pair->pending[i][j].buffer);
+        }
+        pair->pending[i].clear();
+    }
+    pthread_mutex_destroy(&pair->mutex);
+    pthread_mutex_destroy(&pair->commit_mutex);
+    pthread_cond_destroy(&pair->commit_cond);
+    delete pair;
+}
+
+//distance between an image frame and a temp frame, -1 if they can't come from the same sensor frame
+static int64_t frame_pair_distance(FramePair_t* pair, PairEntry_t* image, PairEntry_t* temp)
+{
+    int64_t distance = 0;
+    if (image->buffer->timestamp_us != 0 && temp->buffer->timestamp_us != 0)
+    {
+        distance = (int64_t)image->buffer->timestamp_us - (int64_t)temp->buffer->timestamp_us;
+        if (distance < 0)
+        {
+            distance = -distance;
+        }
+    }
+
+    if (image->frame_count != FRAME_PAIR_NO_COUNT && temp->frame_count != FRAME_PAIR_NO_COUNT)
+    {
+        //the counters are only 16 bits, the timestamps keep an old frame with a wrapped count apart
+        if (image->frame_count != temp->frame_count || distance > (int64_t)pair->window * pair->period_us)
+        {
+            return -1;
+        }
+        return distance;
+    }
+
+    //without a counter the nearest frame within half a period is the partner
+    return (distance <= pair->period_us / 2) ? distance : -1;
+}
+
+static int frame_pair_push(FramePair_t* pair, int channel, FrameBuffer_t* buffer, int frame_count)
+{
+    if (pair == NULL || buffer == NULL)
+    {
+        frame_buffer_unref(buffer);
+        return -1;
+    }
+
+    PairEntry_t entry;
+    entry.buffer = buffer;
+    entry.frame_count = frame_count;
+    vector<FrameBuffer_t*> orphans;
+    FrameSlot_t slot;
+    memset(&slot, 0, sizeof(slot));
+    uint64_t sequence = 0;
+
+    pthread_mutex_lock(&pair->mutex);
+    deque<PairEntry_t>& others = pair->pending[1 - channel];
+    int match = -1;
+    int64_t best_distance = -1;
+    for (size_t i = 0; i < others.size(); i++)
+    {
+        int64_t distance = (channel == FRAME_PAIR_IMAGE) ? frame_pair_distance(pair, &entry, &others[i]) \
+            : frame_pair_distance(pair, &others[i], &entry);
+        if (distance >= 0 && (best_distance < 0 || distance < best_distance))
+        {
+            best_distance = distance;
+            match = (int)i;
+        }
+    }
+
+    if (match < 0)
+    {
+        //wait for the other channel, the oldest frame gives up once the window is full
+        pair->pending[channel].push_back(entry);
+        if (pair->pending[channel].size() > pair->window)
+        {
+            orphans.push_back(pair->pending[channel].front().buffer);
+            pair->pending[channel].pop_front();
+        }
+    }
+    else
+    {
+        //the frames queued before the match have lost their partner
+        for (int i = 0; i < match; i++)
+        {
+            orphans.push_back(others.front().buffer);
+            others.pop_front();
+        }
+
+        slot.raw_buffer = (channel == FRAME_PAIR_IMAGE) ? entry.buffer : others.front().buffer;
+        slot.raw_temp_buffer = (channel == FRAME_PAIR_TEMP) ? entry.buffer : others.front().buffer;
+        others.pop_front();
+        pair->stats.paired++;
+        sequence = pair->next_sequence++;
+    }
+
+    if (!orphans.empty())
+    {
+        bool image_orphan = (match < 0) == (channel == FRAME_PAIR_IMAGE);
+        if (image_orphan)
+        {
+            pair->stats.image_orphans += orphans.size();
+        }
+        else
+        {
+            pair->stats.temp_orphans += orphans.size();
+        }
+    }
+    pthread_mutex_unlock(&pair->mutex);
+
+    //recycling takes the ring's lock, drop the orphans outside ours
+    for (size_t i = 0; i < orphans.size(); i++)
+    {
+        frame_buffer_unref(orphans[i]);
+    }
+    if (match < 0)
+    {
+        return 0;
+    }
+
+    //the pairs reach the ring in capture order, each one after the commit of the pair before
+    pthread_mutex_lock(&pair->commit_mutex);
+    while (pair->commit_sequence != sequence)
+    {
+        pthread_cond_wait(&pair->commit_cond, &pair->commit_mutex);
+    }
+    pthread_mutex_unlock(&pair->commit_mutex);
+
+    int ret = frame_ring_commit(pair->ring, &slot);
+
+    pthread_mutex_lock(&pair->commit_mutex);
+    pair->commit_sequence++;
+    pthread_cond_broadcast(&pair->commit_cond);
+    pthread_mutex_unlock(&pair->commit_mutex);
+    return ret;
+}
+
+int frame_pair_push_image(FramePair_t* pair, FrameBuffer_t* buffer, int frame_count)
+{
+    return frame_pair_push(pair, FRAME_PAIR_IMAGE, buffer, frame_count);
+}
+
+int frame_pair_push_temp(FramePair_t* pair, FrameBuffer_t* buffer, int frame_count)
+{
+    return frame_pair_push(pair, FRAME_PAIR_TEMP, buffer, frame_count);
+}
+
+void frame_pair_get_stats(FramePair_t* pair, FramePairStats_t* stats)
+{
+    if (pair == NULL || stats == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pair->mutex);
+    *stats = pair->stats;
+    pthread_mutex_unlock(&pair->mutex);
+}
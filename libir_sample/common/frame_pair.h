@@ -0,0 +1,32 @@
+#ifndef _FRAME_PAIR_H_
+#define _FRAME_PAIR_H_
+
+#include "data.h"
+#include "frame_ring.h"
+
+#define FRAME_PAIR_DEFAULT_WINDOW   4
+#define FRAME_PAIR_NO_COUNT         -1
+
+typedef struct {
+    uint64_t paired;
+    uint64_t image_orphans;     //image frames dropped because no temp frame matched them
+    uint64_t temp_orphans;      //temp frames dropped because no image frame matched them
+}FramePairStats_t;
+
+//pair the image frames(image + information line) and temp frames(temp + temp information line) into frame_ring slots.
+//window: frames a channel may run ahead of the other before its oldest unmatched frame is dropped as an orphan
+//fps: channel frame rate, the timestamp tolerance is derived from the frame period
+FramePair_t* frame_pair_create(FrameRing_t* ring, uint32_t window, uint32_t fps);
+
+//drop the frames still waiting for a match
+void frame_pair_destroy(FramePair_t* pair);
+
+//hand over one reference of the buffer, frame_count is the info line counter or FRAME_PAIR_NO_COUNT.
+//a matched pair is committed to the ring in the caller's thread, after the pairs matched before it. a frame left
+//waiting for its match returns without touching the ring, so a commit waiting on the ring never holds it
+int frame_pair_push_image(FramePair_t* pair, FrameBuffer_t* buffer, int frame_count);
+int frame_pair_push_temp(FramePair_t* pair, FrameBuffer_t* buffer, int frame_count);
+
+void frame_pair_get_stats(FramePair_t* pair, FramePairStats_t* stats);
+
+#endif
@@ -0,0 +1,385 @@
+#include "frame_ring.h"
+#include <string.h>
+#include <pthread.h>
+#include <vector>
+
+using std::vector;
+
+//recycled buffers of one size, a buffer goes back here when its last reference is dropped
+typedef struct {
+    FrameRing_t* ring;
+    uint32_t byte_size;
+    vector<FrameBuffer_t*> free_buffers;
+}FramePool_t;
+
+struct FrameRing_s {
+    FrameSlot_t* slots;
+    uint32_t slot_num;
+    FrameRingPolicy_e policy;
+    uint64_t write_seq;
+    uint64_t read_seq[FRAME_RING_MAX_CONSUMERS];
+    uint64_t dropped[FRAME_RING_MAX_CONSUMERS];
+    bool consumer_used[FRAME_RING_MAX_CONSUMERS];
+    bool stopped;
+    pthread_mutex_t mutex;
+    pthread_cond_t readable;
+    pthread_cond_t writable;
+    FramePool_t raw_pool;
+    FramePool_t raw_temp_pool;
+};
+
+static void frame_pool_recycle(FrameBuffer_t* buffer)
+{
+    FramePool_t* pool = (FramePool_t*)buffer->priv;
+    pthread_mutex_lock(&pool->ring->mutex);
+    pool->free_buffers.push_back(buffer);
+    pthread_mutex_unlock(&pool->ring->mutex);
+}
+
+static FrameBuffer_t* frame_pool_get(FramePool_t* pool)
+{
+    if (pool->byte_size == 0)
+    {
+        return NULL;
+    }
+
+    FrameBuffer_t* buffer = NULL;
+    pthread_mutex_lock(&pool->ring->mutex);
+    if (!pool->free_buffers.empty())
+    {
+        buffer = pool->free_buffers.back();
+        pool->free_buffers.pop_back();
+    }
+    pthread_mutex_unlock(&pool->ring->mutex);
+
+    if (buffer != NULL)
+    {
+        buffer->ref_count = 1;
+        buffer->timestamp_us = 0;
+        return buffer;
+    }
+
+    //the pool grows until slots + consumers + stream thread buffers are in flight, then it only recycles
+    uint8_t* data = (uint8_t*)malloc(pool->byte_size);
+    if (data == NULL)
+    {
+        printf("there is no more space!\n");
+        return NULL;
+    }
+    return frame_buffer_wrap(data, pool->byte_size, frame_pool_recycle, pool);
+}
+
+static void frame_pool_clear(FramePool_t* pool)
+{
+    for (size_t i = 0; i < pool->free_buffers.size(); i++)
+    {
+        free(pool->free_buffers[i]->data);
+        delete pool->free_buffers[i];
+    }
+    pool->free_buffers.clear();
+}
+
+FrameRing_t* frame_ring_create(uint32_t slot_num, FrameRingPolicy_e policy, uint32_t raw_byte_size, uint32_t raw_temp_byte_size)
+{
+    if (slot_num == 0 || raw_byte_size == 0)
+    {
+        printf("frame_ring_create: invalid param\n");
+        return NULL;
+    }
+
+    FrameRing_t* ring = new FrameRing_t;
+    ring->slots = new FrameSlot_t[slot_num];
+    memset(ring->slots, 0, sizeof(FrameSlot_t) * slot_num);
+    ring->slot_num = slot_num;
+    ring->policy = policy;
+    ring->write_seq = 0;
+    memset(ring->read_seq, 0, sizeof(ring->read_seq));
+    memset(ring->dropped, 0, sizeof(ring->dropped));
+    memset(ring->consumer_used, 0, sizeof(ring->consumer_used));
+    ring->stopped = false;
+    pthread_mutex_init(&ring->mutex, NULL);
+    pthread_cond_init(&ring->readable, NULL);
+    pthread_cond_init(&ring->writable, NULL);
+    ring->raw_pool.ring = ring;
+    ring->raw_pool.byte_size = raw_byte_size;
+    ring->raw_temp_pool.ring = ring;
+    ring->raw_temp_pool.byte_size = raw_temp_byte_size;
+    printf("frame ring: %d slots, policy %s\n", slot_num, (policy == FRAME_RING_BLOCK) ? "block" : "drop_oldest");
+    return ring;
+}
+
+void frame_ring_destroy(FrameRing_t* ring)
+{
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < ring->slot_num; i++)
+    {
+        frame_ring_release(&ring->slots[i]);
+    }
+    frame_pool_clear(&ring->raw_pool);
+    frame_pool_clear(&ring->raw_temp_pool);
+
+    pthread_cond_destroy(&ring->writable);
+    pthread_cond_destroy(&ring->readable);
+    pthread_mutex_destroy(&ring->mutex);
+    delete[] ring->slots;
+    delete ring;
+}
+
+FrameRingPolicy_e frame_ring_policy_from_name(const char* name)
+{
+    if (name != NULL && strcmp(name, "block") == 0)
+    {
+        return FRAME_RING_BLOCK;
+    }
+    return FRAME_RING_DROP_OLDEST;
+}
+
+int frame_ring_acquire(FrameRing_t* ring, FrameSlot_t* slot)
+{
+    if (ring == NULL || slot == NULL)
+    {
+        return -1;
+    }
+
+    slot->sequence = 0;
+    slot->raw_buffer = frame_pool_get(&ring->raw_pool);
+    slot->raw_temp_buffer = frame_pool_get(&ring->raw_temp_pool);
+    if (slot->raw_buffer == NULL || (ring->raw_temp_pool.byte_size != 0 && slot->raw_temp_buffer == NULL))
+    {
+        frame_ring_release(slot);
+        return -1;
+    }
+    return 0;
+}
+
+FrameBuffer_t* frame_ring_acquire_raw_buffer(FrameRing_t* ring)
+{
+    return (ring == NULL) ? NULL : frame_pool_get(&ring->raw_pool);
+}
+
+FrameBuffer_t* frame_ring_acquire_raw_temp_buffer(FrameRing_t* ring)
+{
+    return (ring == NULL) ? NULL : frame_pool_get(&ring->raw_temp_pool);
+}
+
+//lag of the slowest consumer, must hold the mutex
+static uint64_t frame_ring_max_lag(FrameRing_t* ring)
+{
+    uint64_t max_lag = 0;
+    for (int i = 0; i < FRAME_RING_MAX_CONSUMERS; i++)
+    {
+        if (ring->consumer_used[i] && ring->write_seq - ring->read_seq[i] > max_lag)
+        {
+            max_lag = ring->write_seq - ring->read_seq[i];
+        }
+    }
+    return max_lag;
+}
+
+int frame_ring_commit(FrameRing_t* ring, FrameSlot_t* slot)
+{
+    if (ring == NULL || slot == NULL)
+    {
+        return -1;
+    }
+
+    //producers which can't tell the capture time are stamped on publishing
+    if (slot->raw_buffer != NULL && slot->raw_buffer->timestamp_us == 0)
+    {
+        slot->raw_buffer->timestamp_us = frame_clock_us();
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    if (ring->policy == FRAME_RING_BLOCK)
+    {
+        while (!ring->stopped && frame_ring_max_lag(ring) >= ring->slot_num)
+        {
+            pthread_cond_wait(&ring->writable, &ring->mutex);
+        }
+    }
+    if (ring->stopped)
+    {
+        pthread_mutex_unlock(&ring->mutex);
+        frame_ring_release(slot);
+        return -1;
+    }
+
+    FrameSlot_t* dst = &ring->slots[ring->write_seq % ring->slot_num];
+    FrameSlot_t old_slot = *dst;
+    slot->sequence = (uint32_t)ring->write_seq;
+    *dst = *slot;
+    ring->write_seq++;
+
+    //consumers which fall a whole ring behind lose their oldest frame
+    for (int i = 0; i < FRAME_RING_MAX_CONSUMERS; i++)
+    {
+        if (ring->consumer_used[i] && ring->write_seq - ring->read_seq[i] > ring->slot_num)
+        {
+            ring->dropped[i] += ring->write_seq - ring->read_seq[i] - ring->slot_num;
+            ring->read_seq[i] = ring->write_seq - ring->slot_num;
+        }
+    }
+    pthread_cond_broadcast(&ring->readable);
+    pthread_mutex_unlock(&ring->mutex);
+
+    //the ring's reference moves to dst, unref outside the lock since recycling takes it
+    slot->raw_buffer = NULL;
+    slot->raw_temp_buffer = NULL;
+    frame_ring_release(&old_slot);
+    return 0;
+}
+
+void frame_ring_stop(FrameRing_t* ring)
+{
+    if (ring == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    ring->stopped = true;
+    pthread_cond_broadcast(&ring->readable);
+    pthread_cond_broadcast(&ring->writable);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+int frame_ring_add_consumer(FrameRing_t* ring)
+{
+    if (ring == NULL)
+    {
+        return -1;
+    }
+
+    int consumer_id = -1;
+    pthread_mutex_lock(&ring->mutex);
+    for (int i = 0; i < FRAME_RING_MAX_CONSUMERS; i++)
+    {
+        if (!ring->consumer_used[i])
+        {
+            ring->consumer_used[i] = true;
+            ring->read_seq[i] = ring->write_seq;
+            ring->dropped[i] = 0;
+            consumer_id = i;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ring->mutex);
+
+    if (consumer_id < 0)
+    {
+        printf("frame ring: too many consumers\n");
+    }
+    return consumer_id;
+}
+
+void frame_ring_remove_consumer(FrameRing_t* ring, int consumer_id)
+{
+    if (ring == NULL || consumer_id < 0 || consumer_id >= FRAME_RING_MAX_CONSUMERS)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    ring->consumer_used[consumer_id] = false;
+    pthread_cond_broadcast(&ring->writable);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+//copy the slot and take a reference on its buffers, must hold the mutex
+static void frame_ring_get_slot(FrameRing_t* ring, uint64_t sequence, FrameSlot_t* slot)
+{
+    *slot = ring->slots[sequence % ring->slot_num];
+    frame_buffer_ref(slot->raw_buffer);
+    frame_buffer_ref(slot->raw_temp_buffer);
+}
+
+int frame_ring_read(FrameRing_t* ring, int consumer_id, FrameSlot_t* slot)
+{
+    if (ring == NULL || slot == NULL || consumer_id < 0 || consumer_id >= FRAME_RING_MAX_CONSUMERS)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    while (!ring->stopped && ring->read_seq[consumer_id] == ring->write_seq)
+    {
+        pthread_cond_wait(&ring->readable, &ring->mutex);
+    }
+    if (ring->stopped)
+    {
+        pthread_mutex_unlock(&ring->mutex);
+        return -1;
+    }
+
+    frame_ring_get_slot(ring, ring->read_seq[consumer_id], slot);
+    ring->read_seq[consumer_id]++;
+    pthread_cond_broadcast(&ring->writable);
+    pthread_mutex_unlock(&ring->mutex);
+    return 0;
+}
+
+int frame_ring_read_latest(FrameRing_t* ring, FrameSlot_t* slot)
+{
+    if (ring == NULL || slot == NULL)
+    {
+        return -1;
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    while (!ring->stopped && ring->write_seq == 0)
+    {
+        pthread_cond_wait(&ring->readable, &ring->mutex);
+    }
+    if (ring->stopped)
+    {
+        pthread_mutex_unlock(&ring->mutex);
+        return -1;
+    }
+
+    frame_ring_get_slot(ring, ring->write_seq - 1, slot);
+    pthread_mutex_unlock(&ring->mutex);
+    return 0;
+}
+
+void frame_ring_release(FrameSlot_t* slot)
+{
+    if (slot == NULL)
+    {
+        return;
+    }
+
+    frame_buffer_unref(slot->raw_buffer);
+    slot->raw_buffer = NULL;
+    frame_buffer_unref(slot->raw_temp_buffer);
+    slot->raw_temp_buffer = NULL;
+}
+
+uint64_t frame_ring_dropped(FrameRing_t* ring, int consumer_id)
+{
+    if (ring == NULL || consumer_id < 0 || consumer_id >= FRAME_RING_MAX_CONSUMERS)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    uint64_t dropped = ring->dropped[consumer_id];
+    pthread_mutex_unlock(&ring->mutex);
+    return dropped;
+}
+
+uint64_t frame_ring_published(FrameRing_t* ring)
+{
+    if (ring == NULL)
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&ring->mutex);
+    uint64_t published = ring->write_seq;
+    pthread_mutex_unlock(&ring->mutex);
+    return published;
+}
@@ -0,0 +1,63 @@
+#ifndef _FRAME_RING_H_
+#define _FRAME_RING_H_
+
+#include "data.h"
+
+#define FRAME_RING_DEFAULT_SLOTS    4
+#define FRAME_RING_MAX_CONSUMERS    8
+
+typedef enum
+{
+    FRAME_RING_DROP_OLDEST = 0, //the stream thread overwrites the oldest slot, slow consumers skip frames
+    FRAME_RING_BLOCK,           //the stream thread waits until every consumer has read the oldest slot
+}FrameRingPolicy_e;
+
+//one published frame, the consumer holds a reference on each buffer until frame_ring_release
+typedef struct {
+    FrameBuffer_t* raw_buffer;
+    FrameBuffer_t* raw_temp_buffer;
+    uint32_t sequence;
+}FrameSlot_t;
+
+//create a ring of slot_num frames, each slot owns one raw buffer and one raw temp buffer(if raw_temp_byte_size != 0)
+FrameRing_t* frame_ring_create(uint32_t slot_num, FrameRingPolicy_e policy, uint32_t raw_byte_size, uint32_t raw_temp_byte_size);
+
+//every frame must be released before destroying the ring
+void frame_ring_destroy(FrameRing_t* ring);
+
+//"drop_oldest" or "block", unknown names fall back to drop_oldest
+FrameRingPolicy_e frame_ring_policy_from_name(const char* name);
+
+//stream thread: take empty buffers from the ring's pool, never waits for the consumers
+int frame_ring_acquire(FrameRing_t* ring, FrameSlot_t* slot);
+
+//stream threads which fill the two buffers of a slot independently(mipi 2vc), take one empty buffer of each kind
+FrameBuffer_t* frame_ring_acquire_raw_buffer(FrameRing_t* ring);
+FrameBuffer_t* frame_ring_acquire_raw_temp_buffer(FrameRing_t* ring);
+
+//stream thread: publish the acquired frame to all consumers
+int frame_ring_commit(FrameRing_t* ring, FrameSlot_t* slot);
+
+//wake up all waiting threads, frame_ring_read/frame_ring_commit return -1 afterwards
+void frame_ring_stop(FrameRing_t* ring);
+
+//register a consumer which starts from the next published frame, return the consumer id or -1
+int frame_ring_add_consumer(FrameRing_t* ring);
+
+void frame_ring_remove_consumer(FrameRing_t* ring, int consumer_id);
+
+//wait for the next frame of the consumer, return -1 when the ring is stopped
+int frame_ring_read(FrameRing_t* ring, int consumer_id, FrameSlot_t* slot);
+
+//wait for the newest frame without a consumer cursor, for one-shot readers like temp measure
+int frame_ring_read_latest(FrameRing_t* ring, FrameSlot_t* slot);
+
+void frame_ring_release(FrameSlot_t* slot);
+
+//frames the consumer skipped because the ring was overwritten
+uint64_t frame_ring_dropped(FrameRing_t* ring, int consumer_id);
+
+//frames committed since the ring was created
+uint64_t frame_ring_published(FrameRing_t* ring);
+
+#endif
@@ -0,0 +1,262 @@
+#include "hist_agc.h"
+#include <stdio.h>
+#include <vector>
+
+using std::vector;
+
+struct HistAgc_s {
+    HistAgcParam_t param;
+    int width;
+    int height;
+    int shift;                  //raw value >> shift is its bin
+    int grid_width;
+    int grid_height;
+    vector<uint16_t> samples;   //bin of every grid pixel in the last frame
+    vector<int> histogram;
+    bool first;                 //no frame yet, the first one sets the curve without smoothing
+    vector<float> curve;        //plateau: smoothed 0~255 position of every bin
+    float low;                  //linear: smoothed stretch range, in bins
+    float high;
+    vector<uint16_t> transfer;
+};
+
+void hist_agc_default_param(HistAgcParam_t* param)
+{
+    param->mode = HIST_AGC_PLATEAU;
+    param->input_bits = 14;
+    param->sample_step = 4;
+    param->low_discard = 0.005f;
+    param->high_discard = 0.005f;
+    param->plateau = 3;
+    param->smoothing = 0.25f;
+}
+
+HistAgc_t* hist_agc_create(const HistAgcParam_t* param, int width, int height)
+{
+    if (param == NULL || width <= 0 || height <= 0 || (param->input_bits != 14 && param->input_bits != 16) \
+        || param->sample_step <= 0 || param->low_discard < 0 || param->high_discard < 0 \
+        || param->low_discard + param->high_discard >= 1 || param->plateau < 1 \
+        || param->smoothing <= 0 || param->smoothing > 1)
+    {
+        printf("hist_agc_create: invalid param\n");
+        return NULL;
+    }
+
+    HistAgc_t* agc = new HistAgc_t;
+    agc->param = *param;
+    agc->width = width;
+    agc->height = height;
+    agc->shift = param->input_bits - 14;
+    agc->grid_width = (width + param->sample_step - 1) / param->sample_step;
+    agc->grid_height = (height + param->sample_step - 1) / param->sample_step;
+
+    //every grid pixel starts in bin 0, so the first frame moves them like any other
+    agc->samples.assign(agc->grid_width * agc->grid_height, 0);
+    agc->histogram.assign(HIST_AGC_BIN_NUM, 0);
+    agc->histogram[0] = (int)agc->samples.size();
+    agc->first = true;
+    agc->curve.assign(HIST_AGC_BIN_NUM, 0);
+    agc->low = 0;
+    agc->high = HIST_AGC_BIN_NUM;
+    agc->transfer.assign(HIST_AGC_TRANSFER_SIZE, 0);
+    return agc;
+}
+
+void hist_agc_destroy(HistAgc_t* agc)
+{
+    delete agc;
+}
+
+static void hist_agc_sample(HistAgc_t* agc, const uint16_t* frame)
+{
+    int step = agc->param.sample_step;
+    uint16_t* sample = &agc->samples[0];
+    int* histogram = &agc->histogram[0];
+    for (int row = 0; row < agc->height; row += step)
+    {
+        const uint16_t* line = frame + row * agc->width;
+        for (int x = 0; x < agc->width; x += step)
+        {
+            int bin = line[x] >> agc->shift;
+            if (bin >= HIST_AGC_BIN_NUM)
+            {
+                bin = HIST_AGC_BIN_NUM - 1;
+            }
+            if (bin != *sample)
+            {
+                histogram[*sample]--;
+                histogram[bin]++;
+                *sample = (uint16_t)bin;
+            }
+            sample++;
+        }
+    }
+}
+
+//first and last bin left after discarding the low and high share of the samples
+static void hist_agc_range(HistAgc_t* agc, int* low_bin, int* high_bin)
+{
+    const int* histogram = &agc->histogram[0];
+    int total = (int)agc->samples.size();
+    int low_count = (int)(total * agc->param.low_discard);
+    int high_count = (int)(total * agc->param.high_discard);
+
+    int count = 0;
+    int bin = 0;
+    while (bin < HIST_AGC_BIN_NUM - 1 && count + histogram[bin] <= low_count)
+    {
+        count += histogram[bin++];
+    }
+    *low_bin = bin;
+
+    count = 0;
+    bin = HIST_AGC_BIN_NUM - 1;
+    while (bin > *low_bin && count + histogram[bin] <= high_count)
+    {
+        count += histogram[bin--];
+    }
+    *high_bin = bin;
+}
+
+static uint16_t hist_agc_position(float position)
+{
+    if (position <= 0)
+    {
+        return 0;
+    }
+    if (position >= 255)
+    {
+        return HIST_AGC_TRANSFER_MAX;
+    }
+    return (uint16_t)(position * 256 + 0.5f);
+}
+
+//equalize the clipped histogram between low_bin and high_bin, each bin goes to the middle of its share of 0~255
+static void hist_agc_plateau(HistAgc_t* agc, int low_bin, int high_bin)
+{
+    const int* histogram = &agc->histogram[0];
+    int occupied = 0;
+    int sum = 0;
+    for (int bin = low_bin; bin <= high_bin; bin++)
+    {
+        if (histogram[bin] > 0)
+        {
+            occupied++;
+            sum += histogram[bin];
+        }
+    }
+    int limit = (int)(agc->param.plateau * sum / occupied);
+    if (limit < 1)
+    {
+        limit = 1;
+    }
+    int clipped_sum = 0;
+    for (int bin = low_bin; bin <= high_bin; bin++)
+    {
+        clipped_sum += (histogram[bin] < limit) ? histogram[bin] : limit;
+    }
+
+    float smoothing = agc->first ? 1 : agc->param.smoothing;
+    float scale = 255.0f / clipped_sum;
+    float* curve = &agc->curve[0];
+    int cumulative = 0;
+    for (int bin = 0; bin < HIST_AGC_BIN_NUM; bin++)
+    {
+        float target;
+        if (bin < low_bin)
+        {
+            target = 0;
+        }
+        else if (bin > high_bin)
+        {
+            target = 255;
+        }
+        else
+        {
+            int count = (histogram[bin] < limit) ? histogram[bin] : limit;
+            target = (cumulative + count * 0.5f) * scale;
+            cumulative += count;
+        }
+        curve[bin] += (target - curve[bin]) * smoothing;
+    }
+
+    int values_per_bin = 1 << agc->shift;
+    uint16_t* transfer = &agc->transfer[0];
+    for (int bin = 0; bin < HIST_AGC_BIN_NUM; bin++)
+    {
+        uint16_t position = hist_agc_position(curve[bin]);
+        for (int i = 0; i < values_per_bin; i++)
+        {
+            *transfer++ = position;
+        }
+    }
+    //y14 frames: values above 16383 are out of range, they take the top bin
+    while (transfer < &agc->transfer[0] + HIST_AGC_TRANSFER_SIZE)
+    {
+        *transfer++ = hist_agc_position(curve[HIST_AGC_BIN_NUM - 1]);
+    }
+}
+
+//stretch low_bin~high_bin linearly over 0~255, only the two ends are smoothed
+static void hist_agc_linear(HistAgc_t* agc, int low_bin, int high_bin)
+{
+    float smoothing = agc->first ? 1 : agc->param.smoothing;
+    agc->low += (low_bin - agc->low) * smoothing;
+    agc->high += (high_bin + 1 - agc->high) * smoothing;
+
+    float bin_scale = 1.0f / (1 << agc->shift);
+    float scale = 255.0f / (agc->high - agc->low);
+    uint16_t* transfer = &agc->transfer[0];
+    for (int value = 0; value < HIST_AGC_TRANSFER_SIZE; value++)
+    {
+        transfer[value] = hist_agc_position((value * bin_scale - agc->low) * scale);
+    }
+}
+
+int hist_agc_update(HistAgc_t* agc, const uint16_t* frame)
+{
+    if (agc == NULL || frame == NULL)
+    {
+        printf("hist_agc_update: invalid param\n");
+        return -1;
+    }
+
+    hist_agc_sample(agc, frame);
+    int low_bin, high_bin;
+    hist_agc_range(agc, &low_bin, &high_bin);
+    if (agc->param.mode == HIST_AGC_PLATEAU)
+    {
+        hist_agc_plateau(agc, low_bin, high_bin);
+    }
+    else
+    {
+        hist_agc_linear(agc, low_bin, high_bin);
+    }
+    agc->first = false;
+    return 0;
+}
+
+const uint16_t* hist_agc_transfer(HistAgc_t* agc)
+{
+    if (agc == NULL)
+    {
+        return NULL;
+    }
+    return &agc->transfer[0];
+}
+
+int hist_agc_to_y8(HistAgc_t* agc, const uint16_t* frame, int pixel_num, uint8_t* y8_data)
+{
+    if (agc == NULL || frame == NULL || y8_data == NULL || pixel_num <= 0)
+    {
+        printf("hist_agc_to_y8: invalid param\n");
+        return -1;
+    }
+
+    const uint16_t* transfer = &agc->transfer[0];
+    for (int i = 0; i < pixel_num; i++)
+    {
+        y8_data[i] = (uint8_t)((transfer[frame[i]] + 128) >> 8);
+    }
+    return 0;
+}
@@ -0,0 +1,47 @@
+#ifndef _HIST_AGC_H_
+#define _HIST_AGC_H_
+
+#include <stdint.h>
+
+#define HIST_AGC_BIN_NUM        16384
+#define HIST_AGC_TRANSFER_SIZE  65536
+#define HIST_AGC_TRANSFER_MAX   (255 << 8)
+
+//automatic gain control of raw y14 frames(or y16 temp frames) for display. the histogram is kept over a subsampled
+//grid of the frame and updated incrementally, only the grid pixels whose bin changed since the last frame move a count.
+//the transfer curve built from it is smoothed over the frames, so the picture doesn't pump with every hot object
+//passing through. the curve maps every raw value to 0~255 and is used for 8 bit images or fed to a palette engine
+typedef struct HistAgc_s HistAgc_t;
+
+typedef enum {
+    HIST_AGC_PLATEAU = 0,   //plateau histogram equalization
+    HIST_AGC_LINEAR,        //linear stretch between the low and high discard percentiles
+}HistAgcMode_e;
+
+typedef struct {
+    HistAgcMode_e mode;
+    int input_bits;         //14 for y14 frames, 16 for y16 temp frames
+    int sample_step;        //every sample_step-th pixel of every sample_step-th row goes into the histogram
+    float low_discard;      //share of the samples mapped to 0, and to 255
+    float high_discard;
+    float plateau;          //plateau mode: count limit of a bin, times the mean count of the occupied bins
+    float smoothing;        //weight of the latest frame in the curve, 1 follows every frame without smoothing
+}HistAgcParam_t;
+
+void hist_agc_default_param(HistAgcParam_t* param);
+
+HistAgc_t* hist_agc_create(const HistAgcParam_t* param, int width, int height);
+
+void hist_agc_destroy(HistAgc_t* agc);
+
+//take a frame into the histogram and update the transfer curve
+int hist_agc_update(HistAgc_t* agc, const uint16_t* frame);
+
+//the transfer curve, position 0~255 of every raw value in 1/256 steps(0~HIST_AGC_TRANSFER_MAX).
+//it can be passed to palette_engine_set_transfer as is
+const uint16_t* hist_agc_transfer(HistAgc_t* agc);
+
+//8 bit image of pixel_num pixels through the transfer curve
+int hist_agc_to_y8(HistAgc_t* agc, const uint16_t* frame, int pixel_num, uint8_t* y8_data);
+
+#endif
@@ -57,6 +57,49 @@ void display_one_frame(uint8_t* frame, uint16_t width, uint16_t height, const ch
     cvWaitKey(5);
 }
 
+//y16 temp frames are 1/64 kelvin
+static uint16_t celsius_to_y16(float celsius)
+{
+    double y16 = (celsius + 273.15) * 64;
+    if (y16 <= 0)
+    {
+        return 0;
+    }
+    if (y16 >= 65535)
+    {
+        return 65535;
+    }
+    return (uint16_t)(y16 + 0.5);
+}
+
+static PaletteEngine_t* opencv_display_palette_create(const camera_config* camera)
+{
+    PaletteEngine_t* palette_engine = palette_engine_create(camera->temp_palette.c_str());
+    if (palette_engine == NULL)
+    {
+        return NULL;
+    }
+    if (camera->temp_palette_low < camera->temp_palette_high)
+    {
+        palette_engine_set_range(palette_engine, celsius_to_y16(camera->temp_palette_low), celsius_to_y16(camera->temp_palette_high));
+    }
+    return palette_engine;
+}
+
+//temp view gain control of camera::temp_agc, NULL if it's off
+static HistAgc_t* opencv_display_agc_create(const camera_config* camera, int width, int height)
+{
+    if (camera->temp_agc == "off")
+    {
+        return NULL;
+    }
+    HistAgcParam_t param;
+    hist_agc_default_param(&param);
+    param.mode = (camera->temp_agc == "linear") ? HIST_AGC_LINEAR : HIST_AGC_PLATEAU;
+    param.input_bits = 16;
+    return hist_agc_create(&param, width, height);
+}
+
 void* opencv_display_function(void* threadarg)
 {
     if (threadarg == NULL)
@@ -65,66 +108,85 @@ void* opencv_display_function(void* threadarg)
         return NULL;
     }
 
-    StreamFrameInfo_t* stream_frame_info = (StreamFrameInfo_t*)threadarg;
-
-    uint8_t* rgb_image_frame = NULL;
-    rgb_image_frame = (uint8_t*)malloc(stream_frame_info->width * stream_frame_info->height * 3);
-    if (rgb_image_frame == NULL)
+    //private copy of the layout, bound to each frame read from the ring
+    StreamFrameInfo_t frame_view = *(StreamFrameInfo_t*)threadarg;
+    StreamFrameInfo_t* stream_frame_info = &frame_view;
+    FrameRing_t* frame_ring = stream_frame_info->frame_ring;
+    FrameSlot_t slot;
+    int consumer_id = frame_ring_add_consumer(frame_ring);
+    if (consumer_id < 0)
     {
-        printf("there is no more space!\n");
         return NULL;
     }
+
+    //the frames are converted straight to opencv's BGR, one buffer serves the image and the temp view.
+    //the conversions are split into row bands on the pipeline's workers
+    RowBandPool_t* row_band_pool = stream_frame_info->pipeline->row_band_pool;
     uint8_t* bgr_image_frame = NULL;
     bgr_image_frame = (uint8_t*)malloc(stream_frame_info->width * stream_frame_info->height * 3);
     if (bgr_image_frame == NULL)
     {
         printf("there is no more space!\n");
-        free(rgb_image_frame);
-        rgb_image_frame = NULL;
+        frame_ring_remove_consumer(frame_ring, consumer_id);
         return NULL;
     }
 
-    while (isRUNNING)
+    //the temp view is rendered through the palette table of camera::temp_palette over its temperature range,
+    //or over the transfer curve of the gain control
+    PaletteEngine_t* palette_engine = NULL;
+    HistAgc_t* agc = NULL;
+    if ((stream_frame_info->frame_output_format == YUYV_AND_TEMP) || (stream_frame_info->frame_output_format == NV12_AND_TEMP))
     {
-#if defined(_WIN32)
-        WaitForSingleObject(image_sem, INFINITE);
-#elif defined (linux)||(unix)
-        sem_wait(&image_sem);
-#endif
+        const camera_config* camera = &stream_frame_info->product_config.camera;
+        palette_engine = opencv_display_palette_create(camera);
+        agc = opencv_display_agc_create(camera, stream_frame_info->width, stream_frame_info->height);
+        if (palette_engine == NULL || (agc == NULL && camera->temp_agc != "off"))
+        {
+            hist_agc_destroy(agc);
+            palette_engine_destroy(palette_engine);
+            free(bgr_image_frame);
+            frame_ring_remove_consumer(frame_ring, consumer_id);
+            return NULL;
+        }
+    }
+
+    while (stream_frame_info->pipeline->is_running)
+    {
+        if (frame_ring_read(frame_ring, consumer_id, &slot) != 0)
+        {
+            break;
+        }
+        bind_stream_frame_info(stream_frame_info, slot.raw_buffer, slot.raw_temp_buffer);
         if ((stream_frame_info->frame_output_format == YUYV_IMAGE) || (stream_frame_info->frame_output_format == YUYV_AND_TEMP)
             || (stream_frame_info->frame_output_format == UYVY_IMAGE))
         {
-            yuv422_to_rgb(stream_frame_info->image_info.data, (stream_frame_info->width*stream_frame_info->height), rgb_image_frame);
-            rgb_to_bgr(rgb_image_frame, (stream_frame_info->width * stream_frame_info->height), bgr_image_frame);
+            row_band_yuv422_to_bgr(row_band_pool, stream_frame_info->image_info.data, stream_frame_info->width, stream_frame_info->height, bgr_image_frame);
         }
         if ((stream_frame_info->frame_output_format == NV12_IMAGE) || (stream_frame_info->frame_output_format == NV12_AND_TEMP))
         {
-            nv12_to_rgb(stream_frame_info->image_info.data, stream_frame_info->width, stream_frame_info->height, rgb_image_frame);
-            rgb_to_bgr(rgb_image_frame, (stream_frame_info->width * stream_frame_info->height), bgr_image_frame);
+            row_band_nv12_to_bgr(row_band_pool, stream_frame_info->image_info.data, stream_frame_info->width, stream_frame_info->height, bgr_image_frame);
         }
         display_one_frame(bgr_image_frame, stream_frame_info->width, stream_frame_info->height, "image");
 
 
         if ((stream_frame_info->frame_output_format == YUYV_AND_TEMP) || (stream_frame_info->frame_output_format == NV12_AND_TEMP))
         {
-            y16_to_rgb((uint16_t*)(stream_frame_info->temp_info.data), stream_frame_info->width, stream_frame_info->height, rgb_image_frame);
-            rgb_to_bgr(rgb_image_frame, (stream_frame_info->width * stream_frame_info->height), bgr_image_frame);
+            if (agc != NULL)
+            {
+                hist_agc_update(agc, (uint16_t*)(stream_frame_info->temp_info.data));
+                palette_engine_set_transfer(palette_engine, hist_agc_transfer(agc));
+            }
+            row_band_palette_to_bgr(row_band_pool, palette_engine, (uint16_t*)(stream_frame_info->temp_info.data), stream_frame_info->width, \
+                stream_frame_info->height, bgr_image_frame);
             display_one_frame(bgr_image_frame, stream_frame_info->width, stream_frame_info->height, "temp");
         }
-
-#if defined(_WIN32)
-        ReleaseSemaphore(image_done_sem, 1, NULL);
-#elif defined (linux)||(unix)
-        sem_post(&image_done_sem);
-#endif
-    }
-
-    if (rgb_image_frame != NULL)
-    {
-        free(rgb_image_frame);
-        rgb_image_frame = NULL;
+        frame_ring_release(&slot);
     }
+    printf("display skipped %llu frames\n", (unsigned long long)frame_ring_dropped(frame_ring, consumer_id));
+    frame_ring_remove_consumer(frame_ring, consumer_id);
 
+    hist_agc_destroy(agc);
+    palette_engine_destroy(palette_engine);
     if (bgr_image_frame != NULL)
     {
         free(bgr_image_frame);
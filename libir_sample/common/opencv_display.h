@@ -7,7 +7,11 @@
 #include <opencv2/highgui.hpp>
 #include <opencv2/highgui/highgui_c.h>
 #include "data.h"
+#include "pipeline.h"
+#include "frame_ring.h"
 #include "libirparse.h"
+#include "row_band_kernels.h"
+#include "hist_agc.h"
 
 
 #if defined(linux) || defined(unix)
@@ -0,0 +1,326 @@
+#include "palette.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+using std::vector;
+
+typedef struct {
+    char name[PALETTE_NAME_LEN];
+    PaletteColor_t colors[PALETTE_COLOR_NUM];
+}Palette_t;
+
+struct PaletteEngine_s {
+    Palette_t palette;
+    uint16_t low;
+    uint16_t high;
+    bool use_transfer;
+    uint16_t transfer[PALETTE_LUT_SIZE];    //position in 1/256 colours
+    bool dirty;
+    uint32_t bgr_lut[PALETTE_LUT_SIZE];    //B | G << 8 | R << 16
+    uint32_t yuv_lut[PALETTE_LUT_SIZE];    //Y | U << 8 | V << 16
+};
+
+//colour stops of the built-in palettes, at 0~255 of the range
+typedef struct {
+    uint8_t position;
+    PaletteColor_t color;
+}PaletteStop_t;
+
+static const PaletteStop_t white_hot_stops[] = { { 0, { 0, 0, 0 } }, { 255, { 255, 255, 255 } } };
+static const PaletteStop_t black_hot_stops[] = { { 0, { 255, 255, 255 } }, { 255, { 0, 0, 0 } } };
+static const PaletteStop_t iron_stops[] = { { 0, { 0, 0, 0 } }, { 32, { 32, 0, 140 } }, { 80, { 140, 0, 160 } }, \
+    { 128, { 220, 60, 30 } }, { 176, { 250, 140, 0 } }, { 224, { 255, 220, 40 } }, { 255, { 255, 255, 255 } } };
+static const PaletteStop_t rainbow_stops[] = { { 0, { 0, 0, 255 } }, { 64, { 0, 255, 255 } }, { 128, { 0, 255, 0 } }, \
+    { 192, { 255, 255, 0 } }, { 255, { 255, 0, 0 } } };
+static const PaletteStop_t hot_stops[] = { { 0, { 0, 0, 0 } }, { 96, { 255, 0, 0 } }, { 192, { 255, 255, 0 } }, \
+    { 255, { 255, 255, 255 } } };
+
+static uint8_t palette_lerp(uint8_t from, uint8_t to, double fraction)
+{
+    return (uint8_t)(from + (to - from) * fraction + 0.5);
+}
+
+static void palette_from_stops(Palette_t* palette, const char* name, const PaletteStop_t* stops, int stop_num)
+{
+    memset(palette, 0, sizeof(Palette_t));
+    strncpy(palette->name, name, PALETTE_NAME_LEN - 1);
+    for (int i = 0; i + 1 < stop_num; i++)
+    {
+        for (int position = stops[i].position; position <= stops[i + 1].position; position++)
+        {
+            double fraction = (double)(position - stops[i].position) / (stops[i + 1].position - stops[i].position);
+            palette->colors[position].r = palette_lerp(stops[i].color.r, stops[i + 1].color.r, fraction);
+            palette->colors[position].g = palette_lerp(stops[i].color.g, stops[i + 1].color.g, fraction);
+            palette->colors[position].b = palette_lerp(stops[i].color.b, stops[i + 1].color.b, fraction);
+        }
+    }
+}
+
+static vector<Palette_t> palette_builtins(void)
+{
+    vector<Palette_t> palettes(5);
+    palette_from_stops(&palettes[0], "white_hot", white_hot_stops, sizeof(white_hot_stops) / sizeof(PaletteStop_t));
+    palette_from_stops(&palettes[1], "black_hot", black_hot_stops, sizeof(black_hot_stops) / sizeof(PaletteStop_t));
+    palette_from_stops(&palettes[2], "iron", iron_stops, sizeof(iron_stops) / sizeof(PaletteStop_t));
+    palette_from_stops(&palettes[3], "rainbow", rainbow_stops, sizeof(rainbow_stops) / sizeof(PaletteStop_t));
+    palette_from_stops(&palettes[4], "hot", hot_stops, sizeof(hot_stops) / sizeof(PaletteStop_t));
+    return palettes;
+}
+
+static vector<Palette_t> palettes = palette_builtins();
+
+static const Palette_t* palette_find(const char* name)
+{
+    for (size_t i = 0; i < palettes.size(); i++)
+    {
+        if (strncmp(palettes[i].name, name, PALETTE_NAME_LEN - 1) == 0)
+        {
+            return &palettes[i];
+        }
+    }
+    return NULL;
+}
+
+int palette_register(const char* name, const PaletteColor_t* colors, int color_num)
+{
+    if (name == NULL || name[0] == '\0' || colors == NULL || color_num < 2 || color_num > PALETTE_COLOR_NUM)
+    {
+        printf("palette_register: invalid param\n");
+        return -1;
+    }
+
+    //spread the colours evenly over the 256 of the table
+    vector<PaletteStop_t> stops(color_num);
+    for (int i = 0; i < color_num; i++)
+    {
+        stops[i].position = (uint8_t)(i * (PALETTE_COLOR_NUM - 1) / (color_num - 1));
+        stops[i].color = colors[i];
+    }
+    Palette_t palette;
+    palette_from_stops(&palette, name, &stops[0], color_num);
+
+    Palette_t* registered = (Palette_t*)palette_find(name);
+    if (registered != NULL)
+    {
+        *registered = palette;
+    }
+    else
+    {
+        palettes.push_back(palette);
+    }
+    return 0;
+}
+
+int palette_num(void)
+{
+    return (int)palettes.size();
+}
+
+const char* palette_name(int index)
+{
+    if (index < 0 || index >= (int)palettes.size())
+    {
+        return NULL;
+    }
+    return palettes[index].name;
+}
+
+PaletteEngine_t* palette_engine_create(const char* name)
+{
+    PaletteEngine_t* engine = new PaletteEngine_t;
+    memset(&engine->palette, 0, sizeof(Palette_t));
+    engine->low = 0;
+    engine->high = PALETTE_LUT_SIZE - 1;
+    engine->use_transfer = false;
+    engine->dirty = true;
+    if (palette_engine_set_palette(engine, name) != 0)
+    {
+        delete engine;
+        return NULL;
+    }
+    return engine;
+}
+
+void palette_engine_destroy(PaletteEngine_t* engine)
+{
+    delete engine;
+}
+
+int palette_engine_set_palette(PaletteEngine_t* engine, const char* name)
+{
+    if (engine == NULL || name == NULL)
+    {
+        printf("palette_engine_set_palette: invalid param\n");
+        return -1;
+    }
+
+    const Palette_t* palette = palette_find(name);
+    if (palette == NULL)
+    {
+        printf("palette %s isn't registered\n", name);
+        return -1;
+    }
+    if (strcmp(engine->palette.name, palette->name) != 0 || memcmp(engine->palette.colors, palette->colors, sizeof(palette->colors)) != 0)
+    {
+        engine->palette = *palette;
+        engine->dirty = true;
+    }
+    return 0;
+}
+
+int palette_engine_set_range(PaletteEngine_t* engine, uint16_t low, uint16_t high)
+{
+    if (engine == NULL || low >= high)
+    {
+        printf("palette_engine_set_range: invalid param\n");
+        return -1;
+    }
+
+    if (low != engine->low || high != engine->high)
+    {
+        engine->low = low;
+        engine->high = high;
+        engine->dirty = true;
+    }
+    return 0;
+}
+
+int palette_engine_set_transfer(PaletteEngine_t* engine, const uint16_t* transfer)
+{
+    if (engine == NULL)
+    {
+        printf("palette_engine_set_transfer: invalid param\n");
+        return -1;
+    }
+
+    if (transfer == NULL)
+    {
+        engine->dirty = engine->dirty || engine->use_transfer;
+        engine->use_transfer = false;
+        return 0;
+    }
+    if (!engine->use_transfer || memcmp(engine->transfer, transfer, sizeof(engine->transfer)) != 0)
+    {
+        memcpy(engine->transfer, transfer, sizeof(engine->transfer));
+        engine->use_transfer = true;
+        engine->dirty = true;
+    }
+    return 0;
+}
+
+static uint8_t palette_clamp(double value)
+{
+    if (value <= 0)
+    {
+        return 0;
+    }
+    if (value >= 255)
+    {
+        return 255;
+    }
+    return (uint8_t)(value + 0.5);
+}
+
+int palette_engine_update(PaletteEngine_t* engine)
+{
+    if (engine == NULL)
+    {
+        printf("palette_engine_update: invalid param\n");
+        return -1;
+    }
+    if (!engine->dirty)
+    {
+        return 0;
+    }
+
+    const PaletteColor_t* colors = engine->palette.colors;
+    double scale = (double)(PALETTE_COLOR_NUM - 1) / (engine->high - engine->low);
+    for (int value = 0; value < PALETTE_LUT_SIZE; value++)
+    {
+        double position;
+        if (engine->use_transfer)
+        {
+            position = engine->transfer[value] / 256.0;
+        }
+        else if (value <= engine->low)
+        {
+            position = 0;
+        }
+        else if (value >= engine->high)
+        {
+            position = PALETTE_COLOR_NUM - 1;
+        }
+        else
+        {
+            position = (value - engine->low) * scale;
+        }
+
+        PaletteColor_t color;
+        int index = (int)position;
+        if (index >= PALETTE_COLOR_NUM - 1)
+        {
+            color = colors[PALETTE_COLOR_NUM - 1];
+        }
+        else
+        {
+            double fraction = position - index;
+            color.r = palette_lerp(colors[index].r, colors[index + 1].r, fraction);
+            color.g = palette_lerp(colors[index].g, colors[index + 1].g, fraction);
+            color.b = palette_lerp(colors[index].b, colors[index + 1].b, fraction);
+        }
+        engine->bgr_lut[value] = color.b | (color.g << 8) | (color.r << 16);
+
+        //the inverse of the yuv -> rgb formula of color_convert
+        double y = 0.299 * color.r + 0.587 * color.g + 0.114 * color.b;
+        uint8_t u = palette_clamp((color.b - y) / 2.032 + 128);
+        uint8_t v = palette_clamp((color.r - y) / 1.14 + 128);
+        engine->yuv_lut[value] = palette_clamp(y) | (u << 8) | (v << 16);
+    }
+    engine->dirty = false;
+    return 0;
+}
+
+int palette_render_bgr(PaletteEngine_t* engine, const uint16_t* y16_data, int pixel_num, uint8_t* bgr_data)
+{
+    if (engine == NULL || y16_data == NULL || bgr_data == NULL || pixel_num <= 0)
+    {
+        printf("palette_render_bgr: invalid param\n");
+        return -1;
+    }
+
+    palette_engine_update(engine);
+    const uint32_t* lut = engine->bgr_lut;
+    for (int i = 0; i < pixel_num; i++)
+    {
+        uint32_t color = lut[y16_data[i]];
+        bgr_data[0] = (uint8_t)color;
+        bgr_data[1] = (uint8_t)(color >> 8);
+        bgr_data[2] = (uint8_t)(color >> 16);
+        bgr_data += 3;
+    }
+    return 0;
+}
+
+int palette_render_yuyv(PaletteEngine_t* engine, const uint16_t* y16_data, int pixel_num, uint8_t* yuyv_data)
+{
+    if (engine == NULL || y16_data == NULL || yuyv_data == NULL || pixel_num <= 0 || (pixel_num % 2) != 0)
+    {
+        printf("palette_render_yuyv: invalid param\n");
+        return -1;
+    }
+
+    palette_engine_update(engine);
+    const uint32_t* lut = engine->yuv_lut;
+    for (int i = 0; i < pixel_num; i += 2)
+    {
+        uint32_t first = lut[y16_data[i]];
+        uint32_t second = lut[y16_data[i + 1]];
+        yuyv_data[0] = (uint8_t)first;
+        yuyv_data[1] = (uint8_t)((((first >> 8) & 0xff) + ((second >> 8) & 0xff) + 1) >> 1);
+        yuyv_data[2] = (uint8_t)second;
+        yuyv_data[3] = (uint8_t)((((first >> 16) & 0xff) + ((second >> 16) & 0xff) + 1) >> 1);
+        yuyv_data += 4;
+    }
+    return 0;
+}
@@ -0,0 +1,57 @@
+#ifndef _PALETTE_H_
+#define _PALETTE_H_
+
+#include <stdint.h>
+
+#define PALETTE_NAME_LEN    16
+#define PALETTE_COLOR_NUM   256
+#define PALETTE_LUT_SIZE    65536
+
+//pseudo colour rendering of 16 bit frames(y16 temp frames, or y14 with a 0~16383 range) through a lookup table of
+//every raw value. the table is built once per palette and range and rebuilt only when one of them changes,
+//values between two palette colours are interpolated so the rendering keeps the radiometric resolution of the frame
+typedef struct PaletteEngine_s PaletteEngine_t;
+
+typedef struct {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+}PaletteColor_t;
+
+//add a palette of color_num(2~256) colours from the low to the high end of the range, or replace the one of that name.
+//the built-in palettes are white_hot, black_hot, iron, rainbow and hot. a table of the camera's own palette can be
+//registered under the name basic_palette_name_get reports for it. register before the engines using it are created
+int palette_register(const char* name, const PaletteColor_t* colors, int color_num);
+
+//the registered palettes, index 0~palette_num()-1
+int palette_num(void);
+const char* palette_name(int index);
+
+//engine of the named palette and the full 0~65535 range, NULL if the palette isn't registered
+PaletteEngine_t* palette_engine_create(const char* name);
+
+void palette_engine_destroy(PaletteEngine_t* engine);
+
+int palette_engine_set_palette(PaletteEngine_t* engine, const char* name);
+
+//raw values <= low get the first colour, >= high the last one
+int palette_engine_set_range(PaletteEngine_t* engine, uint16_t low, uint16_t high);
+
+//nonlinear mapping instead of the range(the curve of hist_agc): position 0~255 in the palette of every raw value, in
+//1/256 steps, PALETTE_LUT_SIZE entries. the curve is copied, the tables are rebuilt only if it changed. NULL goes back
+//to the range
+int palette_engine_set_transfer(PaletteEngine_t* engine, const uint16_t* transfer);
+
+//rebuild the tables if the palette or range changed, the render functions call it. renderers sharing an engine from
+//several threads(row bands) call it once first, then the render calls only read the tables
+int palette_engine_update(PaletteEngine_t* engine);
+
+//one table lookup per pixel to BGR888
+int palette_render_bgr(PaletteEngine_t* engine, const uint16_t* y16_data, int pixel_num, uint8_t* bgr_data);
+
+//one table lookup per pixel to YUYV, the two pixels of a pair share the average of their U and V.
+//Y U V are those color_convert_yuv422_to_bgr turns back into the palette colour, as far as the 0~255 range of U and V
+//reaches(strongly saturated reds, greens and blues are clipped)
+int palette_render_yuyv(PaletteEngine_t* engine, const uint16_t* y16_data, int pixel_num, uint8_t* yuyv_data);
+
+#endif
@@ -0,0 +1,64 @@
+#include "pipeline.h"
+
+Pipeline_t* pipeline_create(const single_config& product_config)
+{
+    Pipeline_t* pipeline = new Pipeline_t;
+    //value-initialised, the plain fields are zeroed and product_config is constructed
+    pipeline->stream_frame_info = StreamFrameInfo_t();
+    pipeline->stream_frame_info.product_config = product_config;
+    pipeline->stream_frame_info.pipeline = pipeline;
+    pipeline->ir_image_video_handle = NULL;
+    pipeline->ir_temp_video_handle = NULL;
+    pipeline->is_running = true;
+    pipeline->row_band_pool = NULL;
+    if (product_config.camera.row_band_threads != 1)
+    {
+        const vector<int>& cpus = product_config.camera.row_band_cpus;
+        pipeline->row_band_pool = row_band_pool_create(product_config.camera.row_band_threads, \
+            cpus.empty() ? NULL : &cpus[0], (int)cpus.size());
+    }
+
+#if defined(_WIN32)
+    pipeline->temp_sem = CreateSemaphore(NULL, 0, 1, NULL);
+    pipeline->cmd_sem = CreateSemaphore(NULL, 0, 1, NULL);
+#elif defined(linux) || defined(unix)
+    sem_init(&pipeline->temp_sem, 0, 0);
+    sem_init(&pipeline->cmd_sem, 0, 0);
+#endif
+    return pipeline;
+}
+
+void pipeline_stop(Pipeline_t* pipeline)
+{
+    if (pipeline != NULL)
+    {
+        pipeline->is_running = false;
+    }
+}
+
+int pipeline_destroy(Pipeline_t* pipeline)
+{
+    if (pipeline == NULL)
+    {
+        return -1;
+    }
+
+#if defined(_WIN32)
+    CloseHandle(pipeline->temp_sem);
+    CloseHandle(pipeline->cmd_sem);
+#elif defined(linux) || defined(unix)
+    sem_destroy(&pipeline->temp_sem);
+    sem_destroy(&pipeline->cmd_sem);
+#endif
+    row_band_pool_destroy(pipeline->row_band_pool);
+    if (pipeline->ir_image_video_handle != NULL)
+    {
+        ir_video_handle_delete(&pipeline->ir_image_video_handle);
+    }
+    if (pipeline->ir_temp_video_handle != NULL)
+    {
+        ir_video_handle_delete(&pipeline->ir_temp_video_handle);
+    }
+    delete pipeline;
+    return 0;
+}
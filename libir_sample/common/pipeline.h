@@ -0,0 +1,35 @@
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include "data.h"
+#include "row_band.h"
+
+//everything the threads of one camera share. The thread functions take &pipeline->stream_frame_info and reach
+//the rest by stream_frame_info->pipeline, so one process can drive a pipeline per camera
+struct Pipeline_s {
+    StreamFrameInfo_t stream_frame_info;
+    IrVideoHandle_t* ir_image_video_handle;
+    IrVideoHandle_t* ir_temp_video_handle;
+    std::atomic_bool is_running;    //the thread loops of this camera run until it is cleared
+    RowBandPool_t* row_band_pool;   //workers of the full frame kernels, NULL when camera::row_band_threads is 1
+
+    //cmd thread <-> temp measure thread handshakes
+#if defined(_WIN32)
+    HANDLE temp_sem;
+    HANDLE cmd_sem;
+#elif defined(linux) || defined(unix)
+    sem_t temp_sem;
+    sem_t cmd_sem;
+#endif
+};
+
+//create the pipeline of one product and its semaphores, the sample creates the video handles for the driver it uses
+Pipeline_t* pipeline_create(const single_config& product_config);
+
+//let every thread of the pipeline leave its loop
+void pipeline_stop(Pipeline_t* pipeline);
+
+//release the semaphores and the video handles left, after all threads of the pipeline are joined
+int pipeline_destroy(Pipeline_t* pipeline);
+
+#endif
@@ -0,0 +1,312 @@
+#include "pixel_convert.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(PIXEL_CONVERT_SSE2)
+#include <emmintrin.h>
+#elif defined(PIXEL_CONVERT_NEON)
+#include <arm_neon.h>
+#endif
+
+//interleave the first and second plane byte by byte, 16 pixels per vector step
+static void interleave_planes(const uint8_t* first, const uint8_t* second, int pixel_num, uint8_t* dst)
+{
+    int i = 0;
+#if defined(PIXEL_CONVERT_SSE2)
+    for (; i + 16 <= pixel_num; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(first + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(second + i));
+        _mm_storeu_si128((__m128i*)(dst + 2 * i), _mm_unpacklo_epi8(a, b));
+        _mm_storeu_si128((__m128i*)(dst + 2 * i + 16), _mm_unpackhi_epi8(a, b));
+    }
+#elif defined(PIXEL_CONVERT_NEON)
+    for (; i + 16 <= pixel_num; i += 16)
+    {
+        uint8x16x2_t pair;
+        pair.val[0] = vld1q_u8(first + i);
+        pair.val[1] = vld1q_u8(second + i);
+        vst2q_u8(dst + 2 * i, pair);
+    }
+#endif
+    for (; i < pixel_num; i++)
+    {
+        dst[2 * i] = first[i];
+        dst[2 * i + 1] = second[i];
+    }
+}
+
+int nv16_to_yuyv_fused(uint8_t* nv16_data, int width, int height, uint8_t* yuyv_data)
+{
+    if (nv16_data == NULL || yuyv_data == NULL || width <= 0 || height <= 0)
+    {
+        printf("nv16_to_yuyv_fused: invalid param\n");
+        return -1;
+    }
+
+    int pixel_num = width * height;
+    interleave_planes(nv16_data, nv16_data + pixel_num, pixel_num, yuyv_data);
+    return 0;
+}
+
+int nv16_to_uyvy_fused(uint8_t* nv16_data, int width, int height, uint8_t* uyvy_data)
+{
+    if (nv16_data == NULL || uyvy_data == NULL || width <= 0 || height <= 0)
+    {
+        printf("nv16_to_uyvy_fused: invalid param\n");
+        return -1;
+    }
+
+    int pixel_num = width * height;
+    interleave_planes(nv16_data + pixel_num, nv16_data, pixel_num, uyvy_data);
+    return 0;
+}
+
+//U Y0 V Y1 -> Y0 U Y1 V, swap the bytes of every 16 bit word
+int uyvy_to_yuyv_inplace(uint8_t* data, int width, int height)
+{
+    if (data == NULL || width <= 0 || height <= 0)
+    {
+        printf("uyvy_to_yuyv_inplace: invalid param\n");
+        return -1;
+    }
+
+    int byte_size = width * height * 2;
+    int i = 0;
+#if defined(PIXEL_CONVERT_SSE2)
+    for (; i + 16 <= byte_size; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(data + i));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8)));
+    }
+#elif defined(PIXEL_CONVERT_NEON)
+    for (; i + 16 <= byte_size; i += 16)
+    {
+        vst1q_u8(data + i, vrev16q_u8(vld1q_u8(data + i)));
+    }
+#endif
+    for (; i + 2 <= byte_size; i += 2)
+    {
+        uint8_t first = data[i];
+        data[i] = data[i + 1];
+        data[i + 1] = first;
+    }
+    return 0;
+}
+
+//V Y0 U Y1 -> Y0 U Y1 V, rotate every 4 bytes by one
+int vyuy_to_yuyv_inplace(uint8_t* data, int width, int height)
+{
+    if (data == NULL || width <= 0 || height <= 0)
+    {
+        printf("vyuy_to_yuyv_inplace: invalid param\n");
+        return -1;
+    }
+
+    int byte_size = width * height * 2;
+    int i = 0;
+#if defined(PIXEL_CONVERT_SSE2)
+    for (; i + 16 <= byte_size; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(data + i));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(_mm_srli_epi32(x, 8), _mm_slli_epi32(x, 24)));
+    }
+#elif defined(PIXEL_CONVERT_NEON)
+    for (; i + 16 <= byte_size; i += 16)
+    {
+        uint32x4_t x = vreinterpretq_u32_u8(vld1q_u8(data + i));
+        vst1q_u8(data + i, vreinterpretq_u8_u32(vorrq_u32(vshrq_n_u32(x, 8), vshlq_n_u32(x, 24))));
+    }
+#endif
+    for (; i + 4 <= byte_size; i += 4)
+    {
+        uint8_t v = data[i];
+        data[i] = data[i + 1];
+        data[i + 1] = data[i + 2];
+        data[i + 2] = data[i + 3];
+        data[i + 3] = v;
+    }
+    return 0;
+}
+
+//Y0 V Y1 U -> Y0 U Y1 V, swap the chroma bytes of every 4 bytes
+int yvyu_to_yuyv_inplace(uint8_t* data, int width, int height)
+{
+    if (data == NULL || width <= 0 || height <= 0)
+    {
+        printf("yvyu_to_yuyv_inplace: invalid param\n");
+        return -1;
+    }
+
+    int byte_size = width * height * 2;
+    int i = 0;
+#if defined(PIXEL_CONVERT_SSE2)
+    const __m128i luma_mask = _mm_set1_epi32(0x00ff00ff);
+    for (; i + 16 <= byte_size; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i swapped = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(_mm_and_si128(luma_mask, x), _mm_andnot_si128(luma_mask, swapped)));
+    }
+#elif defined(PIXEL_CONVERT_NEON)
+    const uint8x16_t chroma_mask = vreinterpretq_u8_u32(vdupq_n_u32(0xff00ff00));
+    for (; i + 16 <= byte_size; i += 16)
+    {
+        uint8x16_t x = vld1q_u8(data + i);
+        uint8x16_t swapped = vreinterpretq_u8_u16(vrev32q_u16(vreinterpretq_u16_u8(x)));
+        vst1q_u8(data + i, vbslq_u8(chroma_mask, swapped, x));
+    }
+#endif
+    for (; i + 4 <= byte_size; i += 4)
+    {
+        uint8_t v = data[i + 1];
+        data[i + 1] = data[i + 3];
+        data[i + 3] = v;
+    }
+    return 0;
+}
+
+//split packed 4:2:2 into its luma bytes and its chroma bytes(U V U V ...), 16 pixels per vector step.
+//luma_offset is 0 if the luma byte comes first in a pixel(YUYV), 1 if it comes second(UYVY)
+static void deinterleave_luma_chroma(const uint8_t* src, int pixel_num, int luma_offset, uint8_t* luma, uint8_t* chroma)
+{
+    int i = 0;
+#if defined(PIXEL_CONVERT_SSE2)
+    const __m128i low_mask = _mm_set1_epi16(0x00ff);
+    for (; i + 16 <= pixel_num; i += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + 2 * i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + 2 * i + 16));
+        __m128i even = _mm_packus_epi16(_mm_and_si128(a, low_mask), _mm_and_si128(b, low_mask));
+        __m128i odd = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128((__m128i*)(luma + i), luma_offset ? odd : even);
+        _mm_storeu_si128((__m128i*)(chroma + i), luma_offset ? even : odd);
+    }
+#elif defined(PIXEL_CONVERT_NEON)
+    for (; i + 16 <= pixel_num; i += 16)
+    {
+        uint8x16x2_t pair = vld2q_u8(src + 2 * i);
+        vst1q_u8(luma + i, pair.val[luma_offset]);
+        vst1q_u8(chroma + i, pair.val[1 - luma_offset]);
+    }
+#endif
+    for (; i < pixel_num; i++)
+    {
+        luma[i] = src[2 * i + luma_offset];
+        chroma[i] = src[2 * i + 1 - luma_offset];
+    }
+}
+
+//split packed 4:2:2 into the Y, U and V planes, 32 pixels per vector step
+static void deinterleave_planar(const uint8_t* src, int pixel_num, int luma_offset, uint8_t* y_plane, uint8_t* u_plane, uint8_t* v_plane)
+{
+    int i = 0;
+#if defined(PIXEL_CONVERT_SSE2)
+    const __m128i low_mask = _mm_set1_epi16(0x00ff);
+    for (; i + 32 <= pixel_num; i += 32)
+    {
+        __m128i chroma[2];
+        for (int half = 0; half < 2; half++)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(src + 2 * i + 32 * half));
+            __m128i b = _mm_loadu_si128((const __m128i*)(src + 2 * i + 32 * half + 16));
+            __m128i even = _mm_packus_epi16(_mm_and_si128(a, low_mask), _mm_and_si128(b, low_mask));
+            __m128i odd = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+            _mm_storeu_si128((__m128i*)(y_plane + i + 16 * half), luma_offset ? odd : even);
+            chroma[half] = luma_offset ? even : odd;
+        }
+        //U V U V ... -> U U ..., V V ...
+        _mm_storeu_si128((__m128i*)(u_plane + i / 2), \
+            _mm_packus_epi16(_mm_and_si128(chroma[0], low_mask), _mm_and_si128(chroma[1], low_mask)));
+        _mm_storeu_si128((__m128i*)(v_plane + i / 2), \
+            _mm_packus_epi16(_mm_srli_epi16(chroma[0], 8), _mm_srli_epi16(chroma[1], 8)));
+    }
+#elif defined(PIXEL_CONVERT_NEON)
+    //Y0 U Y1 V(or U Y0 V Y1) of 16 pixel pairs in the four lanes
+    for (; i + 32 <= pixel_num; i += 32)
+    {
+        uint8x16x4_t pixels = vld4q_u8(src + 2 * i);
+        uint8x16x2_t luma;
+        luma.val[0] = pixels.val[luma_offset];
+        luma.val[1] = pixels.val[luma_offset + 2];
+        vst2q_u8(y_plane + i, luma);
+        vst1q_u8(u_plane + i / 2, pixels.val[1 - luma_offset]);
+        vst1q_u8(v_plane + i / 2, pixels.val[3 - luma_offset]);
+    }
+#endif
+    for (; i + 2 <= pixel_num; i += 2)
+    {
+        y_plane[i] = src[2 * i + luma_offset];
+        y_plane[i + 1] = src[2 * i + 2 + luma_offset];
+        u_plane[i / 2] = src[2 * i + 1 - luma_offset];
+        v_plane[i / 2] = src[2 * i + 3 - luma_offset];
+    }
+}
+
+int yuyv_to_yuv422p(uint8_t* yuyv_data, int width, int height, uint8_t* y_plane, uint8_t* u_plane, uint8_t* v_plane)
+{
+    if (yuyv_data == NULL || y_plane == NULL || u_plane == NULL || v_plane == NULL || width <= 0 || height <= 0 \
+        || (width % 2) != 0)
+    {
+        printf("yuyv_to_yuv422p: invalid param\n");
+        return -1;
+    }
+
+    deinterleave_planar(yuyv_data, width * height, 0, y_plane, u_plane, v_plane);
+    return 0;
+}
+
+int uyvy_to_yuv422p(uint8_t* uyvy_data, int width, int height, uint8_t* y_plane, uint8_t* u_plane, uint8_t* v_plane)
+{
+    if (uyvy_data == NULL || y_plane == NULL || u_plane == NULL || v_plane == NULL || width <= 0 || height <= 0 \
+        || (width % 2) != 0)
+    {
+        printf("uyvy_to_yuv422p: invalid param\n");
+        return -1;
+    }
+
+    deinterleave_planar(uyvy_data, width * height, 1, y_plane, u_plane, v_plane);
+    return 0;
+}
+
+int yuyv_to_nv16(uint8_t* yuyv_data, int width, int height, uint8_t* nv16_data)
+{
+    if (yuyv_data == NULL || nv16_data == NULL || width <= 0 || height <= 0 || (width % 2) != 0)
+    {
+        printf("yuyv_to_nv16: invalid param\n");
+        return -1;
+    }
+
+    int pixel_num = width * height;
+    deinterleave_luma_chroma(yuyv_data, pixel_num, 0, nv16_data, nv16_data + pixel_num);
+    return 0;
+}
+
+int uyvy_to_nv16(uint8_t* uyvy_data, int width, int height, uint8_t* nv16_data)
+{
+    if (uyvy_data == NULL || nv16_data == NULL || width <= 0 || height <= 0 || (width % 2) != 0)
+    {
+        printf("uyvy_to_nv16: invalid param\n");
+        return -1;
+    }
+
+    int pixel_num = width * height;
+    deinterleave_luma_chroma(uyvy_data, pixel_num, 1, nv16_data, nv16_data + pixel_num);
+    return 0;
+}
+
+int nv12_to_yuv420p(uint8_t* nv12_data, int width, int height, uint8_t* y_plane, uint8_t* u_plane, uint8_t* v_plane)
+{
+    if (nv12_data == NULL || y_plane == NULL || u_plane == NULL || v_plane == NULL || width <= 0 || height <= 0 \
+        || (width % 2) != 0 || (height % 2) != 0)
+    {
+        printf("nv12_to_yuv420p: invalid param\n");
+        return -1;
+    }
+
+    //the UV plane split like a packed frame of U V pairs, U in place of the luma byte
+    int pixel_num = width * height;
+    memcpy(y_plane, nv12_data, pixel_num);
+    deinterleave_luma_chroma(nv12_data + pixel_num, pixel_num / 4, 0, u_plane, v_plane);
+    return 0;
+}
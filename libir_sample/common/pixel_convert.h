@@ -0,0 +1,37 @@
+#ifndef _PIXEL_CONVERT_H_
+#define _PIXEL_CONVERT_H_
+
+#include <stdint.h>
+
+//vector paths are picked at compile time: SSE2 on x86/x64, NEON on arm. other targets run the scalar loops
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXEL_CONVERT_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PIXEL_CONVERT_NEON
+#endif
+
+//NV16(Y plane, then the interleaved UV plane, width*height bytes each) to packed 4:2:2 in one pass.
+//the yuyv output is the same as nv16_to_yuyv of libirparse, the uyvy output(UV byte first) is the same as
+//nv16_to_yuyv followed by uyvy_to_yuyv, which dvp cameras of UYVY_IMAGE format need
+int nv16_to_yuyv_fused(uint8_t* nv16_data, int width, int height, uint8_t* yuyv_data);
+int nv16_to_uyvy_fused(uint8_t* nv16_data, int width, int height, uint8_t* uyvy_data);
+
+//reorder the packed 4:2:2 frame to YUYV in place, the same bytes uyvy_to_yuyv/vyuy_to_yuyv/yvyu_to_yuyv of libirparse
+//write to a second frame buffer. width * height pixels, 2 bytes each
+int uyvy_to_yuyv_inplace(uint8_t* data, int width, int height);
+int vyuy_to_yuyv_inplace(uint8_t* data, int width, int height);
+int yvyu_to_yuyv_inplace(uint8_t* data, int width, int height);
+
+//packed 4:2:2 split into YUV422P planes(Y width x height, U and V width/2 x height each), as the mjpeg encoder of
+//capture takes them. the planes are separate pointers, so they can be those of an AVFrame or any other encoder buffer
+int yuyv_to_yuv422p(uint8_t* yuyv_data, int width, int height, uint8_t* y_plane, uint8_t* u_plane, uint8_t* v_plane);
+int uyvy_to_yuv422p(uint8_t* uyvy_data, int width, int height, uint8_t* y_plane, uint8_t* u_plane, uint8_t* v_plane);
+
+//packed 4:2:2 to NV16, the reverse of nv16_to_yuyv_fused/nv16_to_uyvy_fused
+int yuyv_to_nv16(uint8_t* yuyv_data, int width, int height, uint8_t* nv16_data);
+int uyvy_to_nv16(uint8_t* uyvy_data, int width, int height, uint8_t* nv16_data);
+
+//NV12 split into YUV420P planes(U and V width/2 x height/2 each)
+int nv12_to_yuv420p(uint8_t* nv12_data, int width, int height, uint8_t* y_plane, uint8_t* u_plane, uint8_t* v_plane);
+
+#endif
@@ -0,0 +1,217 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "raw_record.h"
+#include <string.h>
+#include <vector>
+
+using std::vector;
+
+struct RawRecord_s {
+    FILE* fp;
+    RawRecordHeader_t header;
+    uint64_t offset;            //end of the last whole frame, where the next frame or the index goes
+    bool is_failed;             //the file position is lost, nothing more is appended
+    vector<RawRecordIndex_t> index;
+};
+
+static int raw_record_seek(FILE* fp, uint64_t offset)
+{
+#if defined(_WIN32)
+    return _fseeki64(fp, (__int64)offset, SEEK_SET);
+#elif defined(linux) || defined(unix)
+    return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+}
+
+RawRecord_t* raw_record_create(const char* path, StreamFrameInfo_t* stream_frame_info)
+{
+    if (path == NULL || stream_frame_info == NULL)
+    {
+        printf("raw_record_create: invalid param\n");
+        return NULL;
+    }
+
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        printf("fail to open %s\n", path);
+        return NULL;
+    }
+
+    RawRecord_t* record = new RawRecord_t;
+    record->fp = fp;
+    record->is_failed = false;
+    RawRecordHeader_t* header = &record->header;
+    memset(header, 0, sizeof(RawRecordHeader_t));
+    memcpy(header->magic, RAW_RECORD_MAGIC, sizeof(header->magic));
+    header->version = RAW_RECORD_VERSION;
+    header->header_size = sizeof(RawRecordHeader_t);
+
+    camera_config* camera = &stream_frame_info->product_config.camera;
+    header->format = camera->format;
+    header->width = camera->width;
+    header->height = camera->height;
+    header->image_info_height = camera->image_info_height;
+    header->info_line_height = camera->info_line_height;
+    header->temp_info_height = camera->temp_info_height;
+    header->dummy_info_height = camera->dummy_info_height;
+    header->image_info_ratio = camera->image_info_ratio;
+    header->info_line_ratio = camera->info_line_ratio;
+    header->temp_line_ratio = camera->temp_line_ratio;
+    header->dummy_info_ratio = camera->dummy_info_ratio;
+    strncpy(header->image_channel_type, camera->image_channel_type.c_str(), sizeof(header->image_channel_type) - 1);
+    header->raw_byte_size = stream_frame_info->raw_byte_size;
+    header->raw_temp_byte_size = stream_frame_info->raw_temp_byte_size;
+
+    //the header is written again with the frame number and index offset when closing
+    if (fwrite(header, sizeof(RawRecordHeader_t), 1, fp) != 1)
+    {
+        printf("fail to write %s\n", path);
+        fclose(fp);
+        delete record;
+        return NULL;
+    }
+    record->offset = sizeof(RawRecordHeader_t);
+    printf("record to %s, raw %d bytes, raw temp %d bytes per frame\n", path, header->raw_byte_size, header->raw_temp_byte_size);
+    return record;
+}
+
+int raw_record_write(RawRecord_t* record, FrameBuffer_t* raw_buffer, FrameBuffer_t* raw_temp_buffer)
+{
+    if (record == NULL || raw_buffer == NULL || raw_buffer->byte_size < record->header.raw_byte_size)
+    {
+        return -1;
+    }
+    if (record->header.raw_temp_byte_size != 0 && \
+        (raw_temp_buffer == NULL || raw_temp_buffer->byte_size < record->header.raw_temp_byte_size))
+    {
+        return -1;
+    }
+
+    if (record->is_failed)
+    {
+        return -1;
+    }
+
+    if (fwrite(raw_buffer->data, 1, record->header.raw_byte_size, record->fp) != record->header.raw_byte_size || \
+        (record->header.raw_temp_byte_size != 0 && \
+        fwrite(raw_temp_buffer->data, 1, record->header.raw_temp_byte_size, record->fp) != record->header.raw_temp_byte_size))
+    {
+        //a part of the frame may be written, the next frame overwrites it
+        printf("raw_record_write: write failed\n");
+        if (raw_record_seek(record->fp, record->offset) != 0)
+        {
+            printf("raw_record_write: fail to seek back, stop recording\n");
+            record->is_failed = true;
+        }
+        return -1;
+    }
+
+    RawRecordIndex_t entry;
+    entry.offset = record->offset;
+    entry.timestamp_us = raw_buffer->timestamp_us;
+    record->index.push_back(entry);
+    record->offset += record->header.raw_byte_size + record->header.raw_temp_byte_size;
+    return 0;
+}
+
+int raw_record_close(RawRecord_t* record)
+{
+    if (record == NULL)
+    {
+        return -1;
+    }
+
+    int ret = 0;
+    record->header.frame_num = (uint32_t)record->index.size();
+    record->header.index_offset = record->offset;
+    if (raw_record_seek(record->fp, record->offset) != 0)
+    {
+        printf("raw_record_close: seek to the index failed\n");
+        ret = -1;
+    }
+    else if (!record->index.empty() && \
+        fwrite(&record->index[0], sizeof(RawRecordIndex_t), record->index.size(), record->fp) != record->index.size())
+    {
+        printf("raw_record_close: write index failed\n");
+        ret = -1;
+    }
+    fseek(record->fp, 0, SEEK_SET);
+    if (fwrite(&record->header, sizeof(RawRecordHeader_t), 1, record->fp) != 1)
+    {
+        printf("raw_record_close: write header failed\n");
+        ret = -1;
+    }
+    fclose(record->fp);
+    printf("record closed, %d frames\n", record->header.frame_num);
+    delete record;
+    return ret;
+}
+
+int raw_record_read_header(const char* path, RawRecordHeader_t* header)
+{
+    if (path == NULL || header == NULL)
+    {
+        return -1;
+    }
+
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        printf("fail to open %s\n", path);
+        return -1;
+    }
+    size_t read_num = fread(header, sizeof(RawRecordHeader_t), 1, fp);
+    fclose(fp);
+
+    if (read_num != 1 || memcmp(header->magic, RAW_RECORD_MAGIC, sizeof(header->magic)) != 0 \
+        || header->version != RAW_RECORD_VERSION || header->header_size != sizeof(RawRecordHeader_t))
+    {
+        printf("%s is not a raw recording\n", path);
+        return -1;
+    }
+    if (header->frame_num == 0 || header->index_offset == 0)
+    {
+        printf("%s was not closed or has no frame\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+void* raw_record_function(void* threadarg)
+{
+    printf("raw_record_function start\n");
+    StreamFrameInfo_t* stream_frame_info = (StreamFrameInfo_t*)threadarg;
+    if (stream_frame_info == NULL || stream_frame_info->product_config.camera.record_path.empty())
+    {
+        return NULL;
+    }
+
+    RawRecord_t* record = raw_record_create(stream_frame_info->product_config.camera.record_path.c_str(), stream_frame_info);
+    if (record == NULL)
+    {
+        return NULL;
+    }
+    int consumer_id = frame_ring_add_consumer(stream_frame_info->frame_ring);
+    if (consumer_id < 0)
+    {
+        raw_record_close(record);
+        return NULL;
+    }
+
+    //the frames are written in this thread, the stream thread never waits for the disk
+    FrameSlot_t slot;
+    while (frame_ring_read(stream_frame_info->frame_ring, consumer_id, &slot) == 0)
+    {
+        int ret = raw_record_write(record, slot.raw_buffer, slot.raw_temp_buffer);
+        frame_ring_release(&slot);
+        if (ret != 0)
+        {
+            break;
+        }
+    }
+
+    printf("record dropped %llu frames\n", (unsigned long long)frame_ring_dropped(stream_frame_info->frame_ring, consumer_id));
+    frame_ring_remove_consumer(stream_frame_info->frame_ring, consumer_id);
+    raw_record_close(record);
+    return NULL;
+}
@@ -0,0 +1,58 @@
+#ifndef _RAW_RECORD_H_
+#define _RAW_RECORD_H_
+
+#include "data.h"
+#include "frame_ring.h"
+
+#define RAW_RECORD_MAGIC    "IRRAWREC"
+#define RAW_RECORD_VERSION  1
+
+//file layout: RawRecordHeader_t | frame 0 | frame 1 | ... | RawRecordIndex_t[frame_num]
+//every frame is raw_byte_size bytes of raw_buffer followed by raw_temp_byte_size bytes of raw_temp_buffer
+#pragma pack(1)
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    //single_config::camera layout the frames are cut by
+    int32_t format;
+    int32_t width;
+    int32_t height;
+    int32_t image_info_height;
+    int32_t info_line_height;
+    int32_t temp_info_height;
+    int32_t dummy_info_height;
+    float image_info_ratio;
+    float info_line_ratio;
+    float temp_line_ratio;
+    float dummy_info_ratio;
+    char image_channel_type[16];
+    uint32_t raw_byte_size;
+    uint32_t raw_temp_byte_size;
+    uint32_t frame_num;         //written when the recording is closed
+    uint64_t index_offset;
+}RawRecordHeader_t;
+
+typedef struct {
+    uint64_t offset;            //from the beginning of the file
+    uint64_t timestamp_us;      //FrameBuffer_t::timestamp_us of the raw buffer
+}RawRecordIndex_t;
+#pragma pack()
+
+typedef struct RawRecord_s RawRecord_t;
+
+//create the file and write the layout of stream_frame_info, the frames follow by raw_record_write
+RawRecord_t* raw_record_create(const char* path, StreamFrameInfo_t* stream_frame_info);
+
+int raw_record_write(RawRecord_t* record, FrameBuffer_t* raw_buffer, FrameBuffer_t* raw_temp_buffer);
+
+//write the index and finish the header, the file is unreadable for replay without it
+int raw_record_close(RawRecord_t* record);
+
+//read and check the header of a recording
+int raw_record_read_header(const char* path, RawRecordHeader_t* header);
+
+//record thread, a frame ring consumer writing every frame to camera::record_path until the ring stops
+void* raw_record_function(void* threadarg);
+
+#endif
@@ -0,0 +1,354 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "raw_replay_camera.h"
+#include "pipeline.h"
+#include <string.h>
+#include <string>
+#if defined(linux) || defined(unix)
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+struct RawReplayHandle_s {
+    std::string path;
+    RawReplayChannel_e channel;
+    Pipeline_t* pipeline;
+    bool fast;
+    int loops;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#elif defined(linux) || defined(unix)
+    int fd;
+#endif
+    uint8_t* map;
+    uint64_t map_size;
+    RawRecordHeader_t header;
+    RawRecordIndex_t* index;
+    std::atomic_bool streaming;
+    uint32_t next_frame;
+    int loop;
+    uint64_t pass_start_us;     //frame_clock_us() when the first frame of this pass was handed out
+};
+
+int raw_replay_load_config(single_config& config)
+{
+    RawRecordHeader_t header;
+    if (raw_record_read_header(config.camera.replay_path.c_str(), &header) != 0)
+    {
+        return -1;
+    }
+
+    config.camera.format = header.format;
+    config.camera.width = header.width;
+    config.camera.height = header.height;
+    config.camera.image_info_height = header.image_info_height;
+    config.camera.info_line_height = header.info_line_height;
+    config.camera.temp_info_height = header.temp_info_height;
+    config.camera.dummy_info_height = header.dummy_info_height;
+    config.camera.image_info_ratio = header.image_info_ratio;
+    config.camera.info_line_ratio = header.info_line_ratio;
+    config.camera.temp_line_ratio = header.temp_line_ratio;
+    config.camera.dummy_info_ratio = header.dummy_info_ratio;
+    header.image_channel_type[sizeof(header.image_channel_type) - 1] = 0;
+    config.camera.image_channel_type = header.image_channel_type;
+    //the frames were recorded from the frame ring, after the stream thread's dvp/uyvy conversions, don't convert them twice
+    if (config.camera.format == UYVY_IMAGE)
+    {
+        config.camera.format = YUYV_IMAGE;
+    }
+    if (config.camera.image_channel_type == "dvp")
+    {
+        config.camera.image_channel_type = "mipi";
+    }
+    config.camera.v4l2_capture_mode = "copy";
+    printf("replay %s: %d frames, %dx%d\n", config.camera.replay_path.c_str(), header.frame_num, header.width, header.height);
+    return 0;
+}
+
+static void raw_replay_unmap(RawReplayHandle_t* handle)
+{
+    if (handle->map == NULL)
+    {
+        return;
+    }
+#if defined(_WIN32)
+    UnmapViewOfFile(handle->map);
+    CloseHandle(handle->mapping);
+    CloseHandle(handle->file);
+#elif defined(linux) || defined(unix)
+    munmap(handle->map, handle->map_size);
+    close(handle->fd);
+#endif
+    handle->map = NULL;
+    handle->index = NULL;
+}
+
+static int raw_replay_map(RawReplayHandle_t* handle)
+{
+#if defined(_WIN32)
+    handle->file = CreateFileA(handle->path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle->file == INVALID_HANDLE_VALUE)
+    {
+        printf("fail to open %s\n", handle->path.c_str());
+        return -1;
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(handle->file, &file_size);
+    handle->map_size = file_size.QuadPart;
+    handle->mapping = CreateFileMappingA(handle->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    handle->map = (handle->mapping == NULL) ? NULL : (uint8_t*)MapViewOfFile(handle->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (handle->map == NULL)
+    {
+        printf("fail to map %s\n", handle->path.c_str());
+        if (handle->mapping != NULL)
+        {
+            CloseHandle(handle->mapping);
+        }
+        CloseHandle(handle->file);
+        return -1;
+    }
+#elif defined(linux) || defined(unix)
+    handle->fd = open(handle->path.c_str(), O_RDONLY);
+    if (handle->fd < 0)
+    {
+        printf("fail to open %s\n", handle->path.c_str());
+        return -1;
+    }
+    struct stat file_stat;
+    fstat(handle->fd, &file_stat);
+    handle->map_size = file_stat.st_size;
+    void* map = mmap(NULL, handle->map_size, PROT_READ, MAP_SHARED, handle->fd, 0);
+    if (map == MAP_FAILED)
+    {
+        printf("fail to map %s\n", handle->path.c_str());
+        close(handle->fd);
+        return -1;
+    }
+    //frames are read front to back
+    madvise(map, handle->map_size, MADV_SEQUENTIAL);
+    handle->map = (uint8_t*)map;
+#endif
+    return 0;
+}
+
+//the header and every index entry must stay inside the file
+static int raw_replay_check(RawReplayHandle_t* handle)
+{
+    RawRecordHeader_t* header = &handle->header;
+    if (handle->map_size < sizeof(RawRecordHeader_t))
+    {
+        return -1;
+    }
+    memcpy(header, handle->map, sizeof(RawRecordHeader_t));
+    if (memcmp(header->magic, RAW_RECORD_MAGIC, sizeof(header->magic)) != 0 || header->version != RAW_RECORD_VERSION \
+        || header->frame_num == 0 || header->index_offset + (uint64_t)header->frame_num * sizeof(RawRecordIndex_t) > handle->map_size)
+    {
+        return -1;
+    }
+    if (handle->channel == RAW_REPLAY_TEMP && header->raw_temp_byte_size == 0)
+    {
+        printf("the recording has no temp channel\n");
+        return -1;
+    }
+
+    handle->index = (RawRecordIndex_t*)(handle->map + header->index_offset);
+    uint64_t frame_size = (uint64_t)header->raw_byte_size + header->raw_temp_byte_size;
+    for (uint32_t i = 0; i < header->frame_num; i++)
+    {
+        if (handle->index[i].offset + frame_size > header->index_offset)
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int raw_replay_open(void* device_handle, void* params)
+{
+    RawReplayHandle_t* handle = (RawReplayHandle_t*)device_handle;
+    if (handle == NULL || handle->map != NULL)
+    {
+        return -1;
+    }
+
+    if (raw_replay_map(handle) != 0)
+    {
+        return -1;
+    }
+    if (raw_replay_check(handle) != 0)
+    {
+        printf("%s is not a closed raw recording\n", handle->path.c_str());
+        raw_replay_unmap(handle);
+        return -1;
+    }
+    return 0;
+}
+
+static int raw_replay_init(void* device_handle, void* params)
+{
+    return (device_handle == NULL) ? -1 : 0;
+}
+
+static int raw_replay_start_stream(void* device_handle, void* params)
+{
+    RawReplayHandle_t* handle = (RawReplayHandle_t*)device_handle;
+    if (handle == NULL || handle->map == NULL)
+    {
+        return -1;
+    }
+
+    handle->next_frame = 0;
+    handle->loop = 0;
+    handle->pass_start_us = 0;
+    handle->streaming = true;
+    return 0;
+}
+
+static void raw_replay_sleep_us(uint64_t time_us)
+{
+#if defined(_WIN32)
+    Sleep((DWORD)(time_us / 1000));
+#elif defined(linux) || defined(unix)
+    struct timespec duration;
+    duration.tv_sec = time_us / 1000000;
+    duration.tv_nsec = (time_us % 1000000) * 1000;
+    nanosleep(&duration, NULL);
+#endif
+}
+
+//end of the recording, start the next pass or end the stream after camera::replay_loops passes
+static int raw_replay_next_pass(RawReplayHandle_t* handle)
+{
+    uint64_t pass_time_us = frame_clock_us() - handle->pass_start_us;
+    printf("replay pass %d: %d frames in %.1f ms, %.1f fps\n", handle->loop, handle->header.frame_num, pass_time_us / 1000.0, \
+        (pass_time_us == 0) ? 0.0 : handle->header.frame_num * 1000000.0 / pass_time_us);
+
+    handle->loop++;
+    if (handle->loops > 0 && handle->loop >= handle->loops)
+    {
+        //the stream thread leaves its loop as if stop_stream was called
+        handle->streaming = false;
+        pipeline_stop(handle->pipeline);
+        return -1;
+    }
+    handle->next_frame = 0;
+    handle->pass_start_us = 0;
+    return 0;
+}
+
+static int raw_replay_frame_get(void* device_handle, void* params, uint8_t* frame_data, int len)
+{
+    RawReplayHandle_t* handle = (RawReplayHandle_t*)device_handle;
+    if (handle == NULL || frame_data == NULL || !handle->streaming)
+    {
+        return -1;
+    }
+    if (handle->next_frame >= handle->header.frame_num && raw_replay_next_pass(handle) != 0)
+    {
+        return -1;
+    }
+
+    RawRecordIndex_t* entry = &handle->index[handle->next_frame];
+    if (handle->pass_start_us == 0)
+    {
+        handle->pass_start_us = frame_clock_us();
+    }
+    else if (!handle->fast && entry->timestamp_us > handle->index[0].timestamp_us)
+    {
+        //keep the recorded interval to the first frame of the pass
+        uint64_t due_us = handle->pass_start_us + (entry->timestamp_us - handle->index[0].timestamp_us);
+        uint64_t now_us = frame_clock_us();
+        if (due_us > now_us)
+        {
+            raw_replay_sleep_us(due_us - now_us);
+        }
+    }
+
+    uint8_t* data = handle->map + entry->offset;
+    uint32_t byte_size = handle->header.raw_byte_size;
+    if (handle->channel == RAW_REPLAY_TEMP)
+    {
+        data += handle->header.raw_byte_size;
+        byte_size = handle->header.raw_temp_byte_size;
+    }
+    int copy_len = ((int)byte_size < len) ? (int)byte_size : len;
+    memcpy(frame_data, data, copy_len);
+    handle->next_frame++;
+    return 0;
+}
+
+static int raw_replay_stop_stream(void* device_handle, void* params)
+{
+    RawReplayHandle_t* handle = (RawReplayHandle_t*)device_handle;
+    if (handle == NULL)
+    {
+        return -1;
+    }
+
+    handle->streaming = false;
+    return 0;
+}
+
+static int raw_replay_release(void* device_handle, void* params)
+{
+    return (device_handle == NULL) ? -1 : 0;
+}
+
+static int raw_replay_close(void* device_handle)
+{
+    RawReplayHandle_t* handle = (RawReplayHandle_t*)device_handle;
+    if (handle == NULL || handle->map == NULL)
+    {
+        return -1;
+    }
+
+    raw_replay_unmap(handle);
+    return 0;
+}
+
+RawReplayHandle_t* raw_replay_handle_create(IrVideoHandle_t* ir_video_handle, StreamFrameInfo_t* stream_frame_info, RawReplayChannel_e channel)
+{
+    if (ir_video_handle == NULL || stream_frame_info == NULL || stream_frame_info->product_config.camera.replay_path.empty())
+    {
+        printf("raw_replay_handle_create: invalid param\n");
+        return NULL;
+    }
+
+    RawReplayHandle_t* handle = new RawReplayHandle_t;
+    handle->path = stream_frame_info->product_config.camera.replay_path;
+    handle->channel = channel;
+    handle->pipeline = stream_frame_info->pipeline;
+    handle->fast = (stream_frame_info->product_config.camera.replay_pace == "fast");
+    handle->loops = stream_frame_info->product_config.camera.replay_loops;
+    handle->map = NULL;
+    handle->map_size = 0;
+    handle->index = NULL;
+    handle->streaming = false;
+    handle->next_frame = 0;
+    handle->loop = 0;
+    handle->pass_start_us = 0;
+
+    ir_video_handle->ir_video_handle = handle;
+    ir_video_handle->ir_video_open = raw_replay_open;
+    ir_video_handle->ir_video_init = raw_replay_init;
+    ir_video_handle->ir_video_start_stream = raw_replay_start_stream;
+    ir_video_handle->ir_video_frame_get = raw_replay_frame_get;
+    ir_video_handle->ir_video_stop_stream = raw_replay_stop_stream;
+    ir_video_handle->ir_video_release = raw_replay_release;
+    ir_video_handle->ir_video_close = raw_replay_close;
+    return handle;
+}
+
+int raw_replay_handle_delete(RawReplayHandle_t* handle)
+{
+    if (handle == NULL)
+    {
+        return -1;
+    }
+
+    raw_replay_unmap(handle);
+    delete handle;
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef _RAW_REPLAY_CAMERA_H_
+#define _RAW_REPLAY_CAMERA_H_
+
+#include "data.h"
+#include "raw_record.h"
+
+typedef enum
+{
+    RAW_REPLAY_IMAGE = 0,   //the raw buffer part of each frame, the whole composite frame for single channel streams
+    RAW_REPLAY_TEMP,        //the raw temp buffer part, for the mipi 2vc temp channel
+}RawReplayChannel_e;
+
+//replays a recording of raw_record.h from a mmap'd file instead of a camera
+typedef struct RawReplayHandle_s RawReplayHandle_t;
+
+//take the frame layout of config from camera::replay_path, frames are copied from the file so v4l2 capture falls back to copy
+int raw_replay_load_config(single_config& config);
+
+//fill the function table of ir_video_handle the same way irv4l2_handle_create does.
+//ir_video_open maps camera::replay_path, the params of all functions are ignored since they differ between the drivers.
+//frame_get keeps the recorded frame interval unless camera::replay_pace is fast
+RawReplayHandle_t* raw_replay_handle_create(IrVideoHandle_t* ir_video_handle, StreamFrameInfo_t* stream_frame_info, RawReplayChannel_e channel);
+
+int raw_replay_handle_delete(RawReplayHandle_t* handle);
+
+#endif
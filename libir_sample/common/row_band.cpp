@@ -0,0 +1,240 @@
+#include "row_band.h"
+#include <stdio.h>
+#include <atomic>
+#include <vector>
+
+#if defined(_WIN32)
+#define HAVE_STRUCT_TIMESPEC
+#include <Windows.h>
+#elif defined(linux) || defined(unix)
+#include <sched.h>
+#include <unistd.h>
+#endif
+#include <pthread.h>
+
+using std::vector;
+
+typedef struct {
+    RowBandPool_t* pool;
+    int index;
+    pthread_t thread;
+}RowBandWorker_t;
+
+struct RowBandPool_s {
+    int thread_num;
+    vector<RowBandWorker_t> workers;
+    vector<int> cpus;
+    pthread_mutex_t submit_mutex;   //one frame at a time
+    pthread_mutex_t mutex;
+    pthread_cond_t start_cond;
+    pthread_cond_t done_cond;
+    uint64_t generation;            //bumped for every frame, workers wake up when it changes
+    int busy_workers;
+    bool quit;
+
+    //the frame being run
+    RowBandKernel_f kernel;
+    void* arg;
+    int height;
+    int band_rows;
+    int band_num;
+    std::atomic_int next_band;
+};
+
+static int row_band_online_cpus(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO system_info;
+    GetSystemInfo(&system_info);
+    return (int)system_info.dwNumberOfProcessors;
+#elif defined(linux) || defined(unix)
+    long cpu_num = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cpu_num > 0) ? (int)cpu_num : 1;
+#endif
+}
+
+static void row_band_pin_self(int cpu)
+{
+#if defined(_WIN32)
+    if (SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) == 0)
+    {
+        printf("row band: pin worker to cpu %d failed\n", cpu);
+    }
+#elif defined(linux) || defined(unix)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) != 0)
+    {
+        printf("row band: pin worker to cpu %d failed\n", cpu);
+    }
+#endif
+}
+
+//claim bands until none is left, the workers and the caller race on next_band
+static void row_band_work(RowBandPool_t* pool)
+{
+    int band;
+    while ((band = pool->next_band.fetch_add(1)) < pool->band_num)
+    {
+        int row_start = band * pool->band_rows;
+        int row_end = row_start + pool->band_rows;
+        pool->kernel(pool->arg, row_start, (row_end < pool->height) ? row_end : pool->height);
+    }
+}
+
+static void* row_band_worker_function(void* threadarg)
+{
+    RowBandWorker_t* worker = (RowBandWorker_t*)threadarg;
+    RowBandPool_t* pool = worker->pool;
+    if (!pool->cpus.empty())
+    {
+        row_band_pin_self(pool->cpus[worker->index % pool->cpus.size()]);
+    }
+
+    uint64_t seen_generation = 0;
+    pthread_mutex_lock(&pool->mutex);
+    while (true)
+    {
+        while (!pool->quit && pool->generation == seen_generation)
+        {
+            pthread_cond_wait(&pool->start_cond, &pool->mutex);
+        }
+        if (pool->quit)
+        {
+            break;
+        }
+        seen_generation = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+
+        row_band_work(pool);
+
+        pthread_mutex_lock(&pool->mutex);
+        pool->busy_workers--;
+        if (pool->busy_workers == 0)
+        {
+            pthread_cond_signal(&pool->done_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+RowBandPool_t* row_band_pool_create(int thread_num, const int* cpus, int cpu_num)
+{
+    if (thread_num < 0 || cpu_num < 0 || (cpu_num > 0 && cpus == NULL))
+    {
+        printf("row_band_pool_create: invalid param\n");
+        return NULL;
+    }
+
+    RowBandPool_t* pool = new RowBandPool_t;
+    pool->thread_num = (thread_num == 0) ? row_band_online_cpus() : thread_num;
+    pool->cpus.assign(cpus, cpus + cpu_num);
+    pthread_mutex_init(&pool->submit_mutex, NULL);
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->start_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    pool->generation = 0;
+    pool->busy_workers = 0;
+    pool->quit = false;
+    pool->band_num = 0;
+    pool->next_band = 0;
+
+    //the caller is the first thread, so thread_num - 1 workers
+    pool->workers.resize(pool->thread_num - 1);
+    for (size_t i = 0; i < pool->workers.size(); i++)
+    {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = (int)i;
+        if (pthread_create(&pool->workers[i].thread, NULL, row_band_worker_function, &pool->workers[i]) != 0)
+        {
+            printf("row band: create worker %d failed\n", (int)i);
+            pool->workers.resize(i);
+            break;
+        }
+    }
+    pool->thread_num = (int)pool->workers.size() + 1;
+    printf("row band: %d threads\n", pool->thread_num);
+    return pool;
+}
+
+void row_band_pool_destroy(RowBandPool_t* pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->mutex);
+    for (size_t i = 0; i < pool->workers.size(); i++)
+    {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->start_cond);
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_mutex_destroy(&pool->submit_mutex);
+    delete pool;
+}
+
+int row_band_pool_thread_num(RowBandPool_t* pool)
+{
+    return (pool == NULL) ? 1 : pool->thread_num;
+}
+
+int row_band_run(RowBandPool_t* pool, int height, int row_bytes, int row_align, RowBandKernel_f kernel, void* arg)
+{
+    if (height <= 0 || row_bytes <= 0 || row_align <= 0 || kernel == NULL)
+    {
+        printf("row_band_run: invalid param\n");
+        return -1;
+    }
+
+    if (pool == NULL || pool->workers.empty())
+    {
+        kernel(arg, 0, height);
+        return 0;
+    }
+
+    //cache sized bands, but never fewer bands than threads
+    int band_rows = ROW_BAND_BYTES / row_bytes;
+    int even_rows = (height + pool->thread_num - 1) / pool->thread_num;
+    if (band_rows > even_rows)
+    {
+        band_rows = even_rows;
+    }
+    band_rows = (band_rows + row_align - 1) / row_align * row_align;
+    if (band_rows <= 0)
+    {
+        band_rows = row_align;
+    }
+
+    pthread_mutex_lock(&pool->submit_mutex);
+    pthread_mutex_lock(&pool->mutex);
+    pool->kernel = kernel;
+    pool->arg = arg;
+    pool->height = height;
+    pool->band_rows = band_rows;
+    pool->band_num = (height + band_rows - 1) / band_rows;
+    pool->next_band = 0;
+    pool->busy_workers = (int)pool->workers.size();
+    pool->generation++;
+    pthread_cond_broadcast(&pool->start_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    row_band_work(pool);
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->busy_workers > 0)
+    {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    pthread_mutex_unlock(&pool->submit_mutex);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#ifndef _ROW_BAND_H_
+#define _ROW_BAND_H_
+
+#include <stdint.h>
+
+//source bytes of one band, about the L1 data cache of a Cortex-A7, so a band's input stays in cache while it is converted
+#define ROW_BAND_BYTES  (32 * 1024)
+
+//fork-join executor of full frame kernels: the rows of a frame are cut into bands and the bands are shared by
+//persistent worker threads and the calling thread, no thread is created per frame
+typedef struct RowBandPool_s RowBandPool_t;
+
+//converts rows [row_start, row_end) of the frame described by arg, called concurrently for disjoint bands
+typedef void (*RowBandKernel_f)(void* arg, int row_start, int row_end);
+
+//thread_num threads work on a frame including the caller, 0 for one per online cpu.
+//worker i is pinned to cpus[i % cpu_num] when cpu_num > 0, the calling thread keeps its own affinity
+RowBandPool_t* row_band_pool_create(int thread_num, const int* cpus, int cpu_num);
+
+void row_band_pool_destroy(RowBandPool_t* pool);
+
+//threads of the pool including the caller, 1 for a NULL pool
+int row_band_pool_thread_num(RowBandPool_t* pool);
+
+//run kernel over rows 0~height-1 and return when every band is done. bands hold about ROW_BAND_BYTES of row_bytes
+//rows and start at a multiple of row_align(2 for the shared chroma rows of nv12). a NULL pool runs the kernel
+//once over the whole frame in the caller. callers from different threads are served one after another
+int row_band_run(RowBandPool_t* pool, int height, int row_bytes, int row_align, RowBandKernel_f kernel, void* arg);
+
+#endif
@@ -0,0 +1,417 @@
+#include "row_band_kernels.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ROW_BAND_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ROW_BAND_NEON
+#include <arm_neon.h>
+#endif
+
+using std::vector;
+
+//vectors summed into 32 bit lanes before they are added to the 64 bit sum, far from overflowing them
+#define Y16_SUM_BLOCK   4096
+
+//what every band of one frame needs, the bands only differ in their rows
+typedef struct {
+    uint8_t* src;
+    uint8_t* dst;
+    int width;
+    int height;
+    int pitch;
+    int pixel_size;
+    RowBandMinMax_t* row_min_max;   //min/max of each band, stored at its first row
+    PaletteEngine_t* palette_engine;
+}RowBandFrame_t;
+
+static void yuv422_to_bgr_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    color_convert_yuv422_to_bgr(frame->src + row_start * frame->width * 2, (row_end - row_start) * frame->width, \
+        frame->dst + row_start * frame->width * 3);
+}
+
+static void nv12_to_bgr_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    color_convert_nv12_rows_to_bgr(frame->src, frame->width, frame->height, row_start, row_end, frame->dst);
+}
+
+static void y16_to_bgr_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    color_convert_y16_to_bgr((uint16_t*)frame->src + row_start * frame->width, frame->width, row_end - row_start, \
+        frame->dst + row_start * frame->width * 3);
+}
+
+static void yuv422_to_bgra_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    color_convert_yuv422_to_bgra(frame->src + row_start * frame->width * 2, frame->width, row_end - row_start, \
+        frame->dst + row_start * frame->pitch, frame->pitch);
+}
+
+static void nv12_to_bgra_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    color_convert_nv12_rows_to_bgra(frame->src, frame->width, frame->height, row_start, row_end, frame->dst, frame->pitch);
+}
+
+static void palette_to_bgr_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    palette_render_bgr(frame->palette_engine, (uint16_t*)frame->src + row_start * frame->width, (row_end - row_start) * frame->width, \
+        frame->dst + row_start * frame->width * 3);
+}
+
+static void y16_to_celsius_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    const uint16_t* y16 = (const uint16_t*)frame->src + row_start * frame->width;
+    float* celsius = (float*)frame->dst + row_start * frame->width;
+    int pixel_num = (row_end - row_start) * frame->width;
+    for (int i = 0; i < pixel_num; i++)
+    {
+        celsius[i] = (float)((double)y16[i] / 64 - 273.15);
+    }
+}
+
+//min, max and sum of pixel_num pixels
+static void y16_scan(const uint16_t* y16, int pixel_num, uint16_t* min_value, uint16_t* max_value, uint64_t* sum)
+{
+    uint16_t min_v = 0xffff, max_v = 0;
+    uint64_t total = 0;
+    int i = 0;
+#if defined(ROW_BAND_SSE2)
+    //SSE2 only has signed 16 bit min/max, the values are moved to the signed range by flipping the top bit.
+    //the sum is taken of the flipped values too, every pixel then adds 32768 less
+    const __m128i bias = _mm_set1_epi16((short)0x8000);
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i min_vec = _mm_set1_epi16(0x7fff);
+    __m128i max_vec = _mm_set1_epi16((short)0x8000);
+    int vector_end = pixel_num & ~7;
+    while (i < vector_end)
+    {
+        int block_end = (vector_end - i > Y16_SUM_BLOCK * 8) ? i + Y16_SUM_BLOCK * 8 : vector_end;
+        __m128i sum_vec = _mm_setzero_si128();
+        for (; i < block_end; i += 8)
+        {
+            __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(y16 + i)), bias);
+            min_vec = _mm_min_epi16(min_vec, x);
+            max_vec = _mm_max_epi16(max_vec, x);
+            sum_vec = _mm_add_epi32(sum_vec, _mm_madd_epi16(x, ones));
+        }
+        int32_t lanes[4];
+        _mm_storeu_si128((__m128i*)lanes, sum_vec);
+        total += (int64_t)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+    total += (uint64_t)vector_end * 0x8000;
+    uint16_t min_lanes[8], max_lanes[8];
+    _mm_storeu_si128((__m128i*)min_lanes, _mm_xor_si128(min_vec, bias));
+    _mm_storeu_si128((__m128i*)max_lanes, _mm_xor_si128(max_vec, bias));
+    for (int lane = 0; lane < 8; lane++)
+    {
+        min_v = (min_lanes[lane] < min_v) ? min_lanes[lane] : min_v;
+        max_v = (max_lanes[lane] > max_v) ? max_lanes[lane] : max_v;
+    }
+#elif defined(ROW_BAND_NEON)
+    uint16x8_t min_vec = vdupq_n_u16(0xffff);
+    uint16x8_t max_vec = vdupq_n_u16(0);
+    int vector_end = pixel_num & ~7;
+    while (i < vector_end)
+    {
+        int block_end = (vector_end - i > Y16_SUM_BLOCK * 8) ? i + Y16_SUM_BLOCK * 8 : vector_end;
+        uint32x4_t sum_vec = vdupq_n_u32(0);
+        for (; i < block_end; i += 8)
+        {
+            uint16x8_t x = vld1q_u16(y16 + i);
+            min_vec = vminq_u16(min_vec, x);
+            max_vec = vmaxq_u16(max_vec, x);
+            sum_vec = vpadalq_u16(sum_vec, x);
+        }
+        uint64x2_t sum_pair = vpaddlq_u32(sum_vec);
+        total += vgetq_lane_u64(sum_pair, 0) + vgetq_lane_u64(sum_pair, 1);
+    }
+    uint16_t min_lanes[8], max_lanes[8];
+    vst1q_u16(min_lanes, min_vec);
+    vst1q_u16(max_lanes, max_vec);
+    for (int lane = 0; lane < 8; lane++)
+    {
+        min_v = (min_lanes[lane] < min_v) ? min_lanes[lane] : min_v;
+        max_v = (max_lanes[lane] > max_v) ? max_lanes[lane] : max_v;
+    }
+#endif
+    for (; i < pixel_num; i++)
+    {
+        min_v = (y16[i] < min_v) ? y16[i] : min_v;
+        max_v = (y16[i] > max_v) ? y16[i] : max_v;
+        total += y16[i];
+    }
+    *min_value = min_v;
+    *max_value = max_v;
+    *sum = total;
+}
+
+//index of the first pixel of the value, which the caller knows is there
+static int y16_find(const uint16_t* y16, int pixel_num, uint16_t value)
+{
+    int i = 0;
+#if defined(ROW_BAND_SSE2)
+    const __m128i target = _mm_set1_epi16((short)value);
+    for (; i + 8 <= pixel_num; i += 8)
+    {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(y16 + i)), target)) != 0)
+        {
+            break;
+        }
+    }
+#elif defined(ROW_BAND_NEON)
+    const uint16x8_t target = vdupq_n_u16(value);
+    for (; i + 8 <= pixel_num; i += 8)
+    {
+        uint64x2_t equal = vreinterpretq_u64_u16(vceqq_u16(vld1q_u16(y16 + i), target));
+        if ((vgetq_lane_u64(equal, 0) | vgetq_lane_u64(equal, 1)) != 0)
+        {
+            break;
+        }
+    }
+#endif
+    while (i < pixel_num - 1 && y16[i] != value)
+    {
+        i++;
+    }
+    return i;
+}
+
+//one scan for the values and the sum, then a search for the first min and max, which mostly stops early
+static void y16_min_max_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    const uint16_t* y16 = (const uint16_t*)frame->src + row_start * frame->width;
+    int pixel_num = (row_end - row_start) * frame->width;
+
+    RowBandMinMax_t* band_min_max = &frame->row_min_max[row_start];
+    y16_scan(y16, pixel_num, &band_min_max->min_value, &band_min_max->max_value, &band_min_max->sum);
+    int min_index = y16_find(y16, pixel_num, band_min_max->min_value);
+    int max_index = y16_find(y16, pixel_num, band_min_max->max_value);
+    band_min_max->min_x = min_index % frame->width;
+    band_min_max->min_y = row_start + min_index / frame->width;
+    band_min_max->max_x = max_index % frame->width;
+    band_min_max->max_y = row_start + max_index / frame->width;
+}
+
+static void mirror_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    int pixel_size = frame->pixel_size;
+    int row_bytes = frame->width * pixel_size;
+    for (int row = row_start; row < row_end; row++)
+    {
+        const uint8_t* src_row = frame->src + row * row_bytes;
+        uint8_t* dst_pixel = frame->dst + row * row_bytes + row_bytes - pixel_size;
+        for (int x = 0; x < frame->width; x++)
+        {
+            for (int byte = 0; byte < pixel_size; byte++)
+            {
+                dst_pixel[byte] = src_row[byte];
+            }
+            src_row += pixel_size;
+            dst_pixel -= pixel_size;
+        }
+    }
+}
+
+static void flip_band(void* arg, int row_start, int row_end)
+{
+    RowBandFrame_t* frame = (RowBandFrame_t*)arg;
+    int row_bytes = frame->width * frame->pixel_size;
+    for (int row = row_start; row < row_end; row++)
+    {
+        memcpy(frame->dst + (frame->height - 1 - row) * row_bytes, frame->src + row * row_bytes, row_bytes);
+    }
+}
+
+static void row_band_frame_init(RowBandFrame_t* frame, void* src, int width, int height, void* dst)
+{
+    memset(frame, 0, sizeof(RowBandFrame_t));
+    frame->src = (uint8_t*)src;
+    frame->dst = (uint8_t*)dst;
+    frame->width = width;
+    frame->height = height;
+}
+
+int row_band_yuv422_to_bgr(RowBandPool_t* pool, uint8_t* yuv422, int width, int height, uint8_t* bgr_data)
+{
+    if (yuv422 == NULL || bgr_data == NULL || width <= 0 || height <= 0 || (width % 2) != 0)
+    {
+        printf("row_band_yuv422_to_bgr: invalid param\n");
+        return -1;
+    }
+
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, yuv422, width, height, bgr_data);
+    return row_band_run(pool, height, width * 2, 1, yuv422_to_bgr_band, &frame);
+}
+
+int row_band_nv12_to_bgr(RowBandPool_t* pool, uint8_t* nv12_data, int width, int height, uint8_t* bgr_data)
+{
+    if (nv12_data == NULL || bgr_data == NULL || width <= 0 || height <= 0 || (width % 2) != 0 || (height % 2) != 0)
+    {
+        printf("row_band_nv12_to_bgr: invalid param\n");
+        return -1;
+    }
+
+    //a Y row and half a UV row per pixel row, bands keep the two Y rows of a UV row together
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, nv12_data, width, height, bgr_data);
+    return row_band_run(pool, height, width * 3 / 2, 2, nv12_to_bgr_band, &frame);
+}
+
+int row_band_y16_to_bgr(RowBandPool_t* pool, uint16_t* y16_data, int width, int height, uint8_t* bgr_data)
+{
+    if (y16_data == NULL || bgr_data == NULL || width <= 0 || height <= 0)
+    {
+        printf("row_band_y16_to_bgr: invalid param\n");
+        return -1;
+    }
+
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, y16_data, width, height, bgr_data);
+    return row_band_run(pool, height, width * 2, 1, y16_to_bgr_band, &frame);
+}
+
+int row_band_yuv422_to_bgra(RowBandPool_t* pool, uint8_t* yuv422, int width, int height, uint8_t* bgra_data, int bgra_pitch)
+{
+    if (yuv422 == NULL || bgra_data == NULL || width <= 0 || height <= 0 || (width % 2) != 0 || bgra_pitch < width * 4)
+    {
+        printf("row_band_yuv422_to_bgra: invalid param\n");
+        return -1;
+    }
+
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, yuv422, width, height, bgra_data);
+    frame.pitch = bgra_pitch;
+    return row_band_run(pool, height, width * 2, 1, yuv422_to_bgra_band, &frame);
+}
+
+int row_band_nv12_to_bgra(RowBandPool_t* pool, uint8_t* nv12_data, int width, int height, uint8_t* bgra_data, int bgra_pitch)
+{
+    if (nv12_data == NULL || bgra_data == NULL || width <= 0 || height <= 0 || (width % 2) != 0 || (height % 2) != 0 \
+        || bgra_pitch < width * 4)
+    {
+        printf("row_band_nv12_to_bgra: invalid param\n");
+        return -1;
+    }
+
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, nv12_data, width, height, bgra_data);
+    frame.pitch = bgra_pitch;
+    return row_band_run(pool, height, width * 3 / 2, 2, nv12_to_bgra_band, &frame);
+}
+
+int row_band_palette_to_bgr(RowBandPool_t* pool, PaletteEngine_t* engine, uint16_t* y16_data, int width, int height, uint8_t* bgr_data)
+{
+    if (engine == NULL || y16_data == NULL || bgr_data == NULL || width <= 0 || height <= 0)
+    {
+        printf("row_band_palette_to_bgr: invalid param\n");
+        return -1;
+    }
+
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, y16_data, width, height, bgr_data);
+    frame.palette_engine = engine;
+    palette_engine_update(engine);
+    return row_band_run(pool, height, width * 2, 1, palette_to_bgr_band, &frame);
+}
+
+int row_band_y16_to_celsius(RowBandPool_t* pool, uint16_t* y16_data, int width, int height, float* celsius)
+{
+    if (y16_data == NULL || celsius == NULL || width <= 0 || height <= 0)
+    {
+        printf("row_band_y16_to_celsius: invalid param\n");
+        return -1;
+    }
+
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, y16_data, width, height, celsius);
+    return row_band_run(pool, height, width * 2, 1, y16_to_celsius_band, &frame);
+}
+
+int row_band_y16_min_max(RowBandPool_t* pool, uint16_t* y16_data, int width, int height, RowBandMinMax_t* min_max)
+{
+    if (y16_data == NULL || min_max == NULL || width <= 0 || height <= 0)
+    {
+        printf("row_band_y16_min_max: invalid param\n");
+        return -1;
+    }
+
+    //the bands are merged top to bottom, and equal values keep the earlier pixel, so the result is that of one scan
+    vector<RowBandMinMax_t> row_min_max(height);
+    for (int row = 0; row < height; row++)
+    {
+        row_min_max[row].min_y = -1;
+    }
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, y16_data, width, height, NULL);
+    frame.row_min_max = &row_min_max[0];
+    if (row_band_run(pool, height, width * 2, 1, y16_min_max_band, &frame) != 0)
+    {
+        return -1;
+    }
+
+    *min_max = row_min_max[0];
+    for (int row = 1; row < height; row++)
+    {
+        const RowBandMinMax_t& band_min_max = row_min_max[row];
+        if (band_min_max.min_y < 0)
+        {
+            continue;
+        }
+        min_max->sum += band_min_max.sum;
+        if (band_min_max.min_value < min_max->min_value)
+        {
+            min_max->min_value = band_min_max.min_value;
+            min_max->min_x = band_min_max.min_x;
+            min_max->min_y = band_min_max.min_y;
+        }
+        if (band_min_max.max_value > min_max->max_value)
+        {
+            min_max->max_value = band_min_max.max_value;
+            min_max->max_x = band_min_max.max_x;
+            min_max->max_y = band_min_max.max_y;
+        }
+    }
+    return 0;
+}
+
+int row_band_mirror(RowBandPool_t* pool, uint8_t* src, int width, int height, int pixel_size, uint8_t* dst)
+{
+    if (src == NULL || dst == NULL || src == dst || width <= 0 || height <= 0 || pixel_size <= 0)
+    {
+        printf("row_band_mirror: invalid param\n");
+        return -1;
+    }
+
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, src, width, height, dst);
+    frame.pixel_size = pixel_size;
+    return row_band_run(pool, height, width * pixel_size, 1, mirror_band, &frame);
+}
+
+int row_band_flip(RowBandPool_t* pool, uint8_t* src, int width, int height, int pixel_size, uint8_t* dst)
+{
+    if (src == NULL || dst == NULL || src == dst || width <= 0 || height <= 0 || pixel_size <= 0)
+    {
+        printf("row_band_flip: invalid param\n");
+        return -1;
+    }
+
+    RowBandFrame_t frame;
+    row_band_frame_init(&frame, src, width, height, dst);
+    frame.pixel_size = pixel_size;
+    return row_band_run(pool, height, width * pixel_size, 1, flip_band, &frame);
+}
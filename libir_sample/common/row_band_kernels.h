@@ -0,0 +1,44 @@
+#ifndef _ROW_BAND_KERNELS_H_
+#define _ROW_BAND_KERNELS_H_
+
+#include "row_band.h"
+#include "color_convert.h"
+#include "palette.h"
+
+//full frame kernels split into row bands on a row band pool, the output is the same as the single thread version.
+//a NULL pool runs them in the caller
+
+//color_convert_yuv422_to_bgr/nv12_to_bgr/y16_to_bgr of a width x height frame
+int row_band_yuv422_to_bgr(RowBandPool_t* pool, uint8_t* yuv422, int width, int height, uint8_t* bgr_data);
+int row_band_nv12_to_bgr(RowBandPool_t* pool, uint8_t* nv12_data, int width, int height, uint8_t* bgr_data);
+int row_band_y16_to_bgr(RowBandPool_t* pool, uint16_t* y16_data, int width, int height, uint8_t* bgr_data);
+
+//color_convert_yuv422_to_bgra/nv12_to_bgra
+int row_band_yuv422_to_bgra(RowBandPool_t* pool, uint8_t* yuv422, int width, int height, uint8_t* bgra_data, int bgra_pitch);
+int row_band_nv12_to_bgra(RowBandPool_t* pool, uint8_t* nv12_data, int width, int height, uint8_t* bgra_data, int bgra_pitch);
+
+//palette_render_bgr of a width x height frame, the tables are updated before the bands start
+int row_band_palette_to_bgr(RowBandPool_t* pool, PaletteEngine_t* engine, uint16_t* y16_data, int width, int height, uint8_t* bgr_data);
+
+//temperature of every pixel of a y16 temp frame(1/64 kelvin), y16 / 64 - 273.15
+int row_band_y16_to_celsius(RowBandPool_t* pool, uint16_t* y16_data, int width, int height, float* celsius);
+
+typedef struct {
+    uint16_t min_value;
+    uint16_t max_value;
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    uint64_t sum;       //of all the pixels, the mean is sum / (width * height)
+}RowBandMinMax_t;
+
+//min, max and sum of a y16 frame, with the first position of min and max in raster order.
+//SSE2 on x86/x64, NEON on arm, scalar elsewhere
+int row_band_y16_min_max(RowBandPool_t* pool, uint16_t* y16_data, int width, int height, RowBandMinMax_t* min_max);
+
+//swap left and right / top and bottom of a frame of pixel_size bytes per pixel, src and dst are different frames
+int row_band_mirror(RowBandPool_t* pool, uint8_t* src, int width, int height, int pixel_size, uint8_t* dst);
+int row_band_flip(RowBandPool_t* pool, uint8_t* src, int width, int height, int pixel_size, uint8_t* dst);
+
+#endif
@@ -2,6 +2,8 @@
 #define SPI_CAMERA_H_
 
 #include "data.h"
+#include "pipeline.h"
+#include "frame_ring.h"
 #include "libirparse.h"
 #include "libirspi.h"
 
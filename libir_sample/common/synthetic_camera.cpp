@@ -0,0 +1,527 @@
+#include "synthetic_camera.h"
+#include "pipeline.h"
+#include <math.h>
+#include <string.h>
+#if defined(linux) || defined(unix)
+#include <time.h>
+#endif
+
+#define SYNTHETIC_KELVIN_RAW(celsius)   ((uint16_t)(((celsius) + 273.15) * 64))  //raw temp unit is 1/64 K
+#define SYNTHETIC_AMBIENT_TEMP  20.0    //top left of the background, it warms up by 10 degrees to the bottom
+#define SYNTHETIC_HOT_TEMP      80.0    //center of the moving hot spot
+#define SYNTHETIC_ORBIT_SECONDS 4       //the hot spot goes round the frame once in this time
+#define SYNTHETIC_PI            3.14159265358979
+
+typedef struct {
+    uint32_t offset;
+    uint32_t byte_size;
+}SyntheticRegion_t;
+
+struct SyntheticCameraHandle_s {
+    StreamFrameInfo_t* stream_frame_info;
+    SyntheticChannel_e channel;
+    uint32_t fps;
+    float drop_rate;
+    uint32_t jitter_us;
+    float crc_error_rate;
+    uint32_t frame_limit;
+    std::atomic_bool streaming;
+    uint32_t rand_state;
+
+    //layout of the frames this channel hands out, taken from stream_frame_info at start_stream
+    int format;
+    uint32_t width;
+    uint32_t image_height;
+    SyntheticRegion_t image;
+    SyntheticRegion_t info_line;
+    SyntheticRegion_t temp;
+    SyntheticRegion_t dummy;
+    bool has_temp;
+
+    //raw temperature of the scene, the image is rendered from it so both always show the same frame
+    uint32_t scene_height;
+    uint16_t* background;
+    uint16_t* scene;
+
+    uint64_t start_us;
+    uint64_t period_us;
+    uint32_t next_frame;
+    uint32_t frame_num;
+    uint32_t drop_num;
+    uint32_t late_num;
+    uint32_t crc_error_num;
+};
+
+int synthetic_camera_load_config(single_config& config)
+{
+    if (config.camera.synthetic_fps <= 0)
+    {
+        printf("synthetic camera needs a frame rate\n");
+        return -1;
+    }
+    //a drop rate of 1 would never deliver a frame, the reader would wait forever
+    if (config.camera.synthetic_drop_rate < 0 || config.camera.synthetic_drop_rate >= 1 \
+        || config.camera.synthetic_crc_error_rate < 0 || config.camera.synthetic_crc_error_rate >= 1)
+    {
+        printf("synthetic camera drop rate and crc error rate should be in [0, 1)\n");
+        return -1;
+    }
+    //a synthetic dvp frame is generated in the packed format the stream thread would convert it to
+    if (config.camera.image_channel_type == "dvp")
+    {
+        config.camera.image_channel_type = "mipi";
+    }
+    config.camera.v4l2_capture_mode = "copy";
+    //the frame pairer and the stream params take the frame rate of the v4l2 streams
+    config.camera.v4l2_config.image_stream.fps = config.camera.synthetic_fps;
+    config.camera.v4l2_config.temp_stream.fps = config.camera.synthetic_fps;
+    printf("synthetic camera: %dx%d, %d fps\n", config.camera.width, config.camera.height, config.camera.synthetic_fps);
+    return 0;
+}
+
+//xorshift32, the same seed gives the same drops and jitter on every run
+static float synthetic_rand(SyntheticCameraHandle_t* handle)
+{
+    uint32_t x = handle->rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    handle->rand_state = x;
+    return (x >> 8) / 16777216.0f;
+}
+
+//crc8 with polynomial 0x31, what libir_infoparse checks the status block with
+static uint8_t synthetic_crc8(uint8_t* data, int len)
+{
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void synthetic_put_u16(uint8_t* data, uint16_t value)
+{
+    data[0] = value & 0xff;
+    data[1] = value >> 8;
+}
+
+static void synthetic_free_scene(SyntheticCameraHandle_t* handle)
+{
+    if (handle->background != NULL)
+    {
+        free(handle->background);
+        handle->background = NULL;
+    }
+    if (handle->scene != NULL)
+    {
+        free(handle->scene);
+        handle->scene = NULL;
+    }
+}
+
+static void synthetic_load_layout(SyntheticCameraHandle_t* handle)
+{
+    StreamFrameInfo_t* stream_frame_info = handle->stream_frame_info;
+    bool is_double_channel = (stream_frame_info->raw_temp_byte_size != 0);
+    memset(&handle->image, 0, sizeof(SyntheticRegion_t));
+    memset(&handle->info_line, 0, sizeof(SyntheticRegion_t));
+    memset(&handle->temp, 0, sizeof(SyntheticRegion_t));
+    memset(&handle->dummy, 0, sizeof(SyntheticRegion_t));
+
+    //a mipi 2vc channel only carries its half of the composite frame
+    if (!is_double_channel || handle->channel == SYNTHETIC_IMAGE)
+    {
+        handle->image.offset = stream_frame_info->image_info.offset;
+        handle->image.byte_size = stream_frame_info->image_info.byte_size;
+        handle->info_line.offset = stream_frame_info->information_line.offset;
+        handle->info_line.byte_size = stream_frame_info->information_line.byte_size;
+    }
+    if (!is_double_channel || handle->channel == SYNTHETIC_TEMP)
+    {
+        handle->temp.offset = stream_frame_info->temp_info.offset;
+        handle->temp.byte_size = stream_frame_info->temp_info.byte_size;
+        handle->dummy.offset = stream_frame_info->dummy_info.offset;
+        handle->dummy.byte_size = stream_frame_info->dummy_info.byte_size;
+    }
+
+    handle->format = stream_frame_info->product_config.camera.format;
+    handle->width = stream_frame_info->width;
+    handle->image_height = stream_frame_info->image_info.height;
+    handle->has_temp = (stream_frame_info->temp_info.byte_size != 0);
+    handle->scene_height = handle->has_temp ? stream_frame_info->temp_info.height : handle->image_height;
+}
+
+//ambient background with a gradient, the hot spot is painted over a copy of it every frame
+static int synthetic_create_scene(SyntheticCameraHandle_t* handle)
+{
+    uint32_t pixel_num = handle->width * handle->scene_height;
+    if (pixel_num == 0)
+    {
+        return -1;
+    }
+    handle->background = (uint16_t*)malloc(pixel_num * sizeof(uint16_t));
+    handle->scene = (uint16_t*)malloc(pixel_num * sizeof(uint16_t));
+    if (handle->background == NULL || handle->scene == NULL)
+    {
+        printf("there is no more space!\n");
+        synthetic_free_scene(handle);
+        return -1;
+    }
+
+    for (uint32_t y = 0; y < handle->scene_height; y++)
+    {
+        for (uint32_t x = 0; x < handle->width; x++)
+        {
+            double temp = SYNTHETIC_AMBIENT_TEMP + 10.0 * y / handle->scene_height + 2.0 * x / handle->width;
+            handle->background[y * handle->width + x] = SYNTHETIC_KELVIN_RAW(temp);
+        }
+    }
+    return 0;
+}
+
+static void synthetic_render_scene(SyntheticCameraHandle_t* handle, uint32_t frame_count)
+{
+    int width = handle->width;
+    int height = handle->scene_height;
+    memcpy(handle->scene, handle->background, width * height * sizeof(uint16_t));
+
+    double angle = 2 * SYNTHETIC_PI * frame_count / (handle->fps * SYNTHETIC_ORBIT_SECONDS);
+    int center_x = width / 2 + (int)(width / 3 * cos(angle));
+    int center_y = height / 2 + (int)(height / 3 * sin(angle));
+    int radius = ((width > height) ? width : height) / 16;
+    if (radius < 4)
+    {
+        radius = 4;
+    }
+
+    int hot_raw = SYNTHETIC_KELVIN_RAW(SYNTHETIC_HOT_TEMP);
+    for (int y = center_y - radius; y <= center_y + radius; y++)
+    {
+        if (y < 0 || y >= height)
+        {
+            continue;
+        }
+        uint16_t* row = handle->scene + y * width;
+        for (int x = center_x - radius; x <= center_x + radius; x++)
+        {
+            int distance = (x - center_x) * (x - center_x) + (y - center_y) * (y - center_y);
+            if (x < 0 || x >= width || distance > radius * radius)
+            {
+                continue;
+            }
+            //falls off to the background at the edge of the spot
+            row[x] += (uint16_t)((hot_raw - row[x]) * (radius * radius - distance) / (radius * radius));
+        }
+    }
+}
+
+//the image is the scene mapped linearly from the ambient to the hot spot temperature, with neutral chroma
+static void synthetic_render_image(SyntheticCameraHandle_t* handle, uint8_t* data, uint32_t byte_size)
+{
+    int low_raw = SYNTHETIC_KELVIN_RAW(SYNTHETIC_AMBIENT_TEMP);
+    int range = SYNTHETIC_KELVIN_RAW(SYNTHETIC_HOT_TEMP) - low_raw;
+    uint32_t width = handle->width;
+    bool is_nv12 = (handle->format == NV12_IMAGE || handle->format == NV12_AND_TEMP);
+    uint32_t image_byte = is_nv12 ? (width * handle->image_height * 3 / 2) : (width * handle->image_height * 2);
+    if (image_byte > byte_size)
+    {
+        return;
+    }
+
+    for (uint32_t y = 0; y < handle->image_height; y++)
+    {
+        uint16_t* scene_row = handle->scene + (y * handle->scene_height / handle->image_height) * width;
+        uint8_t* dst = is_nv12 ? (data + y * width) : (data + y * width * 2);
+        for (uint32_t x = 0; x < width; x++)
+        {
+            int luma = 16 + ((int)scene_row[x] - low_raw) * 219 / range;
+            luma = (luma < 16) ? 16 : ((luma > 235) ? 235 : luma);
+            if (is_nv12)
+            {
+                dst[x] = (uint8_t)luma;
+            }
+            else
+            {
+                dst[x * 2] = (uint8_t)luma;
+                dst[x * 2 + 1] = 128;
+            }
+        }
+    }
+    if (is_nv12)
+    {
+        memset(data + width * handle->image_height, 128, width * handle->image_height / 2);
+    }
+}
+
+//write the status block of an information line, the counters are what the mipi 2vc frame pairer matches
+static void synthetic_render_info_line(SyntheticCameraHandle_t* handle, uint8_t* data, uint32_t byte_size, uint32_t frame_count)
+{
+    memset(data, 0, byte_size);
+    if (byte_size <= SYNTHETIC_INFO_CRC)
+    {
+        return;
+    }
+
+    memcpy(data + SYNTHETIC_INFO_DEV_PN, "SYNT", 4);
+    synthetic_put_u16(data + SYNTHETIC_INFO_WIDTH, (uint16_t)handle->width);
+    synthetic_put_u16(data + SYNTHETIC_INFO_HEIGHT, (uint16_t)handle->image_height);
+    data[SYNTHETIC_INFO_FPS] = (uint8_t)handle->fps;
+    data[SYNTHETIC_INFO_FORMAT] = (handle->format == NV12_IMAGE || handle->format == NV12_AND_TEMP) ? 2 : 0;
+    data[SYNTHETIC_INFO_MODE] = handle->has_temp ? 2 : 0;
+    data[SYNTHETIC_INFO_VERSION] = 1;
+    data[SYNTHETIC_INFO_CRC] = synthetic_crc8(data, SYNTHETIC_INFO_CRC);
+    if (byte_size >= SYNTHETIC_INFO_SIZE)
+    {
+        synthetic_put_u16(data + SYNTHETIC_INFO_FRAME_COUNT, (uint16_t)frame_count);
+        synthetic_put_u16(data + SYNTHETIC_INFO_TEMP_FRAME_CNT, (uint16_t)frame_count);
+        synthetic_put_u16(data + SYNTHETIC_INFO_FRAME_CNT, (uint16_t)frame_count);
+    }
+
+    if (handle->crc_error_rate > 0 && synthetic_rand(handle) < handle->crc_error_rate)
+    {
+        data[SYNTHETIC_INFO_CRC] ^= 0xff;
+        handle->crc_error_num++;
+    }
+}
+
+//a uyvy camera swaps the bytes of every pixel of the composite frame, the stream thread swaps them all back
+static void synthetic_swap_bytes(uint8_t* data, uint32_t byte_size)
+{
+    for (uint32_t i = 0; i + 1 < byte_size; i += 2)
+    {
+        uint8_t first = data[i];
+        data[i] = data[i + 1];
+        data[i + 1] = first;
+    }
+}
+
+static bool synthetic_region_fits(SyntheticRegion_t* region, int len)
+{
+    return region->byte_size != 0 && (uint64_t)region->offset + region->byte_size <= (uint64_t)len;
+}
+
+static void synthetic_render_frame(SyntheticCameraHandle_t* handle, uint8_t* frame_data, int len, uint32_t frame_count)
+{
+    synthetic_render_scene(handle, frame_count);
+
+    if (synthetic_region_fits(&handle->image, len))
+    {
+        synthetic_render_image(handle, frame_data + handle->image.offset, handle->image.byte_size);
+    }
+    if (synthetic_region_fits(&handle->info_line, len))
+    {
+        synthetic_render_info_line(handle, frame_data + handle->info_line.offset, handle->info_line.byte_size, frame_count);
+    }
+    if (synthetic_region_fits(&handle->temp, len))
+    {
+        uint32_t scene_byte = handle->width * handle->scene_height * sizeof(uint16_t);
+        uint32_t copy_byte = (scene_byte < handle->temp.byte_size) ? scene_byte : handle->temp.byte_size;
+        memcpy(frame_data + handle->temp.offset, handle->scene, copy_byte);
+    }
+    //the dummy rows carry the information line of the temp channel
+    if (synthetic_region_fits(&handle->dummy, len))
+    {
+        synthetic_render_info_line(handle, frame_data + handle->dummy.offset, handle->dummy.byte_size, frame_count);
+    }
+
+    if (handle->format == UYVY_IMAGE)
+    {
+        SyntheticRegion_t* regions[4] = { &handle->image, &handle->info_line, &handle->temp, &handle->dummy };
+        for (int i = 0; i < 4; i++)
+        {
+            if (synthetic_region_fits(regions[i], len))
+            {
+                synthetic_swap_bytes(frame_data + regions[i]->offset, regions[i]->byte_size);
+            }
+        }
+    }
+}
+
+static void synthetic_sleep_us(uint64_t time_us)
+{
+#if defined(_WIN32)
+    Sleep((DWORD)(time_us / 1000));
+#elif defined(linux) || defined(unix)
+    struct timespec duration;
+    duration.tv_sec = time_us / 1000000;
+    duration.tv_nsec = (time_us % 1000000) * 1000;
+    nanosleep(&duration, NULL);
+#endif
+}
+
+static int synthetic_open(void* device_handle, void* params)
+{
+    return (device_handle == NULL) ? -1 : 0;
+}
+
+static int synthetic_init(void* device_handle, void* params)
+{
+    return (device_handle == NULL) ? -1 : 0;
+}
+
+static int synthetic_start_stream(void* device_handle, void* params)
+{
+    SyntheticCameraHandle_t* handle = (SyntheticCameraHandle_t*)device_handle;
+    if (handle == NULL)
+    {
+        return -1;
+    }
+
+    synthetic_free_scene(handle);
+    synthetic_load_layout(handle);
+    if (synthetic_create_scene(handle) != 0)
+    {
+        return -1;
+    }
+    handle->start_us = 0;
+    handle->next_frame = 0;
+    handle->frame_num = 0;
+    handle->drop_num = 0;
+    handle->late_num = 0;
+    handle->crc_error_num = 0;
+    handle->streaming = true;
+    return 0;
+}
+
+//wait for the frame the sensor clock is at, the frames a slow reader missed are skipped like a camera would
+static int synthetic_frame_get(void* device_handle, void* params, uint8_t* frame_data, int len)
+{
+    SyntheticCameraHandle_t* handle = (SyntheticCameraHandle_t*)device_handle;
+    if (handle == NULL || frame_data == NULL || !handle->streaming)
+    {
+        return -1;
+    }
+
+    if (handle->frame_limit > 0 && handle->next_frame >= handle->frame_limit)
+    {
+        //the stream thread leaves its loop as if stop_stream was called
+        handle->streaming = false;
+        pipeline_stop(handle->stream_frame_info->pipeline);
+        return -1;
+    }
+    if (handle->start_us == 0)
+    {
+        handle->start_us = frame_clock_us();
+    }
+    uint64_t due_us;
+    while (true)
+    {
+        due_us = handle->start_us + handle->next_frame * handle->period_us;
+        uint64_t now_us = frame_clock_us();
+        if (now_us > due_us + handle->period_us)
+        {
+            uint32_t current_frame = (uint32_t)((now_us - handle->start_us) / handle->period_us);
+            handle->late_num += current_frame - handle->next_frame;
+            handle->next_frame = current_frame;
+            continue;
+        }
+        //a dropped frame never arrives, the reader waits for the next one
+        if (handle->drop_rate > 0 && synthetic_rand(handle) < handle->drop_rate)
+        {
+            handle->drop_num++;
+            handle->next_frame++;
+            continue;
+        }
+        break;
+    }
+    if (handle->jitter_us > 0)
+    {
+        due_us += (uint64_t)(synthetic_rand(handle) * handle->jitter_us);
+    }
+    uint64_t now_us = frame_clock_us();
+    if (due_us > now_us)
+    {
+        synthetic_sleep_us(due_us - now_us);
+    }
+
+    synthetic_render_frame(handle, frame_data, len, handle->next_frame);
+    handle->next_frame++;
+    handle->frame_num++;
+    return 0;
+}
+
+static int synthetic_stop_stream(void* device_handle, void* params)
+{
+    SyntheticCameraHandle_t* handle = (SyntheticCameraHandle_t*)device_handle;
+    if (handle == NULL)
+    {
+        return -1;
+    }
+
+    handle->streaming = false;
+    printf("synthetic %s: %u frames, %u dropped, %u late, %u crc errors\n", (handle->channel == SYNTHETIC_TEMP) ? "temp" : "image", \
+        handle->frame_num, handle->drop_num, handle->late_num, handle->crc_error_num);
+    return 0;
+}
+
+static int synthetic_release(void* device_handle, void* params)
+{
+    return (device_handle == NULL) ? -1 : 0;
+}
+
+static int synthetic_close(void* device_handle)
+{
+    SyntheticCameraHandle_t* handle = (SyntheticCameraHandle_t*)device_handle;
+    if (handle == NULL)
+    {
+        return -1;
+    }
+
+    synthetic_free_scene(handle);
+    return 0;
+}
+
+SyntheticCameraHandle_t* synthetic_camera_handle_create(IrVideoHandle_t* ir_video_handle, StreamFrameInfo_t* stream_frame_info, SyntheticChannel_e channel)
+{
+    if (ir_video_handle == NULL || stream_frame_info == NULL || stream_frame_info->product_config.camera.synthetic_fps <= 0)
+    {
+        printf("synthetic_camera_handle_create: invalid param\n");
+        return NULL;
+    }
+
+    camera_config* camera = &stream_frame_info->product_config.camera;
+    SyntheticCameraHandle_t* handle = new SyntheticCameraHandle_t;
+    handle->stream_frame_info = stream_frame_info;
+    handle->channel = channel;
+    handle->fps = camera->synthetic_fps;
+    handle->drop_rate = camera->synthetic_drop_rate;
+    handle->jitter_us = camera->synthetic_jitter_us;
+    handle->crc_error_rate = camera->synthetic_crc_error_rate;
+    handle->frame_limit = camera->synthetic_frames;
+    handle->streaming = false;
+    //the channels of a mipi 2vc stream drop different frames
+    handle->rand_state = (channel == SYNTHETIC_TEMP) ? 0x2545f491 : 0x9e3779b9;
+    handle->background = NULL;
+    handle->scene = NULL;
+    handle->period_us = 1000000 / handle->fps;
+    handle->start_us = 0;
+    handle->next_frame = 0;
+
+    ir_video_handle->ir_video_handle = handle;
+    ir_video_handle->ir_video_open = synthetic_open;
+    ir_video_handle->ir_video_init = synthetic_init;
+    ir_video_handle->ir_video_start_stream = synthetic_start_stream;
+    ir_video_handle->ir_video_frame_get = synthetic_frame_get;
+    ir_video_handle->ir_video_stop_stream = synthetic_stop_stream;
+    ir_video_handle->ir_video_release = synthetic_release;
+    ir_video_handle->ir_video_close = synthetic_close;
+    return handle;
+}
+
+int synthetic_camera_handle_delete(SyntheticCameraHandle_t* handle)
+{
+    if (handle == NULL)
+    {
+        return -1;
+    }
+
+    synthetic_free_scene(handle);
+    delete handle;
+    return 0;
+}
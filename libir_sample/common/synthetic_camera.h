@@ -0,0 +1,39 @@
+#ifndef _SYNTHETIC_CAMERA_H_
+#define _SYNTHETIC_CAMERA_H_
+
+#include "data.h"
+
+typedef enum
+{
+    SYNTHETIC_IMAGE = 0,    //image + information line, the whole composite frame for single channel streams
+    SYNTHETIC_TEMP,         //temp + dummy, for the mipi 2vc temp channel
+}SyntheticChannel_e;
+
+//byte offsets inside the information line, the same ones libir_infoparse reads
+#define SYNTHETIC_INFO_DEV_PN           0x00
+#define SYNTHETIC_INFO_WIDTH            0x04
+#define SYNTHETIC_INFO_HEIGHT           0x06
+#define SYNTHETIC_INFO_FPS              0x0b
+#define SYNTHETIC_INFO_FORMAT           0x10
+#define SYNTHETIC_INFO_MODE             0x12
+#define SYNTHETIC_INFO_VERSION          0x2d
+#define SYNTHETIC_INFO_CRC              0x7f    //crc8 of the bytes before it
+#define SYNTHETIC_INFO_FRAME_COUNT      0x80
+#define SYNTHETIC_INFO_TEMP_FRAME_CNT   0x168
+#define SYNTHETIC_INFO_FRAME_CNT        0x16e
+#define SYNTHETIC_INFO_SIZE             0x170
+
+//generates composite frames of the camera layout in stream_frame_info without a camera, for load testing
+typedef struct SyntheticCameraHandle_s SyntheticCameraHandle_t;
+
+//the stream threads copy the generated frames, v4l2 capture falls back to copy and dvp frames are generated already converted
+int synthetic_camera_load_config(single_config& config);
+
+//fill the function table of ir_video_handle the same way irv4l2_handle_create does, the params of all functions are ignored.
+//the layout is read from stream_frame_info at ir_video_start_stream, after load_stream_frame_info.
+//frame_get waits for the next frame of camera::synthetic_fps and injects the configured drops, jitter and info line crc errors
+SyntheticCameraHandle_t* synthetic_camera_handle_create(IrVideoHandle_t* ir_video_handle, StreamFrameInfo_t* stream_frame_info, SyntheticChannel_e channel);
+
+int synthetic_camera_handle_delete(SyntheticCameraHandle_t* handle);
+
+#endif
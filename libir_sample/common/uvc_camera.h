@@ -2,12 +2,15 @@
 #define UVC_CAMERA_H_
 
 #include "data.h"
+#include "pipeline.h"
+#include "frame_ring.h"
 #include "libiruvc.h"
 #include "libirparse.h"
+#include "pixel_convert.h"
 
 //stream thread,use UVC framework to get the raw frame, cut to temperature and image, and then send to other thread
 void* uvc_stream_function(void* threadarg);
 
-void stop_stream();
+void stop_stream(StreamFrameInfo_t* stream_frame_info);
 
 #endif
\ No newline at end of file
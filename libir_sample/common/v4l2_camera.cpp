@@ -1,86 +1,88 @@
 #include "v4l2_camera.h"
+#include "libir_infoparse.h"
 #include <atomic>
 
-std::atomic_bool isRUNNING(true);
-IrVideoHandle_t* ir_image_video_handle = NULL;
-IrVideoHandle_t* ir_temp_video_handle = NULL;
 
-void wait_sem_for_streaming()
+//held_frames: frames kept out of the ring besides the slots, e.g. waiting in the frame pairer
+static void* v4l2_driver_handle_create(StreamFrameInfo_t* stream_frame_info, IrVideoHandle_t* ir_video_handle, int held_frames)
 {
-#if defined(_WIN32)
-   WaitForSingleObject(image_done_sem, INFINITE);	//waitting for image singnal
-#elif defined(linux) || defined(unix)
-   sem_wait(&image_done_sem);
-#endif
-
-#ifdef INFO_LINE
-#if defined(_WIN32)
-    WaitForSingleObject(info_done_sem, INFINITE);	//waitting for info_line singnal
-#elif defined(linux) || defined(unix)
-    sem_wait(&info_done_sem);
-#endif
-#endif
-    return;
+    if (stream_frame_info->product_config.camera.v4l2_capture_mode == "mmap")
+    {
+        int slot_num = stream_frame_info->product_config.camera.frame_ring_slots;
+        if (slot_num <= 0)
+        {
+            slot_num = FRAME_RING_DEFAULT_SLOTS;
+        }
+        return v4l2_mmap_handle_create(ir_video_handle, slot_num + held_frames + V4L2_MMAP_EXTRA_BUFFERS);
+    }
+    return irv4l2_handle_create(ir_video_handle);
 }
 
-void release_sem_after_streaming()
+static void v4l2_driver_handle_delete(StreamFrameInfo_t* stream_frame_info, void* driver_handle)
 {
-#if defined(_WIN32)
-    ReleaseSemaphore(image_sem, 1, NULL);
-#elif defined(linux) || defined(unix)
-    sem_post(&image_sem);
-#endif
-
-#ifdef INFO_LINE
-#if defined(_WIN32)
-        ReleaseSemaphore(info_sem, 1, NULL);
-#elif defined(linux) || defined(unix)
-        sem_post(&info_sem);
-#endif
-#endif
-    return;
+    if (stream_frame_info->product_config.camera.v4l2_capture_mode == "mmap")
+    {
+        v4l2_mmap_handle_delete((V4l2MmapHandle_t*)driver_handle);
+    }
+    else
+    {
+        irv4l2_handle_delete((Irv4l2VideoHandle_t*)driver_handle);
+    }
 }
 
-void release_temp_sem() {
-#if defined(_WIN32)
-    ReleaseSemaphore(i_temp_sem, 1, NULL);
-#elif defined(linux) || defined(unix)
-    sem_post(&i_temp_sem);
-#endif
+void* v4l2_image_driver_handle_create(StreamFrameInfo_t* stream_frame_info, IrVideoHandle_t* ir_video_handle)
+{
+    //with a mipi 2vc temp channel the image frames may wait in the frame pairer
+    int held_frames = 0;
+    if (stream_frame_info->product_config.camera.v4l2_config.has_temp)
+    {
+        held_frames = stream_frame_info->product_config.camera.frame_pair_window;
+    }
+    return v4l2_driver_handle_create(stream_frame_info, ir_video_handle, held_frames);
 }
 
-void wait_temp_sem_for_streaming() {
-    #if defined(_WIN32)
-    WaitForSingleObject(i_temp_sem, INFINITE);	//waitting for image singnal
-#elif defined(linux) || defined(unix)
-    sem_wait(&i_temp_sem);
-#endif
+void v4l2_image_driver_handle_delete(StreamFrameInfo_t* stream_frame_info)
+{
+    v4l2_driver_handle_delete(stream_frame_info, stream_frame_info->image_driver_handle);
+    stream_frame_info->image_driver_handle = NULL;
+}
+
+void* v4l2_temp_driver_handle_create(StreamFrameInfo_t* stream_frame_info, IrVideoHandle_t* ir_video_handle)
+{
+    return v4l2_driver_handle_create(stream_frame_info, ir_video_handle, \
+        stream_frame_info->product_config.camera.frame_pair_window);
+}
+
+void v4l2_temp_driver_handle_delete(StreamFrameInfo_t* stream_frame_info)
+{
+    v4l2_driver_handle_delete(stream_frame_info, stream_frame_info->temp_driver_handle);
+    stream_frame_info->temp_driver_handle = NULL;
 }
 
-void release_temp_done() {
-#if defined(_WIN32)
-    ReleaseSemaphore(i_temp_done, 1, NULL);
-#elif defined(linux) || defined(unix)
-    sem_post(&i_temp_done);
-#endif
+//the dev params are read again by destroy_*_video_stream, they can't live on the stack of init_*_video_stream
+static CamDevParams_t* v4l2_dev_params_alloc(void** dev_params)
+{
+    if (*dev_params == NULL)
+    {
+        *dev_params = malloc(sizeof(CamDevParams_t));
+    }
+    memset(*dev_params, 0, sizeof(CamDevParams_t));
+    return (CamDevParams_t*)*dev_params;
 }
 
-void wait_temp_done() {
-    #if defined(_WIN32)
-    WaitForSingleObject(i_temp_done, INFINITE);	//waitting for image singnal
-#elif defined(linux) || defined(unix)
-    sem_wait(&i_temp_done);
-#endif
+static void v4l2_dev_params_free(void** dev_params)
+{
+    free(*dev_params);
+    *dev_params = NULL;
 }
 
 void init_v4l2_video_stream(StreamFrameInfo_t* stream_frame_info)
 {
     int ret;
-    ret = ir_image_video_handle->ir_video_open(stream_frame_info->image_driver_handle, \
+    ret = stream_frame_info->pipeline->ir_image_video_handle->ir_video_open(stream_frame_info->image_driver_handle, \
         (char*)stream_frame_info->image_name);
     printf("open video node: %d\n", ret);
-    CamDevParams_t dev_params;
-    stream_frame_info->image_dev_params = &dev_params;
+    CamDevParams_t& dev_params = *v4l2_dev_params_alloc(&stream_frame_info->image_dev_params);
     FrameOutputFmt_t cur_fmt = stream_frame_info->frame_output_format;
     dev_params.width = stream_frame_info->product_config.camera.v4l2_config.image_stream.dev_width;
     dev_params.format = V4L2_PIX_FMT_YUYV;  //we transfer the data by composite format, only use V4L2_PIX_FMT_YUYV for 2 bytes transfer.
@@ -91,8 +93,8 @@ void init_v4l2_video_stream(StreamFrameInfo_t* stream_frame_info)
     memset(&stream_params, 0, sizeof(stream_params));
     stream_params.width = dev_params.width;
     stream_params.height = dev_params.height;
-    ir_image_video_handle->ir_video_init(stream_frame_info->image_driver_handle, &dev_params);
-    ir_image_video_handle->ir_video_start_stream(stream_frame_info->image_driver_handle, &stream_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_init(stream_frame_info->image_driver_handle, &dev_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_start_stream(stream_frame_info->image_driver_handle, &stream_params);
     printf("irv4l2_camera_start_stream done\n");
 
     return;
@@ -105,24 +107,45 @@ void destroy_v4l2_video_stream(StreamFrameInfo_t* stream_frame_info)
     memset(&stream_params, 0, sizeof(stream_params));
     stream_params.width = image_dev_param->width;
     stream_params.height = image_dev_param->height;
-    ir_image_video_handle->ir_video_stop_stream(stream_frame_info->image_driver_handle, &stream_params);
-    ir_image_video_handle->ir_video_release(stream_frame_info->image_driver_handle, image_dev_param);
-    ir_image_video_handle->ir_video_close(stream_frame_info->image_driver_handle);
-    ir_video_handle_delete(&ir_image_video_handle);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_stop_stream(stream_frame_info->image_driver_handle, &stream_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_release(stream_frame_info->image_driver_handle, image_dev_param);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_close(stream_frame_info->image_driver_handle);
+    ir_video_handle_delete(&stream_frame_info->pipeline->ir_image_video_handle);
+    v4l2_dev_params_free(&stream_frame_info->image_dev_params);
 
     return;
 }
 
+typedef int (*Nv16ConvertFunc)(uint8_t* nv16_data, int width, int height, uint8_t* packed_data);
+
+//the uyvy order was nv16_to_yuyv + uyvy_to_yuyv through a second frame buffer, the fused kernel writes it directly
+static Nv16ConvertFunc v4l2_dvp_convert_select(int format)
+{
+    if (format == YUYV_IMAGE || format == YUYV_AND_TEMP)
+    {
+        return nv16_to_yuyv_fused;
+    }
+    else if (format == UYVY_IMAGE)
+    {
+        return nv16_to_uyvy_fused;
+    }
+    return NULL;
+}
+
 void* v4l2_stream_function(void* threadarg)
 {
     StreamFrameInfo_t* stream_frame_info = (StreamFrameInfo_t*)threadarg;
 
     init_v4l2_video_stream(stream_frame_info);
 
-    uint8_t* yuyv_frame = NULL;
+    //dvp delivers NV16 planes, they are interleaved straight into the packed layout of the format in one pass
     uint8_t* nv16_frame = NULL;
+    Nv16ConvertFunc nv16_convert = NULL;
+    int nv16_height = stream_frame_info->image_info.height + stream_frame_info->information_line.height \
+        + stream_frame_info->temp_info.height + stream_frame_info->dummy_info.height;
     if (stream_frame_info->product_config.camera.image_channel_type == "dvp")
     {
+        nv16_convert = v4l2_dvp_convert_select(stream_frame_info->product_config.camera.format);
         nv16_frame = (uint8_t*)malloc(stream_frame_info->raw_byte_size);
         if (nv16_frame == NULL)
         {
@@ -130,67 +153,76 @@ void* v4l2_stream_function(void* threadarg)
             return NULL;
         }
     }
-    if (stream_frame_info->product_config.camera.format == UYVY_IMAGE)
+
+    V4l2MmapHandle_t* mmap_handle = NULL;
+    if (stream_frame_info->product_config.camera.v4l2_capture_mode == "mmap")
+    {
+        mmap_handle = (V4l2MmapHandle_t*)stream_frame_info->image_driver_handle;
+    }
+
+    FrameSlot_t slot;
+    while (stream_frame_info->pipeline->is_running)
     {
-        yuyv_frame = (uint8_t*)malloc(stream_frame_info->raw_byte_size);
-        if (yuyv_frame == NULL)
+        if (mmap_handle != NULL && stream_frame_info->product_config.camera.image_channel_type != "dvp")
         {
-            printf("there is no more space!\n");
-            if (stream_frame_info->product_config.camera.image_channel_type == "dvp")
+            //the dequeued V4L2 buffer itself is published, it goes back to the driver when the last consumer releases it
+            FrameBuffer_t* buffer = v4l2_mmap_frame_dequeue(mmap_handle, 2000);
+            if (buffer != NULL)
             {
-                free(nv16_frame);
-                nv16_frame = NULL;
+                v4l2_channel_frame_dispatch(stream_frame_info, buffer, false);
             }
-            return NULL;
+            continue;
         }
-    }
 
-    while (isRUNNING)
-    {
-        wait_sem_for_streaming();
+        //the stream thread only waits for the camera, slow consumers skip frames by the ring's policy
+        if (frame_ring_acquire(stream_frame_info->frame_ring, &slot) != 0)
+        {
+            break;
+        }
+        uint8_t* raw_frame = slot.raw_buffer->data;
         if (stream_frame_info->product_config.camera.image_channel_type != "dvp")
         {
-            ir_image_video_handle->ir_video_frame_get(stream_frame_info->image_driver_handle, NULL, \
-                stream_frame_info->raw_frame, stream_frame_info->raw_byte_size); //raw_data
+            stream_frame_info->pipeline->ir_image_video_handle->ir_video_frame_get(stream_frame_info->image_driver_handle, NULL, \
+                raw_frame, stream_frame_info->raw_byte_size); //raw_data
         }
         else
         {
-            ir_image_video_handle->ir_video_frame_get(stream_frame_info->image_driver_handle, NULL, \
-                    nv16_frame, stream_frame_info->raw_byte_size); //raw_data
-            if (stream_frame_info->product_config.camera.format == YUYV_IMAGE || stream_frame_info->product_config.camera.format == YUYV_AND_TEMP)
+            //dvp always converts into the ring buffer, with mmap it reads the V4L2 buffer instead of a copy of it
+            FrameBuffer_t* capture_buffer = NULL;
+            uint8_t* nv16_data = nv16_frame;
+            if (mmap_handle != NULL)
             {
-                nv16_to_yuyv(nv16_frame, stream_frame_info->width, (stream_frame_info->image_info.height + stream_frame_info->information_line.height
-                    + stream_frame_info->temp_info.height + stream_frame_info->dummy_info.height), stream_frame_info->raw_frame);
+                capture_buffer = v4l2_mmap_frame_dequeue(mmap_handle, 2000);
+                if (capture_buffer == NULL || capture_buffer->byte_size < stream_frame_info->raw_byte_size)
+                {
+                    frame_buffer_unref(capture_buffer);
+                    frame_ring_release(&slot);
+                    continue;
+                }
+                nv16_data = capture_buffer->data;
             }
-            else if (stream_frame_info->product_config.camera.format == UYVY_IMAGE)
+            else
             {
-                nv16_to_yuyv(nv16_frame, stream_frame_info->width, (stream_frame_info->image_info.height + stream_frame_info->information_line.height
-                    + stream_frame_info->temp_info.height + stream_frame_info->dummy_info.height), yuyv_frame);
-                uyvy_to_yuyv(yuyv_frame, stream_frame_info->width, (stream_frame_info->image_info.height + stream_frame_info->information_line.height
-                    + stream_frame_info->temp_info.height + stream_frame_info->dummy_info.height), stream_frame_info->raw_frame);
+                stream_frame_info->pipeline->ir_image_video_handle->ir_video_frame_get(stream_frame_info->image_driver_handle, NULL, \
+                    nv16_frame, stream_frame_info->raw_byte_size); //raw_data
+            }
+            if (nv16_convert != NULL)
+            {
+                nv16_convert(nv16_data, stream_frame_info->width, nv16_height, raw_frame);
             }
+            frame_buffer_unref(capture_buffer);
         }
 
-        memcpy(stream_frame_info->image_info.data, stream_frame_info->raw_frame, \
-            stream_frame_info->image_info.byte_size); //image data
-        memcpy(stream_frame_info->information_line.data, stream_frame_info->raw_frame + \
-            stream_frame_info->image_info.byte_size, stream_frame_info->information_line.byte_size); //information line
-        memcpy(stream_frame_info->temp_info.data, stream_frame_info->raw_frame + \
-            stream_frame_info->image_info.byte_size + stream_frame_info->information_line.byte_size, \
-            stream_frame_info->temp_info.byte_size); //temp data
-        release_sem_after_streaming();
+        //image_info/information_line/temp_info are views into raw_frame, no copy needed
+        frame_ring_commit(stream_frame_info->frame_ring, &slot);
     }
+    frame_ring_stop(stream_frame_info->frame_ring);
 
     if (nv16_frame != NULL)
 	{
 		free(nv16_frame);
 		nv16_frame = NULL;
 	}
-    if (yuyv_frame != NULL)
-	{
-		free(yuyv_frame);
-		yuyv_frame = NULL;
-	}
 
     destroy_v4l2_video_stream(stream_frame_info);
 
@@ -200,18 +232,14 @@ void* v4l2_stream_function(void* threadarg)
 void init_double_channel_video_stream(StreamFrameInfo_t* stream_frame_info)
 {
     int ret;
-    ret = ir_image_video_handle->ir_video_open(stream_frame_info->image_driver_handle, (char*)stream_frame_info->image_name);
+    ret = stream_frame_info->pipeline->ir_image_video_handle->ir_video_open(stream_frame_info->image_driver_handle, (char*)stream_frame_info->image_name);
     printf("open image node:%d\n", ret);
 
-    ret = ir_temp_video_handle->ir_video_open(stream_frame_info->temp_driver_handle, (char*)stream_frame_info->temp_name);
+    ret = stream_frame_info->pipeline->ir_temp_video_handle->ir_video_open(stream_frame_info->temp_driver_handle, (char*)stream_frame_info->temp_name);
     printf("open temp node:%d\n", ret);
 
-    CamDevParams_t image_dev_params, temp_dev_params;
-    memset(&image_dev_params, 0, sizeof(image_dev_params));
-    memset(&temp_dev_params, 0, sizeof(temp_dev_params));
-
-    stream_frame_info->image_dev_params = &image_dev_params;
-    stream_frame_info->temp_dev_params = &temp_dev_params;
+    CamDevParams_t& image_dev_params = *v4l2_dev_params_alloc(&stream_frame_info->image_dev_params);
+    CamDevParams_t& temp_dev_params = *v4l2_dev_params_alloc(&stream_frame_info->temp_dev_params);
 
     FrameOutputFmt_t cur_fmt = stream_frame_info->frame_output_format;
     image_dev_params.width = stream_frame_info->product_config.camera.v4l2_config.image_stream.dev_width;
@@ -233,14 +261,14 @@ void init_double_channel_video_stream(StreamFrameInfo_t* stream_frame_info)
     printf("start image stream\n");
     image_stream_params.width = image_dev_params.width;
     image_stream_params.height = image_dev_params.height;
-    ir_image_video_handle->ir_video_init(stream_frame_info->image_driver_handle, &image_dev_params);
-    ir_image_video_handle->ir_video_start_stream(stream_frame_info->image_driver_handle, &image_stream_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_init(stream_frame_info->image_driver_handle, &image_dev_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_start_stream(stream_frame_info->image_driver_handle, &image_stream_params);
 
     printf("start temp stream\n");
     temp_stream_params.width = temp_dev_params.width;
     temp_stream_params.height = temp_dev_params.height;
-    ir_temp_video_handle->ir_video_init(stream_frame_info->temp_driver_handle, &temp_dev_params);
-    ir_temp_video_handle->ir_video_start_stream(stream_frame_info->temp_driver_handle, &temp_dev_params);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_init(stream_frame_info->temp_driver_handle, &temp_dev_params);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_start_stream(stream_frame_info->temp_driver_handle, &temp_dev_params);
     printf("irv4l2_camera_start_stream done\n");
 
     return;
@@ -262,16 +290,18 @@ void destroy_double_channel_video_stream(StreamFrameInfo_t* stream_frame_info)
     temp_stream_params.height = temp_dev_params->height;
 
     printf("stop image stream\n");
-    ir_image_video_handle->ir_video_stop_stream(stream_frame_info->image_driver_handle, &image_stream_params);
-    ir_image_video_handle->ir_video_release(stream_frame_info->image_driver_handle, &image_dev_params);
-    ir_image_video_handle->ir_video_close(stream_frame_info->image_driver_handle);
-    ir_video_handle_delete(&ir_image_video_handle);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_stop_stream(stream_frame_info->image_driver_handle, &image_stream_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_release(stream_frame_info->image_driver_handle, &image_dev_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_close(stream_frame_info->image_driver_handle);
+    ir_video_handle_delete(&stream_frame_info->pipeline->ir_image_video_handle);
+    v4l2_dev_params_free(&stream_frame_info->image_dev_params);
 
     printf("stop temp stream\n");
-    ir_temp_video_handle->ir_video_stop_stream(stream_frame_info->temp_driver_handle, &temp_stream_params);
-    ir_temp_video_handle->ir_video_release(stream_frame_info->temp_driver_handle, &temp_dev_params);
-    ir_temp_video_handle->ir_video_close(stream_frame_info->temp_driver_handle);
-    ir_video_handle_delete(&ir_temp_video_handle);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_stop_stream(stream_frame_info->temp_driver_handle, &temp_stream_params);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_release(stream_frame_info->temp_driver_handle, &temp_dev_params);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_close(stream_frame_info->temp_driver_handle);
+    ir_video_handle_delete(&stream_frame_info->pipeline->ir_temp_video_handle);
+    v4l2_dev_params_free(&stream_frame_info->temp_dev_params);
 
     return;
 }
@@ -287,24 +317,23 @@ void* v4l2_double_channel_stream_function(void* threadarg)
     uint32_t temp_data_byte = ((CamDevParams_t*)stream_frame_info->temp_dev_params)->height \
         * ((CamDevParams_t*)stream_frame_info->temp_dev_params)->width * 2;
 
-    while (isRUNNING)
+    FrameSlot_t slot;
+    while (stream_frame_info->pipeline->is_running)
     {
-        wait_sem_for_streaming();
+        if (frame_ring_acquire(stream_frame_info->frame_ring, &slot) != 0)
+        {
+            break;
+        }
 
-        ir_image_video_handle->ir_video_frame_get(stream_frame_info->image_driver_handle, NULL, \
-            stream_frame_info->raw_frame, image_data_byte);
-        memcpy(stream_frame_info->image_info.data, stream_frame_info->raw_frame, \
-            stream_frame_info->image_info.byte_size); //image data
-        memcpy(stream_frame_info->information_line.data, stream_frame_info->raw_frame + stream_frame_info->image_info.byte_size, \
-            stream_frame_info->information_line.byte_size); //temp data
+        stream_frame_info->pipeline->ir_image_video_handle->ir_video_frame_get(stream_frame_info->image_driver_handle, NULL, \
+            slot.raw_buffer->data, image_data_byte); //image data + information line
 
-        ir_temp_video_handle->ir_video_frame_get(stream_frame_info->temp_driver_handle, NULL, \
-            stream_frame_info->raw_temp_frame, temp_data_byte);
-        memcpy(stream_frame_info->temp_info.data, stream_frame_info->raw_temp_frame, \
-            stream_frame_info->temp_info.byte_size); //temp data
+        stream_frame_info->pipeline->ir_temp_video_handle->ir_video_frame_get(stream_frame_info->temp_driver_handle, NULL, \
+            slot.raw_temp_buffer->data, temp_data_byte); //temp data + dummy
 
-        release_sem_after_streaming();
+        frame_ring_commit(stream_frame_info->frame_ring, &slot);
     }
+    frame_ring_stop(stream_frame_info->frame_ring);
 
     destroy_double_channel_video_stream(stream_frame_info);
 
@@ -321,10 +350,11 @@ void destroy_temp_video_stream(StreamFrameInfo_t* stream_frame_info)
     temp_stream_params.height = temp_dev_params->height;
 
     printf("stop temp stream\n");
-    ir_temp_video_handle->ir_video_stop_stream(stream_frame_info->temp_driver_handle, &temp_stream_params);
-    ir_temp_video_handle->ir_video_release(stream_frame_info->temp_driver_handle, &temp_dev_params);
-    ir_temp_video_handle->ir_video_close(stream_frame_info->temp_driver_handle);
-    ir_video_handle_delete(&ir_temp_video_handle);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_stop_stream(stream_frame_info->temp_driver_handle, &temp_stream_params);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_release(stream_frame_info->temp_driver_handle, &temp_dev_params);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_close(stream_frame_info->temp_driver_handle);
+    ir_video_handle_delete(&stream_frame_info->pipeline->ir_temp_video_handle);
+    v4l2_dev_params_free(&stream_frame_info->temp_dev_params);
 
     return;
 }
@@ -332,13 +362,10 @@ void destroy_temp_video_stream(StreamFrameInfo_t* stream_frame_info)
 void init_temp_video_stream(StreamFrameInfo_t* stream_frame_info)
 {
     int ret;
-    ret = ir_temp_video_handle->ir_video_open(stream_frame_info->temp_driver_handle, (char*)stream_frame_info->temp_name);
+    ret = stream_frame_info->pipeline->ir_temp_video_handle->ir_video_open(stream_frame_info->temp_driver_handle, (char*)stream_frame_info->temp_name);
     printf("open temp node:%d\n", ret);
 
-    CamDevParams_t temp_dev_params;
-    memset(&temp_dev_params, 0, sizeof(temp_dev_params));
-
-    stream_frame_info->temp_dev_params = &temp_dev_params;
+    CamDevParams_t& temp_dev_params = *v4l2_dev_params_alloc(&stream_frame_info->temp_dev_params);
 
     FrameOutputFmt_t cur_fmt = stream_frame_info->frame_output_format;
 
@@ -353,13 +380,102 @@ void init_temp_video_stream(StreamFrameInfo_t* stream_frame_info)
     printf("start temp stream\n");
     temp_stream_params.width = temp_dev_params.width;
     temp_stream_params.height = temp_dev_params.height;
-    ir_temp_video_handle->ir_video_init(stream_frame_info->temp_driver_handle, &temp_dev_params);
-    ir_temp_video_handle->ir_video_start_stream(stream_frame_info->temp_driver_handle, &temp_dev_params);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_init(stream_frame_info->temp_driver_handle, &temp_dev_params);
+    stream_frame_info->pipeline->ir_temp_video_handle->ir_video_start_stream(stream_frame_info->temp_driver_handle, &temp_dev_params);
     printf("irv4l2_camera_start_stream done\n");
 
     return;
 }
 
+//info line counter of a mipi 2vc channel frame, FRAME_PAIR_NO_COUNT if the line is missing or can't be parsed
+static int v4l2_channel_frame_count(FrameBuffer_t* buffer, FrameInfo_t* info_line, bool is_temp)
+{
+    if (info_line->byte_size == 0 || buffer->byte_size < info_line->offset + info_line->byte_size)
+    {
+        return FRAME_PAIR_NO_COUNT;
+    }
+
+    IrinfoStatusInfo_t status_info;
+    if (irinfoparse_get_irinfo_status_info(buffer->data + info_line->offset, &status_info) != IRLIB_SUCCESS)
+    {
+        return FRAME_PAIR_NO_COUNT;
+    }
+    return is_temp ? status_info.frame_status.temp_frame_cnt : status_info.frame_status.frame_count;
+}
+
+//get one frame of a mipi 2vc channel, mmap capture hands out the V4L2 buffer, copy capture fills a ring buffer
+static FrameBuffer_t* v4l2_channel_frame_get(StreamFrameInfo_t* stream_frame_info, IrVideoHandle_t* ir_video_handle, \
+    void* driver_handle, bool is_temp, uint32_t data_byte)
+{
+    uint32_t frame_byte = is_temp ? stream_frame_info->raw_temp_byte_size : stream_frame_info->raw_byte_size;
+    FrameBuffer_t* buffer = NULL;
+    if (stream_frame_info->product_config.camera.v4l2_capture_mode == "mmap")
+    {
+        buffer = v4l2_mmap_frame_dequeue((V4l2MmapHandle_t*)driver_handle, 2000);
+    }
+    else
+    {
+        buffer = is_temp ? frame_ring_acquire_raw_temp_buffer(stream_frame_info->frame_ring) \
+            : frame_ring_acquire_raw_buffer(stream_frame_info->frame_ring);
+        if (buffer == NULL)
+        {
+            return NULL;
+        }
+        if (ir_video_handle->ir_video_frame_get(driver_handle, NULL, buffer->data, data_byte) < 0)
+        {
+            frame_buffer_unref(buffer);
+            return NULL;
+        }
+        buffer->timestamp_us = frame_clock_us();
+    }
+
+    if (buffer != NULL && buffer->byte_size < frame_byte)
+    {
+        printf("short %s frame: %d bytes\n", is_temp ? "temp" : "image", buffer->byte_size);
+        frame_buffer_unref(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+void v4l2_channel_frame_dispatch(StreamFrameInfo_t* stream_frame_info, FrameBuffer_t* buffer, bool is_temp)
+{
+    if (stream_frame_info->frame_pair != NULL)
+    {
+        if (is_temp)
+        {
+            int frame_count = v4l2_channel_frame_count(buffer, &stream_frame_info->dummy_info, true);
+            frame_pair_push_temp(stream_frame_info->frame_pair, buffer, frame_count);
+        }
+        else
+        {
+            int frame_count = v4l2_channel_frame_count(buffer, &stream_frame_info->information_line, false);
+            frame_pair_push_image(stream_frame_info->frame_pair, buffer, frame_count);
+        }
+        return;
+    }
+
+    if (buffer->byte_size < stream_frame_info->raw_byte_size)
+    {
+        printf("short frame: %d bytes\n", buffer->byte_size);
+        frame_buffer_unref(buffer);
+        return;
+    }
+    FrameSlot_t slot;
+    memset(&slot, 0, sizeof(slot));
+    slot.raw_buffer = buffer;
+    frame_ring_commit(stream_frame_info->frame_ring, &slot);
+}
+
+void print_frame_pair_stats(FramePair_t* frame_pair)
+{
+    FramePairStats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    frame_pair_get_stats(frame_pair, &stats);
+    printf("frame pair: paired %llu, image orphans %llu, temp orphans %llu\n", (unsigned long long)stats.paired, \
+        (unsigned long long)stats.image_orphans, (unsigned long long)stats.temp_orphans);
+}
+
 void* v4l2_temp_channel_stream_function(void* threadarg) {
     StreamFrameInfo_t* stream_frame_info = (StreamFrameInfo_t*)threadarg;
 
@@ -368,18 +484,18 @@ void* v4l2_temp_channel_stream_function(void* threadarg) {
     uint32_t temp_data_byte = ((CamDevParams_t*)stream_frame_info->temp_dev_params)->height \
         * ((CamDevParams_t*)stream_frame_info->temp_dev_params)->width * 2;
 
-    while (isRUNNING)
+    //the temp channel dequeues on its own, the pairer matches it to the image frame by the counter in its info line(dummy)
+    while (stream_frame_info->pipeline->is_running)
     {
-        wait_temp_sem_for_streaming();
-        ir_temp_video_handle->ir_video_frame_get(stream_frame_info->temp_driver_handle, NULL, \
-            stream_frame_info->raw_temp_frame, temp_data_byte);
-
-        memcpy(stream_frame_info->temp_info.data, stream_frame_info->raw_temp_frame, \
-            stream_frame_info->temp_info.byte_size); //temp data
-        memcpy(stream_frame_info->dummy_info.data, stream_frame_info->raw_temp_frame + stream_frame_info->temp_info.byte_size,
-            stream_frame_info->dummy_info.byte_size);
-        release_temp_done();
+        FrameBuffer_t* buffer = v4l2_channel_frame_get(stream_frame_info, stream_frame_info->pipeline->ir_temp_video_handle, \
+            stream_frame_info->temp_driver_handle, true, temp_data_byte); //temp data + dummy
+        if (buffer == NULL)
+        {
+            continue;
+        }
+        v4l2_channel_frame_dispatch(stream_frame_info, buffer, true);
     }
+    frame_ring_stop(stream_frame_info->frame_ring);
 
     destroy_temp_video_stream(stream_frame_info);
 
@@ -396,10 +512,11 @@ void destroy_image_video_stream(StreamFrameInfo_t* stream_frame_info)
     image_stream_params.height = image_dev_params->height;
 
     printf("stop image stream\n");
-    ir_image_video_handle->ir_video_stop_stream(stream_frame_info->image_driver_handle, &image_stream_params);
-    ir_image_video_handle->ir_video_release(stream_frame_info->image_driver_handle, &image_dev_params);
-    ir_image_video_handle->ir_video_close(stream_frame_info->image_driver_handle);
-    ir_video_handle_delete(&ir_image_video_handle);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_stop_stream(stream_frame_info->image_driver_handle, &image_stream_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_release(stream_frame_info->image_driver_handle, &image_dev_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_close(stream_frame_info->image_driver_handle);
+    ir_video_handle_delete(&stream_frame_info->pipeline->ir_image_video_handle);
+    v4l2_dev_params_free(&stream_frame_info->image_dev_params);
 
     return;
 }
@@ -407,13 +524,10 @@ void destroy_image_video_stream(StreamFrameInfo_t* stream_frame_info)
 void init_image_video_stream(StreamFrameInfo_t* stream_frame_info)
 {
     int ret;
-    ret = ir_image_video_handle->ir_video_open(stream_frame_info->image_driver_handle, (char*)stream_frame_info->image_name);
+    ret = stream_frame_info->pipeline->ir_image_video_handle->ir_video_open(stream_frame_info->image_driver_handle, (char*)stream_frame_info->image_name);
     printf("open image node:%d\n", ret);
 
-    CamDevParams_t image_dev_params;
-    memset(&image_dev_params, 0, sizeof(image_dev_params));
-
-    stream_frame_info->image_dev_params = &image_dev_params;
+    CamDevParams_t& image_dev_params = *v4l2_dev_params_alloc(&stream_frame_info->image_dev_params);
 
     FrameOutputFmt_t cur_fmt = stream_frame_info->frame_output_format;
     image_dev_params.width = stream_frame_info->product_config.camera.v4l2_config.image_stream.dev_width;
@@ -427,42 +541,41 @@ void init_image_video_stream(StreamFrameInfo_t* stream_frame_info)
     printf("start image stream\n");
     image_stream_params.width = image_dev_params.width;
     image_stream_params.height = image_dev_params.height;
-    ir_image_video_handle->ir_video_init(stream_frame_info->image_driver_handle, &image_dev_params);
-    ir_image_video_handle->ir_video_start_stream(stream_frame_info->image_driver_handle, &image_stream_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_init(stream_frame_info->image_driver_handle, &image_dev_params);
+    stream_frame_info->pipeline->ir_image_video_handle->ir_video_start_stream(stream_frame_info->image_driver_handle, &image_stream_params);
     printf("irv4l2_camera_start_stream done\n");
 
     return;
 }
 
 void* v4l2_image_channel_stream_function(void* threadarg) {
-StreamFrameInfo_t* stream_frame_info = (StreamFrameInfo_t*)threadarg;
+    StreamFrameInfo_t* stream_frame_info = (StreamFrameInfo_t*)threadarg;
 
     init_image_video_stream(stream_frame_info);
 
     uint32_t image_data_byte = ((CamDevParams_t*)stream_frame_info->image_dev_params)->height \
         * ((CamDevParams_t*)stream_frame_info->image_dev_params)->width * 2;
 
-    while (isRUNNING)
+    //a dropped frame on one vc only costs an orphan, the channels never wait for each other
+    while (stream_frame_info->pipeline->is_running)
     {
-        wait_sem_for_streaming();
-        release_temp_sem();
-
-        ir_image_video_handle->ir_video_frame_get(stream_frame_info->image_driver_handle, NULL, \
-            stream_frame_info->raw_frame, image_data_byte);
- 	    memcpy(stream_frame_info->image_info.data, stream_frame_info->raw_frame, \
-             stream_frame_info->image_info.byte_size); //image data
-        memcpy(stream_frame_info->information_line.data, stream_frame_info->raw_frame + stream_frame_info->image_info.byte_size, \
-            stream_frame_info->information_line.byte_size);
-        wait_temp_done();
-        release_sem_after_streaming();
+        FrameBuffer_t* buffer = v4l2_channel_frame_get(stream_frame_info, stream_frame_info->pipeline->ir_image_video_handle, \
+            stream_frame_info->image_driver_handle, false, image_data_byte); //image data + information line
+        if (buffer == NULL)
+        {
+            continue;
+        }
+        v4l2_channel_frame_dispatch(stream_frame_info, buffer, false);
     }
+    frame_ring_stop(stream_frame_info->frame_ring);
+    print_frame_pair_stats(stream_frame_info->frame_pair);
 
     destroy_image_video_stream(stream_frame_info);
     return NULL;
 }
 
 
-void stop_stream()
+void stop_stream(StreamFrameInfo_t* stream_frame_info)
 {
-    isRUNNING = false;
+    pipeline_stop(stream_frame_info->pipeline);
 }
@@ -2,8 +2,24 @@
 #define V4L2_CAMERA_H_
 
 #include "data.h"
+#include "pipeline.h"
+#include "frame_pair.h"
+#include "frame_ring.h"
 #include "libirparse.h"
 #include "libirv4l2.h"
+#include "v4l2_mmap_camera.h"
+#include "pixel_convert.h"
+
+//create the image driver handle on ir_video_handle by camera::v4l2_capture_mode,
+//"copy" uses libirv4l2, "mmap" hands the V4L2 buffers to the frame ring without copying
+void* v4l2_image_driver_handle_create(StreamFrameInfo_t* stream_frame_info, IrVideoHandle_t* ir_video_handle);
+
+void v4l2_image_driver_handle_delete(StreamFrameInfo_t* stream_frame_info);
+
+//same as above for the mipi 2vc temp channel
+void* v4l2_temp_driver_handle_create(StreamFrameInfo_t* stream_frame_info, IrVideoHandle_t* ir_video_handle);
+
+void v4l2_temp_driver_handle_delete(StreamFrameInfo_t* stream_frame_info);
 
 //stream thread, use v4l2 framework to get the raw frame, cut to temperature and image, and then send to other thread
 void *v4l2_stream_function(void *threadarg);
@@ -14,9 +30,23 @@ void* v4l2_double_channel_stream_function(void* threadarg);
 // stream thread, mipi 2vc/usb 2interface use v4l2 framework to get the raw frame
 // v4l2_temp_channel_stream_function for get temp raw data
 // v4l2_image_channel_stream_function for get image raw data, include infoline
+// both channels dequeue independently, stream_frame_info->frame_pair must be created before and pairs their frames into the frame ring
 void* v4l2_temp_channel_stream_function(void* threadarg);
 void* v4l2_image_channel_stream_function(void* threadarg);
 
-void stop_stream();
+//open and start(init) or stop and close(destroy) the image/temp node of one channel, for capture loops which
+//don't run the stream functions above(v4l2_reactor)
+void init_image_video_stream(StreamFrameInfo_t* stream_frame_info);
+void destroy_image_video_stream(StreamFrameInfo_t* stream_frame_info);
+void init_temp_video_stream(StreamFrameInfo_t* stream_frame_info);
+void destroy_temp_video_stream(StreamFrameInfo_t* stream_frame_info);
+
+//hand a dequeued frame of the image(is_temp false) or temp channel to the pipeline and take over its reference.
+//with stream_frame_info->frame_pair the frame goes to the pairer, otherwise it is published to the frame ring as it is
+void v4l2_channel_frame_dispatch(StreamFrameInfo_t* stream_frame_info, FrameBuffer_t* buffer, bool is_temp);
+
+void print_frame_pair_stats(FramePair_t* frame_pair);
+
+void stop_stream(StreamFrameInfo_t* stream_frame_info);
 
 #endif
\ No newline at end of file
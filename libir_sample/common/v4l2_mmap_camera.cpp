@@ -0,0 +1,402 @@
+#include "v4l2_mmap_camera.h"
+
+typedef struct {
+    V4l2MmapHandle_t* handle;
+    uint32_t index;
+    uint8_t* start;
+    uint32_t length;
+    int dmabuf_fd;
+    FrameBuffer_t* frame_buffer;
+}V4l2MmapBuffer_t;
+
+struct V4l2MmapHandle_s {
+    int fd;
+    uint32_t buffer_num;
+    V4l2MmapBuffer_t* buffers;
+    std::atomic_bool streaming;
+};
+
+static int xioctl(int fd, unsigned long request, void* arg)
+{
+    int ret;
+    do
+    {
+        ret = ioctl(fd, request, arg);
+    } while (ret == -1 && errno == EINTR);
+    return ret;
+}
+
+static int v4l2_mmap_queue_buffer(V4l2MmapHandle_t* handle, uint32_t index)
+{
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+    if (xioctl(handle->fd, VIDIOC_QBUF, &buf) < 0)
+    {
+        printf("VIDIOC_QBUF %d failed: %s\n", index, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+//last reference dropped, give the buffer back to the driver
+static void v4l2_mmap_requeue(FrameBuffer_t* frame_buffer)
+{
+    V4l2MmapBuffer_t* buffer = (V4l2MmapBuffer_t*)frame_buffer->priv;
+    if (buffer->handle->streaming)
+    {
+        v4l2_mmap_queue_buffer(buffer->handle, buffer->index);
+    }
+}
+
+static void v4l2_mmap_unmap_buffers(V4l2MmapHandle_t* handle)
+{
+    if (handle->buffers == NULL)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < handle->buffer_num; i++)
+    {
+        V4l2MmapBuffer_t* buffer = &handle->buffers[i];
+        if (buffer->dmabuf_fd >= 0)
+        {
+            close(buffer->dmabuf_fd);
+        }
+        if (buffer->start != NULL)
+        {
+            munmap(buffer->start, buffer->length);
+        }
+        delete buffer->frame_buffer;
+    }
+    delete[] handle->buffers;
+    handle->buffers = NULL;
+}
+
+static int v4l2_mmap_open(void* device_handle, void* params)
+{
+    V4l2MmapHandle_t* handle = (V4l2MmapHandle_t*)device_handle;
+    char* dev_node = (char*)params;
+    if (handle == NULL || dev_node == NULL)
+    {
+        return -1;
+    }
+
+    handle->fd = open(dev_node, O_RDWR | O_NONBLOCK);
+    if (handle->fd < 0)
+    {
+        printf("open %s failed: %s\n", dev_node, strerror(errno));
+        return -1;
+    }
+
+    struct v4l2_capability cap;
+    memset(&cap, 0, sizeof(cap));
+    if (xioctl(handle->fd, VIDIOC_QUERYCAP, &cap) < 0 || !(cap.capabilities & V4L2_CAP_STREAMING))
+    {
+        printf("%s doesn't support streaming i/o\n", dev_node);
+        close(handle->fd);
+        handle->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static int v4l2_mmap_init(void* device_handle, void* params)
+{
+    V4l2MmapHandle_t* handle = (V4l2MmapHandle_t*)device_handle;
+    CamDevParams_t* dev_params = (CamDevParams_t*)params;
+    if (handle == NULL || dev_params == NULL || handle->fd < 0)
+    {
+        return -1;
+    }
+
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = dev_params->width;
+    fmt.fmt.pix.height = dev_params->height;
+    fmt.fmt.pix.pixelformat = dev_params->format;
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (xioctl(handle->fd, VIDIOC_S_FMT, &fmt) < 0)
+    {
+        printf("VIDIOC_S_FMT failed: %s\n", strerror(errno));
+        return -1;
+    }
+    if ((int)fmt.fmt.pix.width != dev_params->width || (int)fmt.fmt.pix.height != dev_params->height)
+    {
+        printf("driver changed the format to %dx%d\n", fmt.fmt.pix.width, fmt.fmt.pix.height);
+    }
+
+    struct v4l2_streamparm parm;
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.parm.capture.timeperframe.numerator = 1;
+    parm.parm.capture.timeperframe.denominator = dev_params->fps;
+    if (dev_params->fps > 0 && xioctl(handle->fd, VIDIOC_S_PARM, &parm) < 0)
+    {
+        printf("VIDIOC_S_PARM failed, keep the driver's fps\n");
+    }
+
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = handle->buffer_num;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(handle->fd, VIDIOC_REQBUFS, &req) < 0 || req.count == 0)
+    {
+        printf("VIDIOC_REQBUFS failed: %s\n", strerror(errno));
+        return -1;
+    }
+    if (req.count != handle->buffer_num)
+    {
+        printf("driver gives %d buffers instead of %d\n", req.count, handle->buffer_num);
+    }
+    handle->buffer_num = req.count;
+    handle->buffers = new V4l2MmapBuffer_t[handle->buffer_num];
+    memset(handle->buffers, 0, sizeof(V4l2MmapBuffer_t) * handle->buffer_num);
+
+    for (uint32_t i = 0; i < handle->buffer_num; i++)
+    {
+        V4l2MmapBuffer_t* buffer = &handle->buffers[i];
+        buffer->handle = handle;
+        buffer->index = i;
+        buffer->dmabuf_fd = -1;
+
+        struct v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (xioctl(handle->fd, VIDIOC_QUERYBUF, &buf) < 0)
+        {
+            printf("VIDIOC_QUERYBUF failed: %s\n", strerror(errno));
+            v4l2_mmap_unmap_buffers(handle);
+            return -1;
+        }
+
+        void* start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, handle->fd, buf.m.offset);
+        if (start == MAP_FAILED)
+        {
+            printf("mmap buffer %d failed: %s\n", i, strerror(errno));
+            v4l2_mmap_unmap_buffers(handle);
+            return -1;
+        }
+        buffer->start = (uint8_t*)start;
+        buffer->length = buf.length;
+        buffer->frame_buffer = frame_buffer_wrap(buffer->start, buffer->length, v4l2_mmap_requeue, buffer);
+        buffer->frame_buffer->ref_count = 0;
+
+        //best effort, lets RGA/DRM import the frame by fd
+        struct v4l2_exportbuffer expbuf;
+        memset(&expbuf, 0, sizeof(expbuf));
+        expbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        expbuf.index = i;
+        expbuf.flags = O_RDONLY | O_CLOEXEC;
+        if (xioctl(handle->fd, VIDIOC_EXPBUF, &expbuf) == 0)
+        {
+            buffer->dmabuf_fd = expbuf.fd;
+        }
+    }
+    printf("v4l2 mmap: %d buffers of %d bytes\n", handle->buffer_num, handle->buffers[0].length);
+    return 0;
+}
+
+static int v4l2_mmap_start_stream(void* device_handle, void* params)
+{
+    V4l2MmapHandle_t* handle = (V4l2MmapHandle_t*)device_handle;
+    if (handle == NULL || handle->buffers == NULL)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < handle->buffer_num; i++)
+    {
+        if (handle->buffers[i].frame_buffer->ref_count == 0 && v4l2_mmap_queue_buffer(handle, i) != 0)
+        {
+            return -1;
+        }
+    }
+
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(handle->fd, VIDIOC_STREAMON, &type) < 0)
+    {
+        printf("VIDIOC_STREAMON failed: %s\n", strerror(errno));
+        return -1;
+    }
+    handle->streaming = true;
+    return 0;
+}
+
+FrameBuffer_t* v4l2_mmap_frame_dequeue(V4l2MmapHandle_t* handle, int timeout_ms)
+{
+    if (handle == NULL || !handle->streaming)
+    {
+        return NULL;
+    }
+
+    struct pollfd pfd;
+    pfd.fd = handle->fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int ret = poll(&pfd, 1, timeout_ms);
+    if (ret <= 0)
+    {
+        if (ret < 0 && errno != EINTR)
+        {
+            printf("poll failed: %s\n", strerror(errno));
+        }
+        return NULL;
+    }
+    return v4l2_mmap_frame_dequeue_ready(handle);
+}
+
+int v4l2_mmap_fd(V4l2MmapHandle_t* handle)
+{
+    return (handle == NULL) ? -1 : handle->fd;
+}
+
+FrameBuffer_t* v4l2_mmap_frame_dequeue_ready(V4l2MmapHandle_t* handle)
+{
+    if (handle == NULL || !handle->streaming)
+    {
+        return NULL;
+    }
+
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(handle->fd, VIDIOC_DQBUF, &buf) < 0)
+    {
+        if (errno != EAGAIN)
+        {
+            printf("VIDIOC_DQBUF failed: %s\n", strerror(errno));
+        }
+        return NULL;
+    }
+
+    FrameBuffer_t* frame_buffer = handle->buffers[buf.index].frame_buffer;
+    if (buf.flags & V4L2_BUF_FLAG_ERROR)
+    {
+        v4l2_mmap_queue_buffer(handle, buf.index);
+        return NULL;
+    }
+    frame_buffer->byte_size = buf.bytesused;
+    frame_buffer->timestamp_us = (uint64_t)buf.timestamp.tv_sec * 1000000 + buf.timestamp.tv_usec;
+    frame_buffer->ref_count = 1;
+    return frame_buffer;
+}
+
+int v4l2_mmap_frame_dmabuf_fd(FrameBuffer_t* buffer)
+{
+    if (buffer == NULL || buffer->release != v4l2_mmap_requeue)
+    {
+        return -1;
+    }
+    return ((V4l2MmapBuffer_t*)buffer->priv)->dmabuf_fd;
+}
+
+//keep the table's copy semantics for callers which don't hold frames
+static int v4l2_mmap_frame_get(void* device_handle, void* params, uint8_t* frame_data, int len)
+{
+    V4l2MmapHandle_t* handle = (V4l2MmapHandle_t*)device_handle;
+    FrameBuffer_t* frame_buffer = v4l2_mmap_frame_dequeue(handle, 2000);
+    if (frame_buffer == NULL)
+    {
+        return -1;
+    }
+
+    int copy_len = ((int)frame_buffer->byte_size < len) ? (int)frame_buffer->byte_size : len;
+    memcpy(frame_data, frame_buffer->data, copy_len);
+    if (params != NULL)
+    {
+        ((FrameGetParams_t*)params)->got_bytes = copy_len;
+    }
+    frame_buffer_unref(frame_buffer);
+    return 0;
+}
+
+static int v4l2_mmap_stop_stream(void* device_handle, void* params)
+{
+    V4l2MmapHandle_t* handle = (V4l2MmapHandle_t*)device_handle;
+    if (handle == NULL || !handle->streaming)
+    {
+        return -1;
+    }
+
+    //frames released after this point stay with the handle instead of going back to the driver
+    handle->streaming = false;
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(handle->fd, VIDIOC_STREAMOFF, &type) < 0)
+    {
+        printf("VIDIOC_STREAMOFF failed: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+//the mappings outlive the stream so frames still held by the frame ring stay readable until v4l2_mmap_handle_delete
+static int v4l2_mmap_release(void* device_handle, void* params)
+{
+    return (device_handle == NULL) ? -1 : 0;
+}
+
+static int v4l2_mmap_close(void* device_handle)
+{
+    V4l2MmapHandle_t* handle = (V4l2MmapHandle_t*)device_handle;
+    if (handle == NULL || handle->fd < 0)
+    {
+        return -1;
+    }
+
+    close(handle->fd);
+    handle->fd = -1;
+    return 0;
+}
+
+V4l2MmapHandle_t* v4l2_mmap_handle_create(IrVideoHandle_t* ir_video_handle, uint32_t buffer_num)
+{
+    if (ir_video_handle == NULL || buffer_num == 0)
+    {
+        printf("v4l2_mmap_handle_create: invalid param\n");
+        return NULL;
+    }
+
+    V4l2MmapHandle_t* handle = new V4l2MmapHandle_t;
+    handle->fd = -1;
+    handle->buffer_num = buffer_num;
+    handle->buffers = NULL;
+    handle->streaming = false;
+
+    ir_video_handle->ir_video_handle = handle;
+    ir_video_handle->ir_video_open = v4l2_mmap_open;
+    ir_video_handle->ir_video_init = v4l2_mmap_init;
+    ir_video_handle->ir_video_start_stream = v4l2_mmap_start_stream;
+    ir_video_handle->ir_video_frame_get = v4l2_mmap_frame_get;
+    ir_video_handle->ir_video_stop_stream = v4l2_mmap_stop_stream;
+    ir_video_handle->ir_video_release = v4l2_mmap_release;
+    ir_video_handle->ir_video_close = v4l2_mmap_close;
+    return handle;
+}
+
+int v4l2_mmap_handle_delete(V4l2MmapHandle_t* handle)
+{
+    if (handle == NULL)
+    {
+        return -1;
+    }
+
+    if (handle->streaming)
+    {
+        v4l2_mmap_stop_stream(handle, NULL);
+    }
+    v4l2_mmap_unmap_buffers(handle);
+    if (handle->fd >= 0)
+    {
+        v4l2_mmap_close(handle);
+    }
+    delete handle;
+    return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef V4L2_MMAP_CAMERA_H_
+#define V4L2_MMAP_CAMERA_H_
+
+#include "data.h"
+#include "libirv4l2.h"
+
+//capture buffers beyond the frame ring slots, covers the frames held by consumers and the one being filled by the driver
+#define V4L2_MMAP_EXTRA_BUFFERS 4
+
+//V4L2 capture through VIDIOC_REQBUFS/QBUF/DQBUF on mmap'd buffers, dequeued buffers are handed out without copying
+typedef struct V4l2MmapHandle_s V4l2MmapHandle_t;
+
+//create the handle and fill the function table of ir_video_handle, the same way irv4l2_handle_create does.
+//ir_video_open takes the device node, ir_video_init takes CamDevParams_t, ir_video_frame_get still copies
+V4l2MmapHandle_t* v4l2_mmap_handle_create(IrVideoHandle_t* ir_video_handle, uint32_t buffer_num);
+
+//unmap the capture buffers and free the handle, every dequeued frame must be released before
+int v4l2_mmap_handle_delete(V4l2MmapHandle_t* handle);
+
+//wait up to timeout_ms for the next frame and wrap the mmap'd buffer without copying.
+//the buffer is requeued to the driver when its last reference is dropped, NULL on timeout or error
+FrameBuffer_t* v4l2_mmap_frame_dequeue(V4l2MmapHandle_t* handle, int timeout_ms);
+
+//the device fd after ir_video_open, for callers which wait on several devices at once(v4l2_reactor)
+int v4l2_mmap_fd(V4l2MmapHandle_t* handle);
+
+//dequeue without waiting, the caller already knows the fd is readable. NULL if no frame is done yet
+FrameBuffer_t* v4l2_mmap_frame_dequeue_ready(V4l2MmapHandle_t* handle);
+
+//DMABUF fd exported for the buffer (for RGA/DRM import), -1 if the driver doesn't support VIDIOC_EXPBUF
+int v4l2_mmap_frame_dmabuf_fd(FrameBuffer_t* buffer);
+
+#endif
@@ -0,0 +1,233 @@
+#include "v4l2_reactor.h"
+#include <sys/epoll.h>
+
+typedef struct {
+    Pipeline_t* pipeline;
+    V4l2MmapHandle_t* mmap_handle;
+    bool is_temp;
+    bool streaming;
+    uint64_t frames;
+}V4l2ReactorChannel_t;
+
+struct V4l2Reactor_s {
+    int epoll_fd;
+    V4l2ReactorChannel_t channels[V4L2_REACTOR_MAX_CHANNELS];
+    int channel_num;
+};
+
+V4l2Reactor_t* v4l2_reactor_create(void)
+{
+    V4l2Reactor_t* reactor = new V4l2Reactor_t;
+    memset(reactor, 0, sizeof(V4l2Reactor_t));
+    reactor->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (reactor->epoll_fd < 0)
+    {
+        printf("epoll_create1 failed: %s\n", strerror(errno));
+        delete reactor;
+        return NULL;
+    }
+    return reactor;
+}
+
+static int v4l2_reactor_add_channel(V4l2Reactor_t* reactor, Pipeline_t* pipeline, void* driver_handle, bool is_temp)
+{
+    if (reactor->channel_num >= V4L2_REACTOR_MAX_CHANNELS)
+    {
+        printf("v4l2 reactor: more than %d nodes\n", V4L2_REACTOR_MAX_CHANNELS);
+        return -1;
+    }
+
+    V4l2ReactorChannel_t* channel = &reactor->channels[reactor->channel_num++];
+    channel->pipeline = pipeline;
+    channel->mmap_handle = (V4l2MmapHandle_t*)driver_handle;
+    channel->is_temp = is_temp;
+    channel->streaming = false;
+    channel->frames = 0;
+    return 0;
+}
+
+int v4l2_reactor_add_pipeline(V4l2Reactor_t* reactor, Pipeline_t* pipeline)
+{
+    if (reactor == NULL || pipeline == NULL || pipeline->stream_frame_info.image_driver_handle == NULL)
+    {
+        printf("v4l2_reactor_add_pipeline: invalid param\n");
+        return -1;
+    }
+
+    StreamFrameInfo_t* stream_frame_info = &pipeline->stream_frame_info;
+    if (stream_frame_info->product_config.camera.v4l2_capture_mode != "mmap")
+    {
+        printf("v4l2 reactor needs v4l2_capture_mode mmap\n");
+        return -1;
+    }
+    if (stream_frame_info->product_config.camera.image_channel_type == "dvp")
+    {
+        printf("v4l2 reactor doesn't convert dvp frames\n");
+        return -1;
+    }
+    //a commit waiting for a slow consumer would hold the nodes of every camera
+    if (frame_ring_policy_from_name(stream_frame_info->product_config.camera.frame_ring_policy.c_str()) == FRAME_RING_BLOCK)
+    {
+        printf("v4l2 reactor needs frame_ring_policy drop_oldest\n");
+        return -1;
+    }
+
+    bool has_temp = (stream_frame_info->frame_pair != NULL);
+    if (has_temp && stream_frame_info->temp_driver_handle == NULL)
+    {
+        printf("v4l2_reactor_add_pipeline: no temp driver handle\n");
+        return -1;
+    }
+    if (reactor->channel_num + (has_temp ? 2 : 1) > V4L2_REACTOR_MAX_CHANNELS)
+    {
+        printf("v4l2 reactor: more than %d nodes\n", V4L2_REACTOR_MAX_CHANNELS);
+        return -1;
+    }
+
+    v4l2_reactor_add_channel(reactor, pipeline, stream_frame_info->image_driver_handle, false);
+    if (has_temp)
+    {
+        v4l2_reactor_add_channel(reactor, pipeline, stream_frame_info->temp_driver_handle, true);
+    }
+    return 0;
+}
+
+static int v4l2_reactor_channel_start(V4l2Reactor_t* reactor, V4l2ReactorChannel_t* channel)
+{
+    StreamFrameInfo_t* stream_frame_info = &channel->pipeline->stream_frame_info;
+    if (channel->is_temp)
+    {
+        init_temp_video_stream(stream_frame_info);
+    }
+    else
+    {
+        init_image_video_stream(stream_frame_info);
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = channel;
+    int fd = v4l2_mmap_fd(channel->mmap_handle);
+    if (fd < 0 || epoll_ctl(reactor->epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        printf("v4l2 reactor: fail to watch %s node\n", channel->is_temp ? "temp" : "image");
+        if (channel->is_temp)
+        {
+            destroy_temp_video_stream(stream_frame_info);
+        }
+        else
+        {
+            destroy_image_video_stream(stream_frame_info);
+        }
+        frame_ring_stop(stream_frame_info->frame_ring);
+        return -1;
+    }
+    channel->streaming = true;
+    return 0;
+}
+
+//the same teardown as the end of the channel's stream function
+static void v4l2_reactor_channel_stop(V4l2Reactor_t* reactor, V4l2ReactorChannel_t* channel)
+{
+    StreamFrameInfo_t* stream_frame_info = &channel->pipeline->stream_frame_info;
+    epoll_ctl(reactor->epoll_fd, EPOLL_CTL_DEL, v4l2_mmap_fd(channel->mmap_handle), NULL);
+    channel->streaming = false;
+
+    frame_ring_stop(stream_frame_info->frame_ring);
+    printf("v4l2 reactor: %s %s node, %llu frames\n", channel->is_temp ? stream_frame_info->temp_name : stream_frame_info->image_name, \
+        channel->is_temp ? "temp" : "image", (unsigned long long)channel->frames);
+    if (channel->is_temp)
+    {
+        destroy_temp_video_stream(stream_frame_info);
+    }
+    else
+    {
+        if (stream_frame_info->frame_pair != NULL)
+        {
+            print_frame_pair_stats(stream_frame_info->frame_pair);
+        }
+        destroy_image_video_stream(stream_frame_info);
+    }
+}
+
+void* v4l2_reactor_function(void* threadarg)
+{
+    V4l2Reactor_t* reactor = (V4l2Reactor_t*)threadarg;
+
+    int streaming_num = 0;
+    for (int i = 0; i < reactor->channel_num; i++)
+    {
+        if (v4l2_reactor_channel_start(reactor, &reactor->channels[i]) == 0)
+        {
+            streaming_num++;
+        }
+    }
+
+    struct epoll_event events[V4L2_REACTOR_MAX_CHANNELS];
+    while (streaming_num > 0)
+    {
+        //the timeout bounds how long a stopped pipeline keeps its nodes open when its cameras send nothing
+        int event_num = epoll_wait(reactor->epoll_fd, events, V4L2_REACTOR_MAX_CHANNELS, 200);
+        if (event_num < 0 && errno != EINTR)
+        {
+            printf("epoll_wait failed: %s\n", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < event_num; i++)
+        {
+            V4l2ReactorChannel_t* channel = (V4l2ReactorChannel_t*)events[i].data.ptr;
+            if (!channel->streaming || !channel->pipeline->is_running)
+            {
+                continue;
+            }
+            //an unplugged camera reports its node at every wait, the pipeline is stopped with it
+            if (events[i].events & (EPOLLERR | EPOLLHUP))
+            {
+                printf("v4l2 reactor: %s node error\n", channel->is_temp ? "temp" : "image");
+                v4l2_reactor_channel_stop(reactor, channel);
+                streaming_num--;
+                pipeline_stop(channel->pipeline);
+                continue;
+            }
+            FrameBuffer_t* buffer = v4l2_mmap_frame_dequeue_ready(channel->mmap_handle);
+            if (buffer != NULL)
+            {
+                channel->frames++;
+                v4l2_channel_frame_dispatch(&channel->pipeline->stream_frame_info, buffer, channel->is_temp);
+            }
+        }
+
+        for (int i = 0; i < reactor->channel_num; i++)
+        {
+            V4l2ReactorChannel_t* channel = &reactor->channels[i];
+            if (channel->streaming && !channel->pipeline->is_running)
+            {
+                v4l2_reactor_channel_stop(reactor, channel);
+                streaming_num--;
+            }
+        }
+    }
+
+    for (int i = 0; i < reactor->channel_num; i++)
+    {
+        if (reactor->channels[i].streaming)
+        {
+            v4l2_reactor_channel_stop(reactor, &reactor->channels[i]);
+        }
+    }
+    return NULL;
+}
+
+int v4l2_reactor_delete(V4l2Reactor_t* reactor)
+{
+    if (reactor == NULL)
+    {
+        return -1;
+    }
+
+    close(reactor->epoll_fd);
+    delete reactor;
+    return 0;
+}
@@ -0,0 +1,31 @@
+#ifndef V4L2_REACTOR_H_
+#define V4L2_REACTOR_H_
+
+#include "data.h"
+#include "pipeline.h"
+#include "v4l2_camera.h"
+
+#define V4L2_REACTOR_MAX_CHANNELS   32
+
+//one capture thread for the v4l2 nodes of many cameras: every image/temp node is registered with one epoll set,
+//whichever node has a frame done is dequeued and the frame goes to the pipeline of its camera.
+//replaces v4l2_stream_function/v4l2_image_channel_stream_function/v4l2_temp_channel_stream_function of the added pipelines
+typedef struct V4l2Reactor_s V4l2Reactor_t;
+
+V4l2Reactor_t* v4l2_reactor_create(void);
+
+//register the image node and, for mipi 2vc(stream_frame_info.frame_pair created), the temp node of the pipeline.
+//the driver handles must be created by v4l2_image/temp_driver_handle_create in camera::v4l2_capture_mode "mmap",
+//dvp frames which need converting are left to v4l2_stream_function. the frame ring must be camera::frame_ring_policy
+//drop_oldest, the frames of all cameras are committed from the one capture thread
+int v4l2_reactor_add_pipeline(V4l2Reactor_t* reactor, Pipeline_t* pipeline);
+
+//capture thread, threadarg is the reactor. opens and starts every registered node and dispatches the frames
+//until all pipelines are stopped, each node is stopped and closed as soon as its pipeline is. a node reporting an
+//error(camera unplugged) stops its pipeline
+void* v4l2_reactor_function(void* threadarg);
+
+//after v4l2_reactor_function returned
+int v4l2_reactor_delete(V4l2Reactor_t* reactor);
+
+#endif
@@ -2,26 +2,11 @@
 #define _CAPTURE_
 
 #include "data.h"
-#include <sys/timeb.h>
+#include "pipeline.h"
+#include "frame_ring.h"
+#include "jpeg_encoder.h"
 
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-#include "libavcodec/avcodec.h"
-#include "libavformat/avformat.h"
-#include "libavutil/avutil.h"
-#include "libswscale/swscale.h"
-#include "libavdevice/avdevice.h"
-#include "libavformat/avio.h"
-#include "libavutil/imgutils.h"
-
-
-//capture thread, save the raw frame image to jpg
+//capture thread, a frame ring consumer saving the image of a frame to jpg every second
 void *capture_function(void *threadarg);
 
-#ifdef __cplusplus
-}
-#endif
-
 #endif
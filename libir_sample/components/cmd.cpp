@@ -422,11 +422,11 @@ void command_sel(int cmd_type, StreamFrameInfo_t* handle)
     {
     case 8:
 #if defined(_WIN32)
-        ReleaseSemaphore(temp_sem, 1, NULL);
-        WaitForSingleObject(cmd_sem, INFINITE);
+        ReleaseSemaphore(handle->pipeline->temp_sem, 1, NULL);
+        WaitForSingleObject(handle->pipeline->cmd_sem, INFINITE);
 #elif defined(linux) || defined(unix)
-        sem_post(&temp_sem);
-        sem_wait(&cmd_sem);
+        sem_post(&handle->pipeline->temp_sem);
+        sem_wait(&handle->pipeline->cmd_sem);
 #endif
         break;
     }
@@ -13,6 +13,7 @@
 #endif
 
 #include "data.h"
+#include "pipeline.h"
 #include "libiruart.h"
 
 #define PATH_INVALID    0
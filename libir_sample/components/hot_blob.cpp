@@ -0,0 +1,635 @@
+#include "hot_blob.h"
+#include <stdio.h>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HOT_BLOB_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define HOT_BLOB_NEON
+#include <arm_neon.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using std::vector;
+
+//hot pixels start~end of one row, both included
+typedef struct {
+    int start;
+    int end;
+    int label;
+}HotBlobRun_t;
+
+//the stats of a blob while the frame is read, those of a root only once it was joined to others
+typedef struct {
+    uint16_t start_x;
+    uint16_t start_y;
+    uint16_t end_x;
+    uint16_t end_y;
+    uint32_t pixel_num;
+    uint16_t max_value;
+    uint16_t max_x;
+    uint16_t max_y;
+    float max_celsius;
+    uint64_t sum;
+    double celsius_sum;
+}HotBlobNode_t;
+
+struct HotBlob_s {
+    int width;
+    int height;
+    int max_run_num;
+    vector<uint32_t> mask;          //hot pixels of the row, pixel x at bit x % 32 of word x / 32
+    vector<uint32_t> reach;         //pixels with a hot pixel within the join gap after them, themselves included
+    vector<uint32_t> joined;        //the mask with its gaps up to the join gap filled
+    vector<HotBlobRun_t> runs;      //runs, or segments, of the row, width / 2 + 1 at most
+    vector<HotBlobRun_t> last_runs; //of the row above
+    vector<int> parents;            //union-find of the nodes, apart from their stats so a find stays in cache
+    vector<HotBlobNode_t> nodes;
+    vector<HotBlobInfo_t> blobs;
+};
+
+HotBlob_t* hot_blob_create(int width, int height, int max_run_num)
+{
+    if (width <= 0 || height <= 0 || width > 65536 || height > 65536 || max_run_num < 0)
+    {
+        printf("hot_blob_create: invalid param\n");
+        return NULL;
+    }
+
+    HotBlob_t* hot_blob = new HotBlob_t;
+    hot_blob->width = width;
+    hot_blob->height = height;
+    hot_blob->max_run_num = max_run_num;
+    hot_blob->mask.resize((width + 31) / 32);
+    hot_blob->reach.resize((width + 31) / 32);
+    hot_blob->joined.resize((width + 31) / 32);
+    hot_blob->runs.resize(width / 2 + 1);
+    hot_blob->last_runs.resize(width / 2 + 1);
+    return hot_blob;
+}
+
+void hot_blob_destroy(HotBlob_t* hot_blob)
+{
+    delete hot_blob;
+}
+
+static int hot_blob_ctz(uint32_t value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (int)index;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+static int hot_blob_popcount(uint32_t value)
+{
+#if defined(_MSC_VER)
+    value = value - ((value >> 1) & 0x55555555);
+    value = (value & 0x33333333) + ((value >> 2) & 0x33333333);
+    return (int)((((value + (value >> 4)) & 0x0f0f0f0f) * 0x01010101) >> 24);
+#else
+    return __builtin_popcount(value);
+#endif
+}
+
+//cut a mask of bit_num(32 at most) pixels from x into runs, bit i set for a hot pixel x + i. run_start is the start
+//of the run still open at x, -1 if none. every bit differing from the one before starts or ends a run
+static void hot_blob_mask_runs(uint32_t mask, int bit_num, int x, int* run_start, HotBlobRun_t* runs, int* run_num)
+{
+    uint32_t open = (*run_start >= 0) ? 1 : 0;
+    uint32_t edges = (mask ^ ((mask << 1) | open)) & ((bit_num < 32) ? (1u << bit_num) - 1 : 0xffffffffu);
+    while (edges != 0)
+    {
+        int bit = hot_blob_ctz(edges);
+        edges &= edges - 1;
+        if (*run_start < 0)
+        {
+            *run_start = x + bit;
+        }
+        else
+        {
+            runs[*run_num].start = *run_start;
+            runs[*run_num].end = x + bit - 1;
+            (*run_num)++;
+            *run_start = -1;
+        }
+    }
+}
+
+//the mask of the pixels at or above the threshold, the bits past the width cleared
+static void hot_blob_row_mask(const uint16_t* row, int width, uint16_t threshold, uint32_t* mask)
+{
+    int word_num = (width + 31) / 32;
+    for (int i = 0; i < word_num; i++)
+    {
+        mask[i] = 0;
+    }
+    int x = 0;
+#if defined(HOT_BLOB_SSE2)
+    //unsigned pixel >= threshold when threshold - pixel saturates to 0
+    __m128i threshold_vec = _mm_set1_epi16((short)threshold);
+    __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i hot0 = _mm_cmpeq_epi16(_mm_subs_epu16(threshold_vec, _mm_loadu_si128((const __m128i*)(row + x))), zero);
+        __m128i hot1 = _mm_cmpeq_epi16(_mm_subs_epu16(threshold_vec, _mm_loadu_si128((const __m128i*)(row + x + 8))), zero);
+        mask[x / 32] |= (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(hot0, hot1)) << (x % 32);
+    }
+#elif defined(HOT_BLOB_NEON)
+    uint16x8_t threshold_vec = vdupq_n_u16(threshold);
+    for (; x + 8 <= width; x += 8)
+    {
+        uint8x8_t hot = vmovn_u16(vcgeq_u16(vld1q_u16(row + x), threshold_vec));
+        uint64_t bytes = vget_lane_u64(vreinterpret_u64_u8(hot), 0);
+        //one bit of every byte gathered into the top byte
+        mask[x / 32] |= (uint32_t)(((bytes & 0x8040201008040201ULL) * 0x0101010101010101ULL) >> 56) << (x % 32);
+    }
+#endif
+    for (; x < width; x++)
+    {
+        mask[x / 32] |= ((row[x] >= threshold) ? 1u : 0u) << (x % 32);
+    }
+}
+
+//clear the pixels of the mask, those over the y16 bound, below threshold_temp
+static void hot_blob_celsius_mask(const float* celsius_row, float threshold_temp, uint32_t* mask, int word_num)
+{
+    for (int i = 0; i < word_num; i++)
+    {
+        uint32_t bits = mask[i];
+        uint32_t cold = 0;
+        while (bits != 0)
+        {
+            int bit = hot_blob_ctz(bits);
+            bits &= bits - 1;
+            cold |= ((celsius_row[i * 32 + bit] < threshold_temp) ? 1u : 0u) << bit;
+        }
+        mask[i] &= ~cold;
+    }
+}
+
+//the runs of a row mask, in order
+static int hot_blob_mask_row_runs(const uint32_t* mask, int width, HotBlobRun_t* runs)
+{
+    int run_num = 0;
+    int run_start = -1;
+    for (int x = 0; x < width; x += 32)
+    {
+        hot_blob_mask_runs(mask[x / 32], (width - x < 32) ? width - x : 32, x, &run_start, runs, &run_num);
+    }
+    if (run_start >= 0)
+    {
+        runs[run_num].start = run_start;
+        runs[run_num].end = width - 1;
+        run_num++;
+    }
+    return run_num;
+}
+
+//the runs of a row mask counted by their first pixels, a hot pixel after a cold one
+static int hot_blob_mask_run_num(const uint32_t* mask, int word_num)
+{
+    int run_num = 0;
+    uint32_t carry = 0;
+    for (int i = 0; i < word_num; i++)
+    {
+        run_num += hot_blob_popcount(mask[i] & ~((mask[i] << 1) | carry));
+        carry = mask[i] >> 31;
+    }
+    return run_num;
+}
+
+//or every pixel of the mask with the one shift(1 or more) pixels after it, in place from the start of the row so the
+//words read are not changed yet. the pixels past the row are cold
+static void hot_blob_mask_reach(uint32_t* mask, int word_num, int shift)
+{
+    int word_shift = shift / 32;
+    int bit_shift = shift % 32;
+    for (int i = 0; i + word_shift < word_num; i++)
+    {
+        uint32_t near_word = mask[i + word_shift];
+        uint32_t far_word = (i + word_shift + 1 < word_num) ? mask[i + word_shift + 1] : 0;
+        mask[i] |= (near_word >> bit_shift) | ((bit_shift != 0) ? far_word << (32 - bit_shift) : 0);
+    }
+}
+
+//join the run_num(more than share) runs of the row mask over the gaps of cold pixels up to 1, 3, 7 ... pixels, the
+//first leaving share runs at most, into joined and return it. a gap is that short when a hot pixel is within reach of
+//its first pixel, each wider gap doubles the reach of the one before by a single shift, and the gaps found are
+//filled by adding their first pixels to the cold ones: the carry runs over the gap up to the hot pixel ending it. a
+//row costs a few passes over its words whatever its runs
+static int hot_blob_join_mask(HotBlob_t* hot_blob, int run_num, int share)
+{
+    int word_num = (int)hot_blob->mask.size();
+    const uint32_t* mask = &hot_blob->mask[0];
+    uint32_t* reach = &hot_blob->reach[0];
+    uint32_t* joined = &hot_blob->joined[0];
+    //the first pixels of the gaps, cold after a hot one
+    uint32_t carry = 0;
+    for (int i = 0; i < word_num; i++)
+    {
+        joined[i] = ~mask[i] & ((mask[i] << 1) | carry);
+        carry = mask[i] >> 31;
+        reach[i] = mask[i];
+    }
+    int gap = 0;
+    int join_num = 0;
+    do
+    {
+        hot_blob_mask_reach(reach, word_num, gap + 1);
+        gap = 2 * gap + 1;
+        join_num = 0;
+        for (int i = 0; i < word_num; i++)
+        {
+            join_num += hot_blob_popcount(joined[i] & reach[i]);
+        }
+    } while (run_num - join_num > share);
+
+    carry = 0;
+    for (int i = 0; i < word_num; i++)
+    {
+        uint32_t cold = ~mask[i];
+        uint64_t sum = (uint64_t)cold + (joined[i] & reach[i]) + carry;
+        carry = (uint32_t)(sum >> 32);
+        joined[i] = mask[i] | (cold & ~(uint32_t)sum);
+    }
+    return gap;
+}
+
+static int hot_blob_find(int* parents, int label)
+{
+    while (parents[label] != label)
+    {
+        parents[label] = parents[parents[label]];
+        label = parents[label];
+    }
+    return label;
+}
+
+//whether the max of b comes before the one of a, a greater value or the same one earlier in raster order
+static bool hot_blob_max_before(const HotBlobNode_t& a, const HotBlobNode_t& b, bool use_celsius)
+{
+    if (use_celsius ? (b.max_celsius != a.max_celsius) : (b.max_value != a.max_value))
+    {
+        return use_celsius ? (b.max_celsius > a.max_celsius) : (b.max_value > a.max_value);
+    }
+    return b.max_y < a.max_y || (b.max_y == a.max_y && b.max_x < a.max_x);
+}
+
+static void hot_blob_merge_stats(HotBlobNode_t* dst, const HotBlobNode_t& src, bool use_celsius)
+{
+    dst->start_x = (src.start_x < dst->start_x) ? src.start_x : dst->start_x;
+    dst->start_y = (src.start_y < dst->start_y) ? src.start_y : dst->start_y;
+    dst->end_x = (src.end_x > dst->end_x) ? src.end_x : dst->end_x;
+    dst->end_y = (src.end_y > dst->end_y) ? src.end_y : dst->end_y;
+    dst->pixel_num += src.pixel_num;
+    dst->sum += src.sum;
+    dst->celsius_sum += src.celsius_sum;
+    if (hot_blob_max_before(*dst, src, use_celsius))
+    {
+        dst->max_value = src.max_value;
+        dst->max_x = src.max_x;
+        dst->max_y = src.max_y;
+        dst->max_celsius = src.max_celsius;
+    }
+}
+
+//join the blobs of two roots into the older one, the first in raster order, so a root is the first run of its blob
+static int hot_blob_union(int* parents, HotBlobNode_t* nodes, int a, int b, bool use_celsius)
+{
+    int root = (a < b) ? a : b;
+    int child = (a < b) ? b : a;
+    parents[child] = root;
+    hot_blob_merge_stats(&nodes[root], nodes[child], use_celsius);
+    return root;
+}
+
+//the max and the sum of the pixels at or above threshold among pixel_num pixels, 0 for those below. the vectors sum
+//16 bit pixels into 32 bit lanes, a row is 65536 pixels at most so a lane never overflows
+static void hot_blob_run_scan(const uint16_t* y16, int pixel_num, uint16_t threshold, uint16_t* max_value, \
+    uint64_t* sum)
+{
+    uint16_t max_v = 0;
+    uint64_t total = 0;
+    int i = 0;
+#if defined(HOT_BLOB_SSE2)
+    //SSE2 only has a signed 16 bit max, the values are moved to the signed range by flipping the top bit
+    const __m128i bias = _mm_set1_epi16((short)0x8000);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i threshold_vec = _mm_set1_epi16((short)threshold);
+    __m128i max_vec = bias;
+    __m128i sum_vec = zero;
+    for (; i + 8 <= pixel_num; i += 8)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(y16 + i));
+        //unsigned pixel >= threshold when threshold - pixel saturates to 0
+        x = _mm_and_si128(x, _mm_cmpeq_epi16(_mm_subs_epu16(threshold_vec, x), zero));
+        max_vec = _mm_max_epi16(max_vec, _mm_xor_si128(x, bias));
+        sum_vec = _mm_add_epi32(sum_vec, _mm_add_epi32(_mm_unpacklo_epi16(x, zero), _mm_unpackhi_epi16(x, zero)));
+    }
+    uint16_t max_lanes[8];
+    uint32_t sum_lanes[4];
+    _mm_storeu_si128((__m128i*)max_lanes, _mm_xor_si128(max_vec, bias));
+    _mm_storeu_si128((__m128i*)sum_lanes, sum_vec);
+    for (int lane = 0; lane < 8; lane++)
+    {
+        max_v = (max_lanes[lane] > max_v) ? max_lanes[lane] : max_v;
+    }
+    total = (uint64_t)sum_lanes[0] + sum_lanes[1] + sum_lanes[2] + sum_lanes[3];
+#elif defined(HOT_BLOB_NEON)
+    uint16x8_t threshold_vec = vdupq_n_u16(threshold);
+    uint16x8_t max_vec = vdupq_n_u16(0);
+    uint32x4_t sum_vec = vdupq_n_u32(0);
+    for (; i + 8 <= pixel_num; i += 8)
+    {
+        uint16x8_t x = vld1q_u16(y16 + i);
+        x = vandq_u16(x, vcgeq_u16(x, threshold_vec));
+        max_vec = vmaxq_u16(max_vec, x);
+        sum_vec = vpadalq_u16(sum_vec, x);
+    }
+    uint16_t max_lanes[8];
+    vst1q_u16(max_lanes, max_vec);
+    for (int lane = 0; lane < 8; lane++)
+    {
+        max_v = (max_lanes[lane] > max_v) ? max_lanes[lane] : max_v;
+    }
+    uint64x2_t sum_pair = vpaddlq_u32(sum_vec);
+    total = vgetq_lane_u64(sum_pair, 0) + vgetq_lane_u64(sum_pair, 1);
+#endif
+    for (; i < pixel_num; i++)
+    {
+        uint16_t value = (y16[i] >= threshold) ? y16[i] : 0;
+        max_v = (value > max_v) ? value : max_v;
+        total += value;
+    }
+    *max_value = max_v;
+    *sum = total;
+}
+
+//the first x of start~end of a value the row holds there
+static int hot_blob_first_value(const uint16_t* row, int start, int end, uint16_t value)
+{
+    int x = start;
+#if defined(HOT_BLOB_SSE2)
+    __m128i value_vec = _mm_set1_epi16((short)value);
+    for (; x + 8 <= end + 1; x += 8)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128((const __m128i*)(row + x)), value_vec));
+        if (mask != 0)
+        {
+            return x + hot_blob_ctz((uint32_t)mask) / 2;
+        }
+    }
+#endif
+    while (row[x] != value)
+    {
+        x++;
+    }
+    return x;
+}
+
+//the stats of the pixels of one run
+static void hot_blob_run_stats(const uint16_t* row, const float* celsius_row, int y, const HotBlobRun_t& run, \
+    HotBlobNode_t* node)
+{
+    node->start_x = (uint16_t)run.start;
+    node->start_y = (uint16_t)y;
+    node->end_x = (uint16_t)run.end;
+    node->end_y = (uint16_t)y;
+    node->pixel_num = run.end - run.start + 1;
+    node->max_value = row[run.start];
+    node->max_x = (uint16_t)run.start;
+    node->max_y = (uint16_t)y;
+    node->max_celsius = 0;
+    node->sum = 0;
+    node->celsius_sum = 0;
+    if (celsius_row == NULL && node->pixel_num >= 8)
+    {
+        //one scan for the max and the sum, then a search for the first max
+        hot_blob_run_scan(row + run.start, node->pixel_num, 0, &node->max_value, &node->sum);
+        node->max_x = (uint16_t)hot_blob_first_value(row, run.start, run.end, node->max_value);
+        return;
+    }
+    if (celsius_row == NULL)
+    {
+        uint64_t sum = 0;
+        for (int x = run.start; x <= run.end; x++)
+        {
+            sum += row[x];
+            if (row[x] > node->max_value)
+            {
+                node->max_value = row[x];
+                node->max_x = (uint16_t)x;
+            }
+        }
+        node->sum = sum;
+        return;
+    }
+
+    double celsius_sum = 0;
+    node->max_celsius = celsius_row[run.start];
+    for (int x = run.start; x <= run.end; x++)
+    {
+        celsius_sum += celsius_row[x];
+        if (celsius_row[x] > node->max_celsius)
+        {
+            node->max_celsius = celsius_row[x];
+            node->max_value = row[x];
+            node->max_x = (uint16_t)x;
+        }
+    }
+    node->celsius_sum = celsius_sum;
+}
+
+//the bits of the row mask word of x, a multiple of 32, within the segment
+static inline uint32_t hot_blob_segment_bits(const uint32_t* mask, const HotBlobRun_t& segment, int x)
+{
+    uint32_t bits = mask[x / 32];
+    bits &= (x < segment.start) ? ~((1u << (segment.start - x)) - 1) : 0xffffffffu;
+    bits &= (segment.end - x < 31) ? (1u << (segment.end - x + 1)) - 1 : 0xffffffffu;
+    return bits;
+}
+
+//the stats of the hot pixels of a segment, its first and last pixels are hot. in y16 they are those at or above
+//threshold, the one of the mask, in celsius those of the mask
+static void hot_blob_segment_stats(const uint16_t* row, const float* celsius_row, int y, uint16_t threshold, \
+    const uint32_t* mask, const HotBlobRun_t& segment, HotBlobNode_t* node)
+{
+    node->start_x = (uint16_t)segment.start;
+    node->start_y = (uint16_t)y;
+    node->end_x = (uint16_t)segment.end;
+    node->end_y = (uint16_t)y;
+    node->max_value = row[segment.start];
+    node->max_x = (uint16_t)segment.start;
+    node->max_y = (uint16_t)y;
+    node->max_celsius = 0;
+    node->sum = 0;
+    node->celsius_sum = 0;
+    uint32_t pixel_num = 0;
+    if (celsius_row == NULL)
+    {
+        for (int x = segment.start & ~31; x <= segment.end; x += 32)
+        {
+            pixel_num += hot_blob_popcount(hot_blob_segment_bits(mask, segment, x));
+        }
+        //the max is hot, so the first pixel of its value is the first hot one
+        hot_blob_run_scan(row + segment.start, segment.end - segment.start + 1, threshold, &node->max_value, \
+            &node->sum);
+        node->max_x = (uint16_t)hot_blob_first_value(row, segment.start, segment.end, node->max_value);
+        node->pixel_num = pixel_num;
+        return;
+    }
+
+    double celsius_sum = 0;
+    node->max_celsius = celsius_row[segment.start];
+    for (int x = segment.start & ~31; x <= segment.end; x += 32)
+    {
+        uint32_t bits = hot_blob_segment_bits(mask, segment, x);
+        while (bits != 0)
+        {
+            int hot_x = x + hot_blob_ctz(bits);
+            bits &= bits - 1;
+            pixel_num++;
+            celsius_sum += celsius_row[hot_x];
+            if (celsius_row[hot_x] > node->max_celsius)
+            {
+                node->max_celsius = celsius_row[hot_x];
+                node->max_value = row[hot_x];
+                node->max_x = (uint16_t)hot_x;
+            }
+        }
+    }
+    node->pixel_num = pixel_num;
+    node->celsius_sum = celsius_sum;
+}
+
+int hot_blob_detect(HotBlob_t* hot_blob, const uint16_t* y16_data, const float* celsius_data, uint16_t threshold, \
+    float threshold_temp, uint32_t min_pixel_num, HotBlobResult_t* result)
+{
+    if (hot_blob == NULL || y16_data == NULL || result == NULL)
+    {
+        printf("hot_blob_detect: invalid param\n");
+        return -1;
+    }
+
+    int width = hot_blob->width;
+    int word_num = (int)hot_blob->mask.size();
+    bool use_celsius = (celsius_data != NULL);
+    vector<int>& parents = hot_blob->parents;
+    vector<HotBlobNode_t>& nodes = hot_blob->nodes;
+    parents.clear();
+    nodes.clear();
+    int last_run_num = 0;
+    int run_num = 0;
+    int label_num = 0;      //runs and segments labelled
+    int join_row_num = 0;
+    int join_gap = 0;
+    for (int y = 0; y < hot_blob->height; y++)
+    {
+        const uint16_t* row = y16_data + y * width;
+        const float* celsius_row = use_celsius ? celsius_data + y * width : NULL;
+        HotBlobRun_t* runs = &hot_blob->runs[0];
+        const HotBlobRun_t* last_runs = &hot_blob->last_runs[0];
+        hot_blob_row_mask(row, width, threshold, &hot_blob->mask[0]);
+        if (use_celsius)
+        {
+            hot_blob_celsius_mask(celsius_row, threshold_temp, &hot_blob->mask[0], word_num);
+        }
+        int row_run_num = hot_blob_mask_run_num(&hot_blob->mask[0], word_num);
+        run_num += row_run_num;
+
+        //a row of more runs than its share of the budget left is labelled in segments, its runs joined over gaps of
+        //cold pixels. every row is labelled, the blobs close to each other in such rows come out as one
+        bool is_joined = false;
+        if (hot_blob->max_run_num > 0 && row_run_num > 1)
+        {
+            int share = (hot_blob->max_run_num - label_num) / (hot_blob->height - y);
+            share = (share < 1) ? 1 : share;
+            if (row_run_num > share)
+            {
+                int gap = hot_blob_join_mask(hot_blob, row_run_num, share);
+                is_joined = true;
+                join_row_num++;
+                join_gap = (gap > join_gap) ? gap : join_gap;
+            }
+        }
+        const uint32_t* label_mask = is_joined ? &hot_blob->joined[0] : &hot_blob->mask[0];
+        int row_label_num = hot_blob_mask_row_runs(label_mask, width, runs);
+        label_num += row_label_num;
+
+        int first = 0;  //the first run above which may touch the run
+        for (int i = 0; i < row_label_num; i++)
+        {
+            HotBlobRun_t& run = runs[i];
+            HotBlobNode_t run_node;
+            if (is_joined)
+            {
+                hot_blob_segment_stats(row, celsius_row, y, threshold, &hot_blob->mask[0], run, &run_node);
+            }
+            else
+            {
+                hot_blob_run_stats(row, celsius_row, y, run, &run_node);
+            }
+
+            //8-connected, a run above touches from one column before to one column after
+            while (first < last_run_num && last_runs[first].end + 1 < run.start)
+            {
+                first++;
+            }
+            int label = -1;
+            for (int j = first; j < last_run_num && last_runs[j].start <= run.end + 1; j++)
+            {
+                int root = hot_blob_find(&parents[0], last_runs[j].label);
+                label = (label < 0 || root == label) ? root : hot_blob_union(&parents[0], &nodes[0], label, root, use_celsius);
+            }
+            if (label < 0)
+            {
+                label = (int)nodes.size();
+                parents.push_back(label);
+                nodes.push_back(run_node);
+            }
+            else
+            {
+                hot_blob_merge_stats(&nodes[label], run_node, use_celsius);
+            }
+            run.label = label;
+        }
+        hot_blob->runs.swap(hot_blob->last_runs);
+        last_run_num = row_label_num;
+    }
+
+    hot_blob->blobs.clear();
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        const HotBlobNode_t& node = nodes[i];
+        if (parents[i] != (int)i || node.pixel_num < min_pixel_num)
+        {
+            continue;
+        }
+        HotBlobInfo_t blob;
+        blob.start_x = node.start_x;
+        blob.start_y = node.start_y;
+        blob.end_x = node.end_x;
+        blob.end_y = node.end_y;
+        blob.pixel_num = node.pixel_num;
+        blob.max_value = node.max_value;
+        blob.max_x = node.max_x;
+        blob.max_y = node.max_y;
+        blob.max_temp = use_celsius ? node.max_celsius : (float)(node.max_value / 64.0 - 273.15);
+        blob.ave_temp = use_celsius ? (float)(node.celsius_sum / node.pixel_num) \
+            : (float)((double)node.sum / node.pixel_num / 64 - 273.15);
+        hot_blob->blobs.push_back(blob);
+    }
+    result->blob_num = (int)hot_blob->blobs.size();
+    result->blobs = hot_blob->blobs.empty() ? NULL : &hot_blob->blobs[0];
+    result->run_num = run_num;
+    result->join_row_num = join_row_num;
+    result->join_gap = join_gap;
+    return 0;
+}
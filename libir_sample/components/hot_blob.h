@@ -0,0 +1,51 @@
+#ifndef _HOT_BLOB_H_
+#define _HOT_BLOB_H_
+
+#include <stdint.h>
+
+//the hot regions of a y16 temp frame(1/64 kelvin), or of its corrected celsius frame: the pixels at or above a
+//threshold, 8-connected into blobs. the frame is read once top to bottom, each row thresholded on y16 with SSE2/NEON
+//into a bit mask cut into runs of hot pixels. a run touching runs of the row above joins their blobs by union-find,
+//the stats of the blobs merged as they join, so only the runs of two rows are kept whatever the frame size
+typedef struct HotBlob_s HotBlob_t;
+
+//coordinates start from 0, like Roi_t of roi_temp
+typedef struct {
+    uint16_t start_x;       //bounding box, the boundary included
+    uint16_t start_y;
+    uint16_t end_x;
+    uint16_t end_y;
+    uint32_t pixel_num;
+    float max_temp;         //celsius
+    float ave_temp;
+    uint16_t max_value;     //y16
+    uint16_t max_x;         //the first max in raster order
+    uint16_t max_y;
+}HotBlobInfo_t;
+
+typedef struct {
+    int blob_num;
+    HotBlobInfo_t* blobs;   //in raster order of their first pixel, kept by the detector until the next detect
+    int run_num;            //hot runs of the frame, blobs included or not
+    int join_row_num;       //rows labelled in segments to stay within max_run_num, 0 if the blobs are exact
+    int join_gap;           //the widest gap of cold pixels joined in those rows, 1, 3, 7 ...
+}HotBlobResult_t;
+
+//the labelling costs about the same per run whatever the scene, max_run_num(0 for no limit) bounds the runs labelled
+//in a frame breaking into too many, like noise around a threshold set at the background temperature. every row gets a
+//share of the budget left, a row of more runs is labelled in segments: its runs joined over every gap of cold pixels
+//up to 1, 3, 7 ... pixels, the first width to fit, found on its bit mask without cutting it into runs. a segment costs
+//about two runs. all rows are labelled and the pixel number, max and average of a blob still count its hot pixels
+//only, but blobs separated by such gaps come out as one
+HotBlob_t* hot_blob_create(int width, int height, int max_run_num);
+
+void hot_blob_destroy(HotBlob_t* hot_blob);
+
+//the blobs of min_pixel_num pixels or more at or above threshold(y16) of a frame of the detector size.
+//with the corrected celsius frame of the y16 frame, like the one of temp_correct_map_apply, the blobs are the pixels
+//at or above threshold_temp(celsius) and their max and average are corrected. threshold is then a y16 bound at or
+//below every pixel reaching threshold_temp, like temp_correct_map_y16_bound, only the runs over it are read in celsius
+int hot_blob_detect(HotBlob_t* hot_blob, const uint16_t* y16_data, const float* celsius_data, uint16_t threshold, \
+    float threshold_temp, uint32_t min_pixel_num, HotBlobResult_t* result);
+
+#endif
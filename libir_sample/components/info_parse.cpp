@@ -5,6 +5,8 @@ void* info_line_parse_function(void* threadarg)
     printf("info_line_parse_function start\n");
     StreamFrameInfo_t* stream_frame_info;
     stream_frame_info = (StreamFrameInfo_t*)threadarg;
+    StreamFrameInfo_t frame_view;
+    FrameSlot_t slot;
     uint8_t* info_line_data = NULL;
 	IrinfoStatusInfo_t status_info;
 	IrinfoTestInfo_t test_info;
@@ -15,21 +17,28 @@ void* info_line_parse_function(void* threadarg)
 	{
 		return NULL;
 	}
+	if (stream_frame_info->information_line.byte_size == 0)
+	{
+		printf("No current information line\n");
+		return NULL;
+	}
+	frame_view = *stream_frame_info;
+	int consumer_id = frame_ring_add_consumer(frame_view.frame_ring);
+	if (consumer_id < 0)
+	{
+		return NULL;
+	}
 	fp = fopen("info_line.txt", "w+t");
-    while (isRUNNING)
+    while (stream_frame_info->pipeline->is_running)
     {
-        if ((stream_frame_info->information_line.byte_size == 0) || (stream_frame_info->information_line.data == NULL))
+        if (frame_ring_read(frame_view.frame_ring, consumer_id, &slot) != 0)
         {
-			printf("No current information line\n");
             break;
         }
-#if defined(_WIN32)
-        WaitForSingleObject(info_sem, INFINITE);	//waitting for info_line signal
-#elif defined(linux) || defined(unix)
-        sem_wait(&info_sem);
-#endif
-        irinfoparse_get_irinfo_status_info(stream_frame_info->information_line.data, &status_info);
-		irinfoparse_get_irinfo_function_info(stream_frame_info->information_line.data, &function_info);
+        bind_stream_frame_info(&frame_view, slot.raw_buffer, slot.raw_temp_buffer);
+        info_line_data = frame_view.information_line.data;
+        irinfoparse_get_irinfo_status_info(info_line_data, &status_info);
+		irinfoparse_get_irinfo_function_info(info_line_data, &function_info);
 		printf( "----------------------------------------------\n");
    		printf("frame_fps = %d,width = %d,height = %d\n",\
 			status_info.frame_status.frame_fps,function_info.device_info.width,function_info.device_info.height);
@@ -39,13 +48,10 @@ void* info_line_parse_function(void* threadarg)
 		printf( "temp_type = %d\n",status_info.tpd_status.temp_type);
 		printf( "dev_pn = %s\n",function_info.device_info.dev_pn);
 		printf( "------------------------------------------------\n");
-		memset(stream_frame_info->information_line.data, 0, stream_frame_info->information_line.byte_size);
-#if defined(_WIN32)
-        ReleaseSemaphore(info_done_sem, 1, NULL);
-#elif defined(linux) || defined(unix)
-        sem_post(&info_done_sem);
-#endif
+		//the frame is shared with the other consumers, leave the information line untouched
+		frame_ring_release(&slot);
     }
+	frame_ring_remove_consumer(frame_view.frame_ring, consumer_id);
 	fclose(fp);
     return NULL;
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #define _INFO_PARSING_FUNCTION_
 
 #include "data.h"
+#include "pipeline.h"
+#include "frame_ring.h"
 #include "libir_infoparse.h"
 
 
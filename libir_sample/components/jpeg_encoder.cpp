@@ -0,0 +1,346 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "jpeg_encoder.h"
+#include "pixel_convert.h"
+#include <string.h>
+#include <vector>
+
+#if defined(_WIN32)
+#define HAVE_STRUCT_TIMESPEC
+#endif
+#include <pthread.h>
+
+extern "C" {
+#include "libavcodec/avcodec.h"
+#include "libavutil/avutil.h"
+#include "libavutil/frame.h"
+}
+
+using std::vector;
+
+//fixed quantizer, every snapshot is encoded alike whatever the codec encoded before
+#define JPEG_ENCODER_QSCALE     3
+
+typedef struct {
+    FrameBuffer_t* buffer;      //referenced until the job is encoded
+    uint8_t* data;
+    int width;
+    int height;
+    JpegInputFormat_e format;
+    char file_name[JPEG_FILE_NAME_LEN];
+}JpegJob_t;
+
+//an opened codec of one size and pixel format, with the frame the planes are split into and the packet it encodes to
+typedef struct {
+    int width;
+    int height;
+    AVPixelFormat pix_fmt;
+    AVCodecContext* codec_ctx;
+    AVFrame* frame;
+    AVPacket* packet;
+}JpegCodec_t;
+
+typedef struct {
+    JpegEncoder_t* encoder;
+    pthread_t thread;
+    vector<JpegCodec_t*> codecs;
+}JpegWorker_t;
+
+struct JpegEncoder_s {
+    vector<JpegWorker_t> workers;
+    vector<JpegJob_t> queue;
+    int queue_head;
+    int queue_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t job_cond;
+    bool quit;
+    uint64_t dropped;
+};
+
+static void jpeg_codec_close(JpegCodec_t* codec)
+{
+    av_packet_free(&codec->packet);
+    av_frame_free(&codec->frame);
+    avcodec_free_context(&codec->codec_ctx);
+    delete codec;
+}
+
+static JpegCodec_t* jpeg_codec_open(int width, int height, AVPixelFormat pix_fmt)
+{
+    const AVCodec* av_codec = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    if (av_codec == NULL)
+    {
+        printf("can not find codec!\n");
+        return NULL;
+    }
+
+    JpegCodec_t* codec = new JpegCodec_t;
+    codec->width = width;
+    codec->height = height;
+    codec->pix_fmt = pix_fmt;
+    codec->codec_ctx = avcodec_alloc_context3(av_codec);
+    codec->frame = av_frame_alloc();
+    codec->packet = av_packet_alloc();
+    if (codec->codec_ctx == NULL || codec->frame == NULL || codec->packet == NULL)
+    {
+        printf("there is no more space!\n");
+        jpeg_codec_close(codec);
+        return NULL;
+    }
+
+    AVCodecContext* codec_ctx = codec->codec_ctx;
+    codec_ctx->codec_type = AVMEDIA_TYPE_VIDEO;
+    codec_ctx->pix_fmt = pix_fmt;
+    codec_ctx->width = width;
+    codec_ctx->height = height;
+    codec_ctx->time_base.num = 1;
+    codec_ctx->time_base.den = 25;
+    codec_ctx->flags |= AV_CODEC_FLAG_QSCALE;
+    codec_ctx->global_quality = FF_QP2LAMBDA * JPEG_ENCODER_QSCALE;
+    if (avcodec_open2(codec_ctx, av_codec, NULL) < 0)
+    {
+        printf("con not open codec!\n");
+        jpeg_codec_close(codec);
+        return NULL;
+    }
+
+    //1 byte alignment, the rows of every plane are packed(linesize == width of the plane) like pixel_convert writes them
+    codec->frame->format = pix_fmt;
+    codec->frame->width = width;
+    codec->frame->height = height;
+    codec->frame->pts = 0;
+    if (av_frame_get_buffer(codec->frame, 1) < 0)
+    {
+        printf("malloc picture buf error!\n");
+        jpeg_codec_close(codec);
+        return NULL;
+    }
+    printf("jpeg encoder: codec of %dx%d opened\n", width, height);
+    return codec;
+}
+
+static JpegCodec_t* jpeg_worker_codec(JpegWorker_t* worker, int width, int height, AVPixelFormat pix_fmt)
+{
+    for (size_t i = 0; i < worker->codecs.size(); i++)
+    {
+        JpegCodec_t* codec = worker->codecs[i];
+        if (codec->width == width && codec->height == height && codec->pix_fmt == pix_fmt)
+        {
+            return codec;
+        }
+    }
+
+    JpegCodec_t* codec = jpeg_codec_open(width, height, pix_fmt);
+    if (codec != NULL)
+    {
+        worker->codecs.push_back(codec);
+    }
+    return codec;
+}
+
+static int jpeg_worker_encode(JpegWorker_t* worker, JpegJob_t* job)
+{
+    AVPixelFormat pix_fmt = (job->format == JPEG_INPUT_NV12) ? AV_PIX_FMT_YUVJ420P : AV_PIX_FMT_YUVJ422P;
+    JpegCodec_t* codec = jpeg_worker_codec(worker, job->width, job->height, pix_fmt);
+    if (codec == NULL)
+    {
+        return -1;
+    }
+
+    //the codec may still reference the frame of the last snapshot
+    AVFrame* frame = codec->frame;
+    if (av_frame_make_writable(frame) < 0)
+    {
+        printf("malloc picture buf error!\n");
+        return -1;
+    }
+    if (job->format == JPEG_INPUT_YUYV)
+    {
+        yuyv_to_yuv422p(job->data, job->width, job->height, frame->data[0], frame->data[1], frame->data[2]);
+    }
+    else if (job->format == JPEG_INPUT_UYVY)
+    {
+        uyvy_to_yuv422p(job->data, job->width, job->height, frame->data[0], frame->data[1], frame->data[2]);
+    }
+    else
+    {
+        nv12_to_yuv420p(job->data, job->width, job->height, frame->data[0], frame->data[1], frame->data[2]);
+    }
+    frame->quality = codec->codec_ctx->global_quality;
+    frame->pts++;
+
+    if (avcodec_send_frame(codec->codec_ctx, frame) < 0)
+    {
+        printf("avcodec_send_frame error!\n");
+        return -1;
+    }
+    //mjpeg is intra only, every frame comes out as one packet right away
+    if (avcodec_receive_packet(codec->codec_ctx, codec->packet) < 0)
+    {
+        printf("encodec yuv data error!\n");
+        return -1;
+    }
+
+    //the packet is a complete jpeg file, no muxer needed
+    int ret = 0;
+    FILE* fp = fopen(job->file_name, "wb");
+    if (fp == NULL)
+    {
+        printf("Could not open output file!\n");
+        ret = -1;
+    }
+    else
+    {
+        if (fwrite(codec->packet->data, 1, codec->packet->size, fp) != (size_t)codec->packet->size)
+        {
+            printf("fail to write %s\n", job->file_name);
+            ret = -1;
+        }
+        fclose(fp);
+    }
+    av_packet_unref(codec->packet);
+    return ret;
+}
+
+static void* jpeg_worker_function(void* threadarg)
+{
+    JpegWorker_t* worker = (JpegWorker_t*)threadarg;
+    JpegEncoder_t* encoder = worker->encoder;
+    JpegJob_t job;
+
+    pthread_mutex_lock(&encoder->mutex);
+    while (true)
+    {
+        while (!encoder->quit && encoder->queue_count == 0)
+        {
+            pthread_cond_wait(&encoder->job_cond, &encoder->mutex);
+        }
+        //the jobs queued before the quit are still encoded
+        if (encoder->queue_count == 0)
+        {
+            break;
+        }
+        job = encoder->queue[encoder->queue_head];
+        encoder->queue_head = (encoder->queue_head + 1) % (int)encoder->queue.size();
+        encoder->queue_count--;
+        pthread_mutex_unlock(&encoder->mutex);
+
+        jpeg_worker_encode(worker, &job);
+        frame_buffer_unref(job.buffer);
+
+        pthread_mutex_lock(&encoder->mutex);
+    }
+    pthread_mutex_unlock(&encoder->mutex);
+    return NULL;
+}
+
+JpegEncoder_t* jpeg_encoder_create(int worker_num, int queue_len)
+{
+    if (worker_num <= 0 || queue_len <= 0)
+    {
+        printf("jpeg_encoder_create: invalid param\n");
+        return NULL;
+    }
+
+    JpegEncoder_t* encoder = new JpegEncoder_t;
+    encoder->queue.resize(queue_len);
+    encoder->queue_head = 0;
+    encoder->queue_count = 0;
+    pthread_mutex_init(&encoder->mutex, NULL);
+    pthread_cond_init(&encoder->job_cond, NULL);
+    encoder->quit = false;
+    encoder->dropped = 0;
+
+    encoder->workers.resize(worker_num);
+    for (size_t i = 0; i < encoder->workers.size(); i++)
+    {
+        encoder->workers[i].encoder = encoder;
+        if (pthread_create(&encoder->workers[i].thread, NULL, jpeg_worker_function, &encoder->workers[i]) != 0)
+        {
+            printf("jpeg encoder: create worker %d failed\n", (int)i);
+            encoder->workers.resize(i);
+            break;
+        }
+    }
+    if (encoder->workers.empty())
+    {
+        jpeg_encoder_destroy(encoder);
+        return NULL;
+    }
+    return encoder;
+}
+
+void jpeg_encoder_destroy(JpegEncoder_t* encoder)
+{
+    if (encoder == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&encoder->mutex);
+    encoder->quit = true;
+    pthread_cond_broadcast(&encoder->job_cond);
+    pthread_mutex_unlock(&encoder->mutex);
+    for (size_t i = 0; i < encoder->workers.size(); i++)
+    {
+        pthread_join(encoder->workers[i].thread, NULL);
+        for (size_t j = 0; j < encoder->workers[i].codecs.size(); j++)
+        {
+            jpeg_codec_close(encoder->workers[i].codecs[j]);
+        }
+    }
+
+    //left by workers that failed to start
+    while (encoder->queue_count > 0)
+    {
+        frame_buffer_unref(encoder->queue[encoder->queue_head].buffer);
+        encoder->queue_head = (encoder->queue_head + 1) % (int)encoder->queue.size();
+        encoder->queue_count--;
+    }
+    pthread_cond_destroy(&encoder->job_cond);
+    pthread_mutex_destroy(&encoder->mutex);
+    delete encoder;
+}
+
+int jpeg_encoder_submit(JpegEncoder_t* encoder, FrameBuffer_t* buffer, uint8_t* data, int width, int height, \
+    JpegInputFormat_e format, const char* file_name)
+{
+    if (encoder == NULL || buffer == NULL || data == NULL || file_name == NULL || width <= 0 || height <= 0 \
+        || (width % 2) != 0 || (format == JPEG_INPUT_NV12 && (height % 2) != 0))
+    {
+        printf("jpeg_encoder_submit: invalid param\n");
+        return -1;
+    }
+
+    pthread_mutex_lock(&encoder->mutex);
+    if (encoder->quit || encoder->queue_count == (int)encoder->queue.size())
+    {
+        encoder->dropped++;
+        pthread_mutex_unlock(&encoder->mutex);
+        return -1;
+    }
+    JpegJob_t* job = &encoder->queue[(encoder->queue_head + encoder->queue_count) % (int)encoder->queue.size()];
+    frame_buffer_ref(buffer);
+    job->buffer = buffer;
+    job->data = data;
+    job->width = width;
+    job->height = height;
+    job->format = format;
+    strncpy(job->file_name, file_name, JPEG_FILE_NAME_LEN - 1);
+    job->file_name[JPEG_FILE_NAME_LEN - 1] = '\0';
+    encoder->queue_count++;
+    pthread_cond_signal(&encoder->job_cond);
+    pthread_mutex_unlock(&encoder->mutex);
+    return 0;
+}
+
+uint64_t jpeg_encoder_dropped(JpegEncoder_t* encoder)
+{
+    if (encoder == NULL)
+    {
+        return 0;
+    }
+    pthread_mutex_lock(&encoder->mutex);
+    uint64_t dropped = encoder->dropped;
+    pthread_mutex_unlock(&encoder->mutex);
+    return dropped;
+}
@@ -0,0 +1,35 @@
+#ifndef _JPEG_ENCODER_H_
+#define _JPEG_ENCODER_H_
+
+#include "data.h"
+
+#define JPEG_ENCODER_DEFAULT_WORKERS    1
+#define JPEG_ENCODER_DEFAULT_QUEUE      4
+#define JPEG_FILE_NAME_LEN              256
+
+//snapshot encoder service. the workers keep an opened mjpeg codec with its frame and packet for every size and
+//pixel format they have encoded, so a snapshot costs the plane split and the encode, not the codec setup.
+//the jobs hold a reference on the raw buffer they are a view into, so the submitter releases its frame ring slot
+//right away and never waits for an encode
+typedef struct JpegEncoder_s JpegEncoder_t;
+
+typedef enum {
+    JPEG_INPUT_YUYV = 0,    //encoded as YUVJ422P
+    JPEG_INPUT_UYVY,        //encoded as YUVJ422P
+    JPEG_INPUT_NV12,        //encoded as YUVJ420P
+}JpegInputFormat_e;
+
+JpegEncoder_t* jpeg_encoder_create(int worker_num, int queue_len);
+
+//encode the jobs already queued, then stop the workers and close their codecs
+void jpeg_encoder_destroy(JpegEncoder_t* encoder);
+
+//queue the width x height image at data, a view into buffer, to be saved as file_name.
+//never waits: -1 if the queue is full, the snapshot is dropped
+int jpeg_encoder_submit(JpegEncoder_t* encoder, FrameBuffer_t* buffer, uint8_t* data, int width, int height, \
+    JpegInputFormat_e format, const char* file_name);
+
+//snapshots dropped because the queue was full
+uint64_t jpeg_encoder_dropped(JpegEncoder_t* encoder);
+
+#endif
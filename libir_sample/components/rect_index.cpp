@@ -0,0 +1,252 @@
+#include "rect_index.h"
+#include <stdio.h>
+#include <vector>
+
+using std::vector;
+
+//min and max of a group of pixels, the index is y * width + x so a smaller one is earlier in raster order
+typedef struct {
+    uint16_t min_value;
+    uint16_t max_value;
+    uint32_t min_index;
+    uint32_t max_index;
+}RectIndexExtreme_t;
+
+struct RectIndex_s {
+    int width;
+    int height;
+    int grid_width;     //whole blocks only, the right and bottom pixels past them are always border
+    int grid_height;
+    int level_x_num;
+    int level_y_num;
+    const uint16_t* y16;
+    vector<uint64_t> integral;  //(width + 1) x (height + 1), sum of the pixels above and left of every entry
+    vector<int> log2;
+    //level (lx, ly) holds the extremes of the 2^lx x 2^ly blocks from every block, levels[ly * level_x_num + lx]
+    vector<vector<RectIndexExtreme_t> > levels;
+};
+
+static inline void rect_index_merge(RectIndexExtreme_t* a, const RectIndexExtreme_t& b)
+{
+    if (b.min_value < a->min_value || (b.min_value == a->min_value && b.min_index < a->min_index))
+    {
+        a->min_value = b.min_value;
+        a->min_index = b.min_index;
+    }
+    if (b.max_value > a->max_value || (b.max_value == a->max_value && b.max_index < a->max_index))
+    {
+        a->max_value = b.max_value;
+        a->max_index = b.max_index;
+    }
+}
+
+//extremes of the pixels x_start~x_end, y_start~y_end read from the frame
+static void rect_index_scan(RectIndex_t* index, int x_start, int y_start, int x_end, int y_end, RectIndexExtreme_t* extreme)
+{
+    for (int y = y_start; y <= y_end; y++)
+    {
+        const uint16_t* line = index->y16 + y * index->width;
+        uint32_t row_index = y * index->width;
+        for (int x = x_start; x <= x_end; x++)
+        {
+            if (line[x] < extreme->min_value)
+            {
+                extreme->min_value = line[x];
+                extreme->min_index = row_index + x;
+            }
+            if (line[x] > extreme->max_value)
+            {
+                extreme->max_value = line[x];
+                extreme->max_index = row_index + x;
+            }
+        }
+    }
+}
+
+//a strip scanned on its own then merged, strips side by side interleave in raster order
+static void rect_index_merge_strip(RectIndex_t* index, int x_start, int y_start, int x_end, int y_end, RectIndexExtreme_t* extreme)
+{
+    if (x_start > x_end || y_start > y_end)
+    {
+        return;
+    }
+    RectIndexExtreme_t strip;
+    strip.min_value = 0xffff;
+    strip.max_value = 0;
+    strip.min_index = strip.max_index = y_start * index->width + x_start;
+    rect_index_scan(index, x_start, y_start, x_end, y_end, &strip);
+    rect_index_merge(extreme, strip);
+}
+
+RectIndex_t* rect_index_create(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        printf("rect_index_create: invalid param\n");
+        return NULL;
+    }
+
+    RectIndex_t* index = new RectIndex_t;
+    index->width = width;
+    index->height = height;
+    index->grid_width = width / RECT_INDEX_BLOCK;
+    index->grid_height = height / RECT_INDEX_BLOCK;
+    index->y16 = NULL;
+    index->integral.assign((width + 1) * (height + 1), 0);
+
+    int grid_max = (index->grid_width > index->grid_height) ? index->grid_width : index->grid_height;
+    index->log2.assign(grid_max + 1, 0);
+    for (int i = 2; i <= grid_max; i++)
+    {
+        index->log2[i] = index->log2[i / 2] + 1;
+    }
+    index->level_x_num = (index->grid_width > 0) ? index->log2[index->grid_width] + 1 : 0;
+    index->level_y_num = (index->grid_height > 0) ? index->log2[index->grid_height] + 1 : 0;
+    index->levels.resize(index->level_x_num * index->level_y_num);
+    for (size_t i = 0; i < index->levels.size(); i++)
+    {
+        index->levels[i].resize(index->grid_width * index->grid_height);
+    }
+    return index;
+}
+
+void rect_index_destroy(RectIndex_t* index)
+{
+    delete index;
+}
+
+int rect_index_build(RectIndex_t* index, const uint16_t* y16_data)
+{
+    if (index == NULL || y16_data == NULL)
+    {
+        printf("rect_index_build: invalid param\n");
+        return -1;
+    }
+
+    int width = index->width;
+    index->y16 = y16_data;
+    uint64_t* integral = &index->integral[0];
+    for (int y = 0; y < index->height; y++)
+    {
+        const uint16_t* line = y16_data + y * width;
+        const uint64_t* above = integral + y * (width + 1);
+        uint64_t* row = integral + (y + 1) * (width + 1);
+        uint64_t row_sum = 0;
+        for (int x = 0; x < width; x++)
+        {
+            row_sum += line[x];
+            row[x + 1] = above[x + 1] + row_sum;
+        }
+    }
+
+    if (index->levels.empty())
+    {
+        return 0;
+    }
+    int grid_width = index->grid_width;
+    vector<RectIndexExtreme_t>& blocks = index->levels[0];
+    for (int by = 0; by < index->grid_height; by++)
+    {
+        for (int bx = 0; bx < grid_width; bx++)
+        {
+            RectIndexExtreme_t* block = &blocks[by * grid_width + bx];
+            block->min_value = 0xffff;
+            block->max_value = 0;
+            block->min_index = block->max_index = by * RECT_INDEX_BLOCK * width + bx * RECT_INDEX_BLOCK;
+            rect_index_scan(index, bx * RECT_INDEX_BLOCK, by * RECT_INDEX_BLOCK, (bx + 1) * RECT_INDEX_BLOCK - 1, \
+                (by + 1) * RECT_INDEX_BLOCK - 1, block);
+        }
+    }
+
+    //every level doubles the previous one, across from the level on its left or down from the one above it
+    for (int ly = 0; ly < index->level_y_num; ly++)
+    {
+        for (int lx = (ly == 0) ? 1 : 0; lx < index->level_x_num; lx++)
+        {
+            bool across = (lx > 0);
+            const vector<RectIndexExtreme_t>& from = across ? index->levels[ly * index->level_x_num + lx - 1] \
+                : index->levels[(ly - 1) * index->level_x_num];
+            vector<RectIndexExtreme_t>& to = index->levels[ly * index->level_x_num + lx];
+            int half = across ? (1 << (lx - 1)) : (1 << (ly - 1)) * grid_width;
+            int bx_end = grid_width - (1 << lx);
+            int by_end = index->grid_height - (1 << ly);
+            for (int by = 0; by <= by_end; by++)
+            {
+                for (int bx = 0; bx <= bx_end; bx++)
+                {
+                    int i = by * grid_width + bx;
+                    to[i] = from[i];
+                    rect_index_merge(&to[i], from[i + half]);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+const uint16_t* rect_index_frame(RectIndex_t* index)
+{
+    return (index == NULL) ? NULL : index->y16;
+}
+
+int rect_index_query(RectIndex_t* index, int start_x, int start_y, int end_x, int end_y, RectIndexResult_t* result)
+{
+    if (index == NULL || index->y16 == NULL || result == NULL)
+    {
+        printf("rect_index_query: invalid param\n");
+        return -1;
+    }
+    int x0 = (start_x < end_x) ? start_x : end_x, x1 = (start_x < end_x) ? end_x : start_x;
+    int y0 = (start_y < end_y) ? start_y : end_y, y1 = (start_y < end_y) ? end_y : start_y;
+    if (x0 < 0 || y0 < 0 || x1 >= index->width || y1 >= index->height)
+    {
+        printf("rect_index_query: the rect is out of the frame\n");
+        return -1;
+    }
+
+    int stride = index->width + 1;
+    const uint64_t* integral = &index->integral[0];
+    result->sum = integral[(y1 + 1) * stride + x1 + 1] - integral[y0 * stride + x1 + 1] \
+        - integral[(y1 + 1) * stride + x0] + integral[y0 * stride + x0];
+    result->pixel_num = (x1 - x0 + 1) * (y1 - y0 + 1);
+
+    RectIndexExtreme_t extreme;
+    extreme.min_value = 0xffff;
+    extreme.max_value = 0;
+    extreme.min_index = extreme.max_index = y0 * index->width + x0;
+
+    //whole blocks inside the rect, and the strips around them
+    int bx0 = (x0 + RECT_INDEX_BLOCK - 1) / RECT_INDEX_BLOCK, bx1 = (x1 + 1) / RECT_INDEX_BLOCK - 1;
+    int by0 = (y0 + RECT_INDEX_BLOCK - 1) / RECT_INDEX_BLOCK, by1 = (y1 + 1) / RECT_INDEX_BLOCK - 1;
+    if (bx0 > bx1 || by0 > by1)
+    {
+        rect_index_scan(index, x0, y0, x1, y1, &extreme);
+    }
+    else
+    {
+        //4 squares of power of 2 sides overlapping over the blocks, overlaps don't matter to min and max
+        int lx = index->log2[bx1 - bx0 + 1], ly = index->log2[by1 - by0 + 1];
+        const vector<RectIndexExtreme_t>& level = index->levels[ly * index->level_x_num + lx];
+        int grid_width = index->grid_width;
+        int bx_far = bx1 - (1 << lx) + 1, by_far = by1 - (1 << ly) + 1;
+        rect_index_merge(&extreme, level[by0 * grid_width + bx0]);
+        rect_index_merge(&extreme, level[by0 * grid_width + bx_far]);
+        rect_index_merge(&extreme, level[by_far * grid_width + bx0]);
+        rect_index_merge(&extreme, level[by_far * grid_width + bx_far]);
+
+        int inner_x0 = bx0 * RECT_INDEX_BLOCK, inner_x1 = (bx1 + 1) * RECT_INDEX_BLOCK - 1;
+        int inner_y0 = by0 * RECT_INDEX_BLOCK, inner_y1 = (by1 + 1) * RECT_INDEX_BLOCK - 1;
+        rect_index_merge_strip(index, x0, y0, x1, inner_y0 - 1, &extreme);
+        rect_index_merge_strip(index, x0, inner_y0, inner_x0 - 1, inner_y1, &extreme);
+        rect_index_merge_strip(index, inner_x1 + 1, inner_y0, x1, inner_y1, &extreme);
+        rect_index_merge_strip(index, x0, inner_y1 + 1, x1, y1, &extreme);
+    }
+
+    result->min_value = extreme.min_value;
+    result->max_value = extreme.max_value;
+    result->min_x = extreme.min_index % index->width;
+    result->min_y = extreme.min_index / index->width;
+    result->max_x = extreme.max_index % index->width;
+    result->max_y = extreme.max_index / index->width;
+    return 0;
+}
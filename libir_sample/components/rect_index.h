@@ -0,0 +1,40 @@
+#ifndef _RECT_INDEX_H_
+#define _RECT_INDEX_H_
+
+#include <stdint.h>
+
+#define RECT_INDEX_BLOCK    16
+
+//index of one y16 temp frame(1/64 kelvin) answering the sum, min and max of any rectangle without scanning it.
+//built once per frame: an integral image gives the sum of a rectangle from 4 entries, and a sparse table over the
+//min/max of RECT_INDEX_BLOCK x RECT_INDEX_BLOCK blocks gives the extremes of the whole blocks inside it from 4
+//entries, only the border strips narrower than a block are read from the frame. worth it once a frame has more
+//rectangles than the build costs, see sample/rect_index_bench
+typedef struct RectIndex_s RectIndex_t;
+
+//positions are the first pixel in raster order
+typedef struct {
+    uint16_t min_value;
+    uint16_t max_value;
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    uint64_t sum;
+    uint32_t pixel_num;
+}RectIndexResult_t;
+
+RectIndex_t* rect_index_create(int width, int height);
+
+void rect_index_destroy(RectIndex_t* index);
+
+//index a frame of the index size, the frame is read by the queries until the next build
+int rect_index_build(RectIndex_t* index, const uint16_t* y16_data);
+
+//the frame of the last build, NULL before the first one
+const uint16_t* rect_index_frame(RectIndex_t* index);
+
+//rectangle from start to end, coordinates from 0 and the boundary included
+int rect_index_query(RectIndex_t* index, int start_x, int start_y, int end_x, int end_y, RectIndexResult_t* result);
+
+#endif
@@ -0,0 +1,367 @@
+#include "roi_temp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+using std::vector;
+
+//pixels x_start~x_end of one row covered by one roi
+typedef struct {
+    int roi;
+    int x_start;
+    int x_end;
+}RoiSpan_t;
+
+struct RoiSet_s {
+    int width;
+    int height;
+    int roi_num;
+    vector<RoiSpan_t> spans;    //row by row, by column within a row
+    vector<int> row_offsets;    //spans of row y are row_offsets[y]~row_offsets[y + 1] - 1
+    vector<uint32_t> pixel_num;
+    vector<uint16_t> first_x;   //first pixel of every roi in raster order, where min and max start
+    vector<uint16_t> first_y;
+};
+
+typedef struct {
+    int row;
+    RoiSpan_t span;
+}RoiRowSpan_t;
+
+static bool roi_row_span_less(const RoiRowSpan_t& a, const RoiRowSpan_t& b)
+{
+    if (a.row != b.row)
+    {
+        return a.row < b.row;
+    }
+    return a.span.x_start < b.span.x_start;
+}
+
+static bool roi_in_frame(int x, int y, int width, int height)
+{
+    return x >= 0 && y >= 0 && x < width && y < height;
+}
+
+static void roi_add_span(vector<RoiRowSpan_t>* spans, int roi, int row, int x_start, int x_end)
+{
+    RoiRowSpan_t row_span;
+    row_span.row = row;
+    row_span.span.roi = roi;
+    row_span.span.x_start = x_start;
+    row_span.span.x_end = x_end;
+    spans->push_back(row_span);
+}
+
+//bresenham from start to end, the pixels of a row come out next to each other and are merged into one span
+static void roi_add_line(vector<RoiRowSpan_t>* spans, int roi, const Roi_t* line)
+{
+    int x = line->start_x, y = line->start_y;
+    int dx = abs(line->end_x - x), dy = -abs(line->end_y - y);
+    int step_x = (line->end_x > x) ? 1 : -1, step_y = (line->end_y > y) ? 1 : -1;
+    int error = dx + dy;
+    int run_start = x, run_end = x, run_row = y;
+    while (x != line->end_x || y != line->end_y)
+    {
+        int error2 = 2 * error;
+        if (error2 >= dy)
+        {
+            error += dy;
+            x += step_x;
+        }
+        if (error2 <= dx)
+        {
+            error += dx;
+            y += step_y;
+        }
+        if (y == run_row)
+        {
+            run_start = (x < run_start) ? x : run_start;
+            run_end = (x > run_end) ? x : run_end;
+        }
+        else
+        {
+            roi_add_span(spans, roi, run_row, run_start, run_end);
+            run_start = run_end = x;
+            run_row = y;
+        }
+    }
+    roi_add_span(spans, roi, run_row, run_start, run_end);
+}
+
+RoiSet_t* roi_set_create(const Roi_t* rois, int roi_num, int width, int height)
+{
+    if (rois == NULL || roi_num <= 0 || width <= 0 || height <= 0 || width > 65535 || height > 65535)
+    {
+        printf("roi_set_create: invalid param\n");
+        return NULL;
+    }
+
+    vector<RoiRowSpan_t> row_spans;
+    for (int i = 0; i < roi_num; i++)
+    {
+        const Roi_t* roi = &rois[i];
+        if (!roi_in_frame(roi->start_x, roi->start_y, width, height) \
+            || (roi->type != ROI_TYPE_POINT && !roi_in_frame(roi->end_x, roi->end_y, width, height)))
+        {
+            printf("roi_set_create: roi %d is out of the %dx%d frame\n", i, width, height);
+            return NULL;
+        }
+        if (roi->type == ROI_TYPE_POINT)
+        {
+            roi_add_span(&row_spans, i, roi->start_y, roi->start_x, roi->start_x);
+        }
+        else if (roi->type == ROI_TYPE_LINE)
+        {
+            roi_add_line(&row_spans, i, roi);
+        }
+        else if (roi->type == ROI_TYPE_RECT)
+        {
+            int x_start = std::min(roi->start_x, roi->end_x), x_end = std::max(roi->start_x, roi->end_x);
+            int y_start = std::min(roi->start_y, roi->end_y), y_end = std::max(roi->start_y, roi->end_y);
+            for (int row = y_start; row <= y_end; row++)
+            {
+                roi_add_span(&row_spans, i, row, x_start, x_end);
+            }
+        }
+        else
+        {
+            printf("roi_set_create: roi %d has an unknown type\n", i);
+            return NULL;
+        }
+    }
+    std::sort(row_spans.begin(), row_spans.end(), roi_row_span_less);
+
+    RoiSet_t* set = new RoiSet_t;
+    set->width = width;
+    set->height = height;
+    set->roi_num = roi_num;
+    set->spans.resize(row_spans.size());
+    set->row_offsets.assign(height + 1, 0);
+    set->pixel_num.assign(roi_num, 0);
+    set->first_x.assign(roi_num, 0);
+    set->first_y.assign(roi_num, 0);
+    vector<bool> has_first(roi_num, false);
+    for (size_t i = 0; i < row_spans.size(); i++)
+    {
+        const RoiRowSpan_t& row_span = row_spans[i];
+        int roi = row_span.span.roi;
+        set->spans[i] = row_span.span;
+        set->row_offsets[row_span.row + 1]++;
+        set->pixel_num[roi] += row_span.span.x_end - row_span.span.x_start + 1;
+        if (!has_first[roi])
+        {
+            has_first[roi] = true;
+            set->first_x[roi] = (uint16_t)row_span.span.x_start;
+            set->first_y[roi] = (uint16_t)row_span.row;
+        }
+    }
+    for (int row = 0; row < height; row++)
+    {
+        set->row_offsets[row + 1] += set->row_offsets[row];
+    }
+    return set;
+}
+
+void roi_set_destroy(RoiSet_t* set)
+{
+    delete set;
+}
+
+int roi_set_roi_num(RoiSet_t* set)
+{
+    return (set == NULL) ? 0 : set->roi_num;
+}
+
+RoiTempResult_t* roi_temp_result_create(RoiSet_t* set)
+{
+    if (set == NULL)
+    {
+        printf("roi_temp_result_create: invalid param\n");
+        return NULL;
+    }
+
+    int roi_num = set->roi_num;
+    RoiTempResult_t* result = new RoiTempResult_t;
+    result->roi_num = roi_num;
+    result->max_temp = new float[roi_num];
+    result->min_temp = new float[roi_num];
+    result->ave_temp = new float[roi_num];
+    result->max_value = new uint16_t[roi_num];
+    result->min_value = new uint16_t[roi_num];
+    result->sum = new uint64_t[roi_num];
+    result->pixel_num = new uint32_t[roi_num];
+    result->max_x = new uint16_t[roi_num];
+    result->max_y = new uint16_t[roi_num];
+    result->min_x = new uint16_t[roi_num];
+    result->min_y = new uint16_t[roi_num];
+    std::copy(set->pixel_num.begin(), set->pixel_num.end(), result->pixel_num);
+    return result;
+}
+
+void roi_temp_result_destroy(RoiTempResult_t* result)
+{
+    if (result == NULL)
+    {
+        return;
+    }
+    delete[] result->max_temp;
+    delete[] result->min_temp;
+    delete[] result->ave_temp;
+    delete[] result->max_value;
+    delete[] result->min_value;
+    delete[] result->sum;
+    delete[] result->pixel_num;
+    delete[] result->max_x;
+    delete[] result->max_y;
+    delete[] result->min_x;
+    delete[] result->min_y;
+    delete result;
+}
+
+int roi_set_measure(RoiSet_t* set, const uint16_t* y16_data, RoiTempResult_t* result)
+{
+    if (set == NULL || y16_data == NULL || result == NULL || result->roi_num != set->roi_num)
+    {
+        printf("roi_set_measure: invalid param\n");
+        return -1;
+    }
+
+    //min and max start at the first pixel with the values no pixel can beat, so only a strictly smaller or
+    //larger pixel moves them and equal values keep the first one
+    int roi_num = set->roi_num;
+    for (int i = 0; i < roi_num; i++)
+    {
+        result->max_value[i] = 0;
+        result->min_value[i] = 0xffff;
+        result->sum[i] = 0;
+        result->max_x[i] = result->min_x[i] = set->first_x[i];
+        result->max_y[i] = result->min_y[i] = set->first_y[i];
+    }
+
+    const RoiSpan_t* spans = &set->spans[0];
+    for (int row = 0; row < set->height; row++)
+    {
+        const uint16_t* line = y16_data + row * set->width;
+        for (int i = set->row_offsets[row]; i < set->row_offsets[row + 1]; i++)
+        {
+            const RoiSpan_t& span = spans[i];
+            uint16_t min_value = result->min_value[span.roi];
+            uint16_t max_value = result->max_value[span.roi];
+            int min_x = -1, max_x = -1;
+            uint32_t sum = 0;   //a row of at most 65535 pixels can't overflow it
+            for (int x = span.x_start; x <= span.x_end; x++)
+            {
+                uint16_t value = line[x];
+                sum += value;
+                if (value < min_value)
+                {
+                    min_value = value;
+                    min_x = x;
+                }
+                if (value > max_value)
+                {
+                    max_value = value;
+                    max_x = x;
+                }
+            }
+            result->sum[span.roi] += sum;
+            if (min_x >= 0)
+            {
+                result->min_value[span.roi] = min_value;
+                result->min_x[span.roi] = (uint16_t)min_x;
+                result->min_y[span.roi] = (uint16_t)row;
+            }
+            if (max_x >= 0)
+            {
+                result->max_value[span.roi] = max_value;
+                result->max_x[span.roi] = (uint16_t)max_x;
+                result->max_y[span.roi] = (uint16_t)row;
+            }
+        }
+    }
+
+    for (int i = 0; i < roi_num; i++)
+    {
+        result->max_temp[i] = result->max_value[i] / 64.0f - 273.15f;
+        result->min_temp[i] = result->min_value[i] / 64.0f - 273.15f;
+        result->ave_temp[i] = (float)((double)result->sum[i] / result->pixel_num[i] / 64 - 273.15);
+    }
+    return 0;
+}
+
+int roi_set_measure_celsius(RoiSet_t* set, const uint16_t* y16_data, const float* celsius_data, RoiTempResult_t* result)
+{
+    if (set == NULL || y16_data == NULL || celsius_data == NULL || result == NULL || result->roi_num != set->roi_num)
+    {
+        printf("roi_set_measure_celsius: invalid param\n");
+        return -1;
+    }
+
+    //the first pixel of every roi starts its extremes, the runs then only move them to strictly colder or hotter
+    //pixels, like roi_set_measure
+    int roi_num = set->roi_num;
+    vector<double> celsius_sum(roi_num, 0);
+    for (int i = 0; i < roi_num; i++)
+    {
+        int first = set->first_y[i] * set->width + set->first_x[i];
+        result->max_temp[i] = result->min_temp[i] = celsius_data[first];
+        result->sum[i] = 0;
+        result->max_x[i] = result->min_x[i] = set->first_x[i];
+        result->max_y[i] = result->min_y[i] = set->first_y[i];
+    }
+
+    const RoiSpan_t* spans = &set->spans[0];
+    for (int row = 0; row < set->height; row++)
+    {
+        const uint16_t* line = y16_data + row * set->width;
+        const float* celsius_line = celsius_data + row * set->width;
+        for (int i = set->row_offsets[row]; i < set->row_offsets[row + 1]; i++)
+        {
+            const RoiSpan_t& span = spans[i];
+            float min_temp = result->min_temp[span.roi];
+            float max_temp = result->max_temp[span.roi];
+            int min_x = -1, max_x = -1;
+            uint32_t sum = 0;
+            double span_celsius_sum = 0;
+            for (int x = span.x_start; x <= span.x_end; x++)
+            {
+                float temp = celsius_line[x];
+                sum += line[x];
+                span_celsius_sum += temp;
+                if (temp < min_temp)
+                {
+                    min_temp = temp;
+                    min_x = x;
+                }
+                if (temp > max_temp)
+                {
+                    max_temp = temp;
+                    max_x = x;
+                }
+            }
+            result->sum[span.roi] += sum;
+            celsius_sum[span.roi] += span_celsius_sum;
+            if (min_x >= 0)
+            {
+                result->min_temp[span.roi] = min_temp;
+                result->min_x[span.roi] = (uint16_t)min_x;
+                result->min_y[span.roi] = (uint16_t)row;
+            }
+            if (max_x >= 0)
+            {
+                result->max_temp[span.roi] = max_temp;
+                result->max_x[span.roi] = (uint16_t)max_x;
+                result->max_y[span.roi] = (uint16_t)row;
+            }
+        }
+    }
+
+    for (int i = 0; i < roi_num; i++)
+    {
+        result->max_value[i] = y16_data[result->max_y[i] * set->width + result->max_x[i]];
+        result->min_value[i] = y16_data[result->min_y[i] * set->width + result->min_x[i]];
+        result->ave_temp[i] = (float)(celsius_sum[i] / result->pixel_num[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,60 @@
+#ifndef _ROI_TEMP_H_
+#define _ROI_TEMP_H_
+
+#include <stdint.h>
+
+//many points, lines and rectangles measured in one pass over a y16 temp frame(1/64 kelvin).
+//the set is compiled once into the pixel runs every roi covers on each row, sorted by row and column, so a frame is
+//read top to bottom a single time whatever the number of rois, and the set is reused for every frame of that size
+typedef struct RoiSet_s RoiSet_t;
+
+typedef enum {
+    ROI_TYPE_POINT = 0,     //start point only
+    ROI_TYPE_LINE,          //the bresenham pixels from start to end point, both included
+    ROI_TYPE_RECT,          //start to end point, the boundary included
+}RoiType_e;
+
+//coordinates start from 0, like IrRect_t of temp_measure
+typedef struct {
+    RoiType_e type;
+    int start_x;
+    int start_y;
+    int end_x;
+    int end_y;
+}Roi_t;
+
+//one array entry per roi, in the order of the rois of the set. positions are the first pixel in raster order
+typedef struct {
+    int roi_num;
+    float* max_temp;        //celsius
+    float* min_temp;
+    float* ave_temp;
+    uint16_t* max_value;    //y16
+    uint16_t* min_value;
+    uint64_t* sum;
+    uint32_t* pixel_num;
+    uint16_t* max_x;
+    uint16_t* max_y;
+    uint16_t* min_x;
+    uint16_t* min_y;
+}RoiTempResult_t;
+
+//NULL if a roi is out of the width x height frame
+RoiSet_t* roi_set_create(const Roi_t* rois, int roi_num, int width, int height);
+
+void roi_set_destroy(RoiSet_t* set);
+
+int roi_set_roi_num(RoiSet_t* set);
+
+RoiTempResult_t* roi_temp_result_create(RoiSet_t* set);
+
+void roi_temp_result_destroy(RoiTempResult_t* result);
+
+//measure every roi of the set on a y16 frame of the set's size
+int roi_set_measure(RoiSet_t* set, const uint16_t* y16_data, RoiTempResult_t* result);
+
+//measure every roi on a corrected celsius frame of the y16 frame, like the one of temp_correct_map_apply. the
+//extremes and the average are the corrected ones, the y16 values are those of the corrected extremes
+int roi_set_measure_celsius(RoiSet_t* set, const uint16_t* y16_data, const float* celsius_data, RoiTempResult_t* result);
+
+#endif
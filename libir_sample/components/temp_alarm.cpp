@@ -0,0 +1,362 @@
+#include "temp_alarm.h"
+#include "data.h"
+#include "frame_ring.h"
+#include "temp_correct.h"
+#include <string.h>
+#include <atomic>
+#include <vector>
+
+#if defined(_WIN32)
+#define HAVE_STRUCT_TIMESPEC
+#endif
+#include <pthread.h>
+
+using std::vector;
+
+#define TEMP_ALARM_KIND_NUM     2   //OVER_HEAT and OVER_COLD of every roi
+
+//one alarm of one roi, pending while its condition waits out raise_ms or clear_ms
+typedef struct {
+    bool is_enabled;
+    bool is_raised;
+    bool is_pending;
+    uint64_t pending_us;    //frame_us the condition started
+}TempAlarmState_t;
+
+struct TempAlarm_s {
+    RoiSet_t* roi_set;
+    RoiTempResult_t* result;
+    vector<TempAlarmThreshold_t> thresholds;
+    vector<TempAlarmState_t> states;    //roi * TEMP_ALARM_KIND_NUM + 0 for OVER_HEAT, + 1 for OVER_COLD
+    TempAlarmParam_t param;
+    TempAlarmStats_t stats;
+    //written by the producer at tail and read by the consumer at head, each index only moved by its own side
+    vector<TempAlarmEvent_t> events;
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+};
+
+TempAlarm_t* temp_alarm_create(const Roi_t* rois, const TempAlarmThreshold_t* thresholds, int roi_num, \
+    int width, int height, const TempAlarmParam_t* param)
+{
+    if (rois == NULL || thresholds == NULL || param == NULL || param->hysteresis < 0)
+    {
+        printf("temp_alarm_create: invalid param\n");
+        return NULL;
+    }
+
+    RoiSet_t* roi_set = roi_set_create(rois, roi_num, width, height);
+    if (roi_set == NULL)
+    {
+        return NULL;
+    }
+    TempAlarm_t* alarm = new TempAlarm_t;
+    alarm->roi_set = roi_set;
+    alarm->result = roi_temp_result_create(roi_set);
+    alarm->thresholds.assign(thresholds, thresholds + roi_num);
+    alarm->states.resize(roi_num * TEMP_ALARM_KIND_NUM);
+    for (int i = 0; i < roi_num; i++)
+    {
+        memset(&alarm->states[i * TEMP_ALARM_KIND_NUM], 0, sizeof(TempAlarmState_t) * TEMP_ALARM_KIND_NUM);
+        alarm->states[i * TEMP_ALARM_KIND_NUM].is_enabled = thresholds[i].has_high;
+        alarm->states[i * TEMP_ALARM_KIND_NUM + 1].is_enabled = thresholds[i].has_low;
+    }
+    alarm->param = *param;
+    memset(&alarm->stats, 0, sizeof(alarm->stats));
+    alarm->events.resize(TEMP_ALARM_QUEUE);
+    alarm->head = 0;
+    alarm->tail = 0;
+    return alarm;
+}
+
+void temp_alarm_destroy(TempAlarm_t* alarm)
+{
+    if (alarm == NULL)
+    {
+        return;
+    }
+    roi_temp_result_destroy(alarm->result);
+    roi_set_destroy(alarm->roi_set);
+    delete alarm;
+}
+
+static void temp_alarm_push(TempAlarm_t* alarm, TempAlarmEvent_t* event)
+{
+    uint32_t tail = alarm->tail.load(std::memory_order_relaxed);
+    if (tail - alarm->head.load(std::memory_order_acquire) == TEMP_ALARM_QUEUE)
+    {
+        alarm->stats.dropped++;
+        return;
+    }
+    event->event_us = frame_clock_us();
+    alarm->events[tail & (TEMP_ALARM_QUEUE - 1)] = *event;
+    alarm->tail.store(tail + 1, std::memory_order_release);
+
+    uint64_t latency_us = (event->event_us > event->frame_us) ? event->event_us - event->frame_us : 0;
+    alarm->stats.event_num++;
+    alarm->stats.latency_sum_us += latency_us;
+    alarm->stats.latency_max_us = (latency_us > alarm->stats.latency_max_us) ? latency_us : alarm->stats.latency_max_us;
+}
+
+//over is whether the temp is past the threshold, back whether it is back past the hysteresis, the state changes once
+//either held long enough
+static bool temp_alarm_update(TempAlarmState_t* state, bool over, bool back, const TempAlarmParam_t* param, uint64_t frame_us)
+{
+    bool is_changing = state->is_raised ? back : over;
+    if (!is_changing)
+    {
+        state->is_pending = false;
+        return false;
+    }
+    if (!state->is_pending)
+    {
+        state->is_pending = true;
+        state->pending_us = frame_us;
+    }
+    uint64_t wait_us = (uint64_t)(state->is_raised ? param->clear_ms : param->raise_ms) * 1000;
+    if (frame_us - state->pending_us < wait_us)
+    {
+        return false;
+    }
+    state->is_raised = !state->is_raised;
+    state->is_pending = false;
+    return true;
+}
+
+int temp_alarm_process(TempAlarm_t* alarm, const uint16_t* y16_data, const float* celsius_data, uint64_t frame_us)
+{
+    if (alarm == NULL || y16_data == NULL)
+    {
+        printf("temp_alarm_process: invalid param\n");
+        return -1;
+    }
+
+    RoiTempResult_t* result = alarm->result;
+    int ret = (celsius_data != NULL) ? roi_set_measure_celsius(alarm->roi_set, y16_data, celsius_data, result) \
+        : roi_set_measure(alarm->roi_set, y16_data, result);
+    if (ret != 0)
+    {
+        return -1;
+    }
+    alarm->stats.frame_num++;
+
+    float hysteresis = alarm->param.hysteresis;
+    for (int i = 0; i < result->roi_num; i++)
+    {
+        const TempAlarmThreshold_t& threshold = alarm->thresholds[i];
+        TempAlarmState_t* heat = &alarm->states[i * TEMP_ALARM_KIND_NUM];
+        TempAlarmState_t* cold = &alarm->states[i * TEMP_ALARM_KIND_NUM + 1];
+        TempAlarmEvent_t event;
+        event.roi = i;
+        event.frame_us = frame_us;
+        if (heat->is_enabled && temp_alarm_update(heat, result->max_temp[i] >= threshold.high_temp, \
+            result->max_temp[i] < threshold.high_temp - hysteresis, &alarm->param, frame_us))
+        {
+            event.type = OVER_HEAT;
+            event.is_raised = heat->is_raised;
+            event.temp = result->max_temp[i];
+            event.x = result->max_x[i];
+            event.y = result->max_y[i];
+            temp_alarm_push(alarm, &event);
+        }
+        if (cold->is_enabled && temp_alarm_update(cold, result->min_temp[i] <= threshold.low_temp, \
+            result->min_temp[i] > threshold.low_temp + hysteresis, &alarm->param, frame_us))
+        {
+            event.type = OVER_COLD;
+            event.is_raised = cold->is_raised;
+            event.temp = result->min_temp[i];
+            event.x = result->min_x[i];
+            event.y = result->min_y[i];
+            temp_alarm_push(alarm, &event);
+        }
+    }
+    return 0;
+}
+
+int temp_alarm_pop(TempAlarm_t* alarm, TempAlarmEvent_t* event)
+{
+    if (alarm == NULL || event == NULL)
+    {
+        return -1;
+    }
+    uint32_t head = alarm->head.load(std::memory_order_relaxed);
+    if (head == alarm->tail.load(std::memory_order_acquire))
+    {
+        return -1;
+    }
+    *event = alarm->events[head & (TEMP_ALARM_QUEUE - 1)];
+    alarm->head.store(head + 1, std::memory_order_release);
+    return 0;
+}
+
+void temp_alarm_get_stats(TempAlarm_t* alarm, TempAlarmStats_t* stats)
+{
+    if (alarm != NULL && stats != NULL)
+    {
+        *stats = alarm->stats;
+    }
+}
+
+//event_sem is posted after the frames that queued events and once more at quit
+typedef struct {
+    TempAlarm_t* alarm;
+    std::atomic_bool quit;
+#if defined(_WIN32)
+    HANDLE event_sem;
+#elif defined(linux) || defined(unix)
+    sem_t event_sem;
+#endif
+}TempAlarmReport_t;
+
+static void temp_alarm_report_post(TempAlarmReport_t* report)
+{
+#if defined(_WIN32)
+    ReleaseSemaphore(report->event_sem, 1, NULL);
+#elif defined(linux) || defined(unix)
+    sem_post(&report->event_sem);
+#endif
+}
+
+static void temp_alarm_print(const TempAlarmEvent_t* event)
+{
+    uint64_t now_us = frame_clock_us();
+    printf("temp alarm: roi %d %s %s, %.2f at (%d, %d), queued %.3f ms and read %.3f ms after the frame\n", event->roi, \
+        (event->type == OVER_HEAT) ? "over heat" : "over cold", event->is_raised ? "raised" : "cleared", event->temp, \
+        event->x, event->y, (event->event_us - event->frame_us) / 1000.0, (now_us - event->frame_us) / 1000.0);
+}
+
+//empties the queue at every post until the alarm thread quits, the events queued before the quit are read first
+static void* temp_alarm_report_function(void* threadarg)
+{
+    TempAlarmReport_t* report = (TempAlarmReport_t*)threadarg;
+    TempAlarmEvent_t event;
+    bool is_quit = false;
+    while (!is_quit)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(report->event_sem, INFINITE);
+#elif defined(linux) || defined(unix)
+        sem_wait(&report->event_sem);
+#endif
+        is_quit = report->quit;
+        while (temp_alarm_pop(report->alarm, &event) == 0)
+        {
+            temp_alarm_print(&event);
+        }
+    }
+    return NULL;
+}
+
+void* temp_alarm_function(void* threadarg)
+{
+    printf("temp_alarm_function start\n");
+    StreamFrameInfo_t* stream_frame_info = (StreamFrameInfo_t*)threadarg;
+    if (stream_frame_info == NULL || stream_frame_info->product_config.camera.temp_alarms.empty())
+    {
+        return NULL;
+    }
+    if (stream_frame_info->frame_output_format != YUYV_AND_TEMP && stream_frame_info->frame_output_format != NV12_AND_TEMP)
+    {
+        printf("temp alarm: the stream has no temp frame\n");
+        return NULL;
+    }
+
+    camera_config* camera = &stream_frame_info->product_config.camera;
+    int roi_num = (int)camera->temp_alarms.size();
+    vector<Roi_t> rois(roi_num);
+    vector<TempAlarmThreshold_t> thresholds(roi_num);
+    for (int i = 0; i < roi_num; i++)
+    {
+        const temp_alarm_config& alarm_config = camera->temp_alarms[i];
+        rois[i].type = (alarm_config.type == "point") ? ROI_TYPE_POINT : (alarm_config.type == "line") ? ROI_TYPE_LINE \
+            : ROI_TYPE_RECT;
+        rois[i].start_x = alarm_config.start_x;
+        rois[i].start_y = alarm_config.start_y;
+        rois[i].end_x = alarm_config.end_x;
+        rois[i].end_y = alarm_config.end_y;
+        thresholds[i].has_high = alarm_config.has_high;
+        thresholds[i].high_temp = alarm_config.high_temp;
+        thresholds[i].has_low = alarm_config.has_low;
+        thresholds[i].low_temp = alarm_config.low_temp;
+    }
+    TempAlarmParam_t param;
+    param.hysteresis = camera->temp_alarm_hysteresis;
+    param.raise_ms = camera->temp_alarm_raise_ms;
+    param.clear_ms = camera->temp_alarm_clear_ms;
+
+    TempAlarmReport_t* report = new TempAlarmReport_t;
+    report->alarm = temp_alarm_create(&rois[0], &thresholds[0], roi_num, stream_frame_info->temp_info.width, \
+        stream_frame_info->temp_info.height, &param);
+    report->quit = false;
+    if (report->alarm == NULL)
+    {
+        delete report;
+        return NULL;
+    }
+#if defined(_WIN32)
+    report->event_sem = CreateSemaphore(NULL, 0, TEMP_ALARM_QUEUE, NULL);
+#elif defined(linux) || defined(unix)
+    sem_init(&report->event_sem, 0, 0);
+#endif
+
+    //the thresholds hold for the temps temp_measure reports, corrected like its frames. without the correct table
+    //the rois are checked uncorrected
+    EnvCorrectParam env_correct_param;
+    temp_correct_default_param(&env_correct_param);
+    TempCorrectMap_t* correct_map = temp_correct_map_load(TEMP_CORRECT_TABLE_FILE, &env_correct_param, \
+        stream_frame_info->temp_info.width, stream_frame_info->temp_info.height);
+
+    pthread_t report_thread;
+    int consumer_id = -1;
+    if (pthread_create(&report_thread, NULL, temp_alarm_report_function, report) != 0)
+    {
+        printf("temp alarm: create report thread failed\n");
+    }
+    else
+    {
+        consumer_id = frame_ring_add_consumer(stream_frame_info->frame_ring);
+    }
+
+    StreamFrameInfo_t frame_view = *stream_frame_info;
+    FrameSlot_t slot;
+    while (consumer_id >= 0 && frame_ring_read(stream_frame_info->frame_ring, consumer_id, &slot) == 0)
+    {
+        uint64_t frame_us = (slot.raw_buffer->timestamp_us != 0) ? slot.raw_buffer->timestamp_us : frame_clock_us();
+        bind_stream_frame_info(&frame_view, slot.raw_buffer, slot.raw_temp_buffer);
+        uint16_t* y16_data = (uint16_t*)frame_view.temp_info.data;
+        const float* celsius_data = (correct_map != NULL) ? temp_correct_map_apply(correct_map, y16_data) : NULL;
+        uint64_t event_num = report->alarm->stats.event_num;
+        temp_alarm_process(report->alarm, y16_data, celsius_data, frame_us);
+        frame_ring_release(&slot);
+        if (report->alarm->stats.event_num != event_num)
+        {
+            temp_alarm_report_post(report);
+        }
+    }
+
+    if (consumer_id >= 0)
+    {
+        report->quit = true;
+        temp_alarm_report_post(report);
+        pthread_join(report_thread, NULL);
+
+        TempAlarmStats_t stats;
+        memset(&stats, 0, sizeof(stats));
+        temp_alarm_get_stats(report->alarm, &stats);
+        printf("temp alarm checked %llu frames, skipped %llu in the ring, %llu events, %llu dropped, frame to event %.3f ms " \
+            "on average, %.3f ms at most\n", (unsigned long long)stats.frame_num, \
+            (unsigned long long)frame_ring_dropped(stream_frame_info->frame_ring, consumer_id), \
+            (unsigned long long)stats.event_num, (unsigned long long)stats.dropped, \
+            (stats.event_num > 0) ? stats.latency_sum_us / 1000.0 / stats.event_num : 0.0, stats.latency_max_us / 1000.0);
+        frame_ring_remove_consumer(stream_frame_info->frame_ring, consumer_id);
+    }
+    temp_correct_map_destroy(correct_map);
+#if defined(_WIN32)
+    CloseHandle(report->event_sem);
+#elif defined(linux) || defined(unix)
+    sem_destroy(&report->event_sem);
+#endif
+    temp_alarm_destroy(report->alarm);
+    delete report;
+    return NULL;
+}
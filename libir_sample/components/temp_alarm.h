@@ -0,0 +1,70 @@
+#ifndef _TEMP_ALARM_H_
+#define _TEMP_ALARM_H_
+
+#include <stdint.h>
+#include "libirtemp.h"
+#include "roi_temp.h"
+
+#define TEMP_ALARM_QUEUE    256     //a power of 2
+
+//threshold alarms evaluated on every temp frame. each roi of a set is measured in one pass, its max checked against a
+//high threshold and its min against a low one. an alarm is raised once its condition held for raise_ms, and cleared
+//once the temperature stayed back past the threshold by the hysteresis for clear_ms, so a roi on the edge of a
+//threshold doesn't flicker. the events go out through a single producer single consumer lock-free queue, the frame
+//thread never waits on whoever reads them
+typedef struct TempAlarm_s TempAlarm_t;
+
+//celsius
+typedef struct {
+    bool has_high;
+    float high_temp;        //the roi max at or above it is OVER_HEAT
+    bool has_low;
+    float low_temp;         //the roi min at or below it is OVER_COLD
+}TempAlarmThreshold_t;
+
+typedef struct {
+    float hysteresis;       //celsius
+    uint32_t raise_ms;
+    uint32_t clear_ms;
+}TempAlarmParam_t;
+
+typedef struct {
+    int roi;
+    AlarmType_t type;       //OVER_HEAT or OVER_COLD
+    bool is_raised;         //raised, or cleared
+    float temp;             //the roi max of OVER_HEAT, min of OVER_COLD
+    uint16_t x;
+    uint16_t y;
+    uint64_t frame_us;      //arrival of the frame that raised or cleared the alarm
+    uint64_t event_us;      //when the event was queued, on the same clock
+}TempAlarmEvent_t;
+
+typedef struct {
+    uint64_t frame_num;
+    uint64_t event_num;
+    uint64_t dropped;       //events lost to a full queue
+    uint64_t latency_sum_us;    //frame arrival to event queued
+    uint64_t latency_max_us;
+}TempAlarmStats_t;
+
+//one threshold per roi, NULL if a roi is out of the width x height frame
+TempAlarm_t* temp_alarm_create(const Roi_t* rois, const TempAlarmThreshold_t* thresholds, int roi_num, \
+    int width, int height, const TempAlarmParam_t* param);
+
+void temp_alarm_destroy(TempAlarm_t* alarm);
+
+//measure the rois on a y16 frame, or on its corrected celsius frame if not NULL, and queue the alarm events.
+//frame_us is the arrival of the frame on frame_clock_us, the durations are counted on it
+int temp_alarm_process(TempAlarm_t* alarm, const uint16_t* y16_data, const float* celsius_data, uint64_t frame_us);
+
+//take the oldest event, -1 if there is none. from one thread at a time, beside the one processing the frames
+int temp_alarm_pop(TempAlarm_t* alarm, TempAlarmEvent_t* event);
+
+//from the thread processing the frames
+void temp_alarm_get_stats(TempAlarm_t* alarm, TempAlarmStats_t* stats);
+
+//alarm thread, a frame ring consumer checking the camera::temp_alarms rois of every temp frame until the ring stops.
+//the frames are corrected like the ones of temp_measure_function, a second thread prints the events as they come
+void* temp_alarm_function(void* threadarg);
+
+#endif
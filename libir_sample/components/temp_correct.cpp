@@ -0,0 +1,447 @@
+#include "temp_correct.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+using std::vector;
+
+struct TempCorrectLut_s {
+    uint16_t* correct_table;
+    uint32_t table_len;
+    bool is_filled;
+    EnvCorrectParam env_correct_param;  //the lut was filled with
+    vector<float> table;
+    bool has_y16;                       //the last temp_correct_lut_y16, a threshold asks for the same one every frame
+    float y16_celsius;
+    uint16_t y16_value;
+};
+
+static bool temp_correct_same_param(const EnvCorrectParam* a, const EnvCorrectParam* b)
+{
+    return a->dist == b->dist && a->ems == b->ems && a->hum == b->hum && a->ta == b->ta && a->tu == b->tu;
+}
+
+TempCorrectLut_t* temp_correct_lut_create(uint16_t* correct_table, uint32_t table_len)
+{
+    if (correct_table == NULL)
+    {
+        printf("temp_correct_lut_create: invalid param\n");
+        return NULL;
+    }
+
+    TempCorrectLut_t* lut = new TempCorrectLut_t;
+    lut->correct_table = correct_table;
+    lut->table_len = table_len;
+    lut->is_filled = false;
+    lut->table.assign(TEMP_CORRECT_LUT_SIZE, 0);
+    lut->has_y16 = false;
+    return lut;
+}
+
+void temp_correct_lut_destroy(TempCorrectLut_t* lut)
+{
+    delete lut;
+}
+
+int temp_correct_lut_update(TempCorrectLut_t* lut, const EnvCorrectParam* env_correct_param)
+{
+    if (lut == NULL || env_correct_param == NULL)
+    {
+        printf("temp_correct_lut_update: invalid param\n");
+        return -1;
+    }
+    if (lut->is_filled && temp_correct_same_param(&lut->env_correct_param, env_correct_param))
+    {
+        return 0;
+    }
+
+    //the celsius of every y16 value, corrected by one lattice call
+    vector<float> org_temp(TEMP_CORRECT_LUT_SIZE);
+    for (int i = 0; i < TEMP_CORRECT_LUT_SIZE; i++)
+    {
+        org_temp[i] = (float)(i / 64.0 - 273.15);
+    }
+    EnvCorrectParam param = *env_correct_param;
+    if (enhance_distance_temp_correct_lattice(&param, lut->correct_table, lut->table_len, &org_temp[0], \
+        &lut->table[0], TEMP_CORRECT_LUT_SIZE) != IRLIB_SUCCESS)
+    {
+        printf("temp_correct_lut_update: fail to correct the temperatures\n");
+        lut->is_filled = false;
+        return -1;
+    }
+    lut->env_correct_param = *env_correct_param;
+    lut->is_filled = true;
+    lut->has_y16 = false;
+    return 1;
+}
+
+const float* temp_correct_lut_table(TempCorrectLut_t* lut)
+{
+    return (lut == NULL || !lut->is_filled) ? NULL : &lut->table[0];
+}
+
+int temp_correct_lut_apply(TempCorrectLut_t* lut, const uint16_t* y16_data, float* celsius, int pixel_num)
+{
+    if (lut == NULL || !lut->is_filled || y16_data == NULL || celsius == NULL || pixel_num < 0)
+    {
+        printf("temp_correct_lut_apply: invalid param\n");
+        return -1;
+    }
+
+    const float* table = &lut->table[0];
+    int i = 0;
+    for (; i + 4 <= pixel_num; i += 4)
+    {
+        celsius[i] = table[y16_data[i]];
+        celsius[i + 1] = table[y16_data[i + 1]];
+        celsius[i + 2] = table[y16_data[i + 2]];
+        celsius[i + 3] = table[y16_data[i + 3]];
+    }
+    for (; i < pixel_num; i++)
+    {
+        celsius[i] = table[y16_data[i]];
+    }
+    return 0;
+}
+
+float temp_correct_lut_celsius(TempCorrectLut_t* lut, float org_temp)
+{
+    if (lut == NULL || !lut->is_filled)
+    {
+        return org_temp;
+    }
+
+    double position = ((double)org_temp + 273.15) * 64;
+    if (position <= 0)
+    {
+        return lut->table[0];
+    }
+    if (position >= TEMP_CORRECT_LUT_SIZE - 1)
+    {
+        return lut->table[TEMP_CORRECT_LUT_SIZE - 1];
+    }
+    int i = (int)position;
+    float weight = (float)(position - i);
+    return lut->table[i] + (lut->table[i + 1] - lut->table[i]) * weight;
+}
+
+//the first y16 value at or above celsius uncorrected
+static uint16_t temp_correct_org_y16(float celsius)
+{
+    double y16 = ceil(((double)celsius + 273.15) * 64);
+    return (uint16_t)((y16 < 0) ? 0 : (y16 > TEMP_CORRECT_LUT_SIZE - 1) ? TEMP_CORRECT_LUT_SIZE - 1 : y16);
+}
+
+uint16_t temp_correct_lut_y16(TempCorrectLut_t* lut, float celsius)
+{
+    if (lut == NULL || !lut->is_filled)
+    {
+        return temp_correct_org_y16(celsius);
+    }
+    if (lut->has_y16 && lut->y16_celsius == celsius)
+    {
+        return lut->y16_value;
+    }
+
+    //the table needn't rise everywhere, the first value reaching celsius bounds all the others
+    int i = 0;
+    while (i < TEMP_CORRECT_LUT_SIZE - 1 && lut->table[i] < celsius)
+    {
+        i++;
+    }
+    lut->has_y16 = true;
+    lut->y16_celsius = celsius;
+    lut->y16_value = (uint16_t)i;
+    return lut->y16_value;
+}
+
+//pixels start~start + length - 1 of the frame corrected by one lut
+typedef struct {
+    int start;
+    int length;
+    int lut;
+}TempCorrectRun_t;
+
+struct TempCorrectMap_s {
+    uint16_t* correct_table;
+    uint32_t table_len;
+    int width;
+    int height;
+    vector<TempCorrectLut_t*> luts;     //the first one for the pixels out of the regions
+    vector<EnvCorrectParam> params;
+    vector<TempCorrectRun_t> runs;
+    vector<float> celsius;
+    vector<uint16_t> table;             //the table of temp_correct_map_load, correct_table points into it
+};
+
+TempCorrectMap_t* temp_correct_map_create(uint16_t* correct_table, uint32_t table_len, int width, int height)
+{
+    if (correct_table == NULL || width <= 0 || height <= 0)
+    {
+        printf("temp_correct_map_create: invalid param\n");
+        return NULL;
+    }
+
+    TempCorrectMap_t* map = new TempCorrectMap_t;
+    map->correct_table = correct_table;
+    map->table_len = table_len;
+    map->width = width;
+    map->height = height;
+    map->celsius.assign(width * height, 0);
+    return map;
+}
+
+void temp_correct_map_destroy(TempCorrectMap_t* map)
+{
+    if (map == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < map->luts.size(); i++)
+    {
+        temp_correct_lut_destroy(map->luts[i]);
+    }
+    delete map;
+}
+
+//the index of the param in params, added if it is a new one
+static int temp_correct_find_param(vector<EnvCorrectParam>* params, const EnvCorrectParam& param)
+{
+    for (size_t i = 0; i < params->size(); i++)
+    {
+        if (temp_correct_same_param(&(*params)[i], &param))
+        {
+            return (int)i;
+        }
+    }
+    params->push_back(param);
+    return (int)params->size() - 1;
+}
+
+//fill the luts of the new params, the luts of the params already used are kept, then cut the lut of every pixel
+//into runs
+static int temp_correct_map_set(TempCorrectMap_t* map, const vector<EnvCorrectParam>& params, const vector<uint8_t>& lut_ids)
+{
+    vector<TempCorrectLut_t*> luts(params.size(), (TempCorrectLut_t*)NULL);
+    vector<bool> is_new(params.size(), false);
+    vector<bool> is_kept(map->luts.size(), false);
+    bool is_filled = true;
+    for (size_t i = 0; i < params.size() && is_filled; i++)
+    {
+        for (size_t j = 0; j < map->params.size() && luts[i] == NULL; j++)
+        {
+            if (!is_kept[j] && temp_correct_same_param(&map->params[j], &params[i]))
+            {
+                luts[i] = map->luts[j];
+                is_kept[j] = true;
+            }
+        }
+        if (luts[i] == NULL)
+        {
+            luts[i] = temp_correct_lut_create(map->correct_table, map->table_len);
+            is_new[i] = true;
+            is_filled = (luts[i] != NULL && temp_correct_lut_update(luts[i], &params[i]) >= 0);
+        }
+    }
+    //the map stays as it was if a lut can't be filled
+    for (size_t i = 0; i < luts.size(); i++)
+    {
+        if (!is_filled && is_new[i])
+        {
+            temp_correct_lut_destroy(luts[i]);
+        }
+    }
+    if (!is_filled)
+    {
+        return -1;
+    }
+    for (size_t j = 0; j < map->luts.size(); j++)
+    {
+        if (!is_kept[j])
+        {
+            temp_correct_lut_destroy(map->luts[j]);
+        }
+    }
+    map->luts = luts;
+    map->params = params;
+
+    map->runs.clear();
+    int pixel_num = map->width * map->height;
+    for (int i = 0; i < pixel_num; i++)
+    {
+        if (map->runs.empty() || map->runs.back().lut != lut_ids[i])
+        {
+            TempCorrectRun_t run = { i, 0, lut_ids[i] };
+            map->runs.push_back(run);
+        }
+        map->runs.back().length++;
+    }
+    return 0;
+}
+
+int temp_correct_map_set_regions(TempCorrectMap_t* map, const EnvCorrectParam* env_correct_param, \
+    const TempCorrectRegion_t* regions, int region_num)
+{
+    if (map == NULL || env_correct_param == NULL || region_num < 0 || (regions == NULL && region_num > 0))
+    {
+        printf("temp_correct_map_set_regions: invalid param\n");
+        return -1;
+    }
+
+    vector<EnvCorrectParam> params(1, *env_correct_param);
+    vector<uint8_t> lut_ids(map->width * map->height, 0);
+    for (int i = 0; i < region_num; i++)
+    {
+        const TempCorrectRegion_t* region = &regions[i];
+        int x_start = (region->start_x < region->end_x) ? region->start_x : region->end_x;
+        int x_end = (region->start_x < region->end_x) ? region->end_x : region->start_x;
+        int y_start = (region->start_y < region->end_y) ? region->start_y : region->end_y;
+        int y_end = (region->start_y < region->end_y) ? region->end_y : region->start_y;
+        if (x_start < 0 || y_start < 0 || x_end >= map->width || y_end >= map->height)
+        {
+            printf("temp_correct_map_set_regions: region %d is out of the %dx%d frame\n", i, map->width, map->height);
+            return -1;
+        }
+        EnvCorrectParam param = *env_correct_param;
+        param.ems = region->ems;
+        param.dist = region->dist;
+        int lut = temp_correct_find_param(&params, param);
+        if (lut >= TEMP_CORRECT_MAP_MAX_LUT)
+        {
+            printf("temp_correct_map_set_regions: more than %d emissivity and distance\n", TEMP_CORRECT_MAP_MAX_LUT);
+            return -1;
+        }
+        for (int y = y_start; y <= y_end; y++)
+        {
+            memset(&lut_ids[y * map->width + x_start], lut, x_end - x_start + 1);
+        }
+    }
+    return temp_correct_map_set(map, params, lut_ids);
+}
+
+int temp_correct_map_set_pixels(TempCorrectMap_t* map, const EnvCorrectParam* env_correct_param, \
+    const float* ems_map, const float* dist_map)
+{
+    if (map == NULL || env_correct_param == NULL)
+    {
+        printf("temp_correct_map_set_pixels: invalid param\n");
+        return -1;
+    }
+
+    vector<EnvCorrectParam> params(1, *env_correct_param);
+    int pixel_num = map->width * map->height;
+    vector<uint8_t> lut_ids(pixel_num, 0);
+    EnvCorrectParam param = *env_correct_param;
+    int lut = 0;
+    for (int i = 0; i < pixel_num; i++)
+    {
+        float ems = (ems_map == NULL) ? env_correct_param->ems : ems_map[i];
+        float dist = (dist_map == NULL) ? env_correct_param->dist : dist_map[i];
+        //neighbours mostly share the param, only a change of it is looked up
+        if (ems != param.ems || dist != param.dist)
+        {
+            param.ems = ems;
+            param.dist = dist;
+            lut = temp_correct_find_param(&params, param);
+            if (lut >= TEMP_CORRECT_MAP_MAX_LUT)
+            {
+                printf("temp_correct_map_set_pixels: more than %d emissivity and distance\n", TEMP_CORRECT_MAP_MAX_LUT);
+                return -1;
+            }
+        }
+        lut_ids[i] = (uint8_t)lut;
+    }
+    return temp_correct_map_set(map, params, lut_ids);
+}
+
+int temp_correct_map_lut_num(TempCorrectMap_t* map)
+{
+    return (map == NULL) ? 0 : (int)map->luts.size();
+}
+
+const float* temp_correct_map_apply(TempCorrectMap_t* map, const uint16_t* y16_data)
+{
+    if (map == NULL || y16_data == NULL || map->luts.empty())
+    {
+        printf("temp_correct_map_apply: invalid param\n");
+        return NULL;
+    }
+
+    float* celsius = &map->celsius[0];
+    for (size_t i = 0; i < map->runs.size(); i++)
+    {
+        const TempCorrectRun_t& run = map->runs[i];
+        temp_correct_lut_apply(map->luts[run.lut], y16_data + run.start, celsius + run.start, run.length);
+    }
+    return celsius;
+}
+
+void temp_correct_default_param(EnvCorrectParam* env_correct_param)
+{
+    memset(env_correct_param, 0, sizeof(EnvCorrectParam));
+    env_correct_param->dist = 0.25;
+    env_correct_param->ems = 0.98;
+    env_correct_param->hum = 0.45;
+    env_correct_param->ta = 25;
+    env_correct_param->tu = 25;
+}
+
+TempCorrectMap_t* temp_correct_map_load(const char* table_path, const EnvCorrectParam* env_correct_param, \
+    int width, int height)
+{
+    if (table_path == NULL || env_correct_param == NULL)
+    {
+        printf("temp_correct_map_load: invalid param\n");
+        return NULL;
+    }
+
+    vector<uint16_t> table(TEMP_CORRECT_TABLE_LEN, 0);
+    FILE* fp = fopen(table_path, "rb");
+    if (fp == NULL)
+    {
+        printf("%s failed\n", table_path);
+        return NULL;
+    }
+    fread(&table[0], 1, table.size() * sizeof(uint16_t), fp);
+    fclose(fp);
+
+    TempCorrectMap_t* map = temp_correct_map_create(&table[0], 0, width, height);
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    //a swap hands the buffer over, correct_table stays valid
+    map->table.swap(table);
+    if (temp_correct_map_set_regions(map, env_correct_param, NULL, 0) < 0)
+    {
+        temp_correct_map_destroy(map);
+        return NULL;
+    }
+    return map;
+}
+
+float temp_correct_map_celsius(TempCorrectMap_t* map, float org_temp)
+{
+    return (map == NULL || map->luts.empty()) ? org_temp : temp_correct_lut_celsius(map->luts[0], org_temp);
+}
+
+uint16_t temp_correct_map_y16(TempCorrectMap_t* map, float celsius)
+{
+    return (map == NULL || map->luts.empty()) ? temp_correct_org_y16(celsius) : temp_correct_lut_y16(map->luts[0], celsius);
+}
+
+uint16_t temp_correct_map_y16_bound(TempCorrectMap_t* map, float celsius)
+{
+    if (map == NULL || map->luts.empty())
+    {
+        return temp_correct_org_y16(celsius);
+    }
+    uint16_t bound = TEMP_CORRECT_LUT_SIZE - 1;
+    for (size_t i = 0; i < map->luts.size(); i++)
+    {
+        uint16_t y16 = temp_correct_lut_y16(map->luts[i], celsius);
+        bound = (y16 < bound) ? y16 : bound;
+    }
+    return bound;
+}
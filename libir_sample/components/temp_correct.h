@@ -0,0 +1,94 @@
+#ifndef _TEMP_CORRECT_H_
+#define _TEMP_CORRECT_H_
+
+#include <stdint.h>
+#include "libirtemp.h"
+
+//y16 temp(1/64 kelvin) to celsius corrected for the emissivity, distance, humidity and the atmospheric and
+//reflection temperatures of an EnvCorrectParam, folded into one float per y16 value. the table is filled by
+//enhance_distance_temp_correct_lattice of libirtemp and refilled only when the param changes, so a corrected
+//temperature map costs one table read per pixel
+#define TEMP_CORRECT_LUT_SIZE   65536
+
+typedef struct TempCorrectLut_s TempCorrectLut_t;
+
+//the correct table of the module is read on every refill, the caller keeps it while the lut is used
+TempCorrectLut_t* temp_correct_lut_create(uint16_t* correct_table, uint32_t table_len);
+
+void temp_correct_lut_destroy(TempCorrectLut_t* lut);
+
+//refill the lut if the param differs from the one it was filled with, 1 if it was refilled
+int temp_correct_lut_update(TempCorrectLut_t* lut, const EnvCorrectParam* env_correct_param);
+
+//corrected celsius of every y16 value, NULL before the first update
+const float* temp_correct_lut_table(TempCorrectLut_t* lut);
+
+//the first y16 value corrected to celsius or above, every y16 value reaching celsius is at or above it. 0xffff if
+//none does, uncorrected before the first update
+uint16_t temp_correct_lut_y16(TempCorrectLut_t* lut, float celsius);
+
+//corrected temperature map of pixel_num y16 pixels
+int temp_correct_lut_apply(TempCorrectLut_t* lut, const uint16_t* y16_data, float* celsius, int pixel_num);
+
+//correct a celsius temperature between two y16 values, like an average, from the two entries around it.
+//uncorrected before the first update
+float temp_correct_lut_celsius(TempCorrectLut_t* lut, float org_temp);
+
+//a frame corrected with its own emissivity and distance in every pixel, from the luts above. pixels of the same
+//emissivity and distance share one lut, and the frame is kept as the runs of pixels of one lut in raster order so it
+//is corrected run by run, one table read per pixel
+#define TEMP_CORRECT_MAP_MAX_LUT    64
+
+typedef struct TempCorrectMap_s TempCorrectMap_t;
+
+//a rectangle from start to end, coordinates from 0 and the boundary included
+typedef struct {
+    int start_x;
+    int start_y;
+    int end_x;
+    int end_y;
+    float ems;
+    float dist;
+}TempCorrectRegion_t;
+
+TempCorrectMap_t* temp_correct_map_create(uint16_t* correct_table, uint32_t table_len, int width, int height);
+
+void temp_correct_map_destroy(TempCorrectMap_t* map);
+
+//the humidity, atmospheric and reflection temperatures of the param apply to the whole frame, its emissivity and
+//distance to the pixels out of every region. a later region covers the earlier ones
+int temp_correct_map_set_regions(TempCorrectMap_t* map, const EnvCorrectParam* env_correct_param, \
+    const TempCorrectRegion_t* regions, int region_num);
+
+//emissivity and distance of every pixel, a NULL map keeps the one of the param. at most TEMP_CORRECT_MAP_MAX_LUT
+//different pairs
+int temp_correct_map_set_pixels(TempCorrectMap_t* map, const EnvCorrectParam* env_correct_param, \
+    const float* ems_map, const float* dist_map);
+
+int temp_correct_map_lut_num(TempCorrectMap_t* map);
+
+//corrected celsius of a y16 frame of the map size, kept by the map until the next apply. NULL before a set
+const float* temp_correct_map_apply(TempCorrectMap_t* map, const uint16_t* y16_data);
+
+//the correct table of the module the samples read from their working directory, and the env param they correct with:
+//0.25 m, emissivity 0.98, humidity 0.45 and 25 celsius atmospheric and reflection temperatures
+#define TEMP_CORRECT_TABLE_FILE     "V265_wn256without_dust_tablets_L.bin"
+#define TEMP_CORRECT_TABLE_LEN      (HEAD_SIZE + 45 * 88)
+
+void temp_correct_default_param(EnvCorrectParam* env_correct_param);
+
+//a map of the correct table read from table_path, kept by the map, with the param all over the frame. NULL if the
+//table can't be read
+TempCorrectMap_t* temp_correct_map_load(const char* table_path, const EnvCorrectParam* env_correct_param, \
+    int width, int height);
+
+//correct a celsius temperature with the param out of the regions
+float temp_correct_map_celsius(TempCorrectMap_t* map, float org_temp);
+
+//the y16 of a corrected temperature with the param out of the regions, like temp_correct_lut_y16
+uint16_t temp_correct_map_y16(TempCorrectMap_t* map, float celsius);
+
+//a y16 value at or below every pixel the map corrects to celsius or above, whatever its lut
+uint16_t temp_correct_map_y16_bound(TempCorrectMap_t* map, float celsius);
+
+#endif
@@ -89,6 +89,10 @@ temp_measure_error_e init_temp_measure_handle(temp_measure_t* handle, IrinfoTpdI
 	handle->temp_frame_info.temp_height = temp_height;
 	handle->temp_frame_info.temp_width = temp_width;
 	handle->ircmd_handle = ircmd_handle;
+	handle->row_band_pool = NULL;
+	handle->rect_index = NULL;
+	handle->correct_map = NULL;
+	handle->celsius_frame = NULL;
 	handle->temp_frame_info.temp_frame = (uint8_t*)malloc((handle->temp_frame_info.temp_height) * \
 		(handle->temp_frame_info.temp_width) * 2 * sizeof(uint8_t));
 
@@ -121,6 +125,63 @@ temp_measure_error_e destroy_temp_measure_handle(temp_measure_t* handle)
 }
 
 
+//a roi measured on the corrected temp frame, the extremes are the corrected ones
+static temp_measure_error_e get_roi_temp_from_celsius_frame(temp_measure_t* handle, Roi_t roi, \
+	LineRectTempData_t* temp_value)
+{
+	RoiSet_t* roi_set = roi_set_create(&roi, 1, handle->temp_frame_info.temp_width, handle->temp_frame_info.temp_height);
+	RoiTempResult_t* result = roi_temp_result_create(roi_set);
+	temp_measure_error_e ret = TEMP_MEASURE_PROCESS_FAIL;
+	if (result != NULL && roi_set_measure_celsius(roi_set, (uint16_t*)(handle->temp_frame_info.temp_frame), \
+		handle->celsius_frame, result) == 0)
+	{
+		temp_value->ave_temp = result->ave_temp[0];
+		temp_value->max_min_temp_info.max_temp = result->max_temp[0];
+		temp_value->max_min_temp_info.min_temp = result->min_temp[0];
+		temp_value->max_min_temp_info.max_temp_point.x = result->max_x[0];
+		temp_value->max_min_temp_info.max_temp_point.y = result->max_y[0];
+		temp_value->max_min_temp_info.min_temp_point.x = result->min_x[0];
+		temp_value->max_min_temp_info.min_temp_point.y = result->min_y[0];
+		ret = TEMP_MEASURE_SUCCESS;
+	}
+	roi_temp_result_destroy(result);
+	roi_set_destroy(roi_set);
+	return ret;
+}
+
+
+temp_measure_error_e temp_measure_correct_frame(temp_measure_t* handle)
+{
+	if (handle == NULL)
+	{
+		IR_TEMP_MEASURE_ERROR("handle is NULL");
+		return TEMP_MEASURE_ERROR_PARAM;
+	}
+
+	//one lut is monotonic in y16, the extremes of the y16 frame are the corrected ones and temp_measure_corrected_temp
+	//corrects them afterwards. only a map of regions is applied to the frame
+	handle->celsius_frame = NULL;
+	if (temp_correct_map_lut_num(handle->correct_map) > 1 && handle->frame_format != TEMP_MEASURE_ONLY_IMAGE \
+		&& handle->temp_frame_info.temp_format == TEMP_FRAME_FMT_Y16 && handle->temp_frame_info.temp_frame != NULL)
+	{
+		handle->celsius_frame = temp_correct_map_apply(handle->correct_map, (uint16_t*)(handle->temp_frame_info.temp_frame));
+	}
+	if (handle->celsius_frame != NULL)
+	{
+		return TEMP_MEASURE_SUCCESS;
+	}
+
+	//the rects of a frame measured in y16 are answered from the index
+	if (handle->rect_index != NULL && handle->frame_format != TEMP_MEASURE_ONLY_IMAGE \
+		&& handle->temp_frame_info.temp_format == TEMP_FRAME_FMT_Y16 && handle->temp_frame_info.temp_frame != NULL)
+	{
+		rect_index_build(handle->rect_index, (uint16_t*)(handle->temp_frame_info.temp_frame));
+	}
+	IR_TEMP_MEASURE_DEBUG("the temp frame is measured uncorrected");
+	return TEMP_MEASURE_PROCESS_FAIL;
+}
+
+
 temp_measure_error_e get_frame_temp_from_frame_info(IrinfoTpdInfo_t* tpd_info, MaxMinTempData_t* frame_temp_value)
 {
 	if (tpd_info == NULL || frame_temp_value == NULL)
@@ -153,23 +214,32 @@ temp_measure_error_e get_frame_temp_from_temp_frame(temp_measure_t* handle, MaxM
 		return TEMP_MEASURE_ERROR_PARAM;
 	}
 
-	if (handle->frame_format != TEMP_MEASURE_ONLY_IMAGE)
+	if (handle->celsius_frame != NULL)
+	{
+		Roi_t frame = { ROI_TYPE_RECT, 0, 0, (int)handle->temp_frame_info.temp_width - 1, \
+			(int)handle->temp_frame_info.temp_height - 1 };
+		LineRectTempData_t frame_temp;
+		if (get_roi_temp_from_celsius_frame(handle, frame, &frame_temp) == TEMP_MEASURE_SUCCESS)
+		{
+			*frame_temp_value = frame_temp.max_min_temp_info;
+			return TEMP_MEASURE_SUCCESS;
+		}
+	}
+	else if (handle->frame_format != TEMP_MEASURE_ONLY_IMAGE)
 	{
 		if (handle->temp_frame_info.temp_format == TEMP_FRAME_FMT_Y16)
 		{
-			TempDataRes_t temp_res = { handle->temp_frame_info.temp_width, handle->temp_frame_info.temp_height };
-			Area_t rect = { 0,0, handle->temp_frame_info.temp_width, handle->temp_frame_info.temp_height };
-			TempInfo_t temp_info = { 0 };
-			IrlibError_e ret;
-			ret = get_rect_temp((uint16_t*)(handle->temp_frame_info.temp_frame), temp_res, rect, &temp_info);
-			if (ret == IRLIB_SUCCESS)
+			//in-tree scan of the whole frame instead of get_rect_temp, split into row bands on the pool
+			RowBandMinMax_t min_max;
+			if (row_band_y16_min_max(handle->row_band_pool, (uint16_t*)(handle->temp_frame_info.temp_frame), \
+				handle->temp_frame_info.temp_width, handle->temp_frame_info.temp_height, &min_max) == 0)
 			{
-				frame_temp_value->max_temp = ((double)temp_info.max_temp) / 64 - 273.15;
-				frame_temp_value->min_temp = ((double)temp_info.min_temp) / 64 - 273.15;
-				frame_temp_value->max_temp_point.x = temp_info.max_cord.x;
-				frame_temp_value->max_temp_point.y = temp_info.max_cord.y;
-				frame_temp_value->min_temp_point.x = temp_info.min_cord.x;
-				frame_temp_value->min_temp_point.y = temp_info.min_cord.y;
+				frame_temp_value->max_temp = min_max.max_value / 64.0f - 273.15f;
+				frame_temp_value->min_temp = min_max.min_value / 64.0f - 273.15f;
+				frame_temp_value->max_temp_point.x = min_max.max_x;
+				frame_temp_value->max_temp_point.y = min_max.max_y;
+				frame_temp_value->min_temp_point.x = min_max.min_x;
+				frame_temp_value->min_temp_point.y = min_max.min_y;
 				return TEMP_MEASURE_SUCCESS;
 			}
 		}
@@ -297,7 +367,15 @@ temp_measure_error_e get_point_temp_from_temp_frame(temp_measure_t* handle, IrPo
 		return TEMP_MEASURE_ERROR_PARAM;
 	}
 
-	if (handle->frame_format != TEMP_MEASURE_ONLY_IMAGE)
+	if (handle->celsius_frame != NULL)
+	{
+		if (point_pos.x < handle->temp_frame_info.temp_width && point_pos.y < handle->temp_frame_info.temp_height)
+		{
+			*point_temp_value = handle->celsius_frame[point_pos.y * handle->temp_frame_info.temp_width + point_pos.x];
+			return TEMP_MEASURE_SUCCESS;
+		}
+	}
+	else if (handle->frame_format != TEMP_MEASURE_ONLY_IMAGE)
 	{
 		if (handle->temp_frame_info.temp_format == TEMP_FRAME_FMT_Y16)
 		{
@@ -435,7 +513,16 @@ temp_measure_error_e get_line_temp_from_temp_frame(temp_measure_t* handle, IrLin
 		return TEMP_MEASURE_ERROR_PARAM;
 	}
 
-	if (handle->frame_format != TEMP_MEASURE_ONLY_IMAGE)
+	if (handle->celsius_frame != NULL)
+	{
+		Roi_t line = { ROI_TYPE_LINE, line_pos.start_point.x, line_pos.start_point.y, \
+			line_pos.end_point.x, line_pos.end_point.y };
+		if (get_roi_temp_from_celsius_frame(handle, line, line_temp_value) == TEMP_MEASURE_SUCCESS)
+		{
+			return TEMP_MEASURE_SUCCESS;
+		}
+	}
+	else if (handle->frame_format != TEMP_MEASURE_ONLY_IMAGE)
 	{
 		if (handle->temp_frame_info.temp_format == TEMP_FRAME_FMT_Y16)
 		{
@@ -588,6 +675,29 @@ temp_measure_error_e get_rect_temp_from_temp_frame(temp_measure_t* handle, IrRec
 		return TEMP_MEASURE_ERROR_PARAM;
 	}
 
+	if (handle->celsius_frame != NULL)
+	{
+		Roi_t rect = { ROI_TYPE_RECT, rect_pos.start_point.x, rect_pos.start_point.y, \
+			rect_pos.end_point.x, rect_pos.end_point.y };
+		return get_roi_temp_from_celsius_frame(handle, rect, rect_temp_value);
+	}
+
+	RectIndexResult_t index_result;
+	if (handle->rect_index != NULL \
+		&& rect_index_frame(handle->rect_index) == (uint16_t*)(handle->temp_frame_info.temp_frame) \
+		&& rect_index_query(handle->rect_index, rect_pos.start_point.x, \
+		rect_pos.start_point.y, rect_pos.end_point.x, rect_pos.end_point.y, &index_result) == 0)
+	{
+		rect_temp_value->ave_temp = (double)index_result.sum / index_result.pixel_num / 64 - 273.15;
+		rect_temp_value->max_min_temp_info.max_temp = ((double)index_result.max_value) / 64 - 273.15;
+		rect_temp_value->max_min_temp_info.min_temp = ((double)index_result.min_value) / 64 - 273.15;
+		rect_temp_value->max_min_temp_info.max_temp_point.x = index_result.max_x;
+		rect_temp_value->max_min_temp_info.max_temp_point.y = index_result.max_y;
+		rect_temp_value->max_min_temp_info.min_temp_point.x = index_result.min_x;
+		rect_temp_value->max_min_temp_info.min_temp_point.y = index_result.min_y;
+		return TEMP_MEASURE_SUCCESS;
+	}
+
 	TempDataRes_t temp_res = { handle->temp_frame_info.temp_width, handle->temp_frame_info.temp_height };
 	Area_t rect = { rect_pos.start_point.x, rect_pos.start_point.y, \
 		rect_pos.end_point.x - rect_pos.start_point.x + 1, rect_pos.end_point.y - rect_pos.start_point.y + 1 };
@@ -691,6 +801,67 @@ temp_measure_error_e temp_measure_get_rect_temp(temp_measure_t* handle, IrRect_t
 	return TEMP_MEASURE_PROCESS_FAIL;
 }
 
+temp_measure_error_e temp_measure_get_roi_set_temp(temp_measure_t* handle, RoiSet_t* roi_set, RoiTempResult_t* roi_temp_value)
+{
+	if (handle == NULL || roi_set == NULL || roi_temp_value == NULL)
+	{
+		IR_TEMP_MEASURE_ERROR("handle or roi_set or roi_temp_value is NULL");
+		return TEMP_MEASURE_ERROR_PARAM;
+	}
+
+	//the sensor reports a few rois in the frame info at most, a set is only measured on the temp frame
+	if (handle->frame_format != TEMP_MEASURE_ONLY_IMAGE && handle->temp_frame_info.temp_format == TEMP_FRAME_FMT_Y16 \
+		&& handle->temp_frame_info.temp_frame != NULL)
+	{
+		int ret = (handle->celsius_frame != NULL) ? roi_set_measure_celsius(roi_set, \
+			(uint16_t*)(handle->temp_frame_info.temp_frame), handle->celsius_frame, roi_temp_value) \
+			: roi_set_measure(roi_set, (uint16_t*)(handle->temp_frame_info.temp_frame), roi_temp_value);
+		if (ret == 0)
+		{
+			IR_TEMP_MEASURE_DEBUG("use temp frame to get roi set temp successfully");
+			return TEMP_MEASURE_SUCCESS;
+		}
+	}
+
+	IR_TEMP_MEASURE_DEBUG("fail to get roi set temp");
+	return TEMP_MEASURE_PROCESS_FAIL;
+}
+
+temp_measure_error_e temp_measure_get_hot_blobs(temp_measure_t* handle, HotBlob_t* hot_blob, float threshold_temp, \
+	uint32_t min_pixel_num, HotBlobResult_t* hot_blob_value)
+{
+	if (handle == NULL || hot_blob == NULL || hot_blob_value == NULL)
+	{
+		IR_TEMP_MEASURE_ERROR("handle or hot_blob or hot_blob_value is NULL");
+		return TEMP_MEASURE_ERROR_PARAM;
+	}
+
+	//threshold_temp is a corrected temperature: the blobs of a corrected frame are thresholded on it, within a y16
+	//bound of all its luts. the y16 frame is thresholded on the y16 of threshold_temp with the param out of the regions,
+	//like the temps measured on it are corrected by temp_measure_corrected_temp
+	if (handle->frame_format != TEMP_MEASURE_ONLY_IMAGE && handle->temp_frame_info.temp_format == TEMP_FRAME_FMT_Y16 \
+		&& handle->temp_frame_info.temp_frame != NULL)
+	{
+		uint16_t threshold = (handle->celsius_frame != NULL) ? temp_correct_map_y16_bound(handle->correct_map, threshold_temp) \
+			: temp_correct_map_y16(handle->correct_map, threshold_temp);
+		if (hot_blob_detect(hot_blob, (uint16_t*)(handle->temp_frame_info.temp_frame), handle->celsius_frame, \
+			threshold, threshold_temp, min_pixel_num, hot_blob_value) == 0)
+		{
+			IR_TEMP_MEASURE_DEBUG("use temp frame to get hot blobs successfully");
+			return TEMP_MEASURE_SUCCESS;
+		}
+	}
+
+	IR_TEMP_MEASURE_DEBUG("fail to get hot blobs");
+	return TEMP_MEASURE_PROCESS_FAIL;
+}
+
+//measured on the corrected temp frame already, or by the sensor and corrected with the param out of the regions
+static float temp_measure_corrected_temp(temp_measure_t* handle, float temp)
+{
+	return (handle->celsius_frame != NULL) ? temp : temp_correct_map_celsius(handle->correct_map, temp);
+}
+
 void* temp_measure_function(void* threadarg)
 {
 	printf("temp_measure_function start\n");
@@ -716,6 +887,8 @@ void* temp_measure_function(void* threadarg)
 	memset(&rect_temp_value, 0, sizeof(rect_temp_value));
 	frame_format_e frame_format = TEMP_MEASURE_IMAGE_AND_TEMP;
 	temp_format_e temp_format = TEMP_FRAME_FMT_Y16;
+	StreamFrameInfo_t frame_view = *stream_frame_info;
+	FrameSlot_t slot;
 
 	if (stream_frame_info->frame_output_format == YUYV_IMAGE || stream_frame_info->frame_output_format == NV12_IMAGE)
 	{
@@ -731,36 +904,36 @@ void* temp_measure_function(void* threadarg)
 		stream_frame_info->temp_info.width, \
 		frame_format, \
 		temp_format);
-	handle.temp_frame_info.temp_frame = stream_frame_info->temp_info.data;
+	handle.row_band_pool = stream_frame_info->pipeline->row_band_pool;
+	//measure in place on the temp view of the newest frame in the ring
+	free(handle.temp_frame_info.temp_frame);
+	handle.temp_frame_info.temp_frame = NULL;
 
 	//init temp correct env
 	float org_temp = 100;
 	float new_temp = 0;
-	uint32_t table_len = 0;
-	uint16_t correct_table[HEAD_SIZE + 45 * 88];
-
-	EnvCorrectParam env_correct_param = { 0 };
-	env_correct_param.dist = 0.25;
-	env_correct_param.ems = 0.98;
-	env_correct_param.hum = 0.45;
-	env_correct_param.ta = 25;
-	env_correct_param.tu = 25;
-
-	FILE* fp = fopen("V265_wn256without_dust_tablets_L.bin", "rb");
-	if (fp == NULL)
-	{
-		printf("V265_wn256without_dust_tablets_L.bin failed\n");
-		return NULL;
-	}
-	fread(correct_table, 1, sizeof(correct_table), fp);
-	fclose(fp);
-
-	while (isRUNNING)
+	EnvCorrectParam env_correct_param;
+	temp_correct_default_param(&env_correct_param);
+
+	//the temps are corrected with the env param, regions of other emissivity and distance can be set on the map.
+	//without the correct table they are measured uncorrected, the cmd thread is answered either way
+	TempCorrectMap_t* correct_map = temp_correct_map_load(TEMP_CORRECT_TABLE_FILE, &env_correct_param, \
+		stream_frame_info->temp_info.width, stream_frame_info->temp_info.height);
+	handle.correct_map = correct_map;
+	handle.rect_index = rect_index_create(stream_frame_info->temp_info.width, stream_frame_info->temp_info.height);
+	//a run budget of a run per 80 pixels, 16384 at 1280x1024, labels a threshold set in the noise of the background in
+	//about 4ms, joining the runs of the rows over their share of it
+	HotBlob_t* hot_blob = hot_blob_create(stream_frame_info->temp_info.width, stream_frame_info->temp_info.height, \
+		stream_frame_info->temp_info.width * stream_frame_info->temp_info.height / 80);
+	HotBlobResult_t hot_blob_value;
+	float threshold_temp = 0;
+
+	while (stream_frame_info->pipeline->is_running)
 	{
 #if defined(_WIN32)
-		WaitForSingleObject(temp_sem, INFINITE);
+		WaitForSingleObject(stream_frame_info->pipeline->temp_sem, INFINITE);
 #elif defined (linux)||(unix)
-		sem_wait(&temp_sem);
+		sem_wait(&stream_frame_info->pipeline->temp_sem);
 #endif
 
 
@@ -769,17 +942,31 @@ void* temp_measure_function(void* threadarg)
 		printf("2:get_point_temp\n");
 		printf("3:get_line_temp\n");
 		printf("4:get_rect_temp\n");
+		printf("5:get_hot_blobs\n");
 		printf("-------------------------------------------------------------------------------------\n");
 		scanf("%d", &cmd);
 
+		//holding the frame keeps it valid while the stream thread goes on with other slots
+		if (frame_ring_read_latest(frame_view.frame_ring, &slot) != 0)
+		{
+#if defined(_WIN32)
+			ReleaseSemaphore(stream_frame_info->pipeline->cmd_sem, 1, NULL);
+#elif defined (linux)||(unix)
+			sem_post(&stream_frame_info->pipeline->cmd_sem);
+#endif
+			break;
+		}
+		bind_stream_frame_info(&frame_view, slot.raw_buffer, slot.raw_temp_buffer);
+		handle.temp_frame_info.temp_frame = frame_view.temp_info.data;
+		temp_measure_correct_frame(&handle);
+
 		switch (cmd)
 		{
 		case 1:
-			temp_measure_on = 1;
 			temp_measure_get_frame_temp(&handle, &frame_temp_value);
-			enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, frame_temp_value.max_temp, &new_temp);
+			new_temp = temp_measure_corrected_temp(&handle, frame_temp_value.max_temp);
 			printf("frame_temp_value.max_temp is %f\n", new_temp);
-			enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, frame_temp_value.min_temp, &new_temp);
+			new_temp = temp_measure_corrected_temp(&handle, frame_temp_value.min_temp);
 			printf("frame_temp_value.min_temp is %f\n", new_temp);
 			printf("frame_temp_value->max_temp_point.x = %d\n", frame_temp_value.max_temp_point.x);
 			printf("frame_temp_value->max_temp_point.y = %d\n", frame_temp_value.max_temp_point.y);
@@ -789,9 +976,8 @@ void* temp_measure_function(void* threadarg)
 		case 2:
 			printf("Please enter point coordinate\n");
 			scanf("%hd %hd", &(point_pos.x), &(point_pos.y));
-			temp_measure_on = 1;
 			temp_measure_get_point_temp(&handle, point_pos, &point_temp_value);
-			enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, point_temp_value, &new_temp);
+			new_temp = temp_measure_corrected_temp(&handle, point_temp_value);
 			printf("point_temp_value is %f\n", new_temp);
 			break;
 		case 3:
@@ -800,15 +986,14 @@ void* temp_measure_function(void* threadarg)
 			scanf("%hd %hd", &(line_pos.start_point.x), &(line_pos.start_point.y));
 			printf("Please enter end point coordinate\n");
 			scanf("%hd %hd", &(line_pos.end_point.x), &(line_pos.end_point.y));
-			temp_measure_on = 1;
 			temp_measure_get_line_temp(&handle, line_pos, &line_temp_value);
-			enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, line_temp_value.ave_temp, &new_temp);
+			new_temp = temp_measure_corrected_temp(&handle, line_temp_value.ave_temp);
 			printf("ave_temp is %f\n", new_temp);
-			enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, line_temp_value.max_min_temp_info.max_temp, &new_temp);
+			new_temp = temp_measure_corrected_temp(&handle, line_temp_value.max_min_temp_info.max_temp);
 			printf("max_temp is %f\n", new_temp);
 			printf("max_temp_point_coordinate is ( %d , %d )\n", line_temp_value.max_min_temp_info.max_temp_point.x, \
 				line_temp_value.max_min_temp_info.max_temp_point.y);
-			enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, line_temp_value.max_min_temp_info.min_temp, &new_temp);
+			new_temp = temp_measure_corrected_temp(&handle, line_temp_value.max_min_temp_info.min_temp);
 			printf("min_temp is %f\n", new_temp);
 			printf("min_temp_point_coordinate is ( %d , %d )\n", line_temp_value.max_min_temp_info.min_temp_point.x, \
 				line_temp_value.max_min_temp_info.min_temp_point.y);
@@ -819,33 +1004,55 @@ void* temp_measure_function(void* threadarg)
 			scanf("%hd %hd", &(rect_pos.start_point.x), &(rect_pos.start_point.y));
 			printf("Please enter end point coordinate\n");
 			scanf("%hd %hd", &(rect_pos.end_point.x), &(rect_pos.end_point.y));
-			temp_measure_on = 1;
 			temp_measure_get_rect_temp(&handle, rect_pos, &rect_temp_value);
-			enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, rect_temp_value.ave_temp, &new_temp);
+			new_temp = temp_measure_corrected_temp(&handle, rect_temp_value.ave_temp);
 			printf("ave_temp is %f\n", new_temp);
-			enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, rect_temp_value.max_min_temp_info.max_temp, &new_temp);
+			new_temp = temp_measure_corrected_temp(&handle, rect_temp_value.max_min_temp_info.max_temp);
 			printf("max_temp is %f\n", new_temp);
 			printf("max_temp_point_coordinate is ( %d , %d )\n", rect_temp_value.max_min_temp_info.max_temp_point.x, \
 				rect_temp_value.max_min_temp_info.max_temp_point.y);
-			enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, rect_temp_value.max_min_temp_info.min_temp, &new_temp);
+			new_temp = temp_measure_corrected_temp(&handle, rect_temp_value.max_min_temp_info.min_temp);
 			printf("min_temp is %f\n", new_temp);
 			printf("min_temp_point_coordinate is ( %d , %d )\n", rect_temp_value.max_min_temp_info.min_temp_point.x, \
 				rect_temp_value.max_min_temp_info.min_temp_point.y);
 			break;
+		case 5:
+			printf("Please enter threshold temperature\n");
+			scanf("%f", &threshold_temp);
+			if (temp_measure_get_hot_blobs(&handle, hot_blob, threshold_temp, 1, &hot_blob_value) != TEMP_MEASURE_SUCCESS)
+			{
+				break;
+			}
+			printf("%d hot blobs, %d rows joined over gaps up to %d pixels\n", hot_blob_value.blob_num, \
+				hot_blob_value.join_row_num, hot_blob_value.join_gap);
+			for (int i = 0; i < hot_blob_value.blob_num; i++)
+			{
+				HotBlobInfo_t* blob = &hot_blob_value.blobs[i];
+				printf("blob %d: ( %d , %d ) to ( %d , %d ), %u pixels, max_temp %f at ( %d , %d ), ave_temp %f\n", i, \
+					blob->start_x, blob->start_y, blob->end_x, blob->end_y, blob->pixel_num, \
+					temp_measure_corrected_temp(&handle, blob->max_temp), blob->max_x, blob->max_y, \
+					temp_measure_corrected_temp(&handle, blob->ave_temp));
+			}
+			break;
 		default:
 			printf("param is invalid!\n");
 			break;
 		}
 
-		temp_measure_on = 0;
+		handle.temp_frame_info.temp_frame = NULL;
+		handle.celsius_frame = NULL;
+		frame_ring_release(&slot);
 #if defined(_WIN32)
-		ReleaseSemaphore(temp_done_sem, 1, NULL);
-		ReleaseSemaphore(cmd_sem, 1, NULL);
+		ReleaseSemaphore(stream_frame_info->pipeline->cmd_sem, 1, NULL);
 #elif defined (linux)||(unix)
-		sem_post(&temp_done_sem);
-		sem_post(&cmd_sem);
+		sem_post(&stream_frame_info->pipeline->cmd_sem);
 #endif
 	}
+	handle.correct_map = NULL;
+	temp_correct_map_destroy(correct_map);
+	rect_index_destroy(handle.rect_index);
+	handle.rect_index = NULL;
+	hot_blob_destroy(hot_blob);
 	destroy_temp_measure_handle(&handle);
 
 	return NULL;
@@ -14,6 +14,13 @@
 #include "libirtemp.h"
 #include "info_parse.h"
 #include "data.h"
+#include "pipeline.h"
+#include "frame_ring.h"
+#include "row_band_kernels.h"
+#include "roi_temp.h"
+#include "rect_index.h"
+#include "temp_correct.h"
+#include "hot_blob.h"
 
 #if defined(_WIN32)
 #define IR_TEMP_MEASURE_DEBUG(format, ...) ir_temp_measure_debug_print("ir temp measure debug [%s:%d/%s] " format "\n", \
@@ -151,6 +158,17 @@
 		frame_format_e frame_format;
 		temp_frame_info_t temp_frame_info;
 		IrcmdHandle_t* ircmd_handle;
+		/// row band pool of the frame scans, NULL scans in the calling thread
+		RowBandPool_t* row_band_pool;
+		/// index of the current temp frame for many rects per frame, built by temp_measure_correct_frame when
+		/// the frame isn't corrected. NULL, or an index of another frame, measures every rect with libirtemp, which
+		/// also smooths isolated pixels the index keeps
+		RectIndex_t* rect_index;
+		/// emissivity and distance map of the temp frame, NULL leaves the temperatures uncorrected
+		TempCorrectMap_t* correct_map;
+		/// the current temp frame corrected by temp_measure_correct_frame when the correct_map has regions, NULL
+		/// otherwise: the frame is measured in y16 and the temps are corrected one by one
+		const float* celsius_frame;
 	}temp_measure_t;
 
 #pragma pack ()
@@ -162,6 +180,10 @@
 
 	temp_measure_error_e destroy_temp_measure_handle(temp_measure_t* handle);
 
+	//correct the current temp frame with a correct map of regions, the temps measured on the frame are then corrected
+	//ones. any other frame is indexed by rect_index if set
+	temp_measure_error_e temp_measure_correct_frame(temp_measure_t* handle);
+
 	temp_measure_error_e temp_measure_get_frame_temp(temp_measure_t* handle, MaxMinTempData_t* frame_temp_value);
 
 	temp_measure_error_e temp_measure_get_point_temp(temp_measure_t* handle, IrPoint_t point_pos, float* point_temp_value);
@@ -170,6 +192,14 @@
 
 	temp_measure_error_e temp_measure_get_rect_temp(temp_measure_t* handle, IrRect_t rect_pos, LineRectTempData_t* rect_temp_value);
 
+	//every roi of a set compiled for the temp frame size, in one pass over the y16 temp frame
+	temp_measure_error_e temp_measure_get_roi_set_temp(temp_measure_t* handle, RoiSet_t* roi_set, RoiTempResult_t* roi_temp_value);
+
+	//blobs of the temp frame pixels at or above threshold_temp(corrected celsius), detected by a hot_blob of the temp
+	//frame size
+	temp_measure_error_e temp_measure_get_hot_blobs(temp_measure_t* handle, HotBlob_t* hot_blob, float threshold_temp, \
+		uint32_t min_pixel_num, HotBlobResult_t* hot_blob_value);
+
 	void* temp_measure_function(void* threadarg);
 
 	void ircmd_temp_measure_log_register(IrcmdLogLevel_e log_level);
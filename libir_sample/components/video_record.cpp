@@ -0,0 +1,482 @@
+#define _CRT_SECURE_NO_WARNINGS
+#include "video_record.h"
+#include "pixel_convert.h"
+#include <string.h>
+#include <vector>
+
+#if defined(_WIN32)
+#define HAVE_STRUCT_TIMESPEC
+#endif
+#include <pthread.h>
+
+extern "C" {
+#include "libavformat/avformat.h"
+#include "libavcodec/avcodec.h"
+#include "libavutil/avutil.h"
+#include "libavutil/opt.h"
+}
+
+using std::vector;
+
+//pts are milliseconds from the first frame, the time base of matroska
+#define VIDEO_RECORD_TIME_BASE  1000
+#define VIDEO_RECORD_QSCALE     3
+
+//one encoded stream of the file, the frame is reused for every capture
+typedef struct {
+    AVCodecContext* codec_ctx;
+    AVStream* stream;
+    AVFrame* frame;
+    AVPacket* packet;
+}VideoRecordTrack_t;
+
+struct VideoRecord_s {
+    VideoRecordParam_t param;
+    AVFormatContext* format_ctx;
+    VideoRecordTrack_t image;   //codec_ctx is NULL for a stream the recording doesn't have
+    VideoRecordTrack_t temp;
+    uint64_t first_timestamp_us;
+    int64_t last_pts;
+    uint32_t frame_num;
+};
+
+static void video_record_track_free(VideoRecordTrack_t* track)
+{
+    av_packet_free(&track->packet);
+    av_frame_free(&track->frame);
+    avcodec_free_context(&track->codec_ctx);
+}
+
+static void video_record_free(VideoRecord_t* record)
+{
+    video_record_track_free(&record->image);
+    video_record_track_free(&record->temp);
+    if (record->format_ctx != NULL)
+    {
+        if (!(record->format_ctx->oformat->flags & AVFMT_NOFILE))
+        {
+            avio_closep(&record->format_ctx->pb);
+        }
+        avformat_free_context(record->format_ctx);
+    }
+    delete record;
+}
+
+static int video_record_track_open(VideoRecord_t* record, VideoRecordTrack_t* track, const char* encoder_name, \
+    AVPixelFormat pix_fmt, int width, int height)
+{
+    const AVCodec* codec = avcodec_find_encoder_by_name(encoder_name);
+    if (codec == NULL)
+    {
+        printf("can not find codec %s!\n", encoder_name);
+        return -1;
+    }
+    track->codec_ctx = avcodec_alloc_context3(codec);
+    track->frame = av_frame_alloc();
+    track->packet = av_packet_alloc();
+    if (track->codec_ctx == NULL || track->frame == NULL || track->packet == NULL)
+    {
+        printf("there is no more space!\n");
+        return -1;
+    }
+
+    AVCodecContext* codec_ctx = track->codec_ctx;
+    codec_ctx->codec_type = AVMEDIA_TYPE_VIDEO;
+    codec_ctx->pix_fmt = pix_fmt;
+    codec_ctx->width = width;
+    codec_ctx->height = height;
+    codec_ctx->time_base.num = 1;
+    codec_ctx->time_base.den = VIDEO_RECORD_TIME_BASE;
+    if (record->format_ctx->oformat->flags & AVFMT_GLOBALHEADER)
+    {
+        codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    if (strcmp(encoder_name, "mjpeg") == 0)
+    {
+        codec_ctx->flags |= AV_CODEC_FLAG_QSCALE;
+        codec_ctx->global_quality = FF_QP2LAMBDA * VIDEO_RECORD_QSCALE;
+    }
+    else if (strcmp(encoder_name, "libx264") == 0)
+    {
+        //no b frames and no lookahead, every frame is out of the encoder before the next one comes in
+        av_opt_set(codec_ctx->priv_data, "preset", "ultrafast", 0);
+        av_opt_set(codec_ctx->priv_data, "tune", "zerolatency", 0);
+    }
+    if (avcodec_open2(codec_ctx, codec, NULL) < 0)
+    {
+        printf("con not open codec %s!\n", encoder_name);
+        return -1;
+    }
+
+    track->stream = avformat_new_stream(record->format_ctx, NULL);
+    if (track->stream == NULL)
+    {
+        printf("there is no more space!\n");
+        return -1;
+    }
+    track->stream->time_base = codec_ctx->time_base;
+    avcodec_parameters_from_context(track->stream->codecpar, codec_ctx);
+
+    //1 byte alignment, the rows of every plane are packed like pixel_convert writes them
+    track->frame->format = pix_fmt;
+    track->frame->width = width;
+    track->frame->height = height;
+    if (av_frame_get_buffer(track->frame, 1) < 0)
+    {
+        printf("malloc picture buf error!\n");
+        return -1;
+    }
+    return 0;
+}
+
+//send a frame, or NULL to flush, and write every packet the encoder has ready
+static int video_record_encode(VideoRecord_t* record, VideoRecordTrack_t* track, AVFrame* frame)
+{
+    if (avcodec_send_frame(track->codec_ctx, frame) < 0)
+    {
+        printf("avcodec_send_frame error!\n");
+        return -1;
+    }
+    int ret;
+    while ((ret = avcodec_receive_packet(track->codec_ctx, track->packet)) == 0)
+    {
+        av_packet_rescale_ts(track->packet, track->codec_ctx->time_base, track->stream->time_base);
+        track->packet->stream_index = track->stream->index;
+        //the muxer takes the packet over
+        if (av_interleaved_write_frame(record->format_ctx, track->packet) < 0)
+        {
+            printf("fail to write video frame\n");
+            return -1;
+        }
+    }
+    return (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) ? 0 : -1;
+}
+
+VideoRecord_t* video_record_create(const char* path, const VideoRecordParam_t* param)
+{
+    if (path == NULL || param == NULL || param->codec == NULL || (!param->has_image && !param->has_temp) \
+        || (param->has_image && (param->image_width <= 0 || param->image_height <= 0 || (param->image_width % 2) != 0 \
+        || (param->image_format == VIDEO_RECORD_NV12 && (param->image_height % 2) != 0))) \
+        || (param->has_temp && (param->temp_width <= 0 || param->temp_height <= 0)))
+    {
+        printf("video_record_create: invalid param\n");
+        return NULL;
+    }
+    const char* image_encoder = NULL;
+    if (strcmp(param->codec, "mjpeg") == 0)
+    {
+        image_encoder = "mjpeg";
+    }
+    else if (strcmp(param->codec, "h264") == 0)
+    {
+        image_encoder = "libx264";
+    }
+    else
+    {
+        printf("video record: unknown codec %s\n", param->codec);
+        return NULL;
+    }
+
+    VideoRecord_t* record = new VideoRecord_t;
+    memset(&record->image, 0, sizeof(VideoRecordTrack_t));
+    memset(&record->temp, 0, sizeof(VideoRecordTrack_t));
+    record->param = *param;
+    record->format_ctx = NULL;
+    record->first_timestamp_us = 0;
+    record->last_pts = -1;
+    record->frame_num = 0;
+
+    //the container follows the file extension
+    if (avformat_alloc_output_context2(&record->format_ctx, NULL, NULL, path) < 0 || record->format_ctx == NULL)
+    {
+        printf("video record: no container for %s\n", path);
+        video_record_free(record);
+        return NULL;
+    }
+    if (record->param.has_temp && strcmp(record->format_ctx->oformat->name, "matroska") != 0)
+    {
+        printf("video record: the temp track needs a .mkv file, %s is recorded without it\n", path);
+        record->param.has_temp = false;
+        if (!record->param.has_image)
+        {
+            video_record_free(record);
+            return NULL;
+        }
+    }
+
+    //mjpeg takes the full range yuv formats
+    bool full_range = (strcmp(image_encoder, "mjpeg") == 0);
+    AVPixelFormat image_pix_fmt;
+    if (record->param.image_format == VIDEO_RECORD_NV12)
+    {
+        image_pix_fmt = full_range ? AV_PIX_FMT_YUVJ420P : AV_PIX_FMT_YUV420P;
+    }
+    else
+    {
+        image_pix_fmt = full_range ? AV_PIX_FMT_YUVJ422P : AV_PIX_FMT_YUV422P;
+    }
+    if ((record->param.has_image && video_record_track_open(record, &record->image, image_encoder, image_pix_fmt, \
+        param->image_width, param->image_height) != 0) \
+        || (record->param.has_temp && video_record_track_open(record, &record->temp, "ffv1", AV_PIX_FMT_GRAY16LE, \
+        param->temp_width, param->temp_height) != 0))
+    {
+        video_record_free(record);
+        return NULL;
+    }
+
+    if (!(record->format_ctx->oformat->flags & AVFMT_NOFILE) && avio_open(&record->format_ctx->pb, path, AVIO_FLAG_WRITE) < 0)
+    {
+        printf("Could not open output file!\n");
+        video_record_free(record);
+        return NULL;
+    }
+    if (avformat_write_header(record->format_ctx, NULL) < 0)
+    {
+        printf("video record: write header of %s failed\n", path);
+        video_record_free(record);
+        return NULL;
+    }
+    printf("video record to %s, image %s, y16 temp %s\n", path, record->param.has_image ? param->codec : "off", \
+        record->param.has_temp ? "ffv1" : "off");
+    return record;
+}
+
+int video_record_write(VideoRecord_t* record, uint8_t* image_data, uint16_t* temp_data, uint64_t timestamp_us)
+{
+    if (record == NULL || (record->param.has_image && image_data == NULL) || (record->param.has_temp && temp_data == NULL))
+    {
+        printf("video_record_write: invalid param\n");
+        return -1;
+    }
+
+    //the image and temp frame of one capture share the pts, strictly increasing even if the clock isn't
+    if (record->frame_num == 0)
+    {
+        record->first_timestamp_us = timestamp_us;
+    }
+    int64_t pts = (timestamp_us >= record->first_timestamp_us) ? \
+        (int64_t)((timestamp_us - record->first_timestamp_us) * VIDEO_RECORD_TIME_BASE / 1000000) : 0;
+    if (pts <= record->last_pts)
+    {
+        pts = record->last_pts + 1;
+    }
+    record->last_pts = pts;
+
+    if (record->param.has_image)
+    {
+        AVFrame* frame = record->image.frame;
+        if (av_frame_make_writable(frame) < 0)
+        {
+            printf("malloc picture buf error!\n");
+            return -1;
+        }
+        if (record->param.image_format == VIDEO_RECORD_NV12)
+        {
+            nv12_to_yuv420p(image_data, frame->width, frame->height, frame->data[0], frame->data[1], frame->data[2]);
+        }
+        else
+        {
+            yuyv_to_yuv422p(image_data, frame->width, frame->height, frame->data[0], frame->data[1], frame->data[2]);
+        }
+        frame->quality = record->image.codec_ctx->global_quality;
+        frame->pts = pts;
+        if (video_record_encode(record, &record->image, frame) != 0)
+        {
+            return -1;
+        }
+    }
+    if (record->param.has_temp)
+    {
+        AVFrame* frame = record->temp.frame;
+        if (av_frame_make_writable(frame) < 0)
+        {
+            printf("malloc picture buf error!\n");
+            return -1;
+        }
+        int row_bytes = frame->width * 2;
+        for (int row = 0; row < frame->height; row++)
+        {
+            memcpy(frame->data[0] + row * frame->linesize[0], (uint8_t*)temp_data + row * row_bytes, row_bytes);
+        }
+        frame->pts = pts;
+        if (video_record_encode(record, &record->temp, frame) != 0)
+        {
+            return -1;
+        }
+    }
+    record->frame_num++;
+    return 0;
+}
+
+int video_record_close(VideoRecord_t* record)
+{
+    if (record == NULL)
+    {
+        return -1;
+    }
+
+    int ret = 0;
+    if (record->image.codec_ctx != NULL && video_record_encode(record, &record->image, NULL) != 0)
+    {
+        ret = -1;
+    }
+    if (record->temp.codec_ctx != NULL && video_record_encode(record, &record->temp, NULL) != 0)
+    {
+        ret = -1;
+    }
+    if (av_write_trailer(record->format_ctx) < 0)
+    {
+        printf("video record: write trailer failed\n");
+        ret = -1;
+    }
+    printf("video record closed, %u frames\n", record->frame_num);
+    video_record_free(record);
+    return ret;
+}
+
+//a frame handed from the ring reader to the encoder thread, the slot holds the buffers until it is encoded
+typedef struct {
+    FrameSlot_t slot;
+    uint64_t timestamp_us;
+}VideoRecordJob_t;
+
+typedef struct {
+    VideoRecord_t* record;
+    StreamFrameInfo_t frame_view;   //the encoder thread's copy of the layout, bound to each frame
+    vector<VideoRecordJob_t> queue;
+    int queue_head;
+    int queue_count;
+    pthread_mutex_t mutex;
+    pthread_cond_t job_cond;
+    bool quit;
+    uint64_t dropped;
+}VideoRecordQueue_t;
+
+static void* video_record_encode_function(void* threadarg)
+{
+    VideoRecordQueue_t* queue = (VideoRecordQueue_t*)threadarg;
+    StreamFrameInfo_t* stream_frame_info = &queue->frame_view;
+    bool failed = false;
+    VideoRecordJob_t job;
+
+    pthread_mutex_lock(&queue->mutex);
+    while (true)
+    {
+        while (!queue->quit && queue->queue_count == 0)
+        {
+            pthread_cond_wait(&queue->job_cond, &queue->mutex);
+        }
+        if (queue->queue_count == 0)
+        {
+            break;
+        }
+        job = queue->queue[queue->queue_head];
+        queue->queue_head = (queue->queue_head + 1) % (int)queue->queue.size();
+        queue->queue_count--;
+        pthread_mutex_unlock(&queue->mutex);
+
+        //after a failed write the frames are only released
+        if (!failed)
+        {
+            bind_stream_frame_info(stream_frame_info, job.slot.raw_buffer, job.slot.raw_temp_buffer);
+            failed = (video_record_write(queue->record, stream_frame_info->image_info.data, \
+                (uint16_t*)stream_frame_info->temp_info.data, job.timestamp_us) != 0);
+        }
+        frame_ring_release(&job.slot);
+
+        pthread_mutex_lock(&queue->mutex);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return NULL;
+}
+
+void* video_record_function(void* threadarg)
+{
+    printf("video_record_function start\n");
+    StreamFrameInfo_t* stream_frame_info = (StreamFrameInfo_t*)threadarg;
+    if (stream_frame_info == NULL || stream_frame_info->product_config.camera.video_record_path.empty())
+    {
+        return NULL;
+    }
+
+    camera_config* camera = &stream_frame_info->product_config.camera;
+    FrameOutputFmt_t format = stream_frame_info->frame_output_format;
+    VideoRecordParam_t param;
+    param.codec = camera->video_record_codec.c_str();
+    param.has_image = true;
+    param.image_format = ((format == NV12_IMAGE) || (format == NV12_AND_TEMP)) ? VIDEO_RECORD_NV12 : VIDEO_RECORD_YUYV;
+    param.image_width = stream_frame_info->image_info.width;
+    param.image_height = stream_frame_info->image_info.height;
+    param.has_temp = (format == YUYV_AND_TEMP) || (format == NV12_AND_TEMP);
+    param.temp_width = stream_frame_info->temp_info.width;
+    param.temp_height = stream_frame_info->temp_info.height;
+
+    VideoRecordQueue_t* queue = new VideoRecordQueue_t;
+    queue->record = video_record_create(camera->video_record_path.c_str(), &param);
+    if (queue->record == NULL)
+    {
+        delete queue;
+        return NULL;
+    }
+    queue->frame_view = *stream_frame_info;
+    queue->queue.resize(VIDEO_RECORD_QUEUE);
+    queue->queue_head = 0;
+    queue->queue_count = 0;
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->job_cond, NULL);
+    queue->quit = false;
+    queue->dropped = 0;
+
+    pthread_t encode_thread;
+    int consumer_id = -1;
+    if (pthread_create(&encode_thread, NULL, video_record_encode_function, queue) != 0)
+    {
+        printf("video record: create encode thread failed\n");
+    }
+    else
+    {
+        consumer_id = frame_ring_add_consumer(stream_frame_info->frame_ring);
+    }
+
+    //this thread only queues the frames, it keeps up with the ring whatever the encoder does
+    FrameSlot_t slot;
+    while (consumer_id >= 0 && frame_ring_read(stream_frame_info->frame_ring, consumer_id, &slot) == 0)
+    {
+        uint64_t timestamp_us = (slot.raw_buffer->timestamp_us != 0) ? slot.raw_buffer->timestamp_us : frame_clock_us();
+        pthread_mutex_lock(&queue->mutex);
+        if (queue->queue_count == (int)queue->queue.size())
+        {
+            queue->dropped++;
+            pthread_mutex_unlock(&queue->mutex);
+            frame_ring_release(&slot);
+            continue;
+        }
+        VideoRecordJob_t* job = &queue->queue[(queue->queue_head + queue->queue_count) % (int)queue->queue.size()];
+        job->slot = slot;
+        job->timestamp_us = timestamp_us;
+        queue->queue_count++;
+        pthread_cond_signal(&queue->job_cond);
+        pthread_mutex_unlock(&queue->mutex);
+    }
+
+    if (consumer_id >= 0)
+    {
+        printf("video record skipped %llu frames in the ring, dropped %llu in the queue\n", \
+            (unsigned long long)frame_ring_dropped(stream_frame_info->frame_ring, consumer_id), (unsigned long long)queue->dropped);
+        frame_ring_remove_consumer(stream_frame_info->frame_ring, consumer_id);
+    }
+    pthread_mutex_lock(&queue->mutex);
+    queue->quit = true;
+    pthread_cond_broadcast(&queue->job_cond);
+    pthread_mutex_unlock(&queue->mutex);
+    if (consumer_id >= 0)
+    {
+        pthread_join(encode_thread, NULL);
+    }
+
+    video_record_close(queue->record);
+    pthread_cond_destroy(&queue->job_cond);
+    pthread_mutex_destroy(&queue->mutex);
+    delete queue;
+    return NULL;
+}
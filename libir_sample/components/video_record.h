@@ -0,0 +1,45 @@
+#ifndef _VIDEO_RECORD_H_
+#define _VIDEO_RECORD_H_
+
+#include "data.h"
+#include "frame_ring.h"
+
+#define VIDEO_RECORD_QUEUE  8
+
+//continuous recording of the image stream to a video file with one encoder kept open for the whole recording,
+//mjpeg or h264(libx264). the y16 temp plane goes along as a lossless ffv1 track of the same file, every temp frame has
+//the pts of the image frame it came with, so the two tracks stay matched frame by frame. the temp track needs a
+//matroska(.mkv) file, other containers get the image track only
+typedef struct VideoRecord_s VideoRecord_t;
+
+typedef enum {
+    VIDEO_RECORD_YUYV = 0,  //encoded as 4:2:2
+    VIDEO_RECORD_NV12,      //encoded as 4:2:0
+}VideoRecordImageFormat_e;
+
+typedef struct {
+    const char* codec;      //"mjpeg" or "h264"
+    bool has_image;
+    VideoRecordImageFormat_e image_format;
+    int image_width;
+    int image_height;
+    bool has_temp;
+    int temp_width;
+    int temp_height;
+}VideoRecordParam_t;
+
+VideoRecord_t* video_record_create(const char* path, const VideoRecordParam_t* param);
+
+//encode the image and temp frame of one capture, timestamp_us on any clock(the FrameBuffer_t timestamp).
+//frames of a stream the recording doesn't have may be NULL
+int video_record_write(VideoRecord_t* record, uint8_t* image_data, uint16_t* temp_data, uint64_t timestamp_us);
+
+//flush the encoders and finish the file
+int video_record_close(VideoRecord_t* record);
+
+//record thread, a frame ring consumer recording to camera::video_record_path until the ring stops.
+//the frames are encoded by a second thread behind a queue of VIDEO_RECORD_QUEUE frames, frames arriving while it is
+//full are dropped, so a slow encode never holds the ring back(even with the block policy)
+void* video_record_function(void* threadarg);
+
+#endif
@@ -0,0 +1,46 @@
+# build settings shared by the bench samples, their CMakeLists.txt include it and list only their sources and libs
+
+set(CMAKE_CXX_STANDARD 11)
+
+set(EXTERN_LIB extern_lib.cmake)
+if(NOT EXISTS ${CMAKE_CURRENT_SOURCE_DIR}/${EXTERN_LIB})
+    file(WRITE ${EXTERN_LIB} "")
+endif()
+include(${EXTERN_LIB})
+
+include_directories(${CMAKE_CURRENT_LIST_DIR}/../../interfaces)
+include_directories(${CMAKE_CURRENT_LIST_DIR}/../../drivers)
+include_directories(${CMAKE_CURRENT_LIST_DIR}/../../thirdparty/cJSON/include)
+include_directories(${CMAKE_CURRENT_LIST_DIR}/../../common)
+include_directories(${CMAKE_CURRENT_LIST_DIR}/../../other)
+include_directories(${CMAKE_CURRENT_LIST_DIR}/../../components)
+include_directories(${CMAKE_CURRENT_LIST_DIR})
+include_directories(${CMAKE_CURRENT_SOURCE_DIR})
+
+option(BUILD32 "Build x86" OFF)
+if(BUILD32)
+    if(${CMAKE_SYSTEM_NAME} MATCHES "Android")
+        message("building x86")
+        set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -m32 -Wno-incompatible-pointer-types -Wmissing-field-initializers -Wunknown-escape-sequence -Wsign-compare")
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -m32 -Wno-incompatible-pointer-types -Wmissing-field-initializers -Wunknown-escape-sequence -Wsign-compare")
+    else()
+        message("building x86")
+        set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -m32 -Wno-incompatible-pointer-types -Wmissing-field-initializers -Wsign-compare")
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -m32 -Wmissing-field-initializers -Wsign-compare")
+    endif()
+else()
+    if(${CMAKE_SYSTEM_NAME} MATCHES "Android")
+        message("building x64")
+        set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -g -Wno-incompatible-pointer-types -Wmissing-field-initializers -Wunknown-escape-sequence -Wsign-compare")
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -g -Wno-incompatible-pointer-types -Wmissing-field-initializers -Wunknown-escape-sequence -Wsign-compare")
+    else()
+        message("building x64")
+        set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -g -s -Wno-incompatible-pointer-types -Wmissing-field-initializers -Wsign-compare")
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -g -s -Wmissing-field-initializers -Wsign-compare")
+    endif()
+endif()
+# the benches time the kernels as the cameras run them, not a debug build
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -O2")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -O2")
+
+link_directories(${CMAKE_CURRENT_LIST_DIR}/../../drivers)
@@ -0,0 +1,95 @@
+#ifndef _BENCH_COMMON_H_
+#define _BENCH_COMMON_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+#include "roi_temp.h"
+
+//the fixture of the bench samples: the frame sizes they loop over, a clock, a seeded rand and synthetic y16 temp
+//frames(1/64 kelvin). each bench includes it from its sample.h and keeps only its own scenes and checks
+
+typedef struct {
+    int width;
+    int height;
+}BenchSize_t;
+
+static const BenchSize_t bench_sizes[] = {
+    { 256, 192 },
+    { 384, 288 },
+    { 640, 512 },
+    { 1280, 1024 },
+};
+
+#define BENCH_SIZE_NUM      ((int)(sizeof(bench_sizes) / sizeof(bench_sizes[0])))
+
+//the clock of frame_clock_us, without linking data.cpp
+static inline uint64_t bench_clock_us()
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000 \
+        + (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart;
+#elif defined(linux) || defined(unix)
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+#endif
+}
+
+//0 ~ range - 1 from rand(), seeded by the bench with srand so the frames repeat
+static inline int bench_rand(int range)
+{
+    return (range <= 0) ? 0 : rand() % range;
+}
+
+static inline uint16_t bench_y16(double celsius)
+{
+    return (uint16_t)((celsius + 273.15) * 64 + 0.5);
+}
+
+//a 20~30 celsius gradient with 0.5 celsius of noise in steps of noise_step, 1 for every value, larger so
+//neighbouring values tie
+static inline void bench_make_frame(uint16_t* y16, int width, int height, int noise_step)
+{
+    int base = (int)((273.15 + 20) * 64);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            y16[y * width + x] = (uint16_t)(base + (x + y) * 640 / (width + height) \
+                + bench_rand(32 / noise_step) * noise_step);
+        }
+    }
+}
+
+//a third each of points, lines up to half the frame long and rectangles up to an eighth of the frame wide
+static inline void bench_make_rois(Roi_t* rois, int roi_num, int width, int height)
+{
+    for (int i = 0; i < roi_num; i++)
+    {
+        Roi_t* roi = &rois[i];
+        roi->type = (RoiType_e)(i % 3);
+        roi->start_x = bench_rand(width);
+        roi->start_y = bench_rand(height);
+        int range_x = (roi->type == ROI_TYPE_LINE) ? width / 2 : width / 8;
+        int range_y = (roi->type == ROI_TYPE_LINE) ? height / 2 : height / 8;
+        roi->end_x = roi->start_x + bench_rand(2 * range_x + 1) - range_x;
+        roi->end_y = roi->start_y + bench_rand(2 * range_y + 1) - range_y;
+        roi->end_x = (roi->end_x < 0) ? 0 : (roi->end_x >= width) ? width - 1 : roi->end_x;
+        roi->end_y = (roi->end_y < 0) ? 0 : (roi->end_y >= height) ? height - 1 : roi->end_y;
+        if (roi->type == ROI_TYPE_POINT)
+        {
+            roi->end_x = roi->start_x;
+            roi->end_y = roi->start_y;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,140 @@
+#include "sample.h"
+
+//time the whole frame min/max scan of temp_measure_get_frame_temp: get_rect_temp of libirtemp over the full frame
+//against row_band_y16_min_max in the caller and on a row band pool, on synthetic y16 temp frames of the usual sizes.
+//the kernel output is checked against a plain scan. get_rect_temp is only printed: it replaces isolated pixels by
+//their neighbours before taking min/max and keeps the last pixel of equal values, so its extremes differ on
+//frames with single hot or cold pixels like these
+
+#define BENCH_DEFAULT_LOOPS     200
+
+//one hot and one cold pixel on the background
+static void bench_add_spots(uint16_t* y16, int width, int height)
+{
+    y16[(height / 3) * width + width * 2 / 3] = (uint16_t)((273.15 + 80) * 64);
+    y16[(height * 2 / 3) * width + width / 4] = (uint16_t)((273.15 - 5) * 64);
+}
+
+//the plain raster scan the kernel must match
+static void bench_reference(const uint16_t* y16, int width, int height, RowBandMinMax_t* min_max)
+{
+    int pixel_num = width * height;
+    int min_index = 0, max_index = 0;
+    uint64_t sum = 0;
+    for (int i = 0; i < pixel_num; i++)
+    {
+        if (y16[i] < y16[min_index])
+        {
+            min_index = i;
+        }
+        if (y16[i] > y16[max_index])
+        {
+            max_index = i;
+        }
+        sum += y16[i];
+    }
+    min_max->min_value = y16[min_index];
+    min_max->max_value = y16[max_index];
+    min_max->min_x = min_index % width;
+    min_max->min_y = min_index / width;
+    min_max->max_x = max_index % width;
+    min_max->max_y = max_index / width;
+    min_max->sum = sum;
+}
+
+static bool bench_same(const RowBandMinMax_t& a, const RowBandMinMax_t& b)
+{
+    return a.min_value == b.min_value && a.max_value == b.max_value && a.min_x == b.min_x && a.min_y == b.min_y \
+        && a.max_x == b.max_x && a.max_y == b.max_y && a.sum == b.sum;
+}
+
+static double bench_rect_temp_ms(uint16_t* y16, int width, int height, int loops, TempInfo_t* temp_info)
+{
+    TempDataRes_t temp_res = { (uint16_t)width, (uint16_t)height };
+    Area_t rect = { 0, 0, width, height };
+    get_rect_temp(y16, temp_res, rect, temp_info);
+    uint64_t start_us = bench_clock_us();
+    for (int i = 0; i < loops; i++)
+    {
+        get_rect_temp(y16, temp_res, rect, temp_info);
+    }
+    return (bench_clock_us() - start_us) / 1000.0 / loops;
+}
+
+static double bench_min_max_ms(RowBandPool_t* pool, uint16_t* y16, int width, int height, int loops, RowBandMinMax_t* min_max)
+{
+    row_band_y16_min_max(pool, y16, width, height, min_max);
+    uint64_t start_us = bench_clock_us();
+    for (int i = 0; i < loops; i++)
+    {
+        row_band_y16_min_max(pool, y16, width, height, min_max);
+    }
+    return (bench_clock_us() - start_us) / 1000.0 / loops;
+}
+
+int main(int argc, char* argv[])
+{
+    int loops = BENCH_DEFAULT_LOOPS;
+    int threads = 0;
+    if (argc > 3)
+    {
+        printf("usage: %s [<loops> [<threads>]]\n", argv[0]);
+        return -1;
+    }
+    if (argc >= 2)
+    {
+        loops = atoi(argv[1]);
+    }
+    if (argc >= 3)
+    {
+        threads = atoi(argv[2]);
+    }
+    if (loops <= 0 || threads < 0)
+    {
+        printf("set an illicit loops or threads\n");
+        return -1;
+    }
+
+    //0 threads is one per online cpu
+    RowBandPool_t* pool = row_band_pool_create(threads, NULL, 0);
+    threads = row_band_pool_thread_num(pool);
+
+    bool all_same = true;
+    srand(1);
+    printf("%d loops, average time per frame:\n", loops);
+    for (int i = 0; i < BENCH_SIZE_NUM; i++)
+    {
+        int width = bench_sizes[i].width;
+        int height = bench_sizes[i].height;
+        std::vector<uint16_t> y16(width * height);
+        bench_make_frame(&y16[0], width, height, 1);
+        bench_add_spots(&y16[0], width, height);
+
+        RowBandMinMax_t expected;
+        bench_reference(&y16[0], width, height, &expected);
+        TempInfo_t temp_info = {};
+        RowBandMinMax_t single, banded;
+        double rect_ms = bench_rect_temp_ms(&y16[0], width, height, loops, &temp_info);
+        double single_ms = bench_min_max_ms(NULL, &y16[0], width, height, loops, &single);
+        double banded_ms = bench_min_max_ms(pool, &y16[0], width, height, loops, &banded);
+
+        bool same = bench_same(expected, single) && bench_same(expected, banded);
+        all_same = all_same && same;
+
+        printf("%dx%d: min %.2f(%d,%d) max %.2f(%d,%d) mean %.2f celsius\n", width, height, \
+            expected.min_value / 64.0 - 273.15, expected.min_x, expected.min_y, \
+            expected.max_value / 64.0 - 273.15, expected.max_x, expected.max_y, \
+            (double)expected.sum / (width * height) / 64.0 - 273.15);
+        printf("  %-24s %8.3f ms  min %.2f(%d,%d) max %.2f(%d,%d) mean %.2f\n", "get_rect_temp", rect_ms, \
+            temp_info.min_temp / 64.0 - 273.15, temp_info.min_cord.x, temp_info.min_cord.y, \
+            temp_info.max_temp / 64.0 - 273.15, temp_info.max_cord.x, temp_info.max_cord.y, temp_info.avr_temp / 64.0 - 273.15);
+        printf("  %-24s %8.3f ms  x%.2f  %s\n", "min/max 1 thread", single_ms, (single_ms > 0) ? rect_ms / single_ms : 0.0, \
+            same ? "same output" : "OUTPUT DIFFERS");
+        char banded_name[32];
+        snprintf(banded_name, sizeof(banded_name), "min/max %d threads", threads);
+        printf("  %-24s %8.3f ms  x%.2f\n", banded_name, banded_ms, (banded_ms > 0) ? rect_ms / banded_ms : 0.0);
+    }
+    row_band_pool_destroy(pool);
+    printf("%s\n", all_same ? "all outputs are the same" : "SOME OUTPUTS DIFFER");
+    return all_same ? 0 : -1;
+}
@@ -0,0 +1,337 @@
+#include "sample.h"
+
+//time hot_blob_detect against a plain flood fill of the thresholded frame, on a few scenes of every size: scattered
+//hot spots on a noisy background, and the scenes with the most runs and joins, random noise around the threshold,
+//a checkerboard and a frame all over the threshold. the blobs are checked against the flood fill, on the y16 frame
+//and on a celsius frame corrected by a different gain on every quarter of the width, thresholded in celsius within a
+//y16 bound of the 4 gains. a second detector with a run budget joins the runs of the rows over their share of it, it
+//is checked against the flood fill when it joined none, otherwise every blob of the flood fill must lie in one of its
+//blobs and their pixels and sums must add up. its worst scene at the largest size is checked against a time budget
+
+#define BENCH_DEFAULT_LOOPS     50
+#define BENCH_HOT_TEMP          80      //celsius threshold
+#define BENCH_MAX_RUN_NUM       16384   //run budget of the second detector, a joined segment costs about two runs
+#define BENCH_BUDGET_MS         4.0     //per 1280x1024 frame, the worst scene of the second detector
+#define BENCH_BUDGET_WIDTH      1280
+#define BENCH_BUDGET_HEIGHT     1024
+#define BENCH_GAIN_NUM          4       //quarters of the celsius frame
+#define BENCH_GAIN_STEP         0.004   //between two quarters, about 0.3 celsius at the threshold
+
+typedef enum {
+    BENCH_SCENE_SPOTS = 0,
+    BENCH_SCENE_NOISE,
+    BENCH_SCENE_CHECKER,
+    BENCH_SCENE_ALL_HOT,
+    BENCH_SCENE_NUM,
+}BenchScene_e;
+
+static const char* bench_scene_names[] = { "hot spots", "noise", "checkerboard", "all hot" };
+
+static void bench_make_scene(uint16_t* y16, int width, int height, BenchScene_e scene)
+{
+    uint16_t threshold = bench_y16(BENCH_HOT_TEMP);
+    if (scene != BENCH_SCENE_SPOTS)
+    {
+        for (int i = 0; i < width * height; i++)
+        {
+            switch (scene)
+            {
+            case BENCH_SCENE_NOISE:
+                y16[i] = (uint16_t)(threshold - 64 + bench_rand(128));
+                break;
+            case BENCH_SCENE_CHECKER:
+                y16[i] = (uint16_t)(((i % width + i / width) % 2 == 0) ? threshold + bench_rand(640) \
+                    : threshold - 1 - bench_rand(640));
+                break;
+            default:
+                y16[i] = (uint16_t)(threshold + bench_rand(640));
+                break;
+            }
+        }
+        return;
+    }
+
+    //discs of 85~125 celsius falling off to the edge on the background, some of them overlapping
+    bench_make_frame(y16, width, height, 1);
+    for (int i = 0; i < 40; i++)
+    {
+        int center_x = bench_rand(width);
+        int center_y = bench_rand(height);
+        int radius = 2 + bench_rand(width / 32 + 1);
+        double peak = 85 + bench_rand(40);
+        for (int y = center_y - radius; y <= center_y + radius; y++)
+        {
+            for (int x = center_x - radius; x <= center_x + radius; x++)
+            {
+                int distance2 = (x - center_x) * (x - center_x) + (y - center_y) * (y - center_y);
+                if (x < 0 || y < 0 || x >= width || y >= height || distance2 > radius * radius)
+                {
+                    continue;
+                }
+                uint16_t value = bench_y16(peak - 10.0 * distance2 / (radius * radius) + bench_rand(100) / 100.0);
+                y16[y * width + x] = (value > y16[y * width + x]) ? value : y16[y * width + x];
+            }
+        }
+    }
+}
+
+//celsius of a y16 value in a quarter of the width, like a lut of its own emissivity
+static float bench_celsius(uint16_t y16, int gain)
+{
+    return (float)((y16 / 64.0 - 273.15) * (1 + (gain - (BENCH_GAIN_NUM - 1) / 2.0) * BENCH_GAIN_STEP));
+}
+
+static void bench_make_celsius(const uint16_t* y16, int width, int height, float* celsius)
+{
+    for (int i = 0; i < width * height; i++)
+    {
+        celsius[i] = bench_celsius(y16[i], (i % width) * BENCH_GAIN_NUM / width);
+    }
+}
+
+//the first y16 value reaching threshold_temp with any gain, like temp_correct_map_y16_bound
+static uint16_t bench_y16_bound(float threshold_temp)
+{
+    int bound = 0xffff;
+    for (int gain = 0; gain < BENCH_GAIN_NUM; gain++)
+    {
+        int y16 = 0;
+        while (y16 < bound && bench_celsius((uint16_t)y16, gain) < threshold_temp)
+        {
+            y16++;
+        }
+        bound = y16;
+    }
+    return (uint16_t)bound;
+}
+
+//label the hot pixels blob by blob from their first pixel in raster order, 8-connected, with a stack. with a celsius
+//frame the pixels are hot at or above threshold_temp, and the max is taken in celsius
+static void bench_flood_fill(const uint16_t* y16, const float* celsius, int width, int height, uint16_t threshold, \
+    float threshold_temp, uint32_t min_pixel_num, std::vector<int>& labels, std::vector<int>& stack, \
+    std::vector<HotBlobInfo_t>* blobs)
+{
+    blobs->clear();
+    labels.assign(width * height, -1);
+    std::vector<bool> hot(width * height);
+    for (int i = 0; i < width * height; i++)
+    {
+        hot[i] = (celsius != NULL) ? celsius[i] >= threshold_temp : y16[i] >= threshold;
+    }
+    for (int i = 0; i < width * height; i++)
+    {
+        if (!hot[i] || labels[i] >= 0)
+        {
+            continue;
+        }
+        HotBlobInfo_t blob;
+        memset(&blob, 0, sizeof(blob));
+        blob.start_x = blob.end_x = blob.max_x = (uint16_t)(i % width);
+        blob.start_y = blob.end_y = blob.max_y = (uint16_t)(i / width);
+        blob.max_value = y16[i];
+        uint64_t sum = 0;
+        double celsius_sum = 0;
+        labels[i] = i;
+        stack.clear();
+        stack.push_back(i);
+        while (!stack.empty())
+        {
+            int pixel = stack.back();
+            stack.pop_back();
+            int x = pixel % width, y = pixel / width;
+            blob.start_x = (x < blob.start_x) ? x : blob.start_x;
+            blob.start_y = (y < blob.start_y) ? y : blob.start_y;
+            blob.end_x = (x > blob.end_x) ? x : blob.end_x;
+            blob.end_y = (y > blob.end_y) ? y : blob.end_y;
+            blob.pixel_num++;
+            sum += y16[pixel];
+            celsius_sum += (celsius != NULL) ? celsius[pixel] : 0;
+            int max_pixel = blob.max_y * width + blob.max_x;
+            bool is_greater = (celsius != NULL) ? celsius[pixel] > celsius[max_pixel] : y16[pixel] > y16[max_pixel];
+            bool is_same = (celsius != NULL) ? celsius[pixel] == celsius[max_pixel] : y16[pixel] == y16[max_pixel];
+            if (is_greater || (is_same && (y < blob.max_y || (y == blob.max_y && x < blob.max_x))))
+            {
+                blob.max_value = y16[pixel];
+                blob.max_x = x;
+                blob.max_y = y;
+            }
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    int nx = x + dx, ny = y + dy;
+                    if (nx < 0 || ny < 0 || nx >= width || ny >= height || labels[ny * width + nx] >= 0 \
+                        || !hot[ny * width + nx])
+                    {
+                        continue;
+                    }
+                    labels[ny * width + nx] = i;
+                    stack.push_back(ny * width + nx);
+                }
+            }
+        }
+        if (blob.pixel_num >= min_pixel_num)
+        {
+            blob.max_temp = (celsius != NULL) ? celsius[blob.max_y * width + blob.max_x] \
+                : (float)(blob.max_value / 64.0 - 273.15);
+            blob.ave_temp = (celsius != NULL) ? (float)(celsius_sum / blob.pixel_num) \
+                : (float)((double)sum / blob.pixel_num / 64 - 273.15);
+            blobs->push_back(blob);
+        }
+    }
+}
+
+static bool bench_same_blobs(const HotBlobResult_t* result, const std::vector<HotBlobInfo_t>& blobs, bool is_celsius)
+{
+    if (result->blob_num != (int)blobs.size())
+    {
+        return false;
+    }
+    for (int i = 0; i < result->blob_num; i++)
+    {
+        const HotBlobInfo_t& a = result->blobs[i];
+        const HotBlobInfo_t& b = blobs[i];
+        if (a.start_x != b.start_x || a.start_y != b.start_y || a.end_x != b.end_x || a.end_y != b.end_y \
+            || a.pixel_num != b.pixel_num || a.max_value != b.max_value || a.max_x != b.max_x || a.max_y != b.max_y)
+        {
+            return false;
+        }
+        //the celsius sum is taken in a different order
+        if (is_celsius ? (a.max_temp - b.max_temp > 0.001 || b.max_temp - a.max_temp > 0.001 \
+            || a.ave_temp - b.ave_temp > 0.001 || b.ave_temp - a.ave_temp > 0.001) \
+            : (a.max_temp != b.max_temp || a.ave_temp != b.ave_temp))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//the blobs of a detector joining runs over gaps: unions of the flood fill blobs, so each of those lies in the bounding
+//box of one and the pixels and y16 sums of both add up
+static bool bench_joined_blobs(const HotBlobResult_t* result, const std::vector<HotBlobInfo_t>& blobs)
+{
+    if (result->blob_num > (int)blobs.size())
+    {
+        return false;
+    }
+    uint64_t pixel_num = 0, joined_pixel_num = 0;
+    double sum = 0, joined_sum = 0;
+    for (size_t i = 0; i < blobs.size(); i++)
+    {
+        const HotBlobInfo_t& b = blobs[i];
+        pixel_num += b.pixel_num;
+        sum += ((double)b.ave_temp + 273.15) * b.pixel_num;
+        bool is_covered = false;
+        for (int j = 0; j < result->blob_num && !is_covered; j++)
+        {
+            const HotBlobInfo_t& a = result->blobs[j];
+            is_covered = (a.start_x <= b.start_x && a.start_y <= b.start_y && a.end_x >= b.end_x && a.end_y >= b.end_y \
+                && a.max_value >= b.max_value);
+        }
+        if (!is_covered)
+        {
+            return false;
+        }
+    }
+    for (int j = 0; j < result->blob_num; j++)
+    {
+        joined_pixel_num += result->blobs[j].pixel_num;
+        joined_sum += ((double)result->blobs[j].ave_temp + 273.15) * result->blobs[j].pixel_num;
+    }
+    //the sums go through float averages
+    return pixel_num == joined_pixel_num && (sum - joined_sum) / sum < 1e-5 && (joined_sum - sum) / sum < 1e-5;
+}
+
+int main(int argc, char* argv[])
+{
+    int loops = BENCH_DEFAULT_LOOPS;
+    if (argc != 1 && argc != 2)
+    {
+        printf("usage: %s [<loops>]\n", argv[0]);
+        return -1;
+    }
+    if (argc == 2)
+    {
+        loops = atoi(argv[1]);
+    }
+    if (loops <= 0)
+    {
+        printf("set an illicit loops\n");
+        return -1;
+    }
+
+    bool all_same = true;
+    double budget_worst_ms = 0;
+    uint16_t threshold = bench_y16(BENCH_HOT_TEMP);
+    uint16_t celsius_threshold = bench_y16_bound(BENCH_HOT_TEMP);
+    srand(1);
+    printf("blobs at or above %d celsius, 8-connected, %d loops, average time per frame:\n", BENCH_HOT_TEMP, loops);
+    for (int s = 0; s < BENCH_SIZE_NUM; s++)
+    {
+        int width = bench_sizes[s].width;
+        int height = bench_sizes[s].height;
+        std::vector<uint16_t> y16(width * height);
+        std::vector<float> celsius(width * height);
+        std::vector<int> labels, stack;
+        std::vector<HotBlobInfo_t> blobs;
+        HotBlob_t* hot_blob = hot_blob_create(width, height, 0);
+        HotBlob_t* budget_blob = hot_blob_create(width, height, BENCH_MAX_RUN_NUM);
+        HotBlobResult_t result;
+        printf("%dx%d:\n", width, height);
+        for (int scene = 0; scene < BENCH_SCENE_NUM; scene++)
+        {
+            bench_make_scene(&y16[0], width, height, (BenchScene_e)scene);
+
+            uint64_t start_us = bench_clock_us();
+            for (int loop = 0; loop < loops; loop++)
+            {
+                bench_flood_fill(&y16[0], NULL, width, height, threshold, 0, 1, labels, stack, &blobs);
+            }
+            double flood_ms = (bench_clock_us() - start_us) / 1000.0 / loops;
+
+            start_us = bench_clock_us();
+            for (int loop = 0; loop < loops; loop++)
+            {
+                hot_blob_detect(hot_blob, &y16[0], NULL, threshold, 0, 1, &result);
+            }
+            double blob_ms = (bench_clock_us() - start_us) / 1000.0 / loops;
+            bool is_same = bench_same_blobs(&result, blobs, false);
+            int run_num = result.run_num;
+            int blob_num = result.blob_num;
+
+            //blobs under a few pixels filtered, on the celsius frame
+            bench_make_celsius(&y16[0], width, height, &celsius[0]);
+            bench_flood_fill(&y16[0], &celsius[0], width, height, 0, BENCH_HOT_TEMP, 4, labels, stack, &blobs);
+            hot_blob_detect(hot_blob, &y16[0], &celsius[0], celsius_threshold, BENCH_HOT_TEMP, 4, &result);
+            is_same = is_same && bench_same_blobs(&result, blobs, true);
+
+            start_us = bench_clock_us();
+            for (int loop = 0; loop < loops; loop++)
+            {
+                hot_blob_detect(budget_blob, &y16[0], NULL, threshold, 0, 1, &result);
+            }
+            double budget_ms = (bench_clock_us() - start_us) / 1000.0 / loops;
+            bench_flood_fill(&y16[0], NULL, width, height, threshold, 0, 1, labels, stack, &blobs);
+            is_same = is_same && ((result.join_row_num == 0) ? bench_same_blobs(&result, blobs, false) \
+                : bench_joined_blobs(&result, blobs));
+            all_same = all_same && is_same;
+
+            if (width == BENCH_BUDGET_WIDTH && height == BENCH_BUDGET_HEIGHT && budget_ms > budget_worst_ms)
+            {
+                budget_worst_ms = budget_ms;
+            }
+            printf("  %-14s %7d runs %6d blobs  flood fill %8.3f ms  hot blob %7.3f ms  x%.2f  %s\n", \
+                bench_scene_names[scene], run_num, blob_num, flood_ms, blob_ms, \
+                (blob_ms > 0) ? flood_ms / blob_ms : 0.0, is_same ? "same" : "DIFFERENT");
+            printf("  %-14s %7d runs budget: %7.3f ms, %d blobs, %d of %d rows joined over gaps up to %d\n", "", \
+                BENCH_MAX_RUN_NUM, budget_ms, result.blob_num, result.join_row_num, height, result.join_gap);
+        }
+        hot_blob_destroy(hot_blob);
+        hot_blob_destroy(budget_blob);
+    }
+    printf("%s\n", all_same ? "all outputs are the same" : "SOME OUTPUTS DIFFER");
+    printf("worst %dx%d frame with the run budget %.3f ms, %s the %.1f ms budget\n", BENCH_BUDGET_WIDTH, BENCH_BUDGET_HEIGHT, \
+        budget_worst_ms, (budget_worst_ms <= BENCH_BUDGET_MS) ? "within" : "OVER", BENCH_BUDGET_MS);
+    return (all_same && budget_worst_ms <= BENCH_BUDGET_MS) ? 0 : -1;
+}
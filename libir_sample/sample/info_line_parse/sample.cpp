@@ -40,22 +40,21 @@ int main(int argc, char* argv[])
     printf("init all stream handle\n");
     int fd;
     int ret;
-    StreamFrameInfo_t stream_frame_info;
-    memset(&stream_frame_info, 0, sizeof(stream_frame_info) - sizeof(product_config));
-    stream_frame_info.product_config = product_config;
+    Pipeline_t* pipeline = pipeline_create(product_config);
+    StreamFrameInfo_t& stream_frame_info = pipeline->stream_frame_info;
     if (product_config.camera.v4l2_config.has_image)
     {
         printf("create image video handle\n");
         stream_frame_info.image_name = (char*)product_config.camera.v4l2_config.image_stream.device_name.data();
-        ir_video_handle_create(&ir_image_video_handle);
-        stream_frame_info.image_driver_handle = (Irv4l2VideoHandle_t*)irv4l2_handle_create(ir_image_video_handle);
+        ir_video_handle_create(&pipeline->ir_image_video_handle);
+        stream_frame_info.image_driver_handle = v4l2_image_driver_handle_create(&stream_frame_info, pipeline->ir_image_video_handle);
     }
     if (product_config.camera.v4l2_config.has_temp)
     {
         printf("creat temp video handle\n");
         stream_frame_info.temp_name = (char*)product_config.camera.v4l2_config.temp_stream.device_name.data();
-        ir_video_handle_create(&ir_temp_video_handle);
-        stream_frame_info.temp_driver_handle = (Irv4l2VideoHandle_t*)irv4l2_handle_create(ir_temp_video_handle);
+        ir_video_handle_create(&pipeline->ir_temp_video_handle);
+        stream_frame_info.temp_driver_handle = (Irv4l2VideoHandle_t*)irv4l2_handle_create(pipeline->ir_temp_video_handle);
     }
     if (!product_config.camera.v4l2_config.has_image && !product_config.camera.v4l2_config.has_temp)
     {
@@ -97,7 +96,6 @@ int main(int argc, char* argv[])
     printf("basic_video_stream_continue:%d\n", ret);    //control mipi start
 
     load_stream_frame_info(&stream_frame_info, true, false);
-    init_pthread_sem();
     pthread_t image_thread,temp_thread,display_thread,cmd_thread,info_thread;
 
     if (product_config.camera.v4l2_config.has_image && product_config.camera.v4l2_config.has_temp)
@@ -123,7 +121,6 @@ int main(int argc, char* argv[])
     pthread_join(display_thread, &thread_result);
     pthread_join(info_thread, &thread_result);
     printf("stop stream\n");
-    destroy_pthread_sem();
     destroy_data_demo(&stream_frame_info);
 
     ircmd_delete_handle(stream_frame_info.ircmd_handle);
@@ -137,13 +134,14 @@ int main(int argc, char* argv[])
     if (product_config.camera.v4l2_config.has_temp)
     {
         irv4l2_handle_delete((Irv4l2VideoHandle_t*)stream_frame_info.temp_driver_handle);
-        ir_video_handle_delete(&ir_temp_video_handle);
+        ir_video_handle_delete(&pipeline->ir_temp_video_handle);
     }
     if (product_config.camera.v4l2_config.has_image)
     {
-        irv4l2_handle_delete((Irv4l2VideoHandle_t*)stream_frame_info.image_driver_handle);
-        ir_video_handle_delete(&ir_image_video_handle);
+        v4l2_image_driver_handle_delete(&stream_frame_info);
+        ir_video_handle_delete(&pipeline->ir_image_video_handle);
     }
 
+    pipeline_destroy(pipeline);
     return 0;
 }
@@ -28,6 +28,23 @@ int main(int argc, char* argv[])
         return -1;
     }
 
+    //run against a recording of raw_record_function instead of the camera
+    bool is_replay = !product_config.camera.replay_path.empty();
+    if (is_replay && raw_replay_load_config(product_config) != 0)
+    {
+        printf("load replay failed\n");
+        return -1;
+    }
+
+    //generate frames of the product layout instead of the camera, a load generator without hardware
+    bool is_synthetic = !is_replay && product_config.camera.synthetic;
+    if (is_synthetic && synthetic_camera_load_config(product_config) != 0)
+    {
+        printf("load synthetic camera failed\n");
+        return -1;
+    }
+    bool has_camera = !is_replay && !is_synthetic;
+
     printf("Depends lib version:\n");
     printf("version:%s\n", ircmd_version());
     printf("version:%s\n", ircam_version());
@@ -41,24 +58,45 @@ int main(int argc, char* argv[])
     printf("init all stream handle\n");
     int fd;
     int ret;
-    StreamFrameInfo_t stream_frame_info;
-    memset(&stream_frame_info, 0, sizeof(stream_frame_info) - sizeof(product_config));
-    stream_frame_info.product_config = product_config;
+    Pipeline_t* pipeline = pipeline_create(product_config);
+    StreamFrameInfo_t& stream_frame_info = pipeline->stream_frame_info;
 
     printf("init image stream handle\n");
     if (product_config.camera.v4l2_config.has_image)
     {
         printf("create image video handle\n");
         stream_frame_info.image_name = (char*)product_config.camera.v4l2_config.image_stream.device_name.data();
-        ir_video_handle_create(&ir_image_video_handle);
-        stream_frame_info.image_driver_handle = (Irv4l2VideoHandle_t*)irv4l2_handle_create(ir_image_video_handle);
+        ir_video_handle_create(&pipeline->ir_image_video_handle);
+        if (is_replay)
+        {
+            stream_frame_info.image_driver_handle = raw_replay_handle_create(pipeline->ir_image_video_handle, &stream_frame_info, RAW_REPLAY_IMAGE);
+        }
+        else if (is_synthetic)
+        {
+            stream_frame_info.image_driver_handle = synthetic_camera_handle_create(pipeline->ir_image_video_handle, &stream_frame_info, SYNTHETIC_IMAGE);
+        }
+        else
+        {
+            stream_frame_info.image_driver_handle = v4l2_image_driver_handle_create(&stream_frame_info, pipeline->ir_image_video_handle);
+        }
     }
     if (product_config.camera.v4l2_config.has_temp)
     {
         printf("creat temp video handle\n");
         stream_frame_info.temp_name = (char*)product_config.camera.v4l2_config.temp_stream.device_name.data();
-        ir_video_handle_create(&ir_temp_video_handle);
-        stream_frame_info.temp_driver_handle = (Irv4l2VideoHandle_t*)irv4l2_handle_create(ir_temp_video_handle);
+        ir_video_handle_create(&pipeline->ir_temp_video_handle);
+        if (is_replay)
+        {
+            stream_frame_info.temp_driver_handle = raw_replay_handle_create(pipeline->ir_temp_video_handle, &stream_frame_info, RAW_REPLAY_TEMP);
+        }
+        else if (is_synthetic)
+        {
+            stream_frame_info.temp_driver_handle = synthetic_camera_handle_create(pipeline->ir_temp_video_handle, &stream_frame_info, SYNTHETIC_TEMP);
+        }
+        else
+        {
+            stream_frame_info.temp_driver_handle = v4l2_temp_driver_handle_create(&stream_frame_info, pipeline->ir_temp_video_handle);
+        }
     }
     if (!product_config.camera.v4l2_config.has_image || !product_config.camera.v4l2_config.has_temp)
     {
@@ -70,54 +108,73 @@ int main(int argc, char* argv[])
     IrControlHandle_t* ir_control_handle = NULL;
     ir_control_handle_create(&ir_control_handle);
     IruartHandle_t* iruart_handle = NULL;
-    iruart_handle = iruart_handle_create(ir_control_handle);
-
-    FILE* fp;
-    char buffer[80] = { 0 };
-    char dev_node[20] = "/dev/";
-    fp = popen("ls /dev | grep \"ttyUSB*\" ", "r");
-    fgets(buffer, sizeof(buffer), fp);
-    pclose(fp);
-    fp = NULL;
-    printf("content of ls /dev | grep \"ttyUSB*\" is %s\n", buffer);
-    strcat(dev_node, buffer);
-    printf("dev_node is %s\n", dev_node);
-
-    int i;
-    for (i = sizeof(dev_node) - 1; i < (int)(sizeof(dev_node)); i--)
-    {
-        if (dev_node[i] == '\n')
-        {
-            dev_node[i] = 0;
-            break;
-        }
+    if (!has_camera)
+    {
+        printf("%s without control\n", is_replay ? "replay" : "synthetic camera");
     }
-    ret = ir_control_handle->ir_control_open(iruart_handle, dev_node);
-    //set baudrate, params:115200 or 921600 or NULL(self-adaptation)
-    ret = ir_control_handle->ir_control_init(iruart_handle, NULL);
-    printf("open control node:%d\n", ret);
-    stream_frame_info.ircmd_handle = ircmd_create_handle(ir_control_handle);
-
-    //this function is used to judge whether the device data is ready
-    //if judge failed, any command is not allowed
-    ret = judge_device_status(stream_frame_info.ircmd_handle);
-    if(ret != 0)
+    else
     {
-        printf("judge_device_status failed\n");
-        return -1;
+        iruart_handle = iruart_handle_create(ir_control_handle);
+
+        FILE* fp;
+        char buffer[80] = { 0 };
+        char dev_node[20] = "/dev/";
+        fp = popen("ls /dev | grep \"ttyUSB*\" ", "r");
+        fgets(buffer, sizeof(buffer), fp);
+        pclose(fp);
+        fp = NULL;
+        printf("content of ls /dev | grep \"ttyUSB*\" is %s\n", buffer);
+        strcat(dev_node, buffer);
+        printf("dev_node is %s\n", dev_node);
+
+        int i;
+        for (i = sizeof(dev_node) - 1; i < (int)(sizeof(dev_node)); i--)
+        {
+            if (dev_node[i] == '\n')
+            {
+                dev_node[i] = 0;
+                break;
+            }
+        }
+        ret = ir_control_handle->ir_control_open(iruart_handle, dev_node);
+        //set baudrate, params:115200 or 921600 or NULL(self-adaptation)
+        ret = ir_control_handle->ir_control_init(iruart_handle, NULL);
+        printf("open control node:%d\n", ret);
+        stream_frame_info.ircmd_handle = ircmd_create_handle(ir_control_handle);
+
+        //this function is used to judge whether the device data is ready
+        //if judge failed, any command is not allowed
+        ret = judge_device_status(stream_frame_info.ircmd_handle);
+        if(ret != 0)
+        {
+            printf("judge_device_status failed\n");
+            return -1;
+        }
+        ret = basic_video_stream_continue(stream_frame_info.ircmd_handle);
+        printf("basic_video_stream_continue:%d\n", ret);    //control mipi start
     }
-    ret = basic_video_stream_continue(stream_frame_info.ircmd_handle);
-    printf("basic_video_stream_continue:%d\n", ret);    //control mipi start
 
     load_stream_frame_info(&stream_frame_info, true, false);
-    init_pthread_sem();
-    pthread_t image_thread, temp_thread, display_thread, capture_thread, cmd_thread;
+    stream_frame_info.frame_pair = frame_pair_create(stream_frame_info.frame_ring, \
+        product_config.camera.frame_pair_window, product_config.camera.v4l2_config.image_stream.fps);
+    pthread_t image_thread, temp_thread, display_thread, capture_thread, cmd_thread, record_thread, alarm_thread;
     pthread_create(&image_thread, NULL, v4l2_image_channel_stream_function, &stream_frame_info);
     pthread_create(&temp_thread, NULL, v4l2_temp_channel_stream_function, &stream_frame_info);
+    if (!product_config.camera.record_path.empty())
+    {
+        pthread_create(&record_thread, NULL, raw_record_function, &stream_frame_info);
+    }
+    if (!product_config.camera.temp_alarms.empty())
+    {
+        pthread_create(&alarm_thread, NULL, temp_alarm_function, &stream_frame_info);
+    }
     //pthread_create(&image_thread, NULL, v4l2_double_channel_stream_function, &stream_frame_info);
     pthread_create(&display_thread, NULL, drm_display_function, &stream_frame_info);
     // pthread_create(&capture_thread, NULL, capture_function, &stream_frame_info);
-    pthread_create(&cmd_thread, NULL, cmd_function, &stream_frame_info);
+    if (has_camera)
+    {
+        pthread_create(&cmd_thread, NULL, cmd_function, &stream_frame_info);
+    }
     sleep(1);
 
     printf("in streaming\n");
@@ -125,29 +182,64 @@ int main(int argc, char* argv[])
     pthread_join(image_thread, &thread_result);
     pthread_join(temp_thread, &thread_result);
     printf("stop stream\n");
+    if (!product_config.camera.record_path.empty())
+    {
+        pthread_join(record_thread, &thread_result);
+    }
+    if (!product_config.camera.temp_alarms.empty())
+    {
+        pthread_join(alarm_thread, &thread_result);
+    }
     //pthread_cancel(display_thread);
     //pthread_cancel(cmd_thread);
-    destroy_pthread_sem();
+    frame_pair_destroy(stream_frame_info.frame_pair);
+    stream_frame_info.frame_pair = NULL;
     destroy_data_demo(&stream_frame_info);
 
-    ircmd_delete_handle(stream_frame_info.ircmd_handle);
-    ir_control_handle->ir_control_release(iruart_handle, NULL);
-    ir_control_handle->ir_control_close(iruart_handle);
-    iruart_handle_delete(ir_control_handle);
-    iruart_handle = NULL;
+    if (has_camera)
+    {
+        ircmd_delete_handle(stream_frame_info.ircmd_handle);
+        ir_control_handle->ir_control_release(iruart_handle, NULL);
+        ir_control_handle->ir_control_close(iruart_handle);
+        iruart_handle_delete(ir_control_handle);
+        iruart_handle = NULL;
+    }
     ir_control_handle_delete(&ir_control_handle);
     ir_control_handle = NULL;
 
     if (product_config.camera.v4l2_config.has_image)
     {
-        irv4l2_handle_delete((Irv4l2VideoHandle_t*)stream_frame_info.image_driver_handle);
-        ir_video_handle_delete(&ir_image_video_handle);
+        if (is_replay)
+        {
+            raw_replay_handle_delete((RawReplayHandle_t*)stream_frame_info.image_driver_handle);
+        }
+        else if (is_synthetic)
+        {
+            synthetic_camera_handle_delete((SyntheticCameraHandle_t*)stream_frame_info.image_driver_handle);
+        }
+        else
+        {
+            v4l2_image_driver_handle_delete(&stream_frame_info);
+        }
+        ir_video_handle_delete(&pipeline->ir_image_video_handle);
     }
     if(product_config.camera.v4l2_config.has_temp)
     {
-        irv4l2_handle_delete((Irv4l2VideoHandle_t*)stream_frame_info.temp_driver_handle);
-        ir_video_handle_delete(&ir_temp_video_handle);
+        if (is_replay)
+        {
+            raw_replay_handle_delete((RawReplayHandle_t*)stream_frame_info.temp_driver_handle);
+        }
+        else if (is_synthetic)
+        {
+            synthetic_camera_handle_delete((SyntheticCameraHandle_t*)stream_frame_info.temp_driver_handle);
+        }
+        else
+        {
+            v4l2_temp_driver_handle_delete(&stream_frame_info);
+        }
+        ir_video_handle_delete(&pipeline->ir_temp_video_handle);
     }
 
+    pipeline_destroy(pipeline);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,566 @@
+#include "sample.h"
+
+//time the libirparse conversions the stream/display threads used against the pixel_convert and color_convert kernels
+//replacing them, on random frames of the given size, and check that both produce the same bytes.
+//the color_convert cases run once for every instruction set the cpu has, then the full range check compares
+//every kernel with libirparse on all Y U V combinations and all 16 bit gray values. last the hist_agc gain control
+//is timed against the fixed y14 -> y8 mapping
+
+#define BENCH_DEFAULT_WIDTH     1280
+#define BENCH_DEFAULT_HEIGHT    1024
+#define BENCH_DEFAULT_LOOPS     200
+
+typedef struct {
+    int width;
+    int height;
+    uint8_t* src;       //4 bytes per pixel of random data, enough for every input format
+    uint8_t* scratch;   //intermediate frame of the multi-pass references
+    uint8_t* dst;
+    uint32_t dst_size;  //bytes of dst compared
+    HistAgc_t* agc;
+    PaletteEngine_t* palette_engine;
+}BenchData_t;
+
+typedef void (*BenchFunc)(BenchData_t* data);
+
+static double bench_run_ms(BenchFunc func, BenchData_t* data, int loops)
+{
+    func(data);     //warm up the caches and page in dst
+    uint64_t start_us = bench_clock_us();
+    for (int i = 0; i < loops; i++)
+    {
+        func(data);
+    }
+    return (bench_clock_us() - start_us) / 1000.0 / loops;
+}
+
+static void bench_case(const char* name, BenchFunc reference, BenchFunc candidate, BenchData_t* data, int loops)
+{
+    uint8_t* expected = (uint8_t*)malloc(data->dst_size);
+    reference(data);
+    memcpy(expected, data->dst, data->dst_size);
+    memset(data->dst, 0, data->dst_size);
+    candidate(data);
+    bool same = (memcmp(expected, data->dst, data->dst_size) == 0);
+    free(expected);
+
+    double reference_ms = bench_run_ms(reference, data, loops);
+    double candidate_ms = bench_run_ms(candidate, data, loops);
+    printf("%-24s %8.3f ms -> %8.3f ms  x%.2f  %s\n", name, reference_ms, candidate_ms, \
+        (candidate_ms > 0) ? reference_ms / candidate_ms : 0.0, same ? "same output" : "OUTPUT DIFFERS");
+}
+
+//dvp NV16 frames of YUYV_IMAGE and UYVY_IMAGE format
+static void dvp_yuyv_reference(BenchData_t* data)
+{
+    nv16_to_yuyv(data->src, data->width, data->height, data->dst);
+}
+
+static void dvp_yuyv_fused(BenchData_t* data)
+{
+    nv16_to_yuyv_fused(data->src, data->width, data->height, data->dst);
+}
+
+static void dvp_uyvy_reference(BenchData_t* data)
+{
+    nv16_to_yuyv(data->src, data->width, data->height, data->scratch);
+    uyvy_to_yuyv(data->scratch, data->width, data->height, data->dst);
+}
+
+static void dvp_uyvy_fused(BenchData_t* data)
+{
+    nv16_to_uyvy_fused(data->src, data->width, data->height, data->dst);
+}
+
+//the uvc stream thread gets the frame into the ring buffer, then converted it into a second buffer and copied it back.
+//both sides start from the frame in dst
+static void uvc_uyvy_reference(BenchData_t* data)
+{
+    memcpy(data->dst, data->src, data->dst_size);
+    uyvy_to_yuyv(data->dst, data->width, data->height, data->scratch);
+    memcpy(data->dst, data->scratch, data->dst_size);
+}
+
+static void uvc_uyvy_inplace(BenchData_t* data)
+{
+    memcpy(data->dst, data->src, data->dst_size);
+    uyvy_to_yuyv_inplace(data->dst, data->width, data->height);
+}
+
+static void uvc_vyuy_reference(BenchData_t* data)
+{
+    memcpy(data->dst, data->src, data->dst_size);
+    vyuy_to_yuyv(data->dst, data->width, data->height, data->scratch);
+    memcpy(data->dst, data->scratch, data->dst_size);
+}
+
+static void uvc_vyuy_inplace(BenchData_t* data)
+{
+    memcpy(data->dst, data->src, data->dst_size);
+    vyuy_to_yuyv_inplace(data->dst, data->width, data->height);
+}
+
+static void uvc_yvyu_reference(BenchData_t* data)
+{
+    memcpy(data->dst, data->src, data->dst_size);
+    yvyu_to_yuyv(data->dst, data->width, data->height, data->scratch);
+    memcpy(data->dst, data->scratch, data->dst_size);
+}
+
+static void uvc_yvyu_inplace(BenchData_t* data)
+{
+    memcpy(data->dst, data->src, data->dst_size);
+    yvyu_to_yuyv_inplace(data->dst, data->width, data->height);
+}
+
+//snapshot/encoder planes. the references are the scalar loop capture.cpp split the frame with for its mjpeg encoder,
+//U plane at pix_size and V plane at pix_size * 3 / 2 of YUV422P, and the same loop writing NV16
+static void split_reference(const uint8_t* src, int pix_size, int luma_offset, bool planar, uint8_t* out_data)
+{
+    for (int i = 0; i < pix_size; i += 2)
+    {
+        out_data[i] = src[2 * i + luma_offset];
+        out_data[i + 1] = src[2 * i + 2 + luma_offset];
+        if (planar)
+        {
+            out_data[pix_size + i / 2] = src[2 * i + 1 - luma_offset];
+            out_data[pix_size * 3 / 2 + i / 2] = src[2 * i + 3 - luma_offset];
+        }
+        else
+        {
+            out_data[pix_size + i] = src[2 * i + 1 - luma_offset];
+            out_data[pix_size + i + 1] = src[2 * i + 3 - luma_offset];
+        }
+    }
+}
+
+static void yuyv_yuv422p_reference(BenchData_t* data)
+{
+    split_reference(data->src, data->width * data->height, 0, true, data->dst);
+}
+
+static void yuyv_yuv422p_in_tree(BenchData_t* data)
+{
+    int pix_size = data->width * data->height;
+    yuyv_to_yuv422p(data->src, data->width, data->height, data->dst, data->dst + pix_size, data->dst + pix_size * 3 / 2);
+}
+
+static void uyvy_yuv422p_reference(BenchData_t* data)
+{
+    split_reference(data->src, data->width * data->height, 1, true, data->dst);
+}
+
+static void uyvy_yuv422p_in_tree(BenchData_t* data)
+{
+    int pix_size = data->width * data->height;
+    uyvy_to_yuv422p(data->src, data->width, data->height, data->dst, data->dst + pix_size, data->dst + pix_size * 3 / 2);
+}
+
+static void yuyv_nv16_reference(BenchData_t* data)
+{
+    split_reference(data->src, data->width * data->height, 0, false, data->dst);
+}
+
+static void yuyv_nv16_in_tree(BenchData_t* data)
+{
+    yuyv_to_nv16(data->src, data->width, data->height, data->dst);
+}
+
+static void uyvy_nv16_reference(BenchData_t* data)
+{
+    split_reference(data->src, data->width * data->height, 1, false, data->dst);
+}
+
+static void uyvy_nv16_in_tree(BenchData_t* data)
+{
+    uyvy_to_nv16(data->src, data->width, data->height, data->dst);
+}
+
+static void nv12_yuv420p_reference(BenchData_t* data)
+{
+    int pix_size = data->width * data->height;
+    memcpy(data->dst, data->src, pix_size);
+    for (int i = 0; i < pix_size / 4; i++)
+    {
+        data->dst[pix_size + i] = data->src[pix_size + 2 * i];
+        data->dst[pix_size * 5 / 4 + i] = data->src[pix_size + 2 * i + 1];
+    }
+}
+
+static void nv12_yuv420p_in_tree(BenchData_t* data)
+{
+    int pix_size = data->width * data->height;
+    nv12_to_yuv420p(data->src, data->width, data->height, data->dst, data->dst + pix_size, data->dst + pix_size * 5 / 4);
+}
+
+//display conversions, src holds the yuyv/nv12/nv16/rgb/y16/y14 frame
+static void yuv422_rgb_reference(BenchData_t* data)
+{
+    yuv422_to_rgb(data->src, data->width * data->height, data->dst);
+}
+
+static void yuv422_rgb_in_tree(BenchData_t* data)
+{
+    color_convert_yuv422_to_rgb(data->src, data->width * data->height, data->dst);
+}
+
+static void nv12_rgb_reference(BenchData_t* data)
+{
+    nv12_to_rgb(data->src, data->width, data->height, data->dst);
+}
+
+static void nv12_rgb_in_tree(BenchData_t* data)
+{
+    color_convert_nv12_to_rgb(data->src, data->width, data->height, data->dst);
+}
+
+static void nv16_rgb_reference(BenchData_t* data)
+{
+    nv16_to_rgb(data->src, data->width, data->height, data->dst);
+}
+
+static void nv16_rgb_in_tree(BenchData_t* data)
+{
+    color_convert_nv16_to_rgb(data->src, data->width, data->height, data->dst);
+}
+
+//the opencv display converted to rgb, then to bgr in a second frame
+static void yuv422_bgr_reference(BenchData_t* data)
+{
+    yuv422_to_rgb(data->src, data->width * data->height, data->scratch);
+    rgb_to_bgr(data->scratch, data->width * data->height, data->dst);
+}
+
+static void yuv422_bgr_in_tree(BenchData_t* data)
+{
+    color_convert_yuv422_to_bgr(data->src, data->width * data->height, data->dst);
+}
+
+static void nv12_bgr_reference(BenchData_t* data)
+{
+    nv12_to_rgb(data->src, data->width, data->height, data->scratch);
+    rgb_to_bgr(data->scratch, data->width * data->height, data->dst);
+}
+
+static void nv12_bgr_in_tree(BenchData_t* data)
+{
+    color_convert_nv12_to_bgr(data->src, data->width, data->height, data->dst);
+}
+
+//the bgra references expand the bgr frame as a copy into a XRGB8888 drm buffer would
+static void bgr_to_bgra(BenchData_t* data)
+{
+    int pixel_num = data->width * data->height;
+    for (int i = pixel_num - 1; i >= 0; i--)
+    {
+        data->dst[4 * i + 3] = 255;
+        data->dst[4 * i + 2] = data->scratch[3 * i + 2];
+        data->dst[4 * i + 1] = data->scratch[3 * i + 1];
+        data->dst[4 * i] = data->scratch[3 * i];
+    }
+}
+
+static void yuv422_bgra_reference(BenchData_t* data)
+{
+    yuv422_to_rgb(data->src, data->width * data->height, data->scratch);
+    rgb_to_bgr(data->scratch, data->width * data->height, data->scratch);
+    bgr_to_bgra(data);
+}
+
+static void yuv422_bgra_in_tree(BenchData_t* data)
+{
+    color_convert_yuv422_to_bgra(data->src, data->width, data->height, data->dst, data->width * 4);
+}
+
+static void nv12_bgra_reference(BenchData_t* data)
+{
+    nv12_to_rgb(data->src, data->width, data->height, data->scratch);
+    rgb_to_bgr(data->scratch, data->width * data->height, data->scratch);
+    bgr_to_bgra(data);
+}
+
+static void nv12_bgra_in_tree(BenchData_t* data)
+{
+    color_convert_nv12_to_bgra(data->src, data->width, data->height, data->dst, data->width * 4);
+}
+
+static void rgb_bgr_reference(BenchData_t* data)
+{
+    rgb_to_bgr(data->src, data->width * data->height, data->dst);
+}
+
+static void rgb_bgr_in_tree(BenchData_t* data)
+{
+    color_convert_rgb_to_bgr(data->src, data->width * data->height, data->dst);
+}
+
+static void y16_rgb_reference(BenchData_t* data)
+{
+    y16_to_rgb((uint16_t*)data->src, data->width, data->height, data->dst);
+}
+
+static void y16_rgb_in_tree(BenchData_t* data)
+{
+    color_convert_y16_to_rgb((uint16_t*)data->src, data->width, data->height, data->dst);
+}
+
+static void y14_yuv444_reference(BenchData_t* data)
+{
+    y14_to_yuv444((uint16_t*)data->src, data->width * data->height, data->dst);
+}
+
+static void y14_yuv444_in_tree(BenchData_t* data)
+{
+    color_convert_y14_to_yuv444((uint16_t*)data->src, data->width * data->height, data->dst);
+}
+
+static void bench_color_cases(ColorConvertIsa_e isa, BenchData_t* data, int loops)
+{
+    const char* isa_name = color_convert_isa_name(isa);
+    char name[64];
+    snprintf(name, sizeof(name), "yuyv -> rgb %s", isa_name);
+    bench_case(name, yuv422_rgb_reference, yuv422_rgb_in_tree, data, loops);
+    snprintf(name, sizeof(name), "nv12 -> rgb %s", isa_name);
+    bench_case(name, nv12_rgb_reference, nv12_rgb_in_tree, data, loops);
+    snprintf(name, sizeof(name), "nv16 -> rgb %s", isa_name);
+    bench_case(name, nv16_rgb_reference, nv16_rgb_in_tree, data, loops);
+    snprintf(name, sizeof(name), "rgb -> bgr %s", isa_name);
+    bench_case(name, rgb_bgr_reference, rgb_bgr_in_tree, data, loops);
+    snprintf(name, sizeof(name), "y16 -> rgb %s", isa_name);
+    bench_case(name, y16_rgb_reference, y16_rgb_in_tree, data, loops);
+    snprintf(name, sizeof(name), "y14 -> yuv444 %s", isa_name);
+    bench_case(name, y14_yuv444_reference, y14_yuv444_in_tree, data, loops);
+    snprintf(name, sizeof(name), "yuyv -> bgr %s", isa_name);
+    bench_case(name, yuv422_bgr_reference, yuv422_bgr_in_tree, data, loops);
+    snprintf(name, sizeof(name), "nv12 -> bgr %s", isa_name);
+    bench_case(name, nv12_bgr_reference, nv12_bgr_in_tree, data, loops);
+
+    data->dst_size = data->width * data->height * 4;
+    snprintf(name, sizeof(name), "yuyv -> bgra %s", isa_name);
+    bench_case(name, yuv422_bgra_reference, yuv422_bgra_in_tree, data, loops);
+    snprintf(name, sizeof(name), "nv12 -> bgra %s", isa_name);
+    bench_case(name, nv12_bgra_reference, nv12_bgra_in_tree, data, loops);
+    data->dst_size = data->width * data->height * 3;
+}
+
+//gain control of y14 frames against the fixed mapping of libirparse. scratch holds two frames of a scene with a hot
+//spot moving between them, the updates alternate between the two so every one moves part of the histogram.
+//the curves differ from the fixed mapping, so only the time is compared
+static uint16_t* agc_next_frame(BenchData_t* data)
+{
+    static int frame_index = 0;
+    frame_index ^= 1;
+    return (uint16_t*)data->scratch + frame_index * data->width * data->height;
+}
+
+static void y14_y8_reference(BenchData_t* data)
+{
+    y14_to_y8((uint16_t*)data->scratch, data->width * data->height, data->dst);
+}
+
+static void agc_update(BenchData_t* data)
+{
+    hist_agc_update(data->agc, agc_next_frame(data));
+}
+
+static void agc_to_y8(BenchData_t* data)
+{
+    hist_agc_to_y8(data->agc, (uint16_t*)data->scratch, data->width * data->height, data->dst);
+}
+
+//the curve fed to the palette table the temp view renders through
+static void agc_palette_update(BenchData_t* data)
+{
+    hist_agc_update(data->agc, agc_next_frame(data));
+    palette_engine_set_transfer(data->palette_engine, hist_agc_transfer(data->agc));
+    palette_engine_update(data->palette_engine);
+}
+
+static void agc_scene(BenchData_t* data)
+{
+    for (int frame = 0; frame < 2; frame++)
+    {
+        uint16_t* y14 = (uint16_t*)data->scratch + frame * data->width * data->height;
+        int spot_x = data->width / 3 + frame * 16;
+        int spot_y = data->height / 3;
+        int spot_radius = data->height / 10;
+        for (int y = 0; y < data->height; y++)
+        {
+            for (int x = 0; x < data->width; x++)
+            {
+                int value = 6000 + x * 1000 / data->width + y * 500 / data->height + (rand() % 64) - 32;
+                if ((x - spot_x) * (x - spot_x) + (y - spot_y) * (y - spot_y) < spot_radius * spot_radius)
+                {
+                    value += 6000;
+                }
+                y14[y * data->width + x] = (uint16_t)value;
+            }
+        }
+    }
+}
+
+static bool bench_agc(BenchData_t* data, int loops)
+{
+    agc_scene(data);
+    data->palette_engine = palette_engine_create("iron");
+    if (data->palette_engine == NULL)
+    {
+        return false;
+    }
+    printf("%-24s %8.3f ms\n", "y14 -> y8 fixed", bench_run_ms(y14_y8_reference, data, loops));
+
+    const char* mode_names[] = { "plateau", "linear" };
+    for (int mode = HIST_AGC_PLATEAU; mode <= HIST_AGC_LINEAR; mode++)
+    {
+        HistAgcParam_t param;
+        hist_agc_default_param(&param);
+        param.mode = (HistAgcMode_e)mode;
+        data->agc = hist_agc_create(&param, data->width, data->height);
+        if (data->agc == NULL)
+        {
+            palette_engine_destroy(data->palette_engine);
+            return false;
+        }
+        char name[64];
+        snprintf(name, sizeof(name), "agc %s update", mode_names[mode]);
+        printf("%-24s %8.3f ms\n", name, bench_run_ms(agc_update, data, loops));
+        snprintf(name, sizeof(name), "agc %s -> y8", mode_names[mode]);
+        printf("%-24s %8.3f ms\n", name, bench_run_ms(agc_to_y8, data, loops));
+        snprintf(name, sizeof(name), "agc %s -> palette", mode_names[mode]);
+        printf("%-24s %8.3f ms\n", name, bench_run_ms(agc_palette_update, data, loops));
+        hist_agc_destroy(data->agc);
+        data->agc = NULL;
+    }
+    palette_engine_destroy(data->palette_engine);
+    data->palette_engine = NULL;
+    return true;
+}
+
+//every U V pair with every Y as Y0 and the inverted Y as Y1, one U a pass. then every 16 bit value as y16 and y14
+static bool color_full_range_check(void)
+{
+    const int pair_num = 256 * 256;
+    uint8_t* yuyv = (uint8_t*)malloc(pair_num * 4);
+    uint8_t* expected = (uint8_t*)malloc(pair_num * 6);
+    uint8_t* actual = (uint8_t*)malloc(pair_num * 6);
+    uint16_t* gray = (uint16_t*)malloc(65536 * sizeof(uint16_t));
+    bool same = true;
+
+    for (int u = 0; u < 256 && same; u++)
+    {
+        for (int i = 0; i < pair_num; i++)
+        {
+            yuyv[4 * i] = i & 0xff;
+            yuyv[4 * i + 1] = u;
+            yuyv[4 * i + 2] = 255 - (i & 0xff);
+            yuyv[4 * i + 3] = i >> 8;
+        }
+        yuv422_to_rgb(yuyv, pair_num * 2, expected);
+        color_convert_yuv422_to_rgb(yuyv, pair_num * 2, actual);
+        same = (memcmp(expected, actual, pair_num * 6) == 0);
+    }
+
+    for (int i = 0; i < 65536; i++)
+    {
+        gray[i] = i;
+    }
+    y16_to_rgb(gray, 256, 256, expected);
+    color_convert_y16_to_rgb(gray, 256, 256, actual);
+    same = same && (memcmp(expected, actual, 65536 * 3) == 0);
+    y14_to_yuv444(gray, 65536, expected);
+    color_convert_y14_to_yuv444(gray, 65536, actual);
+    same = same && (memcmp(expected, actual, 65536 * 3) == 0);
+
+    free(yuyv);
+    free(expected);
+    free(actual);
+    free(gray);
+    return same;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchData_t data;
+    data.width = BENCH_DEFAULT_WIDTH;
+    data.height = BENCH_DEFAULT_HEIGHT;
+    int loops = BENCH_DEFAULT_LOOPS;
+    if (argc != 1 && argc != 3 && argc != 4)
+    {
+        printf("usage: %s [<width> <height> [loops]]\n", argv[0]);
+        return -1;
+    }
+    if (argc >= 3)
+    {
+        data.width = atoi(argv[1]);
+        data.height = atoi(argv[2]);
+    }
+    if (argc == 4)
+    {
+        loops = atoi(argv[3]);
+    }
+    if (data.width <= 0 || data.height <= 0 || (data.width % 2) != 0 || loops <= 0)
+    {
+        printf("set an illicit size\n");
+        return -1;
+    }
+
+    irparse_log_register(IRPARSE_LOG_ERROR);
+    uint32_t frame_size = data.width * data.height * 4;
+    data.src = (uint8_t*)malloc(frame_size);
+    data.scratch = (uint8_t*)malloc(frame_size);
+    data.dst = (uint8_t*)malloc(frame_size);
+    data.agc = NULL;
+    data.palette_engine = NULL;
+    if (data.src == NULL || data.scratch == NULL || data.dst == NULL)
+    {
+        printf("there is no more space!\n");
+        return -1;
+    }
+    srand(1);
+    for (uint32_t i = 0; i < frame_size; i++)
+    {
+        data.src[i] = rand() & 0xff;
+    }
+
+    printf("%dx%d, %d loops, average time per frame:\n", data.width, data.height, loops);
+    data.dst_size = data.width * data.height * 2;
+    bench_case("dvp nv16 -> yuyv", dvp_yuyv_reference, dvp_yuyv_fused, &data, loops);
+    bench_case("dvp nv16 -> uyvy", dvp_uyvy_reference, dvp_uyvy_fused, &data, loops);
+    bench_case("uvc uyvy -> yuyv", uvc_uyvy_reference, uvc_uyvy_inplace, &data, loops);
+    bench_case("uvc vyuy -> yuyv", uvc_vyuy_reference, uvc_vyuy_inplace, &data, loops);
+    bench_case("uvc yvyu -> yuyv", uvc_yvyu_reference, uvc_yvyu_inplace, &data, loops);
+    bench_case("yuyv -> yuv422p", yuyv_yuv422p_reference, yuyv_yuv422p_in_tree, &data, loops);
+    bench_case("uyvy -> yuv422p", uyvy_yuv422p_reference, uyvy_yuv422p_in_tree, &data, loops);
+    bench_case("yuyv -> nv16", yuyv_nv16_reference, yuyv_nv16_in_tree, &data, loops);
+    bench_case("uyvy -> nv16", uyvy_nv16_reference, uyvy_nv16_in_tree, &data, loops);
+    if ((data.height % 2) == 0)
+    {
+        data.dst_size = data.width * data.height * 3 / 2;
+        bench_case("nv12 -> yuv420p", nv12_yuv420p_reference, nv12_yuv420p_in_tree, &data, loops);
+    }
+
+    ColorConvertIsa_e best_isa = color_convert_get_isa();
+    printf("color convert kernels of this cpu: %s\n", color_convert_isa_name(best_isa));
+    data.dst_size = data.width * data.height * 3;
+    bool all_same = true;
+    for (int isa = COLOR_CONVERT_SCALAR; isa < COLOR_CONVERT_ISA_NUM; isa++)
+    {
+        if (color_convert_set_isa((ColorConvertIsa_e)isa) != 0)
+        {
+            continue;
+        }
+        bench_color_cases((ColorConvertIsa_e)isa, &data, loops);
+        bool same = color_full_range_check();
+        printf("%-24s %s\n", "full range check", same ? "same output" : "OUTPUT DIFFERS");
+        all_same = all_same && same;
+    }
+    color_convert_set_isa(best_isa);
+
+    printf("gain control of y14 frames:\n");
+    all_same = bench_agc(&data, loops) && all_same;
+
+    free(data.src);
+    free(data.scratch);
+    free(data.dst);
+    return all_same ? 0 : -1;
+}
@@ -0,0 +1,11 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "pixel_convert.h"
+#include "color_convert.h"
+#include "hist_agc.h"
+#include "palette.h"
+#include "libirparse.h"
+#include "bench_common.h"
@@ -0,0 +1,198 @@
+#include "sample.h"
+
+//time building a rect index of a frame against answering random rectangles with get_rect_temp of libirtemp, with a
+//plain scan of each rectangle and with the index. the break-even is the number of rectangles per frame from which
+//building the index and querying it is faster than scanning. the index output is checked against the plain scans,
+//libirtemp filters isolated pixels and is only timed
+
+#define BENCH_DEFAULT_RECT_NUM  300
+#define BENCH_DEFAULT_LOOPS     20
+
+typedef struct {
+    int start_x;
+    int start_y;
+    int end_x;
+    int end_y;
+}BenchRect_t;
+
+//rectangles up to a quarter of the frame wide, plus the corner cases of the blocks: the whole frame, single pixels
+//and rectangles within one row or column of blocks
+static void bench_make_rects(BenchRect_t* rects, int rect_num, int width, int height)
+{
+    for (int i = 0; i < rect_num; i++)
+    {
+        BenchRect_t* rect = &rects[i];
+        int rect_width = 1 + bench_rand(width / 4), rect_height = 1 + bench_rand(height / 4);
+        switch (i % 10)
+        {
+        case 0:
+            rect_width = width;
+            rect_height = height;
+            break;
+        case 1:
+            rect_width = rect_height = 1;
+            break;
+        case 2:
+            rect_height = 1 + bench_rand(RECT_INDEX_BLOCK * 2);
+            break;
+        default:
+            break;
+        }
+        rect->start_x = bench_rand(width - rect_width + 1);
+        rect->start_y = bench_rand(height - rect_height + 1);
+        rect->end_x = rect->start_x + rect_width - 1;
+        rect->end_y = rect->start_y + rect_height - 1;
+    }
+}
+
+static void bench_plain_rect(const uint16_t* y16, int width, const BenchRect_t* rect, RectIndexResult_t* result)
+{
+    memset(result, 0, sizeof(RectIndexResult_t));
+    result->min_value = 0xffff;
+    result->min_x = result->max_x = rect->start_x;
+    result->min_y = result->max_y = rect->start_y;
+    for (int y = rect->start_y; y <= rect->end_y; y++)
+    {
+        for (int x = rect->start_x; x <= rect->end_x; x++)
+        {
+            uint16_t value = y16[y * width + x];
+            if (value < result->min_value)
+            {
+                result->min_value = value;
+                result->min_x = x;
+                result->min_y = y;
+            }
+            if (value > result->max_value)
+            {
+                result->max_value = value;
+                result->max_x = x;
+                result->max_y = y;
+            }
+            result->sum += value;
+        }
+    }
+    result->pixel_num = (rect->end_x - rect->start_x + 1) * (rect->end_y - rect->start_y + 1);
+}
+
+static void bench_libirtemp_rect(uint16_t* y16, int width, int height, const BenchRect_t* rect)
+{
+    TempDataRes_t temp_res = { (uint16_t)width, (uint16_t)height };
+    TempInfo_t temp_info;
+    Area_t area = { rect->start_x, rect->start_y, rect->end_x - rect->start_x + 1, rect->end_y - rect->start_y + 1 };
+    get_rect_temp(y16, temp_res, area, &temp_info);
+}
+
+static bool bench_same(const RectIndexResult_t& a, const RectIndexResult_t& b)
+{
+    return a.min_value == b.min_value && a.max_value == b.max_value && a.min_x == b.min_x && a.min_y == b.min_y \
+        && a.max_x == b.max_x && a.max_y == b.max_y && a.sum == b.sum && a.pixel_num == b.pixel_num;
+}
+
+//rectangles per frame from which building once and querying beats scanning every rectangle
+static void bench_print_break_even(const char* name, double build_ms, double scan_ms, double query_ms)
+{
+    if (scan_ms > query_ms)
+    {
+        printf("  break-even against %-10s %8.1f rects\n", name, build_ms / (scan_ms - query_ms));
+    }
+    else
+    {
+        printf("  break-even against %-10s %8s\n", name, "never");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int rect_num = BENCH_DEFAULT_RECT_NUM;
+    int loops = BENCH_DEFAULT_LOOPS;
+    if (argc != 1 && argc != 3)
+    {
+        printf("usage: %s [<rect_num> <loops>]\n", argv[0]);
+        return -1;
+    }
+    if (argc == 3)
+    {
+        rect_num = atoi(argv[1]);
+        loops = atoi(argv[2]);
+    }
+    if (rect_num <= 0 || loops <= 0)
+    {
+        printf("set an illicit rect_num or loops\n");
+        return -1;
+    }
+
+    bool all_same = true;
+    srand(1);
+    printf("%d rects, %d loops, average time per frame and per rect:\n", rect_num, loops);
+    for (int s = 0; s < BENCH_SIZE_NUM; s++)
+    {
+        int width = bench_sizes[s].width;
+        int height = bench_sizes[s].height;
+        std::vector<uint16_t> y16(width * height);
+        //coarse noise so values tie and the positions of the first pixel in raster order are checked too
+        bench_make_frame(&y16[0], width, height, 8);
+        std::vector<BenchRect_t> rects(rect_num);
+        bench_make_rects(&rects[0], rect_num, width, height);
+        RectIndex_t* index = rect_index_create(width, height);
+        if (index == NULL)
+        {
+            return -1;
+        }
+
+        uint64_t start_us = bench_clock_us();
+        for (int loop = 0; loop < loops; loop++)
+        {
+            rect_index_build(index, &y16[0]);
+        }
+        double build_ms = (bench_clock_us() - start_us) / 1000.0 / loops;
+
+        start_us = bench_clock_us();
+        for (int loop = 0; loop < loops; loop++)
+        {
+            for (int i = 0; i < rect_num; i++)
+            {
+                bench_libirtemp_rect(&y16[0], width, height, &rects[i]);
+            }
+        }
+        double libirtemp_ms = (bench_clock_us() - start_us) / 1000.0 / loops / rect_num;
+
+        std::vector<RectIndexResult_t> expected(rect_num);
+        start_us = bench_clock_us();
+        for (int loop = 0; loop < loops; loop++)
+        {
+            for (int i = 0; i < rect_num; i++)
+            {
+                bench_plain_rect(&y16[0], width, &rects[i], &expected[i]);
+            }
+        }
+        double plain_ms = (bench_clock_us() - start_us) / 1000.0 / loops / rect_num;
+
+        std::vector<RectIndexResult_t> result(rect_num);
+        start_us = bench_clock_us();
+        for (int loop = 0; loop < loops; loop++)
+        {
+            for (int i = 0; i < rect_num; i++)
+            {
+                rect_index_query(index, rects[i].start_x, rects[i].start_y, rects[i].end_x, rects[i].end_y, &result[i]);
+            }
+        }
+        double query_ms = (bench_clock_us() - start_us) / 1000.0 / loops / rect_num;
+
+        bool same = true;
+        for (int i = 0; i < rect_num; i++)
+        {
+            same = same && bench_same(expected[i], result[i]);
+        }
+        all_same = all_same && same;
+
+        printf("%dx%d: index built in %.3f ms\n", width, height, build_ms);
+        printf("  %-28s %8.4f ms\n", "libirtemp per rect", libirtemp_ms);
+        printf("  %-28s %8.4f ms\n", "plain scan per rect", plain_ms);
+        printf("  %-28s %8.4f ms  %s\n", "index query per rect", query_ms, same ? "same output" : "OUTPUT DIFFERS");
+        bench_print_break_even("libirtemp", build_ms, libirtemp_ms, query_ms);
+        bench_print_break_even("plain scan", build_ms, plain_ms, query_ms);
+        rect_index_destroy(index);
+    }
+    printf("%s\n", all_same ? "all outputs are the same" : "SOME OUTPUTS DIFFER");
+    return all_same ? 0 : -1;
+}
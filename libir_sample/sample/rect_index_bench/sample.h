@@ -0,0 +1,9 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+
+#include "libirtemp.h"
+#include "rect_index.h"
+#include "bench_common.h"
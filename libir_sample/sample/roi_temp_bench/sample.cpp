@@ -0,0 +1,206 @@
+#include "sample.h"
+
+//time a set of random points, lines and rectangles measured one call per roi, with get_point_temp/get_line_temp/
+//get_rect_temp of libirtemp and with a plain scan of each roi, against one roi_set_measure pass over the frame.
+//the roi set output is checked against the plain scans, libirtemp filters isolated pixels and is only timed
+
+#define BENCH_DEFAULT_ROI_NUM   300
+#define BENCH_DEFAULT_LOOPS     100
+
+//min/max/sum of one roi, positions first in raster order
+typedef struct {
+    uint16_t min_value;
+    uint16_t max_value;
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+    uint64_t sum;
+    uint32_t pixel_num;
+}BenchRoiResult_t;
+
+static void bench_visit(const uint16_t* y16, int width, int x, int y, BenchRoiResult_t* result)
+{
+    uint16_t value = y16[y * width + x];
+    bool first = (result->pixel_num == 0);
+    if (first || value < result->min_value || (value == result->min_value \
+        && (y < result->min_y || (y == result->min_y && x < result->min_x))))
+    {
+        result->min_value = value;
+        result->min_x = x;
+        result->min_y = y;
+    }
+    if (first || value > result->max_value || (value == result->max_value \
+        && (y < result->max_y || (y == result->max_y && x < result->max_x))))
+    {
+        result->max_value = value;
+        result->max_x = x;
+        result->max_y = y;
+    }
+    result->sum += value;
+    result->pixel_num++;
+}
+
+//walk the pixels of one roi on their own, the lines in the order of the line
+static void bench_plain_roi(const uint16_t* y16, int width, const Roi_t* roi, BenchRoiResult_t* result)
+{
+    memset(result, 0, sizeof(BenchRoiResult_t));
+    if (roi->type == ROI_TYPE_LINE)
+    {
+        int x = roi->start_x, y = roi->start_y;
+        int dx = abs(roi->end_x - x), dy = -abs(roi->end_y - y);
+        int step_x = (roi->end_x > x) ? 1 : -1, step_y = (roi->end_y > y) ? 1 : -1;
+        int error = dx + dy;
+        while (true)
+        {
+            bench_visit(y16, width, x, y, result);
+            if (x == roi->end_x && y == roi->end_y)
+            {
+                break;
+            }
+            int error2 = 2 * error;
+            if (error2 >= dy)
+            {
+                error += dy;
+                x += step_x;
+            }
+            if (error2 <= dx)
+            {
+                error += dx;
+                y += step_y;
+            }
+        }
+        return;
+    }
+
+    int x_start = (roi->start_x < roi->end_x) ? roi->start_x : roi->end_x;
+    int x_end = (roi->start_x < roi->end_x) ? roi->end_x : roi->start_x;
+    int y_start = (roi->start_y < roi->end_y) ? roi->start_y : roi->end_y;
+    int y_end = (roi->start_y < roi->end_y) ? roi->end_y : roi->start_y;
+    for (int y = y_start; y <= y_end; y++)
+    {
+        for (int x = x_start; x <= x_end; x++)
+        {
+            bench_visit(y16, width, x, y, result);
+        }
+    }
+}
+
+static void bench_libirtemp_roi(uint16_t* y16, int width, int height, const Roi_t* roi)
+{
+    TempDataRes_t temp_res = { (uint16_t)width, (uint16_t)height };
+    TempInfo_t temp_info;
+    if (roi->type == ROI_TYPE_POINT)
+    {
+        Dot_t point = { roi->start_x, roi->start_y };
+        uint16_t point_temp;
+        get_point_temp(y16, temp_res, point, &point_temp);
+    }
+    else if (roi->type == ROI_TYPE_LINE)
+    {
+        Line_t line = { roi->start_x, roi->start_y, roi->end_x, roi->end_y };
+        get_line_temp(y16, temp_res, line, &temp_info);
+    }
+    else
+    {
+        int x_start = (roi->start_x < roi->end_x) ? roi->start_x : roi->end_x;
+        int y_start = (roi->start_y < roi->end_y) ? roi->start_y : roi->end_y;
+        Area_t rect = { x_start, y_start, abs(roi->end_x - roi->start_x) + 1, abs(roi->end_y - roi->start_y) + 1 };
+        get_rect_temp(y16, temp_res, rect, &temp_info);
+    }
+}
+
+static bool bench_same(const BenchRoiResult_t& a, const RoiTempResult_t* b, int i)
+{
+    return a.min_value == b->min_value[i] && a.max_value == b->max_value[i] && a.min_x == b->min_x[i] \
+        && a.min_y == b->min_y[i] && a.max_x == b->max_x[i] && a.max_y == b->max_y[i] && a.sum == b->sum[i] \
+        && a.pixel_num == b->pixel_num[i];
+}
+
+int main(int argc, char* argv[])
+{
+    int roi_num = BENCH_DEFAULT_ROI_NUM;
+    int loops = BENCH_DEFAULT_LOOPS;
+    if (argc != 1 && argc != 3)
+    {
+        printf("usage: %s [<roi_num> <loops>]\n", argv[0]);
+        return -1;
+    }
+    if (argc == 3)
+    {
+        roi_num = atoi(argv[1]);
+        loops = atoi(argv[2]);
+    }
+    if (roi_num <= 0 || loops <= 0)
+    {
+        printf("set an illicit roi_num or loops\n");
+        return -1;
+    }
+
+    bool all_same = true;
+    srand(1);
+    printf("%d rois(points, lines, rects), %d loops, average time per frame:\n", roi_num, loops);
+    for (int s = 0; s < BENCH_SIZE_NUM; s++)
+    {
+        int width = bench_sizes[s].width;
+        int height = bench_sizes[s].height;
+        std::vector<uint16_t> y16(width * height);
+        bench_make_frame(&y16[0], width, height, 1);
+        std::vector<Roi_t> rois(roi_num);
+        bench_make_rois(&rois[0], roi_num, width, height);
+
+        uint64_t start_us = bench_clock_us();
+        RoiSet_t* set = roi_set_create(&rois[0], roi_num, width, height);
+        double create_ms = (bench_clock_us() - start_us) / 1000.0;
+        RoiTempResult_t* result = roi_temp_result_create(set);
+        if (set == NULL || result == NULL)
+        {
+            return -1;
+        }
+
+        start_us = bench_clock_us();
+        for (int loop = 0; loop < loops; loop++)
+        {
+            for (int i = 0; i < roi_num; i++)
+            {
+                bench_libirtemp_roi(&y16[0], width, height, &rois[i]);
+            }
+        }
+        double libirtemp_ms = (bench_clock_us() - start_us) / 1000.0 / loops;
+
+        std::vector<BenchRoiResult_t> expected(roi_num);
+        start_us = bench_clock_us();
+        for (int loop = 0; loop < loops; loop++)
+        {
+            for (int i = 0; i < roi_num; i++)
+            {
+                bench_plain_roi(&y16[0], width, &rois[i], &expected[i]);
+            }
+        }
+        double plain_ms = (bench_clock_us() - start_us) / 1000.0 / loops;
+
+        start_us = bench_clock_us();
+        for (int loop = 0; loop < loops; loop++)
+        {
+            roi_set_measure(set, &y16[0], result);
+        }
+        double set_ms = (bench_clock_us() - start_us) / 1000.0 / loops;
+
+        bool same = true;
+        for (int i = 0; i < roi_num; i++)
+        {
+            same = same && bench_same(expected[i], result, i);
+        }
+        all_same = all_same && same;
+
+        printf("%dx%d: roi set compiled in %.3f ms\n", width, height, create_ms);
+        printf("  %-24s %8.3f ms\n", "libirtemp per roi", libirtemp_ms);
+        printf("  %-24s %8.3f ms\n", "plain scan per roi", plain_ms);
+        printf("  %-24s %8.3f ms  x%.2f  %s\n", "roi set", set_ms, (set_ms > 0) ? libirtemp_ms / set_ms : 0.0, \
+            same ? "same output" : "OUTPUT DIFFERS");
+        roi_temp_result_destroy(result);
+        roi_set_destroy(set);
+    }
+    printf("%s\n", all_same ? "all outputs are the same" : "SOME OUTPUTS DIFFER");
+    return all_same ? 0 : -1;
+}
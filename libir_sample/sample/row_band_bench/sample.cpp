@@ -0,0 +1,200 @@
+#include "sample.h"
+
+//time the full frame kernels of the display and temp measure threads on 1~max_threads row band threads,
+//on random frames of the given size, and check that every thread count gives the output of the single thread run.
+//the optional cpu list pins the workers like camera::row_band_cpus
+
+#define BENCH_DEFAULT_WIDTH     1280
+#define BENCH_DEFAULT_HEIGHT    1024
+#define BENCH_DEFAULT_LOOPS     100
+
+typedef struct {
+    int width;
+    int height;
+    uint8_t* src;       //4 bytes per pixel of random data, enough for every input format
+    uint8_t* dst;
+    uint32_t dst_size;  //bytes of dst compared
+    RowBandPool_t* pool;
+    RowBandMinMax_t min_max;
+    PaletteEngine_t* palette_engine;
+}BenchData_t;
+
+typedef void (*BenchFunc)(BenchData_t* data);
+
+typedef struct {
+    const char* name;
+    BenchFunc func;
+    int dst_pixel_size;
+}BenchCase_t;
+
+static double bench_run_ms(BenchFunc func, BenchData_t* data, int loops)
+{
+    func(data);     //warm up the caches and the workers
+    uint64_t start_us = bench_clock_us();
+    for (int i = 0; i < loops; i++)
+    {
+        func(data);
+    }
+    return (bench_clock_us() - start_us) / 1000.0 / loops;
+}
+
+static void yuyv_to_bgr(BenchData_t* data)
+{
+    row_band_yuv422_to_bgr(data->pool, data->src, data->width, data->height, data->dst);
+}
+
+static void nv12_to_bgr(BenchData_t* data)
+{
+    row_band_nv12_to_bgr(data->pool, data->src, data->width, data->height, data->dst);
+}
+
+static void nv12_to_bgra(BenchData_t* data)
+{
+    row_band_nv12_to_bgra(data->pool, data->src, data->width, data->height, data->dst, data->width * 4);
+}
+
+static void y16_to_bgr(BenchData_t* data)
+{
+    row_band_y16_to_bgr(data->pool, (uint16_t*)data->src, data->width, data->height, data->dst);
+}
+
+static void y16_palette_to_bgr(BenchData_t* data)
+{
+    row_band_palette_to_bgr(data->pool, data->palette_engine, (uint16_t*)data->src, data->width, data->height, data->dst);
+}
+
+static void y16_to_celsius(BenchData_t* data)
+{
+    row_band_y16_to_celsius(data->pool, (uint16_t*)data->src, data->width, data->height, (float*)data->dst);
+}
+
+//the result goes to dst so it is compared like the frames
+static void y16_min_max(BenchData_t* data)
+{
+    row_band_y16_min_max(data->pool, (uint16_t*)data->src, data->width, data->height, &data->min_max);
+    memcpy(data->dst, &data->min_max, sizeof(RowBandMinMax_t));
+}
+
+static void bgr_mirror(BenchData_t* data)
+{
+    row_band_mirror(data->pool, data->src, data->width, data->height, 3, data->dst);
+}
+
+static void bgr_flip(BenchData_t* data)
+{
+    row_band_flip(data->pool, data->src, data->width, data->height, 3, data->dst);
+}
+
+static const BenchCase_t bench_cases[] = {
+    { "yuyv -> bgr", yuyv_to_bgr, 3 },
+    { "nv12 -> bgr", nv12_to_bgr, 3 },
+    { "nv12 -> bgra", nv12_to_bgra, 4 },
+    { "y16 -> bgr", y16_to_bgr, 3 },
+    { "y16 palette -> bgr", y16_palette_to_bgr, 3 },
+    { "y16 -> celsius", y16_to_celsius, 4 },
+    { "y16 min/max", y16_min_max, 0 },
+    { "bgr mirror", bgr_mirror, 3 },
+    { "bgr flip", bgr_flip, 3 },
+};
+
+int main(int argc, char* argv[])
+{
+    BenchData_t data;
+    data.width = BENCH_DEFAULT_WIDTH;
+    data.height = BENCH_DEFAULT_HEIGHT;
+    int loops = BENCH_DEFAULT_LOOPS;
+    int max_threads = 0;
+    if (argc > 1 && argc != 2 && argc < 5)
+    {
+        printf("usage: %s [<max_threads> [<width> <height> <loops> [cpu ...]]]\n", argv[0]);
+        return -1;
+    }
+    if (argc >= 2)
+    {
+        max_threads = atoi(argv[1]);
+    }
+    if (argc >= 5)
+    {
+        data.width = atoi(argv[2]);
+        data.height = atoi(argv[3]);
+        loops = atoi(argv[4]);
+    }
+    std::vector<int> cpus;
+    for (int i = 5; i < argc; i++)
+    {
+        cpus.push_back(atoi(argv[i]));
+    }
+    if (data.width <= 0 || data.height <= 0 || (data.width % 2) != 0 || (data.height % 2) != 0 || loops <= 0 || max_threads < 0)
+    {
+        printf("set an illicit size\n");
+        return -1;
+    }
+
+    //0 threads is one per online cpu, the pool knows how many that is
+    RowBandPool_t* probe_pool = row_band_pool_create(max_threads, NULL, 0);
+    max_threads = row_band_pool_thread_num(probe_pool);
+    row_band_pool_destroy(probe_pool);
+
+    uint32_t frame_size = data.width * data.height * 4;
+    data.src = (uint8_t*)malloc(frame_size);
+    data.dst = (uint8_t*)malloc(frame_size);
+    if (data.src == NULL || data.dst == NULL)
+    {
+        printf("there is no more space!\n");
+        return -1;
+    }
+    srand(1);
+    for (uint32_t i = 0; i < frame_size; i++)
+    {
+        data.src[i] = rand() & 0xff;
+    }
+
+    //iron over 0~60 celsius, the table is built in the first run
+    data.palette_engine = palette_engine_create("iron");
+    palette_engine_set_range(data.palette_engine, (uint16_t)(273.15 * 64), (uint16_t)(333.15 * 64));
+
+    int case_num = sizeof(bench_cases) / sizeof(bench_cases[0]);
+    std::vector<double> single_ms(case_num);
+    std::vector<std::vector<uint8_t> > expected(case_num);
+    bool all_same = true;
+    printf("%dx%d, %d loops, 1~%d threads, average time per frame:\n", data.width, data.height, loops, max_threads);
+    for (int thread_num = 1; thread_num <= max_threads; thread_num++)
+    {
+        data.pool = (thread_num == 1) ? NULL : row_band_pool_create(thread_num, cpus.empty() ? NULL : &cpus[0], (int)cpus.size());
+        printf("%d threads:\n", thread_num);
+        for (int i = 0; i < case_num; i++)
+        {
+            const BenchCase_t& bench_case = bench_cases[i];
+            data.dst_size = (bench_case.dst_pixel_size == 0) ? sizeof(RowBandMinMax_t) \
+                : data.width * data.height * bench_case.dst_pixel_size;
+
+            //the single thread run is the reference of the others
+            memset(data.dst, 0, data.dst_size);
+            bench_case.func(&data);
+            bool same = true;
+            if (thread_num == 1)
+            {
+                expected[i].assign(data.dst, data.dst + data.dst_size);
+            }
+            else
+            {
+                same = (memcmp(&expected[i][0], data.dst, data.dst_size) == 0);
+            }
+            all_same = all_same && same;
+
+            double ms = bench_run_ms(bench_case.func, &data, loops);
+            if (thread_num == 1)
+            {
+                single_ms[i] = ms;
+            }
+            printf("  %-20s %8.3f ms  x%.2f  %s\n", bench_case.name, ms, (ms > 0) ? single_ms[i] / ms : 0.0, \
+                same ? "same output" : "OUTPUT DIFFERS");
+        }
+        row_band_pool_destroy(data.pool);
+    }
+
+    palette_engine_destroy(data.palette_engine);
+    free(data.src);
+    free(data.dst);
+    return all_same ? 0 : -1;
+}
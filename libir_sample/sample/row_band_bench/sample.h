@@ -0,0 +1,9 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+
+#include "row_band.h"
+#include "row_band_kernels.h"
+#include "bench_common.h"
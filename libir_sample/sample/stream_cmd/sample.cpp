@@ -77,6 +77,23 @@ int main(int argc, char* argv[])
         return -1;
     }
 
+    //run against a recording of raw_record_function instead of the camera
+    bool is_replay = !product_config.camera.replay_path.empty();
+    if (is_replay && raw_replay_load_config(product_config) != 0)
+    {
+        printf("load replay failed\n");
+        return -1;
+    }
+
+    //generate frames of the product layout instead of the camera, a load generator without hardware
+    bool is_synthetic = !is_replay && product_config.camera.synthetic;
+    if (is_synthetic && synthetic_camera_load_config(product_config) != 0)
+    {
+        printf("load synthetic camera failed\n");
+        return -1;
+    }
+    bool has_camera = !is_replay && !is_synthetic;
+
     printf("Depends lib version:\n");
     printf("version:%s\n", ircmd_version());
     printf("version:%s\n", ircam_version());
@@ -90,9 +107,8 @@ int main(int argc, char* argv[])
     printf("init all stream handle\n");
     int fd;
     int ret;
-    StreamFrameInfo_t stream_frame_info;
-    memset(&stream_frame_info, 0, sizeof(stream_frame_info) - sizeof(product_config));
-    stream_frame_info.product_config = product_config;
+    Pipeline_t* pipeline = pipeline_create(product_config);
+    StreamFrameInfo_t& stream_frame_info = pipeline->stream_frame_info;
 
     printf("init stream handle\n");
     if (!product_config.camera.v4l2_config.has_image)
@@ -101,16 +117,31 @@ int main(int argc, char* argv[])
         return -1;
     }
     stream_frame_info.image_name = (char*)product_config.camera.v4l2_config.image_stream.device_name.data();
-    ir_video_handle_create(&ir_image_video_handle);
-    //for v4l2
-    stream_frame_info.image_driver_handle = (Irv4l2VideoHandle_t*)irv4l2_handle_create(ir_image_video_handle);
+    ir_video_handle_create(&pipeline->ir_image_video_handle);
+    if (is_replay)
+    {
+        stream_frame_info.image_driver_handle = raw_replay_handle_create(pipeline->ir_image_video_handle, &stream_frame_info, RAW_REPLAY_IMAGE);
+    }
+    else if (is_synthetic)
+    {
+        stream_frame_info.image_driver_handle = synthetic_camera_handle_create(pipeline->ir_image_video_handle, &stream_frame_info, SYNTHETIC_IMAGE);
+    }
+    else
+    {
+        //for v4l2
+        stream_frame_info.image_driver_handle = v4l2_image_driver_handle_create(&stream_frame_info, pipeline->ir_image_video_handle);
+    }
     //for spi
-    //stream_frame_info.image_driver_handle = (IrspiVideoHandle_t*)irspi_handle_create(ir_image_video_handle);
+    //stream_frame_info.image_driver_handle = (IrspiVideoHandle_t*)irspi_handle_create(pipeline->ir_image_video_handle);
 
     printf("init control handle\n");
     IrControlHandle_t* ir_control_handle = NULL;
     ir_control_handle_create(&ir_control_handle);
-    if (product_config.control.is_i2c_control)
+    if (!has_camera)
+    {
+        printf("%s without control\n", is_replay ? "replay" : "synthetic camera");
+    }
+    else if (product_config.control.is_i2c_control)
     {
         Iri2cHandle_t* i2c_handle = NULL;
         i2c_handle = iri2c_handle_create(ir_control_handle);
@@ -154,39 +185,59 @@ int main(int argc, char* argv[])
     }
 
     //set auto image
-    if (!product_config.camera.is_auto_image)
+    if (has_camera && !product_config.camera.is_auto_image)
     {
         ret = auto_image_set(stream_frame_info);
         printf("auto_image_set:%d\n", ret);
     }
 
     load_stream_frame_info(&stream_frame_info, true, true);
-    init_pthread_sem();
-    pthread_t stream_thread,display_thread,capture_thread,cmd_thread;
+    pthread_t stream_thread,display_thread,capture_thread,cmd_thread,record_thread,alarm_thread;
     pthread_create(&stream_thread, NULL, v4l2_stream_function, &stream_frame_info);
+    if (!product_config.camera.record_path.empty())
+    {
+        pthread_create(&record_thread, NULL, raw_record_function, &stream_frame_info);
+    }
+    if (!product_config.camera.temp_alarms.empty())
+    {
+        pthread_create(&alarm_thread, NULL, temp_alarm_function, &stream_frame_info);
+    }
     //pthread_create(&stream_thread, NULL, spi_stream_function, &stream_frame_info);
     pthread_create(&display_thread, NULL, drm_display_function, &stream_frame_info);
    // pthread_create(&capture_thread, NULL, capture_function, &stream_frame_info);
-    pthread_create(&cmd_thread, NULL, cmd_function, &stream_frame_info);
+    if (has_camera)
+    {
+        pthread_create(&cmd_thread, NULL, cmd_function, &stream_frame_info);
+    }
     sleep(1);
 
     printf("in streaming\n");
     void *thread_result;
     pthread_join(stream_thread, &thread_result);
     printf("stop stream\n");
+    if (!product_config.camera.record_path.empty())
+    {
+        pthread_join(record_thread, &thread_result);
+    }
+    if (!product_config.camera.temp_alarms.empty())
+    {
+        pthread_join(alarm_thread, &thread_result);
+    }
     //pthread_cancel(display_thread);
     //pthread_cancel(cmd_thread);
-    destroy_pthread_sem();
     destroy_data_demo(&stream_frame_info);
 
-    ircmd_delete_handle(stream_frame_info.ircmd_handle);
+    if (stream_frame_info.ircmd_handle != NULL)
+    {
+        ircmd_delete_handle(stream_frame_info.ircmd_handle);
+    }
 
-    if (product_config.control.is_i2c_control)
+    if (has_camera && product_config.control.is_i2c_control)
     {
         ir_control_handle->ir_control_close(ir_control_handle->ir_control_handle);
         iri2c_handle_delete(ir_control_handle);
     }
-    else if(product_config.control.is_uart_control)
+    else if (has_camera && product_config.control.is_uart_control)
     {
         ir_control_handle->ir_control_close(ir_control_handle->ir_control_handle);
         iruart_handle_delete(ir_control_handle);
@@ -194,10 +245,21 @@ int main(int argc, char* argv[])
 
     ir_control_handle_delete(&ir_control_handle);
     ir_control_handle = NULL;
-    irv4l2_handle_delete((Irv4l2VideoHandle_t*)stream_frame_info.image_driver_handle);
+    if (is_replay)
+    {
+        raw_replay_handle_delete((RawReplayHandle_t*)stream_frame_info.image_driver_handle);
+    }
+    else if (is_synthetic)
+    {
+        synthetic_camera_handle_delete((SyntheticCameraHandle_t*)stream_frame_info.image_driver_handle);
+    }
+    else
+    {
+        v4l2_image_driver_handle_delete(&stream_frame_info);
+    }
     //irspi_handle_delete((IrspiVideoHandle_t*)stream_frame_info.image_driver_handle);
-    ir_video_handle_delete(&ir_image_video_handle);
-    ir_image_video_handle = NULL;
+    ir_video_handle_delete(&pipeline->ir_image_video_handle);
 
+    pipeline_destroy(pipeline);
     return 0;
 }
\ No newline at end of file
@@ -11,6 +11,10 @@
 #include "v4l2_camera.h"
 #include "spi_camera.h"
 #include "drm_display.h"
+#include "raw_record.h"
+#include "raw_replay_camera.h"
+#include "synthetic_camera.h"
+#include "temp_alarm.h"
 #include "cmd.h"
 #include "libiruart.h"
 #include "libiri2c.h"
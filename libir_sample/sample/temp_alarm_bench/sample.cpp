@@ -0,0 +1,285 @@
+#include "sample.h"
+
+//check the raise, hysteresis and clear of temp_alarm on a scripted sequence of frames, on the y16 and on the celsius
+//path, then time temp_alarm_process on frames of every size with a set of random rois all switching between over and
+//under their thresholds, while a second thread reads the events. the latency is from the frame arrival to the event
+//queued and to the event read
+
+#define BENCH_DEFAULT_ROI_NUM   64
+#define BENCH_DEFAULT_FRAMES    300
+#define BENCH_TOGGLE_FRAMES     10      //frames between two switches of the timed frames
+#define BENCH_FRAME_GAP_US      1000    //the timed frames come like a 1000 fps stream
+
+static void bench_fill(uint16_t* y16, int pixel_num, float celsius)
+{
+    uint16_t value = bench_y16(celsius);
+    for (int i = 0; i < pixel_num; i++)
+    {
+        y16[i] = value;
+    }
+}
+
+//the scripted check runs at 25 fps, an alarm with raise_ms and clear_ms of 100 changes on the 4th frame its
+//condition holds
+#define CHECK_WIDTH         64
+#define CHECK_HEIGHT        48
+#define CHECK_FRAMES        60
+#define CHECK_FRAME_US      40000
+
+typedef struct {
+    int frame;
+    int roi;
+    AlarmType_t type;
+    bool is_raised;
+}BenchEvent_t;
+
+//roi 0: a rect with a hot spot, over heat from 40, back under 39
+//roi 1: a point, over cold from 10, back over 11
+static const BenchEvent_t check_events[] = {
+    { 18, 0, OVER_HEAT, true },     //hot from frame 15, the 3 frames at 10~12 were too short
+    { 23, 1, OVER_COLD, true },     //cold from frame 20
+    { 36, 0, OVER_HEAT, false },    //back from frame 33, 25~29 stayed within the hysteresis, 30~31 were cut by 32
+    { 53, 1, OVER_COLD, false },    //back from frame 50, 40~49 stayed within the hysteresis
+};
+
+static float check_hot_temp(int frame)
+{
+    if (frame >= 10 && frame <= 12) return 41;
+    if (frame >= 15 && frame <= 24) return 41;
+    if (frame >= 25 && frame <= 29) return 39.5;
+    if (frame >= 30 && frame <= 31) return 38;
+    if (frame == 32) return 41;
+    if (frame >= 33) return 38;
+    return 30;
+}
+
+static float check_cold_temp(int frame)
+{
+    if (frame >= 20 && frame <= 39) return 9;
+    if (frame >= 40 && frame <= 49) return 10.5;
+    if (frame >= 50) return 12;
+    return 25;
+}
+
+static bool bench_check(bool use_celsius)
+{
+    Roi_t rois[2] = {
+        { ROI_TYPE_RECT, 0, 0, 31, 23 },
+        { ROI_TYPE_POINT, 50, 40, 50, 40 },
+    };
+    TempAlarmThreshold_t thresholds[2] = {
+        { true, 40, false, 0 },
+        { false, 0, true, 10 },
+    };
+    TempAlarmParam_t param = { 1, 100, 100 };
+    TempAlarm_t* alarm = temp_alarm_create(rois, thresholds, 2, CHECK_WIDTH, CHECK_HEIGHT, &param);
+    if (alarm == NULL)
+    {
+        return false;
+    }
+
+    int pixel_num = CHECK_WIDTH * CHECK_HEIGHT;
+    std::vector<uint16_t> y16(pixel_num);
+    std::vector<float> celsius(pixel_num);
+    int check_num = sizeof(check_events) / sizeof(check_events[0]);
+    int event_num = 0;
+    bool is_same = true;
+    for (int frame = 0; frame < CHECK_FRAMES; frame++)
+    {
+        bench_fill(&y16[0], pixel_num, 25);
+        y16[10 * CHECK_WIDTH + 10] = bench_y16(check_hot_temp(frame));
+        y16[40 * CHECK_WIDTH + 50] = bench_y16(check_cold_temp(frame));
+        for (int i = 0; i < pixel_num; i++)
+        {
+            celsius[i] = (float)(y16[i] / 64.0 - 273.15);
+        }
+        temp_alarm_process(alarm, &y16[0], use_celsius ? &celsius[0] : NULL, (uint64_t)frame * CHECK_FRAME_US);
+
+        TempAlarmEvent_t event;
+        while (temp_alarm_pop(alarm, &event) == 0)
+        {
+            int event_frame = (int)(event.frame_us / CHECK_FRAME_US);
+            printf("  frame %2d: roi %d %s %s, %.2f at (%d, %d)\n", event_frame, event.roi, \
+                (event.type == OVER_HEAT) ? "over heat" : "over cold", event.is_raised ? "raised" : "cleared", \
+                event.temp, event.x, event.y);
+            if (event_num >= check_num || check_events[event_num].frame != event_frame \
+                || check_events[event_num].roi != event.roi || check_events[event_num].type != event.type \
+                || check_events[event_num].is_raised != event.is_raised)
+            {
+                is_same = false;
+            }
+            event_num++;
+        }
+    }
+    temp_alarm_destroy(alarm);
+    return is_same && event_num == check_num;
+}
+
+//woken like the report thread of temp_alarm_function, after the frames that queued events and once at quit
+typedef struct {
+    TempAlarm_t* alarm;
+    std::atomic_bool quit;
+#if defined(_WIN32)
+    HANDLE event_sem;
+#elif defined(linux) || defined(unix)
+    sem_t event_sem;
+#endif
+    uint64_t event_num;
+    uint64_t read_sum_us;
+    uint64_t read_max_us;
+}BenchReader_t;
+
+static void bench_read(BenchReader_t* reader, const TempAlarmEvent_t* event)
+{
+    uint64_t read_us = frame_clock_us() - event->frame_us;
+    reader->event_num++;
+    reader->read_sum_us += read_us;
+    reader->read_max_us = (read_us > reader->read_max_us) ? read_us : reader->read_max_us;
+}
+
+static void bench_read_post(BenchReader_t* reader)
+{
+#if defined(_WIN32)
+    ReleaseSemaphore(reader->event_sem, 1, NULL);
+#elif defined(linux) || defined(unix)
+    sem_post(&reader->event_sem);
+#endif
+}
+
+static void* bench_read_function(void* threadarg)
+{
+    BenchReader_t* reader = (BenchReader_t*)threadarg;
+    TempAlarmEvent_t event;
+    bool is_quit = false;
+    while (!is_quit)
+    {
+#if defined(_WIN32)
+        WaitForSingleObject(reader->event_sem, INFINITE);
+#elif defined(linux) || defined(unix)
+        sem_wait(&reader->event_sem);
+#endif
+        is_quit = reader->quit;
+        while (temp_alarm_pop(reader->alarm, &event) == 0)
+        {
+            bench_read(reader, &event);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[])
+{
+    int roi_num = BENCH_DEFAULT_ROI_NUM;
+    int frame_num = BENCH_DEFAULT_FRAMES;
+    if (argc != 1 && argc != 3)
+    {
+        printf("usage: %s [<roi_num> <frames>]\n", argv[0]);
+        return -1;
+    }
+    if (argc == 3)
+    {
+        roi_num = atoi(argv[1]);
+        frame_num = atoi(argv[2]);
+    }
+    if (roi_num <= 0 || frame_num <= 0)
+    {
+        printf("set an illicit roi_num or frames\n");
+        return -1;
+    }
+
+    printf("scripted frames on y16:\n");
+    bool all_same = bench_check(false);
+    printf("scripted frames on celsius:\n");
+    all_same = bench_check(true) && all_same;
+
+    srand(1);
+    printf("%d rois(points, lines, rects) with a high and a low threshold, %d frames switching every %d, " \
+        "%d us apart, raise_ms and clear_ms 0:\n", roi_num, frame_num, BENCH_TOGGLE_FRAMES, BENCH_FRAME_GAP_US);
+    for (int s = 0; s < BENCH_SIZE_NUM; s++)
+    {
+        int width = bench_sizes[s].width;
+        int height = bench_sizes[s].height;
+        int pixel_num = width * height;
+        std::vector<Roi_t> rois(roi_num);
+        bench_make_rois(&rois[0], roi_num, width, height);
+        std::vector<TempAlarmThreshold_t> thresholds(roi_num);
+        for (int i = 0; i < roi_num; i++)
+        {
+            TempAlarmThreshold_t threshold = { true, 40, true, 10 };
+            thresholds[i] = threshold;
+        }
+        TempAlarmParam_t param = { 1, 0, 0 };
+        std::vector<uint16_t> hot(pixel_num), cold(pixel_num);
+        bench_fill(&hot[0], pixel_num, 45);
+        bench_fill(&cold[0], pixel_num, 5);
+
+        BenchReader_t* reader = new BenchReader_t;
+        reader->alarm = temp_alarm_create(&rois[0], &thresholds[0], roi_num, width, height, &param);
+        reader->quit = false;
+        reader->event_num = 0;
+        reader->read_sum_us = 0;
+        reader->read_max_us = 0;
+        if (reader->alarm == NULL)
+        {
+            delete reader;
+            return -1;
+        }
+#if defined(_WIN32)
+        reader->event_sem = CreateSemaphore(NULL, 0, TEMP_ALARM_QUEUE, NULL);
+#elif defined(linux) || defined(unix)
+        sem_init(&reader->event_sem, 0, 0);
+#endif
+        pthread_t read_thread;
+        pthread_create(&read_thread, NULL, bench_read_function, reader);
+
+        uint64_t process_us = 0;
+        for (int frame = 0; frame < frame_num; frame++)
+        {
+            const uint16_t* y16 = ((frame / BENCH_TOGGLE_FRAMES) % 2 == 0) ? &hot[0] : &cold[0];
+            uint64_t frame_us = frame_clock_us();
+            TempAlarmStats_t frame_stats;
+            temp_alarm_get_stats(reader->alarm, &frame_stats);
+            temp_alarm_process(reader->alarm, y16, NULL, frame_us);
+            process_us += frame_clock_us() - frame_us;
+            uint64_t event_num = frame_stats.event_num;
+            temp_alarm_get_stats(reader->alarm, &frame_stats);
+            if (frame_stats.event_num != event_num)
+            {
+                bench_read_post(reader);
+            }
+#if defined(_WIN32)
+            Sleep(BENCH_FRAME_GAP_US / 1000);
+#elif defined(linux) || defined(unix)
+            usleep(BENCH_FRAME_GAP_US);
+#endif
+        }
+        reader->quit = true;
+        bench_read_post(reader);
+        pthread_join(read_thread, NULL);
+
+        TempAlarmStats_t stats;
+        memset(&stats, 0, sizeof(stats));
+        temp_alarm_get_stats(reader->alarm, &stats);
+        //every switch raises one alarm and clears the other of each roi
+        uint64_t switch_num = (frame_num - 1) / BENCH_TOGGLE_FRAMES;
+        uint64_t expected_num = roi_num * (1 + 2 * switch_num);
+        bool is_same = (stats.event_num + stats.dropped == expected_num && reader->event_num == stats.event_num);
+        all_same = all_same && is_same;
+        printf("%dx%d: %.3f ms per frame, %llu events, %llu dropped  %s\n", width, height, \
+            process_us / 1000.0 / frame_num, (unsigned long long)stats.event_num, (unsigned long long)stats.dropped, \
+            is_same ? "same" : "DIFFERENT");
+        printf("  frame to queued %8.3f ms on average, %8.3f ms at most\n", \
+            (stats.event_num > 0) ? stats.latency_sum_us / 1000.0 / stats.event_num : 0.0, stats.latency_max_us / 1000.0);
+        printf("  frame to read   %8.3f ms on average, %8.3f ms at most\n", \
+            (reader->event_num > 0) ? reader->read_sum_us / 1000.0 / reader->event_num : 0.0, reader->read_max_us / 1000.0);
+#if defined(_WIN32)
+        CloseHandle(reader->event_sem);
+#elif defined(linux) || defined(unix)
+        sem_destroy(&reader->event_sem);
+#endif
+        temp_alarm_destroy(reader->alarm);
+        delete reader;
+    }
+    printf("%s\n", all_same ? "all outputs are the same" : "SOME OUTPUTS DIFFER");
+    return all_same ? 0 : -1;
+}
@@ -0,0 +1,14 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector>
+
+#if defined(_WIN32)
+#define HAVE_STRUCT_TIMESPEC
+#endif
+#include <pthread.h>
+
+#include "data.h"
+#include "temp_alarm.h"
+#include "bench_common.h"
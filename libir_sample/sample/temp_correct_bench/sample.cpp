@@ -0,0 +1,267 @@
+#include "sample.h"
+
+//time a corrected temperature map made with one enhance_distance_temp_correct call per pixel against the
+//correction lut, and the cost of refilling the lut when the env param changes. the lut output is checked against
+//the per pixel calls, and against direct calls for celsius values between two y16 values. a correct map with regions
+//of a few materials and distances is checked against per pixel calls with the param of each pixel
+
+#define BENCH_DEFAULT_TABLE     "V265_wn256without_dust_tablets_L.bin"
+#define BENCH_DEFAULT_LOOPS     20
+#define BENCH_CELSIUS_NUM       10000
+#define BENCH_MAX_ERROR         0.01    //celsius
+#define BENCH_REGION_NUM        12
+
+//a few hot and cold pixels on the background, out of the range of the background
+static void bench_add_spots(uint16_t* y16, int width, int height)
+{
+    for (int i = 0; i < 64; i++)
+    {
+        y16[bench_rand(width * height)] = (uint16_t)(bench_rand(2) ? (273.15 + 300) * 64 : (273.15 - 20) * 64);
+    }
+}
+
+//regions of 3 materials at 2 distances over the frame, so some of them share their lut
+static void bench_make_regions(TempCorrectRegion_t* regions, int region_num, int width, int height)
+{
+    static const float ems[] = { 0.95f, 0.80f, 0.60f };
+    static const float dist[] = { 1.0f, 5.0f };
+    for (int i = 0; i < region_num; i++)
+    {
+        TempCorrectRegion_t* region = &regions[i];
+        region->start_x = bench_rand(width);
+        region->start_y = bench_rand(height);
+        region->end_x = region->start_x + bench_rand(width / 3);
+        region->end_y = region->start_y + bench_rand(height / 3);
+        region->end_x = (region->end_x >= width) ? width - 1 : region->end_x;
+        region->end_y = (region->end_y >= height) ? height - 1 : region->end_y;
+        region->ems = ems[i % 3];
+        region->dist = dist[i % 2];
+    }
+}
+
+//the param of every pixel, the last region over it wins
+static void bench_pixel_params(const EnvCorrectParam* env_correct_param, const TempCorrectRegion_t* regions, \
+    int region_num, int width, int height, std::vector<EnvCorrectParam>* params)
+{
+    params->assign(width * height, *env_correct_param);
+    for (int i = 0; i < region_num; i++)
+    {
+        for (int y = regions[i].start_y; y <= regions[i].end_y; y++)
+        {
+            for (int x = regions[i].start_x; x <= regions[i].end_x; x++)
+            {
+                (*params)[y * width + x].ems = regions[i].ems;
+                (*params)[y * width + x].dist = regions[i].dist;
+            }
+        }
+    }
+}
+
+static bool bench_map(uint16_t* correct_table, uint32_t table_len, const EnvCorrectParam* env_correct_param, int loops)
+{
+    bool all_same = true;
+    for (int s = 0; s < BENCH_SIZE_NUM; s++)
+    {
+        int width = bench_sizes[s].width;
+        int height = bench_sizes[s].height;
+        int pixel_num = width * height;
+        std::vector<uint16_t> y16(pixel_num);
+        bench_make_frame(&y16[0], width, height, 1);
+        bench_add_spots(&y16[0], width, height);
+        TempCorrectRegion_t regions[BENCH_REGION_NUM];
+        bench_make_regions(regions, BENCH_REGION_NUM, width, height);
+
+        TempCorrectMap_t* map = temp_correct_map_create(correct_table, table_len, width, height);
+        uint64_t start_us = bench_clock_us();
+        if (temp_correct_map_set_regions(map, env_correct_param, regions, BENCH_REGION_NUM) < 0)
+        {
+            temp_correct_map_destroy(map);
+            return false;
+        }
+        double set_ms = (bench_clock_us() - start_us) / 1000.0;
+        //a set with the luts already filled only cuts the runs again
+        start_us = bench_clock_us();
+        temp_correct_map_set_regions(map, env_correct_param, regions, BENCH_REGION_NUM);
+        double reset_ms = (bench_clock_us() - start_us) / 1000.0;
+
+        std::vector<EnvCorrectParam> params;
+        bench_pixel_params(env_correct_param, regions, BENCH_REGION_NUM, width, height, &params);
+        std::vector<float> expected(pixel_num);
+        start_us = bench_clock_us();
+        for (int i = 0; i < pixel_num; i++)
+        {
+            float org_temp = (float)(y16[i] / 64.0 - 273.15);
+            enhance_distance_temp_correct(&params[i], correct_table, table_len, org_temp, &expected[i]);
+        }
+        double call_ms = (bench_clock_us() - start_us) / 1000.0;
+
+        const float* celsius = NULL;
+        start_us = bench_clock_us();
+        for (int loop = 0; loop < loops; loop++)
+        {
+            celsius = temp_correct_map_apply(map, &y16[0]);
+        }
+        double map_ms = (bench_clock_us() - start_us) / 1000.0 / loops;
+
+        bool same = (celsius != NULL);
+        for (int i = 0; i < pixel_num && same; i++)
+        {
+            same = (fabs(celsius[i] - expected[i]) <= BENCH_MAX_ERROR);
+        }
+
+        //the same params given pixel by pixel
+        std::vector<float> ems_map(pixel_num), dist_map(pixel_num);
+        for (int i = 0; i < pixel_num; i++)
+        {
+            ems_map[i] = params[i].ems;
+            dist_map[i] = params[i].dist;
+        }
+        start_us = bench_clock_us();
+        bool pixels_same = (temp_correct_map_set_pixels(map, env_correct_param, &ems_map[0], &dist_map[0]) == 0);
+        double pixels_ms = (bench_clock_us() - start_us) / 1000.0;
+        celsius = pixels_same ? temp_correct_map_apply(map, &y16[0]) : NULL;
+        pixels_same = (celsius != NULL);
+        for (int i = 0; i < pixel_num && pixels_same; i++)
+        {
+            pixels_same = (fabs(celsius[i] - expected[i]) <= BENCH_MAX_ERROR);
+        }
+        all_same = all_same && same && pixels_same;
+
+        printf("%dx%d with %d regions, %d luts, set in %.3f ms, set again %.3f ms:\n", width, height, BENCH_REGION_NUM, \
+            temp_correct_map_lut_num(map), set_ms, reset_ms);
+        printf("  %-32s %9.3f ms\n", "enhance_distance_temp_correct", call_ms);
+        printf("  %-32s %9.3f ms  x%.0f  %s\n", "correct map", map_ms, (map_ms > 0) ? call_ms / map_ms : 0.0, \
+            same ? "same output" : "OUTPUT DIFFERS");
+        printf("  %-32s %9.3f ms  %s\n", "set from pixel maps", pixels_ms, pixels_same ? "same output" : "OUTPUT DIFFERS");
+        temp_correct_map_destroy(map);
+    }
+    return all_same;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* table_path = BENCH_DEFAULT_TABLE;
+    int loops = BENCH_DEFAULT_LOOPS;
+    if (argc > 3)
+    {
+        printf("usage: %s [<correct_table> [<loops>]]\n", argv[0]);
+        return -1;
+    }
+    if (argc >= 2)
+    {
+        table_path = argv[1];
+    }
+    if (argc == 3)
+    {
+        loops = atoi(argv[2]);
+    }
+    if (loops <= 0)
+    {
+        printf("set an illicit loops\n");
+        return -1;
+    }
+
+    uint16_t correct_table[HEAD_SIZE + 45 * 88];
+    uint32_t table_len = 0;
+    FILE* fp = fopen(table_path, "rb");
+    if (fp == NULL)
+    {
+        printf("%s failed\n", table_path);
+        return -1;
+    }
+    fread(correct_table, 1, sizeof(correct_table), fp);
+    fclose(fp);
+
+    EnvCorrectParam env_correct_param;
+    memset(&env_correct_param, 0, sizeof(env_correct_param));
+    env_correct_param.dist = 0.25;
+    env_correct_param.ems = 0.98;
+    env_correct_param.hum = 0.45;
+    env_correct_param.ta = 25;
+    env_correct_param.tu = 25;
+    TempCorrectLut_t* lut = temp_correct_lut_create(correct_table, table_len);
+    if (lut == NULL)
+    {
+        return -1;
+    }
+
+    //every loop changes the emissivity so the lut is refilled, then updates it again with the same param
+    double refill_ms = 0, same_ms = 0;
+    for (int loop = 0; loop < loops; loop++)
+    {
+        env_correct_param.ems = 0.90f + 0.01f * (loop % 2);
+        uint64_t start_us = bench_clock_us();
+        temp_correct_lut_update(lut, &env_correct_param);
+        uint64_t refilled_us = bench_clock_us();
+        temp_correct_lut_update(lut, &env_correct_param);
+        same_ms += (bench_clock_us() - refilled_us) / 1000.0;
+        refill_ms += (refilled_us - start_us) / 1000.0;
+    }
+    env_correct_param.ems = 0.98f;
+    temp_correct_lut_update(lut, &env_correct_param);
+    printf("%d loops, lut refilled in %.3f ms, update with the same param %.4f ms\n", loops, refill_ms / loops, \
+        same_ms / loops);
+
+    bool all_same = true;
+    srand(1);
+    for (int s = 0; s < BENCH_SIZE_NUM; s++)
+    {
+        int width = bench_sizes[s].width;
+        int height = bench_sizes[s].height;
+        int pixel_num = width * height;
+        std::vector<uint16_t> y16(pixel_num);
+        bench_make_frame(&y16[0], width, height, 1);
+        bench_add_spots(&y16[0], width, height);
+
+        //the per pixel calls are too slow to loop, one frame is enough
+        std::vector<float> expected(pixel_num);
+        uint64_t start_us = bench_clock_us();
+        for (int i = 0; i < pixel_num; i++)
+        {
+            float org_temp = (float)(y16[i] / 64.0 - 273.15);
+            enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, org_temp, &expected[i]);
+        }
+        double call_ms = (bench_clock_us() - start_us) / 1000.0;
+
+        std::vector<float> celsius(pixel_num);
+        start_us = bench_clock_us();
+        for (int loop = 0; loop < loops; loop++)
+        {
+            temp_correct_lut_apply(lut, &y16[0], &celsius[0], pixel_num);
+        }
+        double lut_ms = (bench_clock_us() - start_us) / 1000.0 / loops;
+
+        bool same = true;
+        for (int i = 0; i < pixel_num; i++)
+        {
+            same = same && (fabs(celsius[i] - expected[i]) <= BENCH_MAX_ERROR);
+        }
+        all_same = all_same && same;
+
+        printf("%dx%d corrected temperature map:\n", width, height);
+        printf("  %-32s %9.3f ms\n", "enhance_distance_temp_correct", call_ms);
+        printf("  %-32s %9.3f ms  x%.0f  %s\n", "correction lut", lut_ms, (lut_ms > 0) ? call_ms / lut_ms : 0.0, \
+            same ? "same output" : "OUTPUT DIFFERS");
+    }
+
+    //averages fall between two y16 values and are interpolated
+    double max_error = 0;
+    for (int i = 0; i < BENCH_CELSIUS_NUM; i++)
+    {
+        float org_temp = -20 + bench_rand(400000) / 1000.0f;
+        float new_temp;
+        enhance_distance_temp_correct(&env_correct_param, correct_table, table_len, org_temp, &new_temp);
+        double error = fabs(temp_correct_lut_celsius(lut, org_temp) - new_temp);
+        max_error = (error > max_error) ? error : max_error;
+    }
+    bool celsius_same = (max_error <= BENCH_MAX_ERROR);
+    all_same = all_same && celsius_same;
+    printf("%d celsius values from -20 to 380, max error of the lut %.5f %s\n", BENCH_CELSIUS_NUM, max_error, \
+        celsius_same ? "" : "TOO LARGE");
+
+    all_same = bench_map(correct_table, table_len, &env_correct_param, loops) && all_same;
+
+    temp_correct_lut_destroy(lut);
+    printf("%s\n", all_same ? "all outputs are the same" : "SOME OUTPUTS DIFFER");
+    return all_same ? 0 : -1;
+}
@@ -0,0 +1,10 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "libirtemp.h"
+#include "temp_correct.h"
+#include "bench_common.h"
@@ -5,6 +5,10 @@
 
 #include "uvc_camera.h"
 #include "opencv_display.h"
+#include "raw_record.h"
+#include "raw_replay_camera.h"
+#include "synthetic_camera.h"
 #include "cmd.h"
 #include "libiruart.h"
 #include "temp_measure.h"
+#include "temp_alarm.h"
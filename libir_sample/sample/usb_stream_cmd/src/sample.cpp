@@ -23,6 +23,23 @@ int main(int argc, char* argv[])
         return -1;
     }
 
+    //run against a recording of raw_record_function instead of the camera
+    bool is_replay = !product_config.camera.replay_path.empty();
+    if (is_replay && raw_replay_load_config(product_config) != 0)
+    {
+        printf("load replay failed\n");
+        return -1;
+    }
+
+    //generate frames of the product layout instead of the camera, a load generator without hardware
+    bool is_synthetic = !is_replay && product_config.camera.synthetic;
+    if (is_synthetic && synthetic_camera_load_config(product_config) != 0)
+    {
+        printf("load synthetic camera failed\n");
+        return -1;
+    }
+    bool has_camera = !is_replay && !is_synthetic;
+
     printf("uart cmd and usb image sample start\n");
     printf("Depends lib version:\n");
     printf("version:%s\n", ircmd_version());
@@ -38,15 +55,25 @@ int main(int argc, char* argv[])
     printf("init uvc stream handle\n");
     int fd;
     int ret;
-    StreamFrameInfo_t stream_frame_info;
-    memset(&stream_frame_info, 0, sizeof(stream_frame_info) - sizeof(product_config));
-    stream_frame_info.product_config = product_config;
+    Pipeline_t* pipeline = pipeline_create(product_config);
+    StreamFrameInfo_t& stream_frame_info = pipeline->stream_frame_info;
 
     printf("init stream handle\n");
-    ir_video_handle_create(&ir_image_video_handle);//创建video_handle
+    ir_video_handle_create(&pipeline->ir_image_video_handle);//创建video_handle
 
-    iruvc_handle = (IruvcHandle_t*)iruvc_camera_handle_create(ir_image_video_handle);//创建uvc_handle
-    stream_frame_info.image_driver_handle = iruvc_handle;
+    if (is_replay)
+    {
+        stream_frame_info.image_driver_handle = raw_replay_handle_create(pipeline->ir_image_video_handle, &stream_frame_info, RAW_REPLAY_IMAGE);
+    }
+    else if (is_synthetic)
+    {
+        stream_frame_info.image_driver_handle = synthetic_camera_handle_create(pipeline->ir_image_video_handle, &stream_frame_info, SYNTHETIC_IMAGE);
+    }
+    else
+    {
+        iruvc_handle = (IruvcHandle_t*)iruvc_camera_handle_create(pipeline->ir_image_video_handle);//创建uvc_handle
+        stream_frame_info.image_driver_handle = iruvc_handle;
+    }
     IruvcDevParam_t dev_param;
     memset(&dev_param, 0, sizeof(IruvcDevParam_t));
 
@@ -55,9 +82,9 @@ int main(int argc, char* argv[])
     dev_param.same_idx = product_config.camera.uvc_stream_conf.dev_info.same_id;
 
     stream_frame_info.image_dev_params = &dev_param;
-    ret = ir_image_video_handle->ir_video_open(stream_frame_info.image_driver_handle, &dev_param);
+    ret = pipeline->ir_image_video_handle->ir_video_open(stream_frame_info.image_driver_handle, &dev_param);
     printf("open video : %d\n", ret);
-    ret = ir_image_video_handle->ir_video_init(stream_frame_info.image_driver_handle, &dev_param);
+    ret = pipeline->ir_image_video_handle->ir_video_init(stream_frame_info.image_driver_handle, &dev_param);
     printf("init video : %d\n", ret);
     IruvcCamStreamParams_t params;
     memset(&params, 0, sizeof(params));
@@ -66,7 +93,11 @@ int main(int argc, char* argv[])
     printf("init control handle\n");
     IrControlHandle_t* ir_control_handle = NULL;
     ir_control_handle_create(&ir_control_handle);
-    if (product_config.control.is_usb_control || product_config.control.is_i2c_usb_control)
+    if (!has_camera)
+    {
+        printf("%s without control\n", is_replay ? "replay" : "synthetic camera");
+    }
+    else if (product_config.control.is_usb_control || product_config.control.is_i2c_usb_control)
     {
         if (product_config.control.is_usb_control)
         {
@@ -111,7 +142,7 @@ int main(int argc, char* argv[])
     }
 
 
-    if (!product_config.camera.is_auto_image)
+    if (has_camera && !product_config.camera.is_auto_image)
     {
         ret = basic_video_stream_continue(stream_frame_info.ircmd_handle);
         printf("basic_video_stream_continue:%d\n", ret);    //control mipi start
@@ -122,31 +153,51 @@ int main(int argc, char* argv[])
     //printf("adv_mipi_channel_type_set:%d\n", ret);
 
     load_stream_frame_info(&stream_frame_info, false, true);
-    init_pthread_sem();
-    pthread_t stream_thread, display_thread, cmd_thread, temp_thread;
+    pthread_t stream_thread, display_thread, cmd_thread, temp_thread, record_thread, alarm_thread;
     pthread_create(&stream_thread, NULL, uvc_stream_function, &stream_frame_info);
+    if (!product_config.camera.record_path.empty())
+    {
+        pthread_create(&record_thread, NULL, raw_record_function, &stream_frame_info);
+    }
     pthread_create(&display_thread, NULL, opencv_display_function, &stream_frame_info);
     if (product_config.camera.open_temp_measure)
     {
         pthread_create(&temp_thread, NULL, temp_measure_function, &stream_frame_info);
     }
-    pthread_create(&cmd_thread, NULL, cmd_function, &stream_frame_info);
+    if (!product_config.camera.temp_alarms.empty())
+    {
+        pthread_create(&alarm_thread, NULL, temp_alarm_function, &stream_frame_info);
+    }
+    if (has_camera)
+    {
+        pthread_create(&cmd_thread, NULL, cmd_function, &stream_frame_info);
+    }
 
     printf("in streaming\n");
     void* thread_result;
     pthread_join(stream_thread, &thread_result);
     printf("stop stream\n");
+    if (!product_config.camera.record_path.empty())
+    {
+        pthread_join(record_thread, &thread_result);
+    }
+    if (!product_config.camera.temp_alarms.empty())
+    {
+        pthread_join(alarm_thread, &thread_result);
+    }
     pthread_cancel(display_thread);
     if (product_config.camera.open_temp_measure)
     {
         pthread_cancel(temp_thread);
     }
-    pthread_cancel(cmd_thread);
-    pthread_join(cmd_thread, &thread_result);
-    destroy_pthread_sem();
+    if (has_camera)
+    {
+        pthread_cancel(cmd_thread);
+        pthread_join(cmd_thread, &thread_result);
+    }
     destroy_data_demo(&stream_frame_info);
 
-    if (product_config.control.is_usb_control || product_config.control.is_i2c_usb_control)
+    if (has_camera && (product_config.control.is_usb_control || product_config.control.is_i2c_usb_control))
     {
         ircmd_delete_handle(stream_frame_info.ircmd_handle);
         stream_frame_info.ircmd_handle = NULL;
@@ -161,7 +212,7 @@ int main(int argc, char* argv[])
             iruvc_i2c_usb_handle_delete(iruvc_handle);
         }
     }
-    else if (product_config.control.is_uart_control)
+    else if (has_camera && product_config.control.is_uart_control)
     {
         ircmd_delete_handle(stream_frame_info.ircmd_handle);
         stream_frame_info.ircmd_handle = NULL;
@@ -172,11 +223,23 @@ int main(int argc, char* argv[])
 
     ir_control_handle_delete(&ir_control_handle);
     ir_control_handle = NULL;
-    ir_image_video_handle->ir_video_release(stream_frame_info.image_driver_handle, &dev_param);
-    ir_image_video_handle->ir_video_close(stream_frame_info.image_driver_handle);
-    iruvc_camera_handle_delete(iruvc_handle);
-    iruvc_handle = NULL;
-    ir_video_handle_delete(&ir_image_video_handle);
+    pipeline->ir_image_video_handle->ir_video_release(stream_frame_info.image_driver_handle, &dev_param);
+    pipeline->ir_image_video_handle->ir_video_close(stream_frame_info.image_driver_handle);
+    if (is_replay)
+    {
+        raw_replay_handle_delete((RawReplayHandle_t*)stream_frame_info.image_driver_handle);
+    }
+    else if (is_synthetic)
+    {
+        synthetic_camera_handle_delete((SyntheticCameraHandle_t*)stream_frame_info.image_driver_handle);
+    }
+    else
+    {
+        iruvc_camera_handle_delete(iruvc_handle);
+        iruvc_handle = NULL;
+    }
+    ir_video_handle_delete(&pipeline->ir_image_video_handle);
 
+    pipeline_destroy(pipeline);
     return 0;
 }
@@ -0,0 +1,151 @@
+#include "sample.h"
+#include "config.h"
+
+//compare one v4l2 reactor thread with a stream thread per camera on the same nodes, e.g. vivid instances:
+//  modprobe vivid n_devs=4 node_types=0x1,0x1,0x1,0x1
+//the product's v4l2_stream image entry gives the dev_width/dev_height/fps requested from every node
+
+static double timeval_ms(struct timeval* tv)
+{
+    return tv->tv_sec * 1000.0 + tv->tv_usec / 1000.0;
+}
+
+int main(int argc, char* argv[])
+{
+    printf("v4l2 reactor bench sample start\n");
+    if (argc < 5)
+    {
+        printf("usage: %s <path_of_config_file> <thread|reactor> <seconds> <video_node> [video_node ...]\n", argv[0]);
+        return -1;
+    }
+
+    config config_obj;
+    if (config_obj.parse_config(argv[1]) != 0)
+    {
+        printf("parse config failed\n");
+        return -1;
+    }
+    single_config product_config;
+    if (false == config_obj.get_config(product_config))
+    {
+        printf("can't find config\n");
+        return -1;
+    }
+    if (!product_config.camera.v4l2_config.has_image)
+    {
+        printf("not found image stream config\n");
+        return -1;
+    }
+
+    bool use_reactor = (strcmp(argv[2], "reactor") == 0);
+    int seconds = atoi(argv[3]);
+    int camera_num = argc - 4;
+    if (seconds <= 0)
+    {
+        printf("set an illicit time\n");
+        return -1;
+    }
+
+    irv4l2_log_register(IRV4L2_LOG_ERROR, NULL, NULL);
+
+    //both models dequeue mmap buffers, so the difference is the threading only. every node is a single channel camera
+    product_config.camera.v4l2_capture_mode = "mmap";
+    product_config.camera.v4l2_config.has_temp = false;
+    if (product_config.camera.image_channel_type == "dvp")
+    {
+        product_config.camera.image_channel_type = "mipi";
+    }
+
+    std::vector<Pipeline_t*> pipelines;
+    for (int i = 0; i < camera_num; i++)
+    {
+        single_config camera_config = product_config;
+        camera_config.camera.v4l2_config.image_stream.device_name = argv[4 + i];
+        Pipeline_t* pipeline = pipeline_create(camera_config);
+        StreamFrameInfo_t& stream_frame_info = pipeline->stream_frame_info;
+        stream_frame_info.image_name = (char*)stream_frame_info.product_config.camera.v4l2_config.image_stream.device_name.data();
+        ir_video_handle_create(&pipeline->ir_image_video_handle);
+        stream_frame_info.image_driver_handle = v4l2_image_driver_handle_create(&stream_frame_info, pipeline->ir_image_video_handle);
+        load_stream_frame_info(&stream_frame_info, true, true);
+        pipelines.push_back(pipeline);
+    }
+
+    V4l2Reactor_t* reactor = NULL;
+    std::vector<pthread_t> threads;
+    if (use_reactor)
+    {
+        reactor = v4l2_reactor_create();
+        if (reactor == NULL)
+        {
+            return -1;
+        }
+        for (int i = 0; i < camera_num; i++)
+        {
+            if (v4l2_reactor_add_pipeline(reactor, pipelines[i]) != 0)
+            {
+                return -1;
+            }
+        }
+        pthread_t reactor_thread;
+        pthread_create(&reactor_thread, NULL, v4l2_reactor_function, reactor);
+        threads.push_back(reactor_thread);
+    }
+    else
+    {
+        for (int i = 0; i < camera_num; i++)
+        {
+            pthread_t stream_thread;
+            pthread_create(&stream_thread, NULL, v4l2_stream_function, &pipelines[i]->stream_frame_info);
+            threads.push_back(stream_thread);
+        }
+    }
+
+    //skip the stream on of the nodes
+    sleep(1);
+    std::vector<uint64_t> start_frames(camera_num);
+    for (int i = 0; i < camera_num; i++)
+    {
+        start_frames[i] = frame_ring_published(pipelines[i]->stream_frame_info.frame_ring);
+    }
+    struct rusage start_usage, end_usage;
+    getrusage(RUSAGE_SELF, &start_usage);
+    uint64_t start_us = frame_clock_us();
+
+    sleep(seconds);
+
+    uint64_t total_frames = 0;
+    double elapsed_s = (frame_clock_us() - start_us) / 1000000.0;
+    getrusage(RUSAGE_SELF, &end_usage);
+    for (int i = 0; i < camera_num; i++)
+    {
+        uint64_t frames = frame_ring_published(pipelines[i]->stream_frame_info.frame_ring) - start_frames[i];
+        total_frames += frames;
+        printf("%s: %llu frames, %.1f fps\n", argv[4 + i], (unsigned long long)frames, frames / elapsed_s);
+    }
+
+    double cpu_ms = timeval_ms(&end_usage.ru_utime) - timeval_ms(&start_usage.ru_utime) \
+        + timeval_ms(&end_usage.ru_stime) - timeval_ms(&start_usage.ru_stime);
+    printf("%s, %d cameras, %d capture threads\n", use_reactor ? "reactor" : "thread per stream", camera_num, (int)threads.size());
+    printf("total %.1f fps, cpu %.1f%%, %.3f ms cpu per frame\n", total_frames / elapsed_s, cpu_ms / 10.0 / elapsed_s, \
+        (total_frames == 0) ? 0.0 : cpu_ms / total_frames);
+    printf("context switches: %ld voluntary, %ld involuntary\n", end_usage.ru_nvcsw - start_usage.ru_nvcsw, \
+        end_usage.ru_nivcsw - start_usage.ru_nivcsw);
+
+    for (int i = 0; i < camera_num; i++)
+    {
+        pipeline_stop(pipelines[i]);
+    }
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+    v4l2_reactor_delete(reactor);
+
+    for (int i = 0; i < camera_num; i++)
+    {
+        destroy_data_demo(&pipelines[i]->stream_frame_info);
+        v4l2_image_driver_handle_delete(&pipelines[i]->stream_frame_info);
+        pipeline_destroy(pipelines[i]);
+    }
+    return 0;
+}
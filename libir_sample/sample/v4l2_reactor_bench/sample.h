@@ -0,0 +1,14 @@
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <pthread.h>
+
+#include <unistd.h>
+#include <linux/videodev2.h>
+
+#include "v4l2_camera.h"
+#include "v4l2_reactor.h"
+#include "frame_ring.h"
@@ -0,0 +1,155 @@
+#include "sample.h"
+
+//encode synthetic frames of the given size with the video recorder as fast as it takes them: the image track alone,
+//the y16 temp track alone and both together. reports the encode fps and the cpu it costs per frame, the cpu of
+//every encoder thread included, so a frame rate the camera delivers can be checked against the cpu left
+
+#define BENCH_DEFAULT_WIDTH     640
+#define BENCH_DEFAULT_HEIGHT    512
+#define BENCH_DEFAULT_FRAMES    250
+#define BENCH_FRAME_INTERVAL_US 40000   //25fps timestamps
+
+typedef struct {
+    const char* name;
+    const char* path;
+    bool has_image;
+    bool has_temp;
+}BenchCase_t;
+
+static const BenchCase_t bench_cases[] = {
+    { "image", "video_record_bench_image.mkv", true, false },
+    { "y16 temp", "video_record_bench_temp.mkv", false, true },
+    { "image + y16 temp", "video_record_bench_both.mkv", true, true },
+};
+
+//user + system time of all the threads of the process
+static uint64_t bench_cpu_us()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (uint64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000 + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static long bench_file_size(const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+//a warm blob moving over a gradient with some noise, closer to a thermal scene than random data
+static void bench_make_frame(int frame, int width, int height, uint8_t* yuyv, uint16_t* y16)
+{
+    int blob_x = (frame * 4) % width;
+    int blob_y = height / 2;
+    int radius = height / 6;
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int dx = x - blob_x;
+            int dy = y - blob_y;
+            int value = 5000 + y * 4 + (rand() & 0x1f);
+            if (dx * dx + dy * dy < radius * radius)
+            {
+                value += 4000;
+            }
+            y16[y * width + x] = (uint16_t)value;
+
+            uint8_t* pixel = yuyv + (y * width + x) * 2;
+            pixel[0] = (uint8_t)(value >> 6);
+            pixel[1] = 128;
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    int width = BENCH_DEFAULT_WIDTH;
+    int height = BENCH_DEFAULT_HEIGHT;
+    int frames = BENCH_DEFAULT_FRAMES;
+    const char* codec = "mjpeg";
+    if (argc > 1 && argc < 4)
+    {
+        printf("usage: %s [<width> <height> <frames> [mjpeg|h264]]\n", argv[0]);
+        return -1;
+    }
+    if (argc >= 4)
+    {
+        width = atoi(argv[1]);
+        height = atoi(argv[2]);
+        frames = atoi(argv[3]);
+    }
+    if (argc >= 5)
+    {
+        codec = argv[4];
+    }
+    if (width <= 0 || height <= 0 || (width % 2) != 0 || frames <= 0)
+    {
+        printf("set an illicit size\n");
+        return -1;
+    }
+
+    //a few distinct frames are enough, the encoders see motion without the generator in the timing
+    const int source_num = 25;
+    std::vector<std::vector<uint8_t> > yuyv(source_num, std::vector<uint8_t>(width * height * 2));
+    std::vector<std::vector<uint16_t> > y16(source_num, std::vector<uint16_t>(width * height));
+    srand(1);
+    for (int i = 0; i < source_num; i++)
+    {
+        bench_make_frame(i, width, height, &yuyv[i][0], &y16[i][0]);
+    }
+
+    printf("%dx%d, %d frames, %s:\n", width, height, frames, codec);
+    int case_num = sizeof(bench_cases) / sizeof(bench_cases[0]);
+    for (int i = 0; i < case_num; i++)
+    {
+        const BenchCase_t& bench_case = bench_cases[i];
+        VideoRecordParam_t param;
+        param.codec = codec;
+        param.has_image = bench_case.has_image;
+        param.image_format = VIDEO_RECORD_YUYV;
+        param.image_width = width;
+        param.image_height = height;
+        param.has_temp = bench_case.has_temp;
+        param.temp_width = width;
+        param.temp_height = height;
+
+        //the encoder setup is paid once per recording, it is timed apart from the frames
+        uint64_t open_start_us = frame_clock_us();
+        VideoRecord_t* record = video_record_create(bench_case.path, &param);
+        if (record == NULL)
+        {
+            printf("  %-18s can not record\n", bench_case.name);
+            continue;
+        }
+        uint64_t open_us = frame_clock_us() - open_start_us;
+
+        uint64_t start_us = frame_clock_us();
+        uint64_t start_cpu_us = bench_cpu_us();
+        int written = 0;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            if (video_record_write(record, &yuyv[frame % source_num][0], &y16[frame % source_num][0], \
+                (uint64_t)frame * BENCH_FRAME_INTERVAL_US) != 0)
+            {
+                break;
+            }
+            written++;
+        }
+        video_record_close(record);
+        double wall_ms = (frame_clock_us() - start_us) / 1000.0;
+        double cpu_ms = (bench_cpu_us() - start_cpu_us) / 1000.0;
+
+        printf("  %-18s %8.1f fps  cpu %6.1f%%  %6.2f ms cpu/frame  open %6.2f ms  %ld bytes\n", bench_case.name, \
+            (wall_ms > 0) ? written * 1000.0 / wall_ms : 0.0, (wall_ms > 0) ? cpu_ms * 100 / wall_ms : 0.0, \
+            (written > 0) ? cpu_ms / written : 0.0, open_us / 1000.0, bench_file_size(bench_case.path));
+    }
+    return 0;
+}